@@ -0,0 +1,323 @@
+/**
+ * @file acoustic.c
+ * @author Anthony Yalong
+ * @brief I2S microphone capture and glass-break classifier implementation
+ */
+
+#include "acoustic.h"
+#include <string.h>
+#include "esp_cpu.h"
+#include "esp_dsp.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+
+static const char *TAG = "ACOUSTIC";
+
+// 24-bit mic samples arrive left-justified in 32-bit slots
+#define ACOUSTIC_SAMPLE_SHIFT       8
+#define ACOUSTIC_SAMPLE_SCALE       (1.0f / 8388608.0f)
+
+// fft tables are global in esp-dsp, shared by every instance
+static bool fft_initialized = false;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief I2S receive queue overflow callback - counts lost dma buffers
+ *
+ * @param handle I2S channel handle
+ * @param event Event data
+ * @param user_ctx Pointer to sensor structure
+ * @return bool always false
+ */
+static bool acoustic_on_recv_overflow(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+
+/**
+ * @brief Processing task - reads one hop per dma buffer and processes it
+ *
+ * @param pvParameters Pointer to sensor structure
+ */
+static void acoustic_task(void *pvParameters);
+
+/**
+ * @brief Windowed fft of the analysis buffer and band energies
+ *
+ * @param sensor Pointer to sensor structure
+ * @param features Output features
+ */
+static void compute_features(acoustic_sensor_t *sensor, acoustic_features_t *features);
+
+/**
+ * @brief Step the impact/shatter state machine with one hop of features
+ *
+ * @param sensor Pointer to sensor structure
+ * @param features Features of the current hop
+ */
+static void classify(acoustic_sensor_t *sensor, const acoustic_features_t *features);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t acoustic_sensor_init(acoustic_sensor_t *sensor, acoustic_event_cb_t callback, void *arg) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->callback = callback;
+    sensor->callback_arg = arg;
+    sensor->noise_floor = ACOUSTIC_NOISE_MIN;
+    sensor->warmup_hops = ACOUSTIC_WARMUP_HOPS;
+
+    if (!fft_initialized) {
+        ret = dsps_fft2r_init_fc32(NULL, ACOUSTIC_FFT_SIZE);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to initialize fft tables");
+            return ret;
+        }
+        fft_initialized = true;
+    }
+    dsps_wind_hann_f32(sensor->window, ACOUSTIC_FFT_SIZE);
+
+    ESP_LOGI(TAG, "acoustic sensor initialized (%d-point fft, %d hop)", ACOUSTIC_FFT_SIZE, ACOUSTIC_HOP_SIZE);
+    return ESP_OK;
+}
+
+esp_err_t acoustic_sensor_start(acoustic_sensor_t *sensor, gpio_num_t bclk, gpio_num_t ws, gpio_num_t din) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // one dma buffer per hop so every read completes exactly one hop
+    // (i2s0 is taken by adc continuous mode on the esp32, the analog engine starts first)
+    i2s_chan_config_t chan_config = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_1, I2S_ROLE_MASTER);
+    chan_config.dma_desc_num = ACOUSTIC_DMA_DESC_NUM;
+    chan_config.dma_frame_num = ACOUSTIC_HOP_SIZE;
+    ret = i2s_new_channel(&chan_config, NULL, &sensor->rx);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to allocate i2s channel");
+        return ret;
+    }
+
+    // mono, left slot, 32-bit frames carrying 24-bit samples
+    i2s_std_config_t std_config = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(ACOUSTIC_SAMPLE_RATE_HZ),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_32BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = bclk,
+            .ws = ws,
+            .dout = I2S_GPIO_UNUSED,
+            .din = din,
+        },
+    };
+    std_config.slot_cfg.slot_mask = I2S_STD_SLOT_LEFT;
+    ret = i2s_channel_init_std_mode(sensor->rx, &std_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to configure i2s std mode");
+        i2s_del_channel(sensor->rx);
+        sensor->rx = NULL;
+        return ret;
+    }
+
+    i2s_event_callbacks_t callbacks = {
+        .on_recv_q_ovf = acoustic_on_recv_overflow,
+    };
+    ret = i2s_channel_register_event_callback(sensor->rx, &callbacks, sensor);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to register i2s callbacks");
+        i2s_del_channel(sensor->rx);
+        sensor->rx = NULL;
+        return ret;
+    }
+
+    ret = i2s_channel_enable(sensor->rx);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to enable i2s channel");
+        i2s_del_channel(sensor->rx);
+        sensor->rx = NULL;
+        return ret;
+    }
+
+    if (xTaskCreate(acoustic_task, "acoustic_task", ACOUSTIC_TASK_STACK_SIZE, sensor,
+                    ACOUSTIC_TASK_PRIORITY, &sensor->task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create processing task");
+        i2s_channel_disable(sensor->rx);
+        i2s_del_channel(sensor->rx);
+        sensor->rx = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "acoustic capture started at %d Hz", ACOUSTIC_SAMPLE_RATE_HZ);
+    return ESP_OK;
+}
+
+void acoustic_sensor_process_hop(acoustic_sensor_t *sensor, const float *hop) {
+    if (sensor == NULL || hop == NULL) {
+        return;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+
+    // slide the analysis window by one hop
+    memmove(sensor->samples, &sensor->samples[ACOUSTIC_HOP_SIZE],
+            (ACOUSTIC_FFT_SIZE - ACOUSTIC_HOP_SIZE) * sizeof(float));
+    memcpy(&sensor->samples[ACOUSTIC_FFT_SIZE - ACOUSTIC_HOP_SIZE], hop, ACOUSTIC_HOP_SIZE * sizeof(float));
+
+    compute_features(sensor, &sensor->features);
+    classify(sensor, &sensor->features);
+
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    sensor->stats.hops++;
+    sensor->stats.cycles_total += cycles;
+    if (cycles > sensor->stats.cycles_max) {
+        sensor->stats.cycles_max = cycles;
+    }
+}
+
+void acoustic_sensor_get_stats(const acoustic_sensor_t *sensor, acoustic_stats_t *stats) {
+    if (sensor == NULL || stats == NULL) {
+        return;
+    }
+    *stats = sensor->stats;
+}
+
+float acoustic_sensor_cpu_load(const acoustic_sensor_t *sensor) {
+    if (sensor == NULL || sensor->stats.hops == 0) {
+        return 0.0f;
+    }
+
+    // cycles available per hop at the current cpu clock
+    float hop_us = (ACOUSTIC_HOP_SIZE * 1000000.0f) / ACOUSTIC_SAMPLE_RATE_HZ;
+    float budget = hop_us * esp_rom_get_cpu_ticks_per_us();
+    float average = (float)sensor->stats.cycles_total / sensor->stats.hops;
+
+    return 100.0f * average / budget;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static bool acoustic_on_recv_overflow(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+    acoustic_sensor_t *sensor = (acoustic_sensor_t *)user_ctx;
+
+    sensor->stats.rx_overflows++;
+    return false;
+}
+
+static void acoustic_task(void *pvParameters) {
+    acoustic_sensor_t *sensor = (acoustic_sensor_t *)pvParameters;
+    float hop[ACOUSTIC_HOP_SIZE];
+    size_t bytes_read;
+
+    while (1) {
+        // blocks until the next dma buffer completes
+        if (i2s_channel_read(sensor->rx, sensor->raw, sizeof(sensor->raw), &bytes_read, portMAX_DELAY) != ESP_OK ||
+            bytes_read != sizeof(sensor->raw)) {
+            continue;
+        }
+
+        for (int i = 0; i < ACOUSTIC_HOP_SIZE; i++) {
+            hop[i] = (float)(sensor->raw[i] >> ACOUSTIC_SAMPLE_SHIFT) * ACOUSTIC_SAMPLE_SCALE;
+        }
+        acoustic_sensor_process_hop(sensor, hop);
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void compute_features(acoustic_sensor_t *sensor, acoustic_features_t *features) {
+    static const int band_edges[ACOUSTIC_BAND_COUNT + 1] = {
+        ACOUSTIC_BAND_LOW_START, ACOUSTIC_BAND_MID_START, ACOUSTIC_BAND_HIGH_START, ACOUSTIC_BAND_HIGH_END,
+    };
+    float *buf = sensor->fft_buf;
+
+    // window straight into the real slots of the complex buffer, imaginary slots zero
+    for (int i = 0; i < ACOUSTIC_FFT_SIZE; i++) {
+        buf[2 * i + 1] = 0.0f;
+    }
+    dsps_mul_f32(sensor->samples, sensor->window, buf, ACOUSTIC_FFT_SIZE, 1, 1, 2);
+
+    dsps_fft2r_fc32(buf, ACOUSTIC_FFT_SIZE);
+    dsps_bit_rev_fc32(buf, ACOUSTIC_FFT_SIZE);
+
+    // band energy = sum of re^2 + im^2 over its bins, one dot product per band
+    features->total_energy = 0.0f;
+    for (int b = 0; b < ACOUSTIC_BAND_COUNT; b++) {
+        const float *start = &buf[2 * band_edges[b]];
+        int len = 2 * (band_edges[b + 1] - band_edges[b]);
+
+        dsps_dotprod_f32(start, start, &features->band_energy[b], len);
+        features->total_energy += features->band_energy[b];
+    }
+
+    features->hf_ratio = (features->total_energy > 0.0f)
+                             ? features->band_energy[ACOUSTIC_BAND_HIGH] / features->total_energy
+                             : 0.0f;
+}
+
+static void classify(acoustic_sensor_t *sensor, const acoustic_features_t *features) {
+    float total = features->total_energy;
+
+    // learn the room before anything can count as an impact
+    if (sensor->warmup_hops > 0) {
+        sensor->warmup_hops--;
+        sensor->noise_floor = (sensor->noise_floor + total) * 0.5f;
+        return;
+    }
+
+    switch (sensor->state) {
+        case ACOUSTIC_STATE_IDLE:
+            // impact: loud relative to the room and not purely high-frequency
+            if (total > sensor->noise_floor * ACOUSTIC_IMPACT_RATIO &&
+                features->band_energy[ACOUSTIC_BAND_LOW] >= total * ACOUSTIC_IMPACT_LOW_FRACTION) {
+                sensor->state = ACOUSTIC_STATE_IMPACT;
+                sensor->hops_since_impact = 0;
+                sensor->candidate = (acoustic_event_t){
+                    .impact_ratio = total / sensor->noise_floor,
+                };
+                break;
+            }
+
+            // floor only adapts while nothing is happening
+            sensor->noise_floor += ACOUSTIC_NOISE_ALPHA * (total - sensor->noise_floor);
+            if (sensor->noise_floor < ACOUSTIC_NOISE_MIN) {
+                sensor->noise_floor = ACOUSTIC_NOISE_MIN;
+            }
+            break;
+
+        case ACOUSTIC_STATE_IMPACT:
+            sensor->hops_since_impact++;
+
+            // shatter: loud hops dominated by the high band
+            if (total > sensor->noise_floor * ACOUSTIC_SHATTER_RATIO &&
+                features->hf_ratio >= ACOUSTIC_SHATTER_HF_RATIO) {
+                sensor->candidate.shatter_hops++;
+                if (features->hf_ratio > sensor->candidate.hf_ratio) {
+                    sensor->candidate.hf_ratio = features->hf_ratio;
+                }
+            }
+
+            if (sensor->candidate.shatter_hops >= ACOUSTIC_SHATTER_MIN_HOPS) {
+                sensor->state = ACOUSTIC_STATE_IDLE;
+                if (sensor->callback != NULL) {
+                    sensor->callback(&sensor->candidate, sensor->callback_arg);
+                }
+            } else if (sensor->hops_since_impact >= ACOUSTIC_SHATTER_WINDOW) {
+                // impact without shattering (door slam, knock)
+                sensor->state = ACOUSTIC_STATE_IDLE;
+            }
+            break;
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file acoustic.h
+ * @author Anthony Yalong
+ * @brief I2S microphone capture with FFT band features and glass-break
+ *        classification
+ */
+#ifndef ACOUSTIC_H
+#define ACOUSTIC_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "driver/i2s_std.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// capture configuration
+#define ACOUSTIC_SAMPLE_RATE_HZ     16000
+#define ACOUSTIC_FFT_SIZE           512     // 32 ms analysis window
+#define ACOUSTIC_HOP_SIZE           256     // 16 ms hop, 50% overlap
+#define ACOUSTIC_DMA_DESC_NUM       4       // 64 ms of buffering
+#define ACOUSTIC_TASK_STACK_SIZE    4096
+#define ACOUSTIC_TASK_PRIORITY      4
+
+// band edges in fft bins (31.25 Hz per bin at 16 kHz / 512)
+#define ACOUSTIC_BAND_LOW_START     2       // 62 Hz
+#define ACOUSTIC_BAND_MID_START     32      // 1 kHz
+#define ACOUSTIC_BAND_HIGH_START    96      // 3 kHz
+#define ACOUSTIC_BAND_HIGH_END      256     // 8 kHz (nyquist)
+
+// classifier configuration
+#define ACOUSTIC_NOISE_ALPHA        0.02f   // noise floor ema weight (idle only)
+#define ACOUSTIC_NOISE_MIN          1e-6f   // floor for a silent input
+#define ACOUSTIC_WARMUP_HOPS        32      // floor learning before detection (~500 ms)
+#define ACOUSTIC_IMPACT_RATIO       30.0f   // impact energy over floor (~15 dB)
+#define ACOUSTIC_IMPACT_LOW_FRACTION 0.25f  // impact must carry low-band energy
+#define ACOUSTIC_SHATTER_RATIO      8.0f    // shatter hop energy over floor
+#define ACOUSTIC_SHATTER_HF_RATIO   0.5f    // shatter hop high band / total
+#define ACOUSTIC_SHATTER_WINDOW     31      // hops after impact (~500 ms)
+#define ACOUSTIC_SHATTER_MIN_HOPS   4       // high-band hops to confirm (~64 ms)
+
+/**
+ * @brief Frequency bands
+ */
+typedef enum {
+    ACOUSTIC_BAND_LOW = 0,
+    ACOUSTIC_BAND_MID,
+    ACOUSTIC_BAND_HIGH,
+    ACOUSTIC_BAND_COUNT,
+} acoustic_band_t;
+
+/**
+ * @brief Per-hop features
+ */
+typedef struct {
+    float band_energy[ACOUSTIC_BAND_COUNT];
+    float total_energy;
+    float hf_ratio;             // high band / total
+} acoustic_features_t;
+
+/**
+ * @brief Glass-break detection
+ */
+typedef struct {
+    float impact_ratio;         // impact energy over noise floor
+    float hf_ratio;             // peak high-band ratio during shatter
+    uint16_t shatter_hops;      // high-band hops seen in the window
+} acoustic_event_t;
+
+/**
+ * @brief Event callback - runs in the processing task
+ */
+typedef void (*acoustic_event_cb_t)(const acoustic_event_t *event, void *arg);
+
+/**
+ * @brief Processing cost statistics
+ */
+typedef struct {
+    uint32_t hops;              // hops processed
+    uint64_t cycles_total;      // cpu cycles spent in processing
+    uint32_t cycles_max;        // worst single hop
+    uint32_t rx_overflows;      // i2s dma queue overflows (data lost)
+} acoustic_stats_t;
+
+/**
+ * @brief Classifier states
+ */
+typedef enum {
+    ACOUSTIC_STATE_IDLE = 0,
+    ACOUSTIC_STATE_IMPACT,      // waiting for shatter after an impact
+} acoustic_state_t;
+
+/**
+ * @brief Acoustic sensor structure
+ */
+typedef struct {
+    i2s_chan_handle_t rx;
+    TaskHandle_t task;
+    acoustic_event_cb_t callback;
+    void *callback_arg;
+
+    // analysis buffers (fft_buf is interleaved complex, 16-byte aligned for the simd kernels)
+    float samples[ACOUSTIC_FFT_SIZE];
+    float window[ACOUSTIC_FFT_SIZE];
+    float fft_buf[ACOUSTIC_FFT_SIZE * 2] __attribute__((aligned(16)));
+    int32_t raw[ACOUSTIC_HOP_SIZE];
+
+    // classifier
+    acoustic_state_t state;
+    float noise_floor;
+    uint16_t warmup_hops;       // hops left before detection is enabled
+    uint16_t hops_since_impact;
+    acoustic_event_t candidate;
+    acoustic_features_t features;   // latest hop
+
+    acoustic_stats_t stats;
+} acoustic_sensor_t;
+
+/**
+ * @brief Initialize analysis state and fft tables
+ *
+ * Does not touch the I2S peripheral, so the pipeline can be driven with
+ * synthetic audio through acoustic_sensor_process_hop.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param callback Glass-break callback
+ * @param arg Callback argument
+ * @return esp_err_t ESP_OK on success, error from esp-dsp otherwise
+ */
+esp_err_t acoustic_sensor_init(acoustic_sensor_t *sensor, acoustic_event_cb_t callback, void *arg);
+
+/**
+ * @brief Start I2S capture and the processing task
+ *
+ * @param sensor Pointer to initialized sensor structure
+ * @param bclk Bit clock pin
+ * @param ws Word select pin
+ * @param din Data in pin
+ * @return esp_err_t ESP_OK on success, error from i2s driver otherwise
+ */
+esp_err_t acoustic_sensor_start(acoustic_sensor_t *sensor, gpio_num_t bclk, gpio_num_t ws, gpio_num_t din);
+
+/**
+ * @brief Process one hop of audio
+ *
+ * Slides the analysis window, runs fft and band features, and steps the
+ * classifier. Called by the processing task; exposed for benchmarking.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param hop ACOUSTIC_HOP_SIZE samples, full scale +/-1.0
+ */
+void acoustic_sensor_process_hop(acoustic_sensor_t *sensor, const float *hop);
+
+/**
+ * @brief Get processing cost statistics
+ *
+ * @param sensor Pointer to sensor structure
+ * @param stats Output statistics
+ */
+void acoustic_sensor_get_stats(const acoustic_sensor_t *sensor, acoustic_stats_t *stats);
+
+/**
+ * @brief Average processing load as a percentage of real time
+ *
+ * @param sensor Pointer to sensor structure
+ * @return float Percent of one core used by processing (0 if no hops yet)
+ */
+float acoustic_sensor_cpu_load(const acoustic_sensor_t *sensor);
+
+#endif  // ACOUSTIC_H
@@ -0,0 +1,397 @@
+/**
+ * @file adxl345.c
+ * @author Anthony Yalong
+ * @brief ADXL345 accelerometer driver implementation
+ */
+
+#include "adxl345.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+
+static const char *TAG = "ADXL345";
+
+// registers
+#define ADXL345_REG_DEVID           0x00
+#define ADXL345_REG_BW_RATE         0x2C
+#define ADXL345_REG_POWER_CTL       0x2D
+#define ADXL345_REG_INT_ENABLE      0x2E
+#define ADXL345_REG_INT_MAP         0x2F
+#define ADXL345_REG_DATA_FORMAT     0x31
+#define ADXL345_REG_DATAX0          0x32
+#define ADXL345_REG_FIFO_CTL        0x38
+#define ADXL345_REG_FIFO_STATUS     0x39
+
+// register values
+#define ADXL345_DEVID               0xE5
+#define ADXL345_POWER_MEASURE       0x08
+#define ADXL345_INT_WATERMARK       0x02
+#define ADXL345_FORMAT_FULL_RES_4G  0x09    // full resolution, +/-4 g, int active high
+#define ADXL345_FIFO_STREAM         0x80
+#define ADXL345_FIFO_ENTRIES_MASK   0x3F
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Write one register
+ *
+ * @param sensor Pointer to sensor structure
+ * @param reg Register address
+ * @param value Value to write
+ * @return esp_err_t ESP_OK on success
+ */
+static esp_err_t adxl345_write_reg(adxl345_sensor_t *sensor, uint8_t reg, uint8_t value);
+
+/**
+ * @brief Read one register
+ *
+ * @param sensor Pointer to sensor structure
+ * @param reg Register address
+ * @param value Output value
+ * @return esp_err_t ESP_OK on success
+ */
+static esp_err_t adxl345_read_reg(adxl345_sensor_t *sensor, uint8_t reg, uint8_t *value);
+
+/**
+ * @brief Drain fifo entries in one i2c transaction
+ *
+ * Each entry is its own 6-byte register read (the fifo pops at the end of
+ * a data read), chained with repeated starts so the whole batch is a
+ * single command link with one stop.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param xyz Output samples
+ * @param count Entries to read
+ * @return esp_err_t ESP_OK on success
+ */
+static esp_err_t adxl345_read_fifo(adxl345_sensor_t *sensor, int16_t (*xyz)[3], uint8_t count);
+
+/**
+ * @brief INT1 isr - wakes the driver task
+ *
+ * @param arg Pointer to sensor structure
+ */
+static void adxl345_isr(void *arg);
+
+/**
+ * @brief Driver task - drains the fifo after each watermark interrupt
+ *
+ * @param pvParameters Pointer to sensor structure
+ */
+static void adxl345_task(void *pvParameters);
+
+/**
+ * @brief Integer square root
+ *
+ * @param value Input
+ * @return uint32_t floor(sqrt(value))
+ */
+static uint32_t isqrt64(uint64_t value);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t adxl345_init(adxl345_sensor_t *sensor, uint32_t rms_threshold_mg, uint32_t peak_threshold_mg,
+                       adxl345_event_cb_t callback, void *arg) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->rms_threshold_mg = rms_threshold_mg;
+    sensor->peak_threshold_mg = peak_threshold_mg;
+    sensor->callback = callback;
+    sensor->callback_arg = arg;
+    sensor->int_pin = GPIO_NUM_NC;
+
+    return ESP_OK;
+}
+
+esp_err_t adxl345_start(adxl345_sensor_t *sensor, i2c_port_t i2c_port, uint8_t addr,
+                        gpio_num_t int_pin, uint8_t watermark) {
+    // error management
+    esp_err_t ret;
+    uint8_t devid;
+
+    // sanity check
+    if (sensor == NULL || watermark == 0 || watermark >= ADXL345_FIFO_DEPTH) {
+        ESP_LOGE(TAG, "invalid adxl345 parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sensor->i2c_port = i2c_port;
+    sensor->addr = addr;
+    sensor->int_pin = int_pin;
+    sensor->watermark = watermark;
+
+    ret = adxl345_read_reg(sensor, ADXL345_REG_DEVID, &devid);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "adxl345 not responding at 0x%02x", addr);
+        return ret;
+    }
+    if (devid != ADXL345_DEVID) {
+        ESP_LOGE(TAG, "unexpected device id 0x%02x", devid);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // configure in standby, then enable measurement last
+    const uint8_t setup[][2] = {
+        { ADXL345_REG_POWER_CTL, 0x00 },
+        { ADXL345_REG_BW_RATE, ADXL345_RATE_200HZ },
+        { ADXL345_REG_DATA_FORMAT, ADXL345_FORMAT_FULL_RES_4G },
+        { ADXL345_REG_FIFO_CTL, ADXL345_FIFO_STREAM | watermark },
+        { ADXL345_REG_INT_MAP, 0x00 },                          // everything on INT1
+        { ADXL345_REG_INT_ENABLE, ADXL345_INT_WATERMARK },
+        { ADXL345_REG_POWER_CTL, ADXL345_POWER_MEASURE },
+    };
+    for (size_t i = 0; i < sizeof(setup) / sizeof(setup[0]); i++) {
+        ret = adxl345_write_reg(sensor, setup[i][0], setup[i][1]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to write register 0x%02x", setup[i][0]);
+            return ret;
+        }
+    }
+
+    // configure interrupt pin
+    gpio_config_t int_config = {
+        .pin_bit_mask = (1ULL << int_pin),
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_POSEDGE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE
+    };
+    ret = gpio_config(&int_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to config interrupt gpio");
+        return ret;
+    }
+
+    // driver task must exist before the isr can notify it
+    if (xTaskCreate(adxl345_task, "adxl345_task", ADXL345_TASK_STACK_SIZE, sensor,
+                    ADXL345_TASK_PRIORITY, &sensor->task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create driver task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // service may already be installed by another driver (all install it in iram)
+    ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "failed to install gpio isr service");
+        return ret;
+    }
+    ret = gpio_isr_handler_add(int_pin, adxl345_isr, sensor);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to add isr for gpio %d", int_pin);
+        return ret;
+    }
+
+    // the fifo may already be above the watermark (no edge will come)
+    xTaskNotifyGive(sensor->task);
+
+    ESP_LOGI(TAG, "adxl345 started (200 Hz, watermark %d)", watermark);
+    return ESP_OK;
+}
+
+void adxl345_process_batch(adxl345_sensor_t *sensor, const int16_t (*xyz)[3], uint16_t count) {
+    if (sensor == NULL || xyz == NULL || count == 0) {
+        return;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    uint64_t sum_squares = 0;
+    uint32_t peak = 0;
+
+    // seed gravity with the first sample ever seen
+    if (!sensor->baseline_valid) {
+        for (int axis = 0; axis < 3; axis++) {
+            sensor->baseline[axis] = xyz[0][axis] * (1 << ADXL345_BASELINE_SHIFT);
+        }
+        sensor->baseline_valid = true;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            // dynamic part = sample - slow baseline (gravity and mounting tilt)
+            int32_t d = xyz[i][axis] - (sensor->baseline[axis] >> ADXL345_BASELINE_SHIFT);
+            sensor->baseline[axis] += d;
+
+            uint32_t magnitude = (d < 0) ? -d : d;
+            if (magnitude > peak) {
+                peak = magnitude;
+            }
+            sum_squares += (int64_t)d * d;
+        }
+    }
+
+    adxl345_batch_t batch = {
+        .samples = count,
+        .rms_mg = isqrt64(sum_squares / count) * ADXL345_MG_PER_LSB_X10 / 10,
+        .peak_mg = peak * ADXL345_MG_PER_LSB_X10 / 10,
+    };
+    sensor->last_batch = batch;
+
+    // tamper episode: starts on any loud batch, ends after a run of quiet ones
+    bool loud = batch.rms_mg >= sensor->rms_threshold_mg || batch.peak_mg >= sensor->peak_threshold_mg;
+    adxl345_event_t event = { .batch = batch };
+    bool notify = false;
+
+    if (loud) {
+        sensor->quiet_batches = 0;
+        if (!sensor->tamper) {
+            sensor->tamper = true;
+            event.type = ADXL345_EVENT_TAMPER_START;
+            notify = true;
+        }
+    } else if (sensor->tamper && ++sensor->quiet_batches >= ADXL345_QUIET_BATCHES) {
+        sensor->tamper = false;
+        event.type = ADXL345_EVENT_TAMPER_END;
+        notify = true;
+    }
+
+    sensor->stats.batches++;
+    sensor->stats.samples += count;
+    sensor->stats.process_cycles += esp_cpu_get_cycle_count() - start;
+
+    if (notify && sensor->callback != NULL) {
+        sensor->callback(&event, sensor->callback_arg);
+    }
+}
+
+void adxl345_get_stats(const adxl345_sensor_t *sensor, adxl345_stats_t *stats) {
+    if (sensor == NULL || stats == NULL) {
+        return;
+    }
+    *stats = sensor->stats;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t adxl345_write_reg(adxl345_sensor_t *sensor, uint8_t reg, uint8_t value) {
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, reg, true);
+    i2c_master_write_byte(cmd, value, true);
+    i2c_master_stop(cmd);
+    esp_err_t err = i2c_master_cmd_begin(sensor->i2c_port, cmd, pdMS_TO_TICKS(ADXL345_I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+
+    sensor->stats.i2c_transactions++;
+    return err;
+}
+
+static esp_err_t adxl345_read_reg(adxl345_sensor_t *sensor, uint8_t reg, uint8_t *value) {
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, reg, true);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_READ, true);
+    i2c_master_read_byte(cmd, value, I2C_MASTER_NACK);
+    i2c_master_stop(cmd);
+    esp_err_t err = i2c_master_cmd_begin(sensor->i2c_port, cmd, pdMS_TO_TICKS(ADXL345_I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+
+    sensor->stats.i2c_transactions++;
+    return err;
+}
+
+static esp_err_t adxl345_read_fifo(adxl345_sensor_t *sensor, int16_t (*xyz)[3], uint8_t count) {
+    uint8_t raw[ADXL345_FIFO_DEPTH][6];
+
+    // the repeated start and address bytes between entries cover the 5 us pop time
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    for (uint8_t i = 0; i < count; i++) {
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_WRITE, true);
+        i2c_master_write_byte(cmd, ADXL345_REG_DATAX0, true);
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_READ, true);
+        i2c_master_read(cmd, raw[i], sizeof(raw[i]), I2C_MASTER_LAST_NACK);
+    }
+    i2c_master_stop(cmd);
+    esp_err_t err = i2c_master_cmd_begin(sensor->i2c_port, cmd, pdMS_TO_TICKS(ADXL345_I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+
+    sensor->stats.i2c_transactions++;
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // little-endian x0 x1 y0 y1 z0 z1
+    for (uint8_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            xyz[i][axis] = (int16_t)(raw[i][2 * axis] | (raw[i][2 * axis + 1] << 8));
+        }
+    }
+    return ESP_OK;
+}
+
+static void IRAM_ATTR adxl345_isr(void *arg) {
+    adxl345_sensor_t *sensor = (adxl345_sensor_t *)arg;
+    BaseType_t higher_priority_woken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(sensor->task, &higher_priority_woken);
+    portYIELD_FROM_ISR(higher_priority_woken);
+}
+
+static void adxl345_task(void *pvParameters) {
+    adxl345_sensor_t *sensor = (adxl345_sensor_t *)pvParameters;
+    int16_t xyz[ADXL345_FIFO_DEPTH][3];
+    uint8_t status;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // INT1 is a level: keep draining while it stays high or no new edge will arrive
+        do {
+            if (adxl345_read_reg(sensor, ADXL345_REG_FIFO_STATUS, &status) != ESP_OK) {
+                ESP_LOGW(TAG, "failed to read fifo status");
+                break;
+            }
+
+            uint8_t entries = status & ADXL345_FIFO_ENTRIES_MASK;
+            if (entries >= ADXL345_FIFO_DEPTH) {
+                sensor->stats.fifo_overruns++;
+            }
+            if (entries == 0) {
+                break;
+            }
+            if (entries > ADXL345_FIFO_DEPTH) {
+                entries = ADXL345_FIFO_DEPTH;
+            }
+
+            if (adxl345_read_fifo(sensor, xyz, entries) != ESP_OK) {
+                ESP_LOGW(TAG, "fifo burst read failed");
+                break;
+            }
+            adxl345_process_batch(sensor, (const int16_t (*)[3])xyz, entries);
+        } while (gpio_get_level(sensor->int_pin));
+    }
+
+    vTaskDelete(NULL);
+}
+
+static uint32_t isqrt64(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file adxl345.h
+ * @author Anthony Yalong
+ * @brief ADXL345 accelerometer driver with FIFO burst reads for vibration
+ *        and tamper detection
+ */
+#ifndef ADXL345_H
+#define ADXL345_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// configuration
+#define ADXL345_DEFAULT_ADDR        0x53    // SDO low
+#define ADXL345_FIFO_DEPTH          32
+#define ADXL345_DEFAULT_WATERMARK   25      // samples per batch
+#define ADXL345_RATE_200HZ          0x0B    // bw_rate code
+#define ADXL345_MG_PER_LSB_X10      39      // full resolution: 3.9 mg/lsb
+#define ADXL345_BASELINE_SHIFT      7       // gravity baseline ema weight 1/128
+#define ADXL345_QUIET_BATCHES       8       // quiet batches before tamper ends
+#define ADXL345_I2C_TIMEOUT_MS      100
+#define ADXL345_TASK_STACK_SIZE     3072
+#define ADXL345_TASK_PRIORITY       3
+
+/**
+ * @brief Tamper event types
+ */
+typedef enum {
+    ADXL345_EVENT_TAMPER_START = 0,
+    ADXL345_EVENT_TAMPER_END,
+} adxl345_event_type_t;
+
+/**
+ * @brief Batch vibration summary
+ */
+typedef struct {
+    uint16_t samples;           // samples in the batch
+    uint32_t rms_mg;            // rms of dynamic acceleration magnitude
+    uint32_t peak_mg;           // largest single-axis deviation
+} adxl345_batch_t;
+
+/**
+ * @brief Tamper event
+ */
+typedef struct {
+    adxl345_event_type_t type;
+    adxl345_batch_t batch;      // batch that started the episode / last loud batch
+} adxl345_event_t;
+
+/**
+ * @brief Event callback - runs in the driver task
+ */
+typedef void (*adxl345_event_cb_t)(const adxl345_event_t *event, void *arg);
+
+/**
+ * @brief Bus and processing statistics
+ */
+typedef struct {
+    uint32_t i2c_transactions;  // command links executed
+    uint32_t batches;
+    uint32_t samples;
+    uint32_t fifo_overruns;     // batches where the fifo was found full
+    uint64_t process_cycles;    // cpu cycles in adxl345_process_batch
+} adxl345_stats_t;
+
+/**
+ * @brief ADXL345 sensor structure
+ */
+typedef struct {
+    i2c_port_t i2c_port;
+    uint8_t addr;
+    gpio_num_t int_pin;
+    uint8_t watermark;
+    uint32_t rms_threshold_mg;
+    uint32_t peak_threshold_mg;
+
+    int32_t baseline[3];        // per-axis gravity << ADXL345_BASELINE_SHIFT
+    bool baseline_valid;
+    bool tamper;
+    uint8_t quiet_batches;
+    adxl345_batch_t last_batch;
+
+    adxl345_event_cb_t callback;
+    void *callback_arg;
+    TaskHandle_t task;
+    adxl345_stats_t stats;
+} adxl345_sensor_t;
+
+/**
+ * @brief Initialize ADXL345 sensor state
+ *
+ * Sets detection thresholds only; no bus traffic, so batches can be
+ * processed from simulated fifo data.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param rms_threshold_mg Batch rms that starts a tamper episode
+ * @param peak_threshold_mg Single-sample deviation that starts a tamper episode
+ * @param callback Tamper event callback
+ * @param arg Callback argument
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t adxl345_init(adxl345_sensor_t *sensor, uint32_t rms_threshold_mg, uint32_t peak_threshold_mg,
+                       adxl345_event_cb_t callback, void *arg);
+
+/**
+ * @brief Configure the device fifo/watermark interrupt and start the driver task
+ *
+ * The i2c bus must already be installed. Device is set to 200 Hz, +/-4 g
+ * full resolution, fifo stream mode with the watermark routed to INT1.
+ *
+ * @param sensor Pointer to initialized sensor structure
+ * @param i2c_port I2C port number
+ * @param addr Device address
+ * @param int_pin GPIO connected to INT1
+ * @param watermark FIFO entries per batch (1-31)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the device id does not match
+ */
+esp_err_t adxl345_start(adxl345_sensor_t *sensor, i2c_port_t i2c_port, uint8_t addr,
+                        gpio_num_t int_pin, uint8_t watermark);
+
+/**
+ * @brief Run vibration analysis and tamper detection on a batch
+ *
+ * Called by the driver task after each burst read; exposed for testing
+ * with simulated fifo data.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param xyz Raw samples, x/y/z per entry
+ * @param count Number of entries
+ */
+void adxl345_process_batch(adxl345_sensor_t *sensor, const int16_t (*xyz)[3], uint16_t count);
+
+/**
+ * @brief Get bus and processing statistics
+ *
+ * @param sensor Pointer to sensor structure
+ * @param stats Output statistics
+ */
+void adxl345_get_stats(const adxl345_sensor_t *sensor, adxl345_stats_t *stats);
+
+#endif  // ADXL345_H
@@ -0,0 +1,335 @@
+/**
+ * @file analog_sensor.c
+ * @author Anthony Yalong
+ * @brief Continuous-mode ADC analog sensor engine implementation
+ */
+
+#include "analog_sensor.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "ANALOG";
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Conversion-done callback - wakes the processing task
+ *
+ * @param handle ADC continuous handle
+ * @param edata Event data
+ * @param user_data Pointer to engine structure
+ * @return bool true if a higher priority task was woken
+ */
+static bool analog_on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                void *user_data);
+
+/**
+ * @brief Pool overflow callback - counts frames lost to a slow consumer
+ *
+ * @param handle ADC continuous handle
+ * @param edata Event data
+ * @param user_data Pointer to engine structure
+ * @return bool always false
+ */
+static bool analog_on_pool_ovf(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                               void *user_data);
+
+/**
+ * @brief Processing task - drains dma frames after each conversion-done wake-up
+ *
+ * @param pvParameters Pointer to engine structure
+ */
+static void analog_task(void *pvParameters);
+
+/**
+ * @brief Feed one raw sample through a channel's decimator and detectors
+ *
+ * @param engine Pointer to engine structure
+ * @param index Channel index
+ * @param raw Raw 12-bit conversion result
+ */
+static void process_sample(analog_sensor_t *engine, uint8_t index, int32_t raw);
+
+/**
+ * @brief Run threshold, trend and report logic on a new decimated output
+ *
+ * @param engine Pointer to engine structure
+ * @param index Channel index
+ * @param level New decimated level
+ */
+static void process_output(analog_sensor_t *engine, uint8_t index, int32_t level);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t analog_sensor_init(analog_sensor_t *engine, const analog_channel_config_t *channels,
+                             uint8_t count, uint32_t sample_freq_hz,
+                             analog_event_cb_t callback, void *arg) {
+    // sanity check
+    if (engine == NULL || channels == NULL || count == 0 || count > ANALOG_MAX_CHANNELS) {
+        ESP_LOGE(TAG, "invalid analog engine parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(engine, 0, sizeof(*engine));
+    memset(engine->channel_map, -1, sizeof(engine->channel_map));
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (channels[i].channel >= SOC_ADC_CHANNEL_NUM(0) || engine->channel_map[channels[i].channel] >= 0) {
+            ESP_LOGE(TAG, "invalid or duplicate adc channel %d", channels[i].channel);
+            return ESP_ERR_INVALID_ARG;
+        }
+        // 2nd-order cic gain is 2^(2 * log2 r), keep it inside 32 bits for 12-bit input
+        if (channels[i].decimation_log2 == 0 || channels[i].decimation_log2 > 8) {
+            ESP_LOGE(TAG, "decimation for channel %d out of range", channels[i].channel);
+            return ESP_ERR_INVALID_ARG;
+        }
+        engine->channels[i].config = channels[i];
+        engine->channel_map[channels[i].channel] = i;
+    }
+
+    engine->channel_count = count;
+    engine->sample_freq_hz = sample_freq_hz;
+    engine->callback = callback;
+    engine->callback_arg = arg;
+
+    ESP_LOGI(TAG, "analog engine initialized (%d channels, %lu Hz total)", count, sample_freq_hz);
+    return ESP_OK;
+}
+
+esp_err_t analog_sensor_start(analog_sensor_t *engine) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (engine == NULL || engine->channel_count == 0) {
+        ESP_LOGE(TAG, "analog engine not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // dma ring buffer and frame size
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = ANALOG_STORE_BUF_SIZE,
+        .conv_frame_size = ANALOG_FRAME_SIZE,
+    };
+    ret = adc_continuous_new_handle(&handle_config, &engine->handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create adc continuous handle");
+        return ret;
+    }
+
+    // one conversion pattern entry per channel, scanned round-robin
+    adc_digi_pattern_config_t pattern[ANALOG_MAX_CHANNELS] = {0};
+    for (uint8_t i = 0; i < engine->channel_count; i++) {
+        pattern[i].atten = ADC_ATTEN_DB_12;
+        pattern[i].channel = engine->channels[i].config.channel;
+        pattern[i].unit = ADC_UNIT_1;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    adc_continuous_config_t adc_config = {
+        .pattern_num = engine->channel_count,
+        .adc_pattern = pattern,
+        .sample_freq_hz = engine->sample_freq_hz,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    ret = adc_continuous_config(engine->handle, &adc_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to configure adc continuous mode");
+        adc_continuous_deinit(engine->handle);
+        engine->handle = NULL;
+        return ret;
+    }
+
+    // processing task must exist before the first conversion-done callback
+    if (xTaskCreate(analog_task, "analog_task", ANALOG_TASK_STACK_SIZE, engine,
+                    ANALOG_TASK_PRIORITY, &engine->task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create processing task");
+        adc_continuous_deinit(engine->handle);
+        engine->handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    adc_continuous_evt_cbs_t callbacks = {
+        .on_conv_done = analog_on_conv_done,
+        .on_pool_ovf = analog_on_pool_ovf,
+    };
+    ret = adc_continuous_register_event_callbacks(engine->handle, &callbacks, engine);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to register adc callbacks");
+        vTaskDelete(engine->task);
+        engine->task = NULL;
+        adc_continuous_deinit(engine->handle);
+        engine->handle = NULL;
+        return ret;
+    }
+
+    ret = adc_continuous_start(engine->handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start adc continuous mode");
+        vTaskDelete(engine->task);
+        engine->task = NULL;
+        adc_continuous_deinit(engine->handle);
+        engine->handle = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "analog engine started");
+    return ESP_OK;
+}
+
+void analog_sensor_process_frame(analog_sensor_t *engine, const uint8_t *frame, uint32_t length) {
+    if (engine == NULL || frame == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t *result = (const adc_digi_output_data_t *)&frame[i];
+        uint32_t channel = result->type1.channel;
+
+        // results for channels outside the pattern are discarded
+        if (channel >= SOC_ADC_CHANNEL_NUM(0) || engine->channel_map[channel] < 0) {
+            continue;
+        }
+        process_sample(engine, engine->channel_map[channel], result->type1.data);
+    }
+
+    engine->samples_processed += length / SOC_ADC_DIGI_RESULT_BYTES;
+}
+
+int32_t analog_sensor_get_level(const analog_sensor_t *engine, uint8_t index) {
+    if (engine == NULL || index >= engine->channel_count) {
+        ESP_LOGE(TAG, "invalid analog channel index");
+        return 0;
+    }
+    return engine->channels[index].level;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static bool analog_on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                void *user_data) {
+    analog_sensor_t *engine = (analog_sensor_t *)user_data;
+    BaseType_t higher_priority_woken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(engine->task, &higher_priority_woken);
+    return higher_priority_woken == pdTRUE;
+}
+
+static bool analog_on_pool_ovf(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                               void *user_data) {
+    analog_sensor_t *engine = (analog_sensor_t *)user_data;
+
+    engine->frames_dropped++;
+    return false;
+}
+
+static void analog_task(void *pvParameters) {
+    analog_sensor_t *engine = (analog_sensor_t *)pvParameters;
+    uint8_t frame[ANALOG_FRAME_SIZE];
+    uint32_t length;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // drain every completed frame, the driver pool may hold several
+        while (adc_continuous_read(engine->handle, frame, sizeof(frame), &length, 0) == ESP_OK) {
+            analog_sensor_process_frame(engine, frame, length);
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void process_sample(analog_sensor_t *engine, uint8_t index, int32_t raw) {
+    analog_channel_state_t *ch = &engine->channels[index];
+    int32_t x = raw;
+
+    // audio-type inputs: magnitude of the deviation from a slow dc tracker
+    if (ch->config.rectify) {
+        // seed the tracker with the first sample to avoid a start-up transient
+        if (ch->dc == 0) {
+            ch->dc = x << ANALOG_DC_SHIFT;
+        }
+        ch->dc += x - (ch->dc >> ANALOG_DC_SHIFT);
+        x -= ch->dc >> ANALOG_DC_SHIFT;
+        if (x < 0) {
+            x = -x;
+        }
+    }
+
+    // integrators run at the input rate (unsigned so wraparound is well defined)
+    uint32_t acc = (uint32_t)x;
+    for (int s = 0; s < ANALOG_CIC_ORDER; s++) {
+        ch->integrator[s] += acc;
+        acc = ch->integrator[s];
+    }
+
+    if (++ch->phase < (1U << ch->config.decimation_log2)) {
+        return;
+    }
+    ch->phase = 0;
+
+    // combs run at the output rate
+    for (int s = 0; s < ANALOG_CIC_ORDER; s++) {
+        uint32_t in = acc;
+        acc = in - ch->comb_delay[s];
+        ch->comb_delay[s] = in;
+    }
+
+    // remove cic gain r^n
+    process_output(engine, index, (int32_t)(acc >> (ANALOG_CIC_ORDER * ch->config.decimation_log2)));
+}
+
+static void process_output(analog_sensor_t *engine, uint8_t index, int32_t level) {
+    analog_channel_state_t *ch = &engine->channels[index];
+    const analog_channel_config_t *cfg = &ch->config;
+    analog_event_t event = { .index = index };
+
+    // trend: ema of successive output differences (skipped until cic has settled)
+    if (ch->outputs >= ANALOG_CIC_ORDER) {
+        int32_t diff = (level - ch->level) * (1 << ANALOG_TREND_SHIFT);
+        ch->trend += (diff - ch->trend) / (1 << ANALOG_TREND_SHIFT);
+    }
+    ch->level = level;
+    ch->outputs++;
+    event.level = level;
+    event.trend = ch->trend;
+
+    if (engine->callback == NULL) {
+        return;
+    }
+
+    // threshold alarm with hysteresis
+    if (cfg->threshold > 0) {
+        if (!ch->alarm && level >= cfg->threshold) {
+            ch->alarm = true;
+            event.type = ANALOG_EVENT_ALARM;
+            engine->callback(&event, engine->callback_arg);
+        } else if (ch->alarm && level < cfg->threshold - cfg->hysteresis) {
+            ch->alarm = false;
+            event.type = ANALOG_EVENT_CLEAR;
+            engine->callback(&event, engine->callback_arg);
+        }
+    }
+
+    // rising trend, re-armed once the trend has halved
+    if (cfg->trend_threshold > 0) {
+        if (!ch->trend_active && ch->trend >= cfg->trend_threshold) {
+            ch->trend_active = true;
+            event.type = ANALOG_EVENT_TREND;
+            engine->callback(&event, engine->callback_arg);
+        } else if (ch->trend_active && ch->trend < cfg->trend_threshold / 2) {
+            ch->trend_active = false;
+        }
+    }
+
+    // periodic level report
+    if (cfg->report_every > 0 && ++ch->outputs_since_report >= cfg->report_every) {
+        ch->outputs_since_report = 0;
+        event.type = ANALOG_EVENT_LEVEL;
+        engine->callback(&event, engine->callback_arg);
+    }
+}
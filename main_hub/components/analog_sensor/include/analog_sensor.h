@@ -0,0 +1,147 @@
+/**
+ * @file analog_sensor.h
+ * @author Anthony Yalong
+ * @brief Continuous-mode ADC engine with decimation and event detection
+ *        for analog sensors
+ */
+#ifndef ANALOG_SENSOR_H
+#define ANALOG_SENSOR_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_adc/adc_continuous.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// configuration
+#define ANALOG_MAX_CHANNELS         4
+#define ANALOG_CIC_ORDER            2       // integrator/comb stages
+#define ANALOG_FRAME_SIZE           256     // bytes per dma conversion frame
+#define ANALOG_STORE_BUF_SIZE       1024    // driver ring buffer bytes
+#define ANALOG_TREND_SHIFT          4       // trend ema weight 1/16
+#define ANALOG_DC_SHIFT             8       // dc tracker weight 1/256
+#define ANALOG_TASK_STACK_SIZE      3072
+#define ANALOG_TASK_PRIORITY        3
+
+/**
+ * @brief Analog channel configuration
+ */
+typedef struct {
+    adc_channel_t channel;      // adc1 channel
+    uint8_t decimation_log2;    // cic decimation ratio = 1 << decimation_log2 (1-8)
+    bool rectify;               // use |x - dc| (sound level) instead of x
+    int32_t threshold;          // alarm level on decimated output (raw adc units)
+    int32_t hysteresis;         // alarm clears below threshold - hysteresis
+    int32_t trend_threshold;    // rising trend level, adc units per output << ANALOG_TREND_SHIFT
+    uint16_t report_every;      // level report every n outputs (0 = never)
+} analog_channel_config_t;
+
+/**
+ * @brief Analog event types
+ */
+typedef enum {
+    ANALOG_EVENT_LEVEL = 0,     // periodic level report
+    ANALOG_EVENT_ALARM,         // level rose above threshold
+    ANALOG_EVENT_CLEAR,         // level fell below threshold - hysteresis
+    ANALOG_EVENT_TREND,         // sustained rising trend
+} analog_event_type_t;
+
+/**
+ * @brief Analog event
+ */
+typedef struct {
+    analog_event_type_t type;
+    uint8_t index;              // channel index in configuration order
+    int32_t level;              // decimated level (raw adc units)
+    int32_t trend;              // trend ema (adc units per output << ANALOG_TREND_SHIFT)
+} analog_event_t;
+
+/**
+ * @brief Event callback - runs in the processing task
+ */
+typedef void (*analog_event_cb_t)(const analog_event_t *event, void *arg);
+
+/**
+ * @brief Per-channel processing state
+ */
+typedef struct {
+    analog_channel_config_t config;
+    uint32_t integrator[ANALOG_CIC_ORDER];  // modular arithmetic, wraparound is harmless
+    uint32_t comb_delay[ANALOG_CIC_ORDER];
+    uint16_t phase;             // input samples since last output
+    int32_t dc;                 // tracked dc << ANALOG_DC_SHIFT (rectify only)
+    int32_t level;              // latest decimated output
+    int32_t trend;              // ema of output differences << ANALOG_TREND_SHIFT
+    bool alarm;                 // threshold alarm active
+    bool trend_active;          // trend event raised, waiting to re-arm
+    uint16_t outputs_since_report;
+    uint32_t outputs;           // total decimated outputs
+} analog_channel_state_t;
+
+/**
+ * @brief Analog sensor engine structure
+ */
+typedef struct {
+    adc_continuous_handle_t handle;
+    analog_channel_state_t channels[ANALOG_MAX_CHANNELS];
+    uint8_t channel_count;
+    int8_t channel_map[SOC_ADC_CHANNEL_NUM(0)];  // adc channel -> index, -1 if unused
+    uint32_t sample_freq_hz;
+    analog_event_cb_t callback;
+    void *callback_arg;
+    TaskHandle_t task;
+    uint32_t samples_processed;
+    uint32_t frames_dropped;    // driver pool overflows
+} analog_sensor_t;
+
+/**
+ * @brief Initialize analog engine processing state
+ *
+ * Sets up per-channel filters only; no hardware is touched, so the
+ * processing path can be exercised with synthetic frames.
+ *
+ * @param engine Pointer to engine structure
+ * @param channels Channel configurations
+ * @param count Number of channels (1-ANALOG_MAX_CHANNELS)
+ * @param sample_freq_hz Total conversion rate across all channels
+ * @param callback Event callback
+ * @param arg Callback argument
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad configuration
+ */
+esp_err_t analog_sensor_init(analog_sensor_t *engine, const analog_channel_config_t *channels,
+                             uint8_t count, uint32_t sample_freq_hz,
+                             analog_event_cb_t callback, void *arg);
+
+/**
+ * @brief Start continuous conversions and the processing task
+ *
+ * @param engine Pointer to initialized engine structure
+ * @return esp_err_t ESP_OK on success, error code from adc driver otherwise
+ */
+esp_err_t analog_sensor_start(analog_sensor_t *engine);
+
+/**
+ * @brief Process one frame of raw conversion results
+ *
+ * Runs decimation and detection for every result in the frame and
+ * invokes the callback for any events. Called by the processing task;
+ * exposed for benchmarking with synthetic data.
+ *
+ * @param engine Pointer to engine structure
+ * @param frame Raw adc_digi_output_data_t results
+ * @param length Frame length in bytes
+ */
+void analog_sensor_process_frame(analog_sensor_t *engine, const uint8_t *frame, uint32_t length);
+
+/**
+ * @brief Get latest decimated level of a channel
+ *
+ * @param engine Pointer to engine structure
+ * @param index Channel index in configuration order
+ * @return int32_t Level in raw adc units, 0 on bad index
+ */
+int32_t analog_sensor_get_level(const analog_sensor_t *engine, uint8_t index);
+
+#endif  // ANALOG_SENSOR_H
@@ -0,0 +1,249 @@
+/**
+ * @file approach.c
+ * @author Anthony Yalong
+ * @brief Alpha-beta approach tracker implementation
+ */
+
+#include "approach.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "APPROACH";
+
+// fixed point scales
+#define APPROACH_Q8                 256
+#define APPROACH_Q16                65536
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Start a track at a position (classification state is kept, so a
+ *        target picked up again mid-walk is not reported twice)
+ *
+ * @param tracker Pointer to tracker structure
+ * @param time_us Reading time
+ * @param position Q8 cm
+ * @param velocity Q8 cm/s
+ */
+static void approach_restart(approach_tracker_t *tracker, int64_t time_us, int32_t position, int32_t velocity);
+
+/**
+ * @brief Classify the corrected track, report a transition
+ *
+ * @param tracker Pointer to tracker structure
+ * @param time_us Reading time
+ * @param event Filled in on a transition
+ * @return approach_event_type_t Transition, APPROACH_EVENT_NONE if unchanged
+ */
+static approach_event_type_t approach_classify(approach_tracker_t *tracker, int64_t time_us,
+                                               approach_event_t *event);
+
+/**
+ * @brief Confidence in the current state
+ *
+ * Moving: velocity over velocity plus twice its noise, scaled by how long
+ * the motion has been held. Loitering: how far below the still threshold
+ * the velocity is.
+ *
+ * @param tracker Pointer to tracker structure
+ * @param state State to rate
+ * @return uint8_t 0-100
+ */
+static uint8_t approach_confidence(const approach_tracker_t *tracker, approach_event_type_t state);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t approach_init(approach_tracker_t *tracker, float alpha, float beta, float speed_cm_s, float near_cm,
+                        uint32_t loiter_ms) {
+    // sanity check
+    if (tracker == NULL || !(alpha > 0.0f && alpha < 1.0f) || !(beta > 0.0f && beta < 1.0f) ||
+        !(speed_cm_s > 0.0f) || !(near_cm > 0.0f)) {
+        ESP_LOGE(TAG, "invalid tracker parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->alpha = (int32_t)(alpha * APPROACH_Q16);
+    tracker->beta = (int32_t)(beta * APPROACH_Q16);
+    tracker->speed = (int32_t)(speed_cm_s * APPROACH_Q8);
+    tracker->near = (int32_t)(near_cm * APPROACH_Q8);
+    tracker->loiter_ms = loiter_ms;
+    return ESP_OK;
+}
+
+approach_event_type_t approach_update(approach_tracker_t *tracker, int64_t time_us, float distance_cm,
+                                      approach_event_t *event) {
+    int32_t measured = (int32_t)(distance_cm * APPROACH_Q8);
+    tracker->stats.updates++;
+
+    // no track, or coasted too long to trust the prediction
+    int64_t dt_ms = (time_us - tracker->last_us) / 1000;
+    if (!tracker->tracking || dt_ms > APPROACH_MAX_GAP_MS) {
+        approach_restart(tracker, time_us, measured, 0);
+        tracker->state = APPROACH_EVENT_NONE;
+        tracker->candidate = APPROACH_EVENT_NONE;
+        tracker->run = 0;
+        tracker->still_since_us = -1;
+        return APPROACH_EVENT_NONE;
+    }
+    if (dt_ms <= 0) {
+        return APPROACH_EVENT_NONE;
+    }
+
+    // predict across the gap since the last reading (dropouts included)
+    int32_t predicted = tracker->position + (int32_t)((int64_t)tracker->velocity * dt_ms / 1000);
+    int32_t residual = measured - predicted;
+
+    // gate: a lone jump is a stray echo, a confirmed one is a new target
+    if (abs(residual) > APPROACH_GATE_CM * APPROACH_Q8) {
+        tracker->stats.outliers++;
+        int64_t span_us = time_us - tracker->outlier_us;
+        int64_t reach = (int64_t)APPROACH_MAX_SPEED_CM_S * APPROACH_Q8 * span_us / 1000000 +
+                        APPROACH_GATE_CM * APPROACH_Q8 / 2;
+        if (tracker->outliers > 0 && abs(measured - tracker->outlier_position) <= reach) {
+            tracker->outliers++;
+        } else {
+            tracker->outliers = 1;
+        }
+
+        if (tracker->outliers >= APPROACH_REACQUIRE_COUNT) {
+            int32_t velocity = (span_us > 0) ? (int32_t)((int64_t)(measured - tracker->outlier_position) *
+                                                        1000000 / span_us) : 0;
+            approach_restart(tracker, time_us, measured, velocity);
+            return approach_classify(tracker, time_us, event);
+        }
+        tracker->outlier_position = measured;
+        tracker->outlier_us = time_us;
+        return APPROACH_EVENT_NONE;
+    }
+    tracker->outliers = 0;
+
+    // correct
+    int32_t correction = (int32_t)((int64_t)tracker->beta * residual * 1000 / (dt_ms * APPROACH_Q16));
+    tracker->position = predicted + (int32_t)(((int64_t)tracker->alpha * residual) >> 16);
+    tracker->velocity += correction;
+    tracker->noise += (abs(correction) - tracker->noise) >> APPROACH_NOISE_SHIFT;
+    tracker->last_us = time_us;
+
+    return approach_classify(tracker, time_us, event);
+}
+
+void approach_miss(approach_tracker_t *tracker, int64_t time_us) {
+    tracker->stats.misses++;
+
+    // coast; the next reading predicts across the gap
+    if (tracker->tracking && (time_us - tracker->last_us) / 1000 > APPROACH_MAX_GAP_MS) {
+        tracker->tracking = false;
+        tracker->state = APPROACH_EVENT_NONE;
+    }
+}
+
+bool approach_get_track(const approach_tracker_t *tracker, float *distance_cm, float *velocity_cm_s) {
+    if (distance_cm != NULL) {
+        *distance_cm = (float)tracker->position / APPROACH_Q8;
+    }
+    if (velocity_cm_s != NULL) {
+        *velocity_cm_s = (float)tracker->velocity / APPROACH_Q8;
+    }
+    return tracker->tracking;
+}
+
+void approach_get_stats(const approach_tracker_t *tracker, approach_stats_t *stats) {
+    if (tracker == NULL || stats == NULL) {
+        return;
+    }
+    *stats = tracker->stats;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void approach_restart(approach_tracker_t *tracker, int64_t time_us, int32_t position, int32_t velocity) {
+    tracker->tracking = true;
+    tracker->position = position;
+    tracker->velocity = velocity;
+    tracker->noise = tracker->speed;        // unproven track: low confidence until it settles
+    tracker->last_us = time_us;
+    tracker->outliers = 0;
+    tracker->stats.restarts++;
+}
+
+static approach_event_type_t approach_classify(approach_tracker_t *tracker, int64_t time_us,
+                                               approach_event_t *event) {
+    // hysteresis: half the speed keeps a motion state, a quarter is still
+    int32_t keep = tracker->speed / 2;
+    int32_t still = tracker->speed / 4;
+    int32_t speed = abs(tracker->velocity);
+    approach_event_type_t moving = APPROACH_EVENT_NONE;
+
+    if (tracker->velocity <= -tracker->speed ||
+        (tracker->state == APPROACH_EVENT_APPROACHING && tracker->velocity <= -keep)) {
+        moving = APPROACH_EVENT_APPROACHING;
+    } else if (tracker->velocity >= tracker->speed ||
+               (tracker->state == APPROACH_EVENT_RECEDING && tracker->velocity >= keep)) {
+        moving = APPROACH_EVENT_RECEDING;
+    }
+
+    // motion must hold for a few samples before it is reported
+    if (moving != tracker->candidate) {
+        tracker->candidate = moving;
+        tracker->run = 0;
+    }
+    if (tracker->run < UINT8_MAX) {
+        tracker->run++;
+    }
+
+    approach_event_type_t next = APPROACH_EVENT_NONE;
+    if (moving != APPROACH_EVENT_NONE && (tracker->run >= APPROACH_MIN_SAMPLES || tracker->state == moving)) {
+        next = moving;
+    }
+
+    // loitering: nearly still inside the near range for long enough
+    bool loitering = (tracker->state == APPROACH_EVENT_LOITERING) ? speed <= keep : speed <= still;
+    if (loitering && tracker->position <= tracker->near) {
+        if (tracker->still_since_us < 0) {
+            tracker->still_since_us = time_us;
+        }
+        if (time_us - tracker->still_since_us >= (int64_t)tracker->loiter_ms * 1000) {
+            next = APPROACH_EVENT_LOITERING;
+        }
+    } else {
+        tracker->still_since_us = -1;
+    }
+
+    // report entering a state, leaving one is silent
+    if (next == tracker->state) {
+        return APPROACH_EVENT_NONE;
+    }
+    tracker->state = next;
+    if (next == APPROACH_EVENT_NONE) {
+        return APPROACH_EVENT_NONE;
+    }
+
+    if (event != NULL) {
+        event->type = next;
+        event->time_us = time_us;
+        event->distance_cm = (float)tracker->position / APPROACH_Q8;
+        event->velocity_cm_s = (float)tracker->velocity / APPROACH_Q8;
+        event->confidence = approach_confidence(tracker, next);
+    }
+    tracker->stats.events++;
+    return next;
+}
+
+static uint8_t approach_confidence(const approach_tracker_t *tracker, approach_event_type_t state) {
+    int32_t speed = abs(tracker->velocity);
+    int32_t keep = tracker->speed / 2;
+
+    if (state == APPROACH_EVENT_LOITERING) {
+        return (speed >= keep) ? 0 : (uint8_t)((keep - speed) * 100 / keep);
+    }
+
+    // signal to noise, then how long it has held (full at twice the minimum)
+    int32_t snr = (int32_t)((int64_t)speed * 100 / (speed + 2 * tracker->noise + 1));
+    int32_t held = (tracker->run < 2 * APPROACH_MIN_SAMPLES) ? tracker->run : 2 * APPROACH_MIN_SAMPLES;
+    return (uint8_t)(snr * held / (2 * APPROACH_MIN_SAMPLES));
+}
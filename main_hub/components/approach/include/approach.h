@@ -0,0 +1,149 @@
+/**
+ * @file approach.h
+ * @author Anthony Yalong
+ * @brief Fixed-point alpha-beta tracker on an ultrasonic distance series -
+ *        radial velocity and approaching / receding / loitering events
+ */
+#ifndef APPROACH_H
+#define APPROACH_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// configuration
+#define APPROACH_GATE_CM            15      // innovation beyond this is an outlier
+#define APPROACH_REACQUIRE_COUNT    2       // consistent outliers that restart the track
+#define APPROACH_MAX_SPEED_CM_S     250     // fastest walk, limits what confirms an outlier
+#define APPROACH_MAX_GAP_MS         1500    // track dropped after this long without a reading
+#define APPROACH_MIN_SAMPLES        3       // samples past the speed threshold before an event
+#define APPROACH_NOISE_SHIFT        3       // velocity noise average over 8 samples
+
+/**
+ * @brief Event types
+ */
+typedef enum {
+    APPROACH_EVENT_NONE = 0,
+    APPROACH_EVENT_APPROACHING,     // closing in on the sensor
+    APPROACH_EVENT_RECEDING,        // moving away from it
+    APPROACH_EVENT_LOITERING,       // nearly still within the near range
+} approach_event_type_t;
+
+/**
+ * @brief Event reported on a state transition
+ */
+typedef struct {
+    approach_event_type_t type;
+    int64_t time_us;
+    float distance_cm;              // filtered
+    float velocity_cm_s;            // negative when approaching
+    uint8_t confidence;             // 0-100
+} approach_event_t;
+
+/**
+ * @brief Tracker statistics
+ */
+typedef struct {
+    uint32_t updates;               // readings
+    uint32_t misses;                // dropouts (no echo)
+    uint32_t outliers;              // readings outside the gate
+    uint32_t restarts;              // tracks (re)started
+    uint32_t events;
+} approach_stats_t;
+
+/**
+ * @brief Tracker structure (one per ultrasonic channel, single writer)
+ *
+ * Positions are Q8 cm, velocities Q8 cm/s, gains Q16.
+ */
+typedef struct {
+    // gains and thresholds
+    int32_t alpha;
+    int32_t beta;
+    int32_t speed;                  // |velocity| for approaching / receding
+    int32_t near;                   // loitering range
+    uint32_t loiter_ms;             // stillness needed for loitering
+
+    // track
+    bool tracking;
+    int32_t position;
+    int32_t velocity;
+    int32_t noise;                  // mean |velocity correction|
+    int64_t last_us;
+    uint8_t outliers;               // consecutive consistent outliers
+    int32_t outlier_position;
+    int64_t outlier_us;
+
+    // classification
+    approach_event_type_t state;    // last reported (none after leaving a state)
+    approach_event_type_t candidate; // motion seen on the latest samples
+    uint8_t run;                    // consecutive samples showing the candidate
+    int64_t still_since_us;         // -1 when moving or out of range
+    approach_stats_t stats;
+} approach_tracker_t;
+
+/**
+ * @brief Initialize a tracker
+ *
+ * Critically damped gains satisfy beta = alpha^2 / (2 - alpha).
+ *
+ * @param tracker Pointer to tracker structure
+ * @param alpha Position gain (0, 1)
+ * @param beta Velocity gain (0, 1)
+ * @param speed_cm_s Radial speed that counts as approaching / receding
+ * @param near_cm Range within which a still target is loitering
+ * @param loiter_ms Time still before loitering is reported
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad parameters
+ */
+esp_err_t approach_init(approach_tracker_t *tracker, float alpha, float beta, float speed_cm_s, float near_cm,
+                        uint32_t loiter_ms);
+
+/**
+ * @brief Feed a distance reading
+ *
+ * Predicts across the time since the last reading (so dropped samples need
+ * no catching up), gates the innovation and corrects position and velocity.
+ * A jump outside the gate is ignored unless the next reading confirms it,
+ * which restarts the track with a two-point velocity (someone stepping
+ * into the beam). O(1), integer only after the input conversion.
+ *
+ * @param tracker Pointer to tracker structure
+ * @param time_us Reading time, increasing
+ * @param distance_cm Measured distance
+ * @param event Filled in when a transition is reported
+ * @return approach_event_type_t Transition, APPROACH_EVENT_NONE if the state is unchanged
+ */
+approach_event_type_t approach_update(approach_tracker_t *tracker, int64_t time_us, float distance_cm,
+                                      approach_event_t *event);
+
+/**
+ * @brief Report a reading with no echo (ESP_ERR_TIMEOUT)
+ *
+ * The track coasts; after APPROACH_MAX_GAP_MS without a reading it is
+ * dropped and the state returns to none without an event.
+ *
+ * @param tracker Pointer to tracker structure
+ * @param time_us Reading time
+ */
+void approach_miss(approach_tracker_t *tracker, int64_t time_us);
+
+/**
+ * @brief Current filtered distance and velocity
+ *
+ * @param tracker Pointer to tracker structure
+ * @param distance_cm Output distance (can be NULL)
+ * @param velocity_cm_s Output velocity, negative when approaching (can be NULL)
+ * @return bool true if a track is held
+ */
+bool approach_get_track(const approach_tracker_t *tracker, float *distance_cm, float *velocity_cm_s);
+
+/**
+ * @brief Get tracker statistics
+ *
+ * @param tracker Pointer to tracker structure
+ * @param stats Output statistics
+ */
+void approach_get_stats(const approach_tracker_t *tracker, approach_stats_t *stats);
+
+#endif  // APPROACH_H
@@ -0,0 +1,164 @@
+/**
+ * @file compressor.c
+ * @author Anthony Yalong
+ * @brief Deadband and swinging door compression implementation
+ */
+
+#include "compressor.h"
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "COMPRESSOR";
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Record a point as emitted
+ *
+ * @param compressor Pointer to compressor structure
+ * @param time_us Point time
+ * @param value Point value
+ * @param point Output point
+ * @return bool Always true
+ */
+static bool compressor_emit(compressor_t *compressor, int64_t time_us, float value, compressor_point_t *point);
+
+/**
+ * @brief Point on the middle of the swinging door corridor
+ *
+ * @param compressor Pointer to compressor structure
+ * @param time_us Time to evaluate at
+ * @return float Value at time_us
+ */
+static float compressor_corridor_value(const compressor_t *compressor, int64_t time_us);
+
+/**
+ * @brief Open the doors from the archived point to a sample
+ *
+ * @param compressor Pointer to compressor structure
+ * @param time_us Sample time (after the archived point)
+ * @param value Sample value
+ */
+static void compressor_open_doors(compressor_t *compressor, int64_t time_us, float value);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t compressor_init(compressor_t *compressor, compressor_mode_t mode, float deviation,
+                          uint32_t max_interval_ms) {
+    // sanity check
+    if (compressor == NULL || !(deviation >= 0.0f) || mode > COMPRESSOR_SWINGING_DOOR) {
+        ESP_LOGE(TAG, "invalid compressor parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(compressor, 0, sizeof(*compressor));
+    compressor->mode = mode;
+    compressor->deviation = deviation;
+    compressor->max_interval_us = (int64_t)max_interval_ms * 1000;
+    return ESP_OK;
+}
+
+bool compressor_add(compressor_t *compressor, int64_t time_us, float value, compressor_point_t *point) {
+    if (compressor == NULL || point == NULL) {
+        return false;
+    }
+    compressor->stats.samples++;
+
+    // first sample always goes out
+    if (!compressor->started || compressor->mode == COMPRESSOR_OFF) {
+        compressor->started = true;
+        compressor->last = (compressor_point_t){ time_us, value };
+        return compressor_emit(compressor, time_us, value, point);
+    }
+
+    // out-of-order or duplicate timestamps carry no slope information
+    if (time_us <= compressor->last.time_us) {
+        return false;
+    }
+
+    bool overdue = compressor->max_interval_us > 0 &&
+                   time_us - compressor->archived.time_us >= compressor->max_interval_us;
+    compressor_point_t previous = compressor->last;
+    compressor->last = (compressor_point_t){ time_us, value };
+
+    if (compressor->mode == COMPRESSOR_DEADBAND) {
+        if (fabsf(value - compressor->archived.value) > compressor->deviation || overdue) {
+            return compressor_emit(compressor, time_us, value, point);
+        }
+        return false;
+    }
+
+    // swinging door: first sample after a point just opens the doors
+    if (previous.time_us == compressor->archived.time_us) {
+        compressor_open_doors(compressor, time_us, value);
+        if (overdue) {
+            return compressor_emit(compressor, time_us, compressor_corridor_value(compressor, time_us), point);
+        }
+        return false;
+    }
+
+    // narrow the doors with this sample
+    float elapsed_s = (time_us - compressor->archived.time_us) / 1e6f;
+    float upper = (value + compressor->deviation - compressor->archived.value) / elapsed_s;
+    float lower = (value - compressor->deviation - compressor->archived.value) / elapsed_s;
+    float slope_upper = fminf(compressor->slope_upper, upper);
+    float slope_lower = fmaxf(compressor->slope_lower, lower);
+
+    if (slope_lower > slope_upper) {
+        // no line fits through this sample too - close at the previous one
+        compressor_emit(compressor, previous.time_us, compressor_corridor_value(compressor, previous.time_us), point);
+        compressor_open_doors(compressor, time_us, value);
+        return true;
+    }
+
+    compressor->slope_upper = slope_upper;
+    compressor->slope_lower = slope_lower;
+    if (overdue) {
+        return compressor_emit(compressor, time_us, compressor_corridor_value(compressor, time_us), point);
+    }
+    return false;
+}
+
+bool compressor_flush(compressor_t *compressor, compressor_point_t *point) {
+    if (compressor == NULL || point == NULL || !compressor->started ||
+        compressor->last.time_us == compressor->archived.time_us) {
+        return false;
+    }
+
+    int64_t time_us = compressor->last.time_us;
+    float value = (compressor->mode == COMPRESSOR_SWINGING_DOOR) ? compressor_corridor_value(compressor, time_us)
+                                                                  : compressor->last.value;
+    compressor_emit(compressor, time_us, value, point);
+    return true;
+}
+
+void compressor_get_stats(const compressor_t *compressor, compressor_stats_t *stats) {
+    if (compressor == NULL || stats == NULL) {
+        return;
+    }
+    *stats = compressor->stats;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static bool compressor_emit(compressor_t *compressor, int64_t time_us, float value, compressor_point_t *point) {
+    compressor->archived = (compressor_point_t){ time_us, value };
+    compressor->stats.points++;
+    *point = compressor->archived;
+    return true;
+}
+
+static float compressor_corridor_value(const compressor_t *compressor, int64_t time_us) {
+    float slope = 0.5f * (compressor->slope_upper + compressor->slope_lower);
+    return compressor->archived.value + slope * ((time_us - compressor->archived.time_us) / 1e6f);
+}
+
+static void compressor_open_doors(compressor_t *compressor, int64_t time_us, float value) {
+    float elapsed_s = (time_us - compressor->archived.time_us) / 1e6f;
+    compressor->slope_upper = (value + compressor->deviation - compressor->archived.value) / elapsed_s;
+    compressor->slope_lower = (value - compressor->deviation - compressor->archived.value) / elapsed_s;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file compressor.h
+ * @author Anthony Yalong
+ * @brief Per-channel lossy telemetry compression - deadband and swinging
+ *        door - with a hard reconstruction error bound
+ */
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Compression modes
+ */
+typedef enum {
+    COMPRESSOR_OFF = 0,             // every sample passes
+    COMPRESSOR_DEADBAND,            // reconstruct by holding the last point
+    COMPRESSOR_SWINGING_DOOR,       // reconstruct by linear interpolation
+} compressor_mode_t;
+
+/**
+ * @brief Point kept by the compressor
+ */
+typedef struct {
+    int64_t time_us;
+    float value;
+} compressor_point_t;
+
+/**
+ * @brief Compression statistics
+ */
+typedef struct {
+    uint32_t samples;               // samples offered
+    uint32_t points;                // points emitted
+} compressor_stats_t;
+
+/**
+ * @brief Compressor structure (one per channel, single writer)
+ */
+typedef struct {
+    compressor_mode_t mode;
+    float deviation;                // error bound, channel units
+    int64_t max_interval_us;        // emit at least this often (0: never forced)
+
+    // state
+    bool started;
+    compressor_point_t archived;    // last emitted point
+    compressor_point_t last;        // last sample seen
+    float slope_upper;              // swinging door: steepest slope still allowed
+    float slope_lower;              // swinging door: shallowest slope still allowed
+    compressor_stats_t stats;
+} compressor_t;
+
+/**
+ * @brief Initialize a compressor
+ *
+ * @param compressor Pointer to compressor structure
+ * @param mode Compression mode
+ * @param deviation Error bound (>= 0), in the channel's units
+ * @param max_interval_ms Longest gap between emitted points, 0 for none
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad parameters
+ */
+esp_err_t compressor_init(compressor_t *compressor, compressor_mode_t mode, float deviation,
+                          uint32_t max_interval_ms);
+
+/**
+ * @brief Offer a sample
+ *
+ * Deadband emits the sample itself once it leaves +/-deviation of the last
+ * point. Swinging door emits a point when no single line from the last
+ * point stays within +/-deviation of every sample since; the point emitted
+ * lies on the middle of the remaining corridor, so interpolating between
+ * points is within deviation of every sample. Emitted points may be up to
+ * one sample behind the input.
+ *
+ * @param compressor Pointer to compressor structure
+ * @param time_us Sample time, increasing
+ * @param value Sample value
+ * @param point Output point, valid when true is returned
+ * @return bool true if a point was emitted
+ */
+bool compressor_add(compressor_t *compressor, int64_t time_us, float value, compressor_point_t *point);
+
+/**
+ * @brief Emit the pending tail (the last sample) if it was not emitted
+ *
+ * @param compressor Pointer to compressor structure
+ * @param point Output point, valid when true is returned
+ * @return bool true if a point was emitted
+ */
+bool compressor_flush(compressor_t *compressor, compressor_point_t *point);
+
+/**
+ * @brief Get compression statistics
+ *
+ * @param compressor Pointer to compressor structure
+ * @param stats Output statistics
+ */
+void compressor_get_stats(const compressor_t *compressor, compressor_stats_t *stats);
+
+#endif  // COMPRESSOR_H
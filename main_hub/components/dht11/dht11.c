@@ -5,6 +5,9 @@
  */
 
 #include "dht11.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_rom_sys.h"
@@ -14,11 +17,27 @@ static const char *TAG = "DHT11";
 // ============================================================================
 // DHT11 Configuration
 // ============================================================================
-#define DHT11_START_SIGNAL_LOW_MS   18
 #define DHT11_START_SIGNAL_HIGH_US  30
 #define DHT11_RESPONSE_TIMEOUT_US   100
 #define DHT11_BIT_TIMEOUT_US        200
-#define DHT11_BIT_THRESHOLD_US      40
+
+// bit timing runs from iram: a cache miss (lines evicted by ble or a flash
+// write) would otherwise stretch the measured pulse. gpio_get_level needs
+// CONFIG_GPIO_CTRL_FUNC_IN_IRAM (sdkconfig.defaults), esp_timer_get_time is in iram
+#if DHT11_IRAM
+#define DHT11_HOT_PATH              IRAM_ATTR
+#else
+#define DHT11_HOT_PATH
+#endif
+
+// measurement mode hooks for the polling loops
+#if DHT11_TIMING_STATS
+#define DHT11_POLL_START()          uint32_t poll_last = esp_cpu_get_cycle_count()
+#define DHT11_POLL(sensor)          count_poll((sensor), &poll_last)
+#else
+#define DHT11_POLL_START()
+#define DHT11_POLL(sensor)
+#endif
 
 // ============================================================================
 // Helper Function Prototypes
@@ -29,12 +48,12 @@ static const char *TAG = "DHT11";
  * Polls the GPIO pin until it reaches the target level or timeout occurs.
  * Used for DHT11 protocol timing where the sensor controls the data line.
  * 
- * @param pin GPIO pin to monitor
+ * @param sensor Pointer to sensor structure
  * @param level Target level to wait for (0 = LOW, 1 = HIGH)
  * @param timeout_us Maximum time to wait in microseconds
  * @return esp_err_t ESP_OK if level reached, ESP_ERR_TIMEOUT otherwise
  */
-static esp_err_t wait_for_level(gpio_num_t pin, bool level, uint32_t timeout_us);
+static esp_err_t wait_for_level(dht11_sensor_t *sensor, bool level, uint32_t timeout_us);
 
 /**
  * @brief Measure the width of a pulse on a GPIO pin
@@ -43,27 +62,37 @@ static esp_err_t wait_for_level(gpio_num_t pin, bool level, uint32_t timeout_us)
  * pin returns to opposite level. Used to distinguish between DHT11's
  * short (~26-28μs) and long (~70μs) pulses for bit decoding.
  * 
- * @param pin GPIO pin to monitor
+ * @param sensor Pointer to sensor structure
  * @param level Level to measure (0 = LOW pulse, 1 = HIGH pulse)
  * @param timeout_us Maximum time to wait in microseconds
  * @return int64_t Pulse width in microseconds, or -1 on timeout
  */
-static int64_t measure_pulse_width(gpio_num_t pin, uint32_t level, uint32_t timeout_us);
+static int64_t measure_pulse_width(dht11_sensor_t *sensor, uint32_t level, uint32_t timeout_us);
 
 /**
- * @brief Read 40 bits of data from DHT11 sensor
+ * @brief Capture the 40 bits of data from DHT11 sensor
  * 
- * Reads 5 bytes (40 bits) of data after DHT11 response signal:
- * - Bytes 0-1: Humidity (integer + decimal)
- * - Bytes 2-3: Temperature (integer + decimal)
- * - Byte 4: Checksum
- * Decodes bits based on HIGH pulse width (>50μs = '1', <50μs = '0').
+ * Records the HIGH pulse width of each bit after the DHT11 response
+ * signal; dht11_decode() turns them into bytes afterwards, so nothing
+ * but pin polling happens between bits.
+ * Runs from iram and does not log (format strings live in flash); the
+ * caller decodes and reports sensor->failed_bit.
  * 
  * @param sensor Pointer to initialized sensor structure
- * @return esp_err_t ESP_OK on success, ESP_ERR_TIMEOUT on read failure,
- *                   ESP_ERR_INVALID_CRC on checksum mismatch
+ * @param pulse_us Output pulse widths (saturated at 255 us)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_TIMEOUT on read failure
+ */
+static esp_err_t read_data_bits(dht11_sensor_t *sensor, uint8_t *pulse_us);
+
+#if DHT11_TIMING_STATS
+/**
+ * @brief Account one poll of the data line (measurement mode)
+ *
+ * @param sensor Pointer to sensor structure
+ * @param last Cycle count at the previous poll, updated
  */
-static esp_err_t read_data_bits(dht11_sensor_t *sensor);
+static void count_poll(dht11_sensor_t *sensor, uint32_t *last);
+#endif
 
 // ============================================================================
 // Public API Implementation
@@ -102,6 +131,9 @@ esp_err_t dht11_init(dht11_sensor_t *sensor, gpio_num_t pin) {
     sensor->last_temperature = 0.0;
     sensor->last_humidity = 0.0;
     sensor->last_read_time_us = 0;
+    sensor->start_time_us = 0;
+    sensor->failed_bit = -1;
+    dht11_reset_timing(sensor);
 
     ESP_LOGI(TAG, "successfully initialized dht11 sensor");
     return ESP_OK;
@@ -110,6 +142,18 @@ esp_err_t dht11_init(dht11_sensor_t *sensor, gpio_num_t pin) {
 esp_err_t dht11_read(dht11_sensor_t *sensor) {
     // error management
     esp_err_t ret;
+
+    // start signal busy-waited in dht11_finish()
+    ret = dht11_start(sensor);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return dht11_finish(sensor);
+}
+
+esp_err_t dht11_start(dht11_sensor_t *sensor) {
+    // error management
+    esp_err_t ret;
     
     // sanity check
     if (sensor == NULL) {
@@ -117,9 +161,6 @@ esp_err_t dht11_read(dht11_sensor_t *sensor) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // setup
-    gpio_num_t pin = sensor->pin;
-    
     // check last read time - enforce minimum interval
     int64_t cur_time = esp_timer_get_time();
     if ((cur_time - sensor->last_read_time_us) < (DHT11_MIN_READ_INTERVAL_MS * 1000)) {
@@ -140,7 +181,33 @@ esp_err_t dht11_read(dht11_sensor_t *sensor) {
         return ret;
     }
     
-    esp_rom_delay_us(DHT11_START_SIGNAL_LOW_MS * 1000);
+    sensor->start_time_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+esp_err_t dht11_finish(dht11_sensor_t *sensor) {
+    // error management
+    esp_err_t ret;
+    
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "dht11 sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sensor->start_time_us == 0) {
+        ESP_LOGE(TAG, "no read started");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // setup
+    gpio_num_t pin = sensor->pin;
+    
+    // rest of the start signal, if the caller came early
+    int64_t remaining = sensor->start_time_us + DHT11_START_SIGNAL_LOW_MS * 1000 - esp_timer_get_time();
+    if (remaining > 0) {
+        esp_rom_delay_us((uint32_t)remaining);
+    }
+    sensor->start_time_us = 0;
     
     // pull data line HIGH for 20-40μs
     ret = gpio_set_level(pin, 1);
@@ -149,7 +216,7 @@ esp_err_t dht11_read(dht11_sensor_t *sensor) {
         return ret;
     }
     
-    esp_rom_delay_us(30);
+    esp_rom_delay_us(DHT11_START_SIGNAL_HIGH_US);
     
     // release line (switch to input for DHT11 to take control)
     ret = gpio_set_direction(pin, GPIO_MODE_INPUT);
@@ -158,26 +225,52 @@ esp_err_t dht11_read(dht11_sensor_t *sensor) {
         return ret;
     }
     
+#if DHT11_TIMING_STATS
+    uint32_t stalls = sensor->timing.stalls;
+    sensor->stall_cycles = DHT11_STALL_US * esp_rom_get_cpu_ticks_per_us();
+    sensor->timing.reads++;
+#endif
+
     // wait for DHT11 response signal (LOW)
-    ret = wait_for_level(pin, 0, DHT11_RESPONSE_TIMEOUT_US);
+    ret = wait_for_level(sensor, 0, DHT11_RESPONSE_TIMEOUT_US);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "timeout waiting for DHT11 response LOW");
         return ret;
     }
     
     // wait for DHT11 ready signal (HIGH)
-    ret = wait_for_level(pin, 1, DHT11_RESPONSE_TIMEOUT_US);
+    ret = wait_for_level(sensor, 1, DHT11_RESPONSE_TIMEOUT_US);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "timeout waiting for DHT11 response HIGH");
         return ret;
     }
     
     // read 40 bits of data
-    ret = read_data_bits(sensor);
+    uint8_t pulse_us[DHT11_FRAME_BITS];
+    ret = read_data_bits(sensor, pulse_us);
+#if DHT11_TIMING_STATS
+    if (sensor->timing.stalls != stalls) {
+        sensor->timing.stalled_reads++;
+    }
+#endif
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "failed to read data bits");
+        ESP_LOGW(TAG, "timeout reading data bit %d", sensor->failed_bit);
         return ret;
     }
+
+    // decode and check sum
+    uint8_t data[DHT11_FRAME_BITS / 8];
+    ret = dht11_decode(pulse_us, data);
+    if (ret != ESP_OK) {
+        uint8_t checksum = data[0] + data[1] + data[2] + data[3];
+        ESP_LOGW(TAG, "checksum mismatch: calculated 0x%02X, received 0x%02X", checksum, data[4]);
+        return ret;
+    }
+
+    // extract values
+    sensor->last_humidity = data[0];
+    sensor->last_temperature = data[2];
+    ESP_LOGD(TAG, "temp: %.1f°C, humidity: %.1f%%", sensor->last_temperature, sensor->last_humidity);
     
     // update last read time on success
     sensor->last_read_time_us = esp_timer_get_time();
@@ -205,13 +298,34 @@ float dht11_get_humidity(const dht11_sensor_t *sensor) {
     return sensor->last_humidity;
 }
 
+void dht11_get_timing(const dht11_sensor_t *sensor, dht11_timing_t *timing) {
+    if (sensor == NULL || timing == NULL) {
+        return;
+    }
+#if DHT11_TIMING_STATS
+    *timing = sensor->timing;
+#else
+    memset(timing, 0, sizeof(*timing));
+#endif
+}
+
+void dht11_reset_timing(dht11_sensor_t *sensor) {
+#if DHT11_TIMING_STATS
+    memset(&sensor->timing, 0, sizeof(sensor->timing));
+    sensor->timing.pulse_min_us[0] = INT32_MAX;
+    sensor->timing.pulse_min_us[1] = INT32_MAX;
+#endif
+}
+
 // ============================================================================
 // Helper Function Implementation
 // ============================================================================
-static esp_err_t wait_for_level(gpio_num_t pin, bool level, uint32_t timeout_us) {
+static esp_err_t DHT11_HOT_PATH wait_for_level(dht11_sensor_t *sensor, bool level, uint32_t timeout_us) {
     int64_t start_time = esp_timer_get_time();
+    DHT11_POLL_START();
     
-    while (gpio_get_level(pin) != level) {
+    while (gpio_get_level(sensor->pin) != level) {
+        DHT11_POLL(sensor);
         if ((esp_timer_get_time() - start_time) > timeout_us) {
             return ESP_ERR_TIMEOUT;
         }
@@ -220,10 +334,12 @@ static esp_err_t wait_for_level(gpio_num_t pin, bool level, uint32_t timeout_us)
     return ESP_OK;
 }
 
-static int64_t measure_pulse_width(gpio_num_t pin, uint32_t level, uint32_t timeout_us) {
+static int64_t DHT11_HOT_PATH measure_pulse_width(dht11_sensor_t *sensor, uint32_t level, uint32_t timeout_us) {
     // wait for pin to set to level
     int64_t start_time = esp_timer_get_time();
-    while (gpio_get_level(pin) != level) {
+    DHT11_POLL_START();
+    while (gpio_get_level(sensor->pin) != level) {
+        DHT11_POLL(sensor);
         if ((esp_timer_get_time() - start_time) > timeout_us) {
             return -1;  // timeout
         }
@@ -231,7 +347,8 @@ static int64_t measure_pulse_width(gpio_num_t pin, uint32_t level, uint32_t time
     
     // Measure how long it stays at that level
     int64_t pulse_start = esp_timer_get_time();
-    while (gpio_get_level(pin) == level) {
+    while (gpio_get_level(sensor->pin) == level) {
+        DHT11_POLL(sensor);
         if ((esp_timer_get_time() - pulse_start) > timeout_us) {
             return -1;  // timeout
         }
@@ -240,57 +357,55 @@ static int64_t measure_pulse_width(gpio_num_t pin, uint32_t level, uint32_t time
     return esp_timer_get_time() - pulse_start;
 }
 
-static esp_err_t read_data_bits(dht11_sensor_t *sensor) {
-    // error management
-    esp_err_t ret;
-
+static esp_err_t DHT11_HOT_PATH read_data_bits(dht11_sensor_t *sensor, uint8_t *pulse_us) {
     // read 40 bits
-    uint8_t data[5] = {0};
-    for (int i = 0; i < 40; i++) {
-        int byte_index = i / 8;
-        int bit_position = 7 - (i % 8);
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        sensor->failed_bit = i;
         
-        // wait for low (start of bit)
-        ret = wait_for_level(sensor->pin, 0, DHT11_BIT_TIMEOUT_US);
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Timeout waiting for bit %d LOW", i);
-            return ESP_ERR_TIMEOUT;
-        }
-
-        // wait for high (bit value)
-        ret = wait_for_level(sensor->pin, 1, DHT11_BIT_TIMEOUT_US);
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Timeout waiting for bit %d HIGH", i);
+        // wait for low (start of bit), then high (bit value)
+        if (wait_for_level(sensor, 0, DHT11_BIT_TIMEOUT_US) != ESP_OK ||
+            wait_for_level(sensor, 1, DHT11_BIT_TIMEOUT_US) != ESP_OK) {
             return ESP_ERR_TIMEOUT;
         }
 
         // measure HIGH pulse width
-        int64_t pulse_width = measure_pulse_width(sensor->pin, 1, DHT11_BIT_TIMEOUT_US);
+        int64_t pulse_width = measure_pulse_width(sensor, 1, DHT11_BIT_TIMEOUT_US);
         if (pulse_width < 0) {
-            ESP_LOGW(TAG, "timeout measuring pulse width for bit %d", i);
             return ESP_ERR_TIMEOUT;
         }
 
-        // determine bit value
-        if (pulse_width > DHT11_BIT_THRESHOLD_US) {
-            // bit is 1
-            data[byte_index] |= (1 << bit_position);
-        }
-    }
+        // bit value is decided after the frame
+        pulse_us[i] = (pulse_width > UINT8_MAX) ? UINT8_MAX : (uint8_t)pulse_width;
 
-    // check sum
-    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
-    if (checksum != data[4]) {
-        ESP_LOGW(TAG, "checksum mismatch: calculated 0x%02X, received 0x%02X", checksum, data[4]);
-        return ESP_ERR_INVALID_CRC;
+#if DHT11_TIMING_STATS
+        // spread of each pulse class is the jitter seen by the decoder
+        bool bit = pulse_width > DHT11_BIT_THRESHOLD_US;
+        if (pulse_width < sensor->timing.pulse_min_us[bit]) {
+            sensor->timing.pulse_min_us[bit] = pulse_width;
+        }
+        if (pulse_width > sensor->timing.pulse_max_us[bit]) {
+            sensor->timing.pulse_max_us[bit] = pulse_width;
+        }
+#endif
     }
 
-    // extract values
-    sensor->last_humidity = data[0];
-    sensor->last_temperature = data[2];
+    sensor->failed_bit = -1;
+    return ESP_OK;
+}
 
-    // log
-    ESP_LOGD(TAG, "temp: %.1f°C, humidity: %.1f%%", sensor->last_temperature, sensor->last_humidity);
+#if DHT11_TIMING_STATS
+static void DHT11_HOT_PATH count_poll(dht11_sensor_t *sensor, uint32_t *last) {
+    uint32_t now = esp_cpu_get_cycle_count();
+    uint32_t cycles = now - *last;
+    *last = now;
 
-    return ESP_OK;
-}
\ No newline at end of file
+    sensor->timing.polls++;
+    sensor->timing.poll_cycles += cycles;
+    if (cycles > sensor->timing.max_poll_cycles) {
+        sensor->timing.max_poll_cycles = cycles;
+    }
+    if (cycles > sensor->stall_cycles) {
+        sensor->timing.stalls++;
+    }
+}
+#endif
@@ -0,0 +1,26 @@
+/**
+ * @file dht11_decode.c
+ * @author Anthony Yalong
+ * @brief DHT11 frame decoding - pulse widths to bytes, checksum
+ */
+
+#include "dht11.h"
+#include <string.h>
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t dht11_decode(const uint8_t pulse_us[DHT11_FRAME_BITS], uint8_t data[DHT11_FRAME_BITS / 8]) {
+    memset(data, 0, DHT11_FRAME_BITS / 8);
+
+    // msb first, a long high pulse is a 1
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        if (pulse_us[i] > DHT11_BIT_THRESHOLD_US) {
+            data[i / 8] |= 1 << (7 - (i % 8));
+        }
+    }
+
+    // check sum
+    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
+    return (checksum == data[4]) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
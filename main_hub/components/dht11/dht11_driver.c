@@ -0,0 +1,79 @@
+/**
+ * @file dht11_driver.c
+ * @author Anthony Yalong
+ * @brief DHT11 sensor interface for the sensor registry
+ */
+
+#include "dht11.h"
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Initialize from a dht11_config_t
+ *
+ * @param sensor Pointer to sensor structure
+ * @param config Pointer to dht11_config_t
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG without a config
+ */
+static esp_err_t dht11_driver_init(void *sensor, const void *config);
+
+/**
+ * @brief Send the start signal - the registry sleeps through it
+ *
+ * @param sensor Pointer to sensor structure
+ * @param wait_us Output start signal length
+ * @return esp_err_t ESP_OK on success, error code from dht11_start() otherwise
+ */
+static esp_err_t dht11_driver_start(void *sensor, uint32_t *wait_us);
+
+/**
+ * @brief Read the frame (~5 ms busy)
+ *
+ * @param sensor Pointer to sensor structure
+ * @param wait_us Unused
+ * @return esp_err_t ESP_OK on success, error code from dht11_finish() otherwise
+ */
+static esp_err_t dht11_driver_poll(void *sensor, uint32_t *wait_us);
+
+/**
+ * @brief Last temperature and humidity
+ *
+ * @param sensor Pointer to sensor structure
+ * @param sample Output sample
+ */
+static void dht11_driver_get(const void *sensor, sensor_sample_t *sample);
+
+const sensor_driver_t dht11_driver = {
+    .name = "dht11",
+    .caps = SENSOR_CAP_TEMPERATURE | SENSOR_CAP_HUMIDITY | SENSOR_CAP_SPLIT | SENSOR_CAP_BLOCKING,
+    .init = dht11_driver_init,
+    .start = dht11_driver_start,
+    .poll = dht11_driver_poll,
+    .get = dht11_driver_get,
+};
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t dht11_driver_init(void *sensor, const void *config) {
+    const dht11_config_t *dht11_config = (const dht11_config_t *)config;
+    if (dht11_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return dht11_init((dht11_sensor_t *)sensor, dht11_config->pin);
+}
+
+static esp_err_t dht11_driver_start(void *sensor, uint32_t *wait_us) {
+    *wait_us = DHT11_START_SIGNAL_LOW_MS * 1000;
+    return dht11_start((dht11_sensor_t *)sensor);
+}
+
+static esp_err_t dht11_driver_poll(void *sensor, uint32_t *wait_us) {
+    return dht11_finish((dht11_sensor_t *)sensor);
+}
+
+static void dht11_driver_get(const void *sensor, sensor_sample_t *sample) {
+    sample->temperature = dht11_get_temperature((const dht11_sensor_t *)sensor);
+    sample->humidity = dht11_get_humidity((const dht11_sensor_t *)sensor);
+}
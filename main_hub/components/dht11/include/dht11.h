@@ -11,9 +11,37 @@
 #include <stdint.h>
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "sensor.h"
 
 // configuration
 #define DHT11_MIN_READ_INTERVAL_MS  2000  // minimum time between reads
+#define DHT11_START_SIGNAL_LOW_MS   18    // start signal, dht11_start() to dht11_finish()
+#ifndef DHT11_IRAM
+#define DHT11_IRAM                  1     // bit timing loops in iram (0: flash, baseline for comparison)
+#endif
+#ifndef DHT11_TIMING_STATS
+#define DHT11_TIMING_STATS          0     // measurement mode: poll cycles, stalls and pulse spread
+#endif
+#define DHT11_STALL_US              5     // a poll this long was stalled (cache miss, flash write, interrupt)
+#define DHT11_FRAME_BITS            40    // humidity, 0, temperature, 0, checksum
+#define DHT11_BIT_THRESHOLD_US      40    // high pulse longer than this is a 1 (~26 us: 0, ~70 us: 1)
+
+/**
+ * @brief Bit timing statistics (measurement mode)
+ *
+ * Poll cycles come from the cpu cycle counter: read from a task pinned to
+ * one core.
+ */
+typedef struct {
+    uint32_t reads;
+    uint32_t polls;              // pin polls in the timing loops
+    uint64_t poll_cycles;        // cycles spent in them
+    uint32_t max_poll_cycles;    // slowest single poll
+    uint32_t stalls;             // polls longer than DHT11_STALL_US
+    uint32_t stalled_reads;      // reads with at least one stall
+    int32_t pulse_min_us[2];     // high pulse width of 0 and 1 bits
+    int32_t pulse_max_us[2];
+} dht11_timing_t;
 
 /**
  * @brief DHT11 temperature & humidity sensor structure
@@ -23,8 +51,28 @@ typedef struct {
     float last_temperature;
     float last_humidity;
     int64_t last_read_time_us;
+    int64_t start_time_us;       // start signal pulled low, 0 if no read in progress
+    int failed_bit;              // bit that timed out in the last read, -1 if none
+#if DHT11_TIMING_STATS
+    dht11_timing_t timing;
+    uint32_t stall_cycles;
+#endif
 } dht11_sensor_t;
 
+/**
+ * @brief DHT11 configuration (sensor interface)
+ */
+typedef struct {
+    gpio_num_t pin;
+} dht11_config_t;
+
+/**
+ * @brief Sensor interface for the registry - init takes a dht11_config_t,
+ *        samples carry temperature and humidity; dht11_start() then
+ *        dht11_finish() once the start signal is over (SENSOR_CAP_SPLIT)
+ */
+extern const sensor_driver_t dht11_driver;
+
 /**
  * @brief Initialize DHT11 temperature & humidity sensor
  * 
@@ -51,6 +99,42 @@ esp_err_t dht11_init(dht11_sensor_t *sensor, gpio_num_t pin);
  */
 esp_err_t dht11_read(dht11_sensor_t *sensor);
 
+/**
+ * @brief Start a read - pull the data line low for the start signal
+ *
+ * First half of dht11_read(), for callers that sleep through the
+ * DHT11_START_SIGNAL_LOW_MS start signal instead of busy-waiting it.
+ *
+ * @param sensor Pointer to initialized sensor structure
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if read too soon,
+ *                   error code from gpio otherwise
+ */
+esp_err_t dht11_start(dht11_sensor_t *sensor);
+
+/**
+ * @brief Finish a read started with dht11_start()
+ *
+ * Waits out what is left of the start signal, then reads, checks and
+ * stores the frame as dht11_read() does (~5 ms, timing-critical).
+ *
+ * @param sensor Pointer to initialized sensor structure
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if no read was
+ *                   started, ESP_ERR_TIMEOUT on communication timeout,
+ *                   ESP_ERR_INVALID_CRC on checksum failure
+ */
+esp_err_t dht11_finish(dht11_sensor_t *sensor);
+
+/**
+ * @brief Decode a frame from the high pulse width of each bit
+ *
+ * Pure function, shared by the driver, the simulator and the benchmarks.
+ *
+ * @param pulse_us High pulse widths in microseconds, first bit first
+ * @param data Output bytes: humidity, 0, temperature, 0, checksum
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_CRC on checksum mismatch
+ */
+esp_err_t dht11_decode(const uint8_t pulse_us[DHT11_FRAME_BITS], uint8_t data[DHT11_FRAME_BITS / 8]);
+
 /**
  * @brief Get last read temperature value
  * 
@@ -73,4 +157,21 @@ float dht11_get_temperature(const dht11_sensor_t *sensor);
  */
 float dht11_get_humidity(const dht11_sensor_t *sensor);
 
+/**
+ * @brief Get bit timing statistics
+ *
+ * Zeroed unless built with DHT11_TIMING_STATS.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param timing Output statistics
+ */
+void dht11_get_timing(const dht11_sensor_t *sensor, dht11_timing_t *timing);
+
+/**
+ * @brief Reset bit timing statistics
+ *
+ * @param sensor Pointer to sensor structure
+ */
+void dht11_reset_timing(dht11_sensor_t *sensor);
+
 #endif  // DHT11_H
\ No newline at end of file
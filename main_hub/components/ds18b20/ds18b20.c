@@ -0,0 +1,172 @@
+/**
+ * @file ds18b20.c
+ * @author Anthony Yalong
+ * @brief DS18B20 multi-drop temperature bus implementation
+ */
+
+#include "ds18b20.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "DS18B20";
+
+// ============================================================================
+// DS18B20 Configuration
+// ============================================================================
+#define DS18B20_CMD_CONVERT_T       0x44
+#define DS18B20_CMD_WRITE_SCRATCH   0x4E
+#define DS18B20_CMD_READ_SCRATCH    0xBE
+#define DS18B20_SCRATCHPAD_SIZE     9
+#define DS18B20_ALARM_HIGH_DEFAULT  0x4B    // power-on th/tl, unused
+#define DS18B20_ALARM_LOW_DEFAULT   0x46
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Read and crc-check one device's scratchpad
+ *
+ * @param sensors Pointer to bus structure
+ * @param index Device index
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND on no presence,
+ *                   ESP_ERR_INVALID_CRC on crc mismatch
+ */
+static esp_err_t read_scratchpad(ds18b20_bus_t *sensors, uint8_t index);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t ds18b20_init(ds18b20_bus_t *sensors, gpio_num_t pin) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (sensors == NULL) {
+        ESP_LOGE(TAG, "ds18b20 bus pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(sensors, 0, sizeof(*sensors));
+    ret = onewire_init(&sensors->bus, pin);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // enumerate every rom on the bus
+    uint64_t rom;
+    onewire_search_reset(&sensors->bus);
+    while (onewire_search_next(&sensors->bus, &rom)) {
+        if ((rom & 0xFF) != DS18B20_FAMILY_CODE) {
+            continue;
+        }
+        if (sensors->count >= DS18B20_MAX_DEVICES) {
+            ESP_LOGW(TAG, "more than %d sensors on the bus, ignoring the rest", DS18B20_MAX_DEVICES);
+            break;
+        }
+        sensors->roms[sensors->count++] = rom;
+        ESP_LOGI(TAG, "found sensor %d: %016llx", sensors->count - 1, (unsigned long long)rom);
+    }
+
+    ESP_LOGI(TAG, "ds18b20 bus initialized with %d sensors", sensors->count);
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_set_resolution(ds18b20_bus_t *sensors, uint8_t bits) {
+    // sanity check
+    if (sensors == NULL || bits < 9 || bits > 12) {
+        ESP_LOGE(TAG, "invalid resolution");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!onewire_reset(&sensors->bus)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // th, tl, config (r1 r0 in bits 6-5)
+    onewire_write_byte(&sensors->bus, ONEWIRE_CMD_SKIP_ROM);
+    onewire_write_byte(&sensors->bus, DS18B20_CMD_WRITE_SCRATCH);
+    onewire_write_byte(&sensors->bus, DS18B20_ALARM_HIGH_DEFAULT);
+    onewire_write_byte(&sensors->bus, DS18B20_ALARM_LOW_DEFAULT);
+    onewire_write_byte(&sensors->bus, ((bits - 9) << 5) | 0x1F);
+
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_acquire(ds18b20_bus_t *sensors) {
+    // error management
+    esp_err_t ret = ESP_OK;
+
+    // sanity check
+    if (sensors == NULL) {
+        ESP_LOGE(TAG, "ds18b20 bus pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t start = esp_timer_get_time();
+
+    // one convert for everyone
+    if (!onewire_reset(&sensors->bus)) {
+        ESP_LOGW(TAG, "no presence pulse");
+        return ESP_ERR_NOT_FOUND;
+    }
+    onewire_write_byte(&sensors->bus, ONEWIRE_CMD_SKIP_ROM);
+    onewire_write_byte(&sensors->bus, DS18B20_CMD_CONVERT_T);
+
+    // devices hold read slots low until the slowest one finishes
+    int64_t deadline = start + DS18B20_CONVERT_TIMEOUT_MS * 1000LL;
+    while (!onewire_read_bit(&sensors->bus)) {
+        if (esp_timer_get_time() > deadline) {
+            ESP_LOGW(TAG, "conversion timeout");
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(DS18B20_POLL_INTERVAL_MS));
+    }
+    sensors->last_convert_us = (uint32_t)(esp_timer_get_time() - start);
+
+    // reads are ~10 ms each at standard speed
+    for (uint8_t i = 0; i < sensors->count; i++) {
+        esp_err_t err = read_scratchpad(sensors, i);
+        if (err != ESP_OK) {
+            ret = err;
+        }
+    }
+
+    sensors->last_acquire_us = (uint32_t)(esp_timer_get_time() - start);
+    return ret;
+}
+
+float ds18b20_decode(uint8_t lsb, uint8_t msb) {
+    // two's complement, 4 fractional bits
+    int16_t raw = (int16_t)((msb << 8) | lsb);
+    return raw / 16.0f;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t read_scratchpad(ds18b20_bus_t *sensors, uint8_t index) {
+    uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+
+    if (!onewire_reset(&sensors->bus)) {
+        sensors->valid[index] = false;
+        return ESP_ERR_NOT_FOUND;
+    }
+    onewire_match_rom(&sensors->bus, sensors->roms[index]);
+    onewire_write_byte(&sensors->bus, DS18B20_CMD_READ_SCRATCH);
+    onewire_read_bytes(&sensors->bus, scratchpad, sizeof(scratchpad));
+
+    // crc over all 9 bytes is zero for a good read; config byte 0b0rr11111 catches a stuck bus
+    if (onewire_crc8(scratchpad, sizeof(scratchpad)) != 0 || (scratchpad[4] & 0x9F) != 0x1F) {
+        sensors->valid[index] = false;
+        sensors->crc_errors++;
+        ESP_LOGW(TAG, "scratchpad crc error on sensor %d", index);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    sensors->temperatures[index] = ds18b20_decode(scratchpad[0], scratchpad[1]);
+    sensors->valid[index] = true;
+    return ESP_OK;
+}
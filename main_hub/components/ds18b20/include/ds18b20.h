@@ -0,0 +1,82 @@
+/**
+ * @file ds18b20.h
+ * @author Anthony Yalong
+ * @brief DS18B20 multi-drop temperature bus driver with parallel conversions
+ */
+#ifndef DS18B20_H
+#define DS18B20_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "onewire.h"
+
+// configuration
+#define DS18B20_MAX_DEVICES         16
+#define DS18B20_FAMILY_CODE         0x28
+#define DS18B20_CONVERT_TIMEOUT_MS  1000    // 12-bit conversion is 750 ms max
+#define DS18B20_POLL_INTERVAL_MS    10      // completion poll period
+#define DS18B20_DEFAULT_RESOLUTION  12      // bits (9-12)
+
+/**
+ * @brief DS18B20 bus structure
+ */
+typedef struct {
+    onewire_bus_t bus;
+    uint64_t roms[DS18B20_MAX_DEVICES];
+    float temperatures[DS18B20_MAX_DEVICES];    // last good reading, deg C
+    bool valid[DS18B20_MAX_DEVICES];            // last read passed crc
+    uint8_t count;
+    uint32_t last_acquire_us;   // convert + read time of the last acquisition
+    uint32_t last_convert_us;   // convert-only part
+    uint32_t crc_errors;
+} ds18b20_bus_t;
+
+/**
+ * @brief Initialize the bus and enumerate DS18B20 devices
+ *
+ * Runs a full ROM search; devices with other family codes are ignored.
+ *
+ * @param sensors Pointer to bus structure
+ * @param pin Bus data pin
+ * @return esp_err_t ESP_OK on success (also with zero devices),
+ *                   error code from gpio setup otherwise
+ */
+esp_err_t ds18b20_init(ds18b20_bus_t *sensors, gpio_num_t pin);
+
+/**
+ * @brief Set conversion resolution of every device at once (Skip ROM)
+ *
+ * @param sensors Pointer to bus structure
+ * @param bits Resolution 9-12 (conversion 94-750 ms)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad resolution,
+ *                   ESP_ERR_NOT_FOUND if no device answered the reset
+ */
+esp_err_t ds18b20_set_resolution(ds18b20_bus_t *sensors, uint8_t bits);
+
+/**
+ * @brief Convert on every device in parallel, then read each scratchpad
+ *
+ * One Skip ROM + Convert T starts all conversions together; completion is
+ * polled on read slots, then each device is read with Match ROM and its
+ * scratchpad crc checked. Blocks for about one conversion time.
+ *
+ * @param sensors Pointer to bus structure
+ * @return esp_err_t ESP_OK if every device read back with a valid crc,
+ *                   ESP_ERR_TIMEOUT if conversion never completed,
+ *                   ESP_ERR_INVALID_CRC if any device failed its crc,
+ *                   ESP_ERR_NOT_FOUND if no device answered the reset
+ */
+esp_err_t ds18b20_acquire(ds18b20_bus_t *sensors);
+
+/**
+ * @brief Decode a scratchpad temperature
+ *
+ * @param lsb Scratchpad byte 0
+ * @param msb Scratchpad byte 1
+ * @return float Temperature in deg C (1/16 deg resolution)
+ */
+float ds18b20_decode(uint8_t lsb, uint8_t msb);
+
+#endif  // DS18B20_H
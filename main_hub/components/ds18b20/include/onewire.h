@@ -0,0 +1,128 @@
+/**
+ * @file onewire.h
+ * @author Anthony Yalong
+ * @brief 1-Wire bus master - slot primitives, byte transfer, ROM search
+ *        and CRC8
+ */
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+// rom commands
+#define ONEWIRE_CMD_SEARCH_ROM      0xF0
+#define ONEWIRE_CMD_MATCH_ROM       0x55
+#define ONEWIRE_CMD_SKIP_ROM        0xCC
+
+/**
+ * @brief 1-Wire bus structure
+ */
+typedef struct {
+    gpio_num_t pin;
+
+    // search state (maxim an187)
+    uint64_t search_rom;        // last rom found
+    uint8_t last_discrepancy;   // bit position of the last 0-branch taken
+    bool last_device;           // search finished
+} onewire_bus_t;
+
+/**
+ * @brief Initialize the bus GPIO as open-drain, released high
+ *
+ * @param bus Pointer to bus structure
+ * @param pin Bus data pin (external pull-up required)
+ * @return esp_err_t ESP_OK on success, error code otherwise
+ */
+esp_err_t onewire_init(onewire_bus_t *bus, gpio_num_t pin);
+
+/**
+ * @brief Reset pulse and presence detect
+ *
+ * @param bus Pointer to bus structure
+ * @return bool true if at least one device answered with a presence pulse
+ */
+bool onewire_reset(onewire_bus_t *bus);
+
+/**
+ * @brief Write one time slot
+ *
+ * @param bus Pointer to bus structure
+ * @param bit Bit to write
+ */
+void onewire_write_bit(onewire_bus_t *bus, bool bit);
+
+/**
+ * @brief Read one time slot
+ *
+ * @param bus Pointer to bus structure
+ * @return bool Bit read (wired-and of every device driving the slot)
+ */
+bool onewire_read_bit(onewire_bus_t *bus);
+
+/**
+ * @brief Write one byte, lsb first
+ *
+ * @param bus Pointer to bus structure
+ * @param byte Byte to write
+ */
+void onewire_write_byte(onewire_bus_t *bus, uint8_t byte);
+
+/**
+ * @brief Read one byte, lsb first
+ *
+ * @param bus Pointer to bus structure
+ * @return uint8_t Byte read
+ */
+uint8_t onewire_read_byte(onewire_bus_t *bus);
+
+/**
+ * @brief Read a block of bytes
+ *
+ * @param bus Pointer to bus structure
+ * @param data Output buffer
+ * @param len Number of bytes
+ */
+void onewire_read_bytes(onewire_bus_t *bus, uint8_t *data, size_t len);
+
+/**
+ * @brief Address one device (Match ROM) after a reset
+ *
+ * @param bus Pointer to bus structure
+ * @param rom 64-bit rom code, family code in the low byte
+ */
+void onewire_match_rom(onewire_bus_t *bus, uint64_t rom);
+
+/**
+ * @brief Restart ROM search enumeration from the first device
+ *
+ * @param bus Pointer to bus structure
+ */
+void onewire_search_reset(onewire_bus_t *bus);
+
+/**
+ * @brief Find the next device on the bus
+ *
+ * Walks one branch of the rom tree per call, one read-read-write triplet
+ * per bit. Call onewire_search_reset() before the first call.
+ *
+ * @param bus Pointer to bus structure
+ * @param rom Output rom code (family code in the low byte)
+ * @return bool true if a device with a valid rom crc was found
+ */
+bool onewire_search_next(onewire_bus_t *bus, uint64_t *rom);
+
+/**
+ * @brief Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1, reflected)
+ *
+ * @param data Input bytes
+ * @param len Number of bytes
+ * @return uint8_t CRC; 0 when run over data followed by its own crc
+ */
+uint8_t onewire_crc8(const uint8_t *data, size_t len);
+
+#endif  // ONEWIRE_H
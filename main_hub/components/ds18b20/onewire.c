@@ -0,0 +1,132 @@
+/**
+ * @file onewire.c
+ * @author Anthony Yalong
+ * @brief 1-Wire byte transfer, ROM commands, search and CRC8
+ */
+
+#include "onewire.h"
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+void onewire_write_byte(onewire_bus_t *bus, uint8_t byte) {
+    for (int i = 0; i < 8; i++) {
+        onewire_write_bit(bus, byte & 0x01);
+        byte >>= 1;
+    }
+}
+
+uint8_t onewire_read_byte(onewire_bus_t *bus) {
+    uint8_t byte = 0;
+
+    for (int i = 0; i < 8; i++) {
+        if (onewire_read_bit(bus)) {
+            byte |= (1 << i);
+        }
+    }
+    return byte;
+}
+
+void onewire_read_bytes(onewire_bus_t *bus, uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        data[i] = onewire_read_byte(bus);
+    }
+}
+
+void onewire_match_rom(onewire_bus_t *bus, uint64_t rom) {
+    onewire_write_byte(bus, ONEWIRE_CMD_MATCH_ROM);
+    for (int i = 0; i < 8; i++) {
+        onewire_write_byte(bus, (uint8_t)(rom >> (8 * i)));
+    }
+}
+
+void onewire_search_reset(onewire_bus_t *bus) {
+    bus->search_rom = 0;
+    bus->last_discrepancy = 0;
+    bus->last_device = false;
+}
+
+bool onewire_search_next(onewire_bus_t *bus, uint64_t *rom) {
+    if (bus == NULL || rom == NULL || bus->last_device) {
+        return false;
+    }
+    if (!onewire_reset(bus)) {
+        onewire_search_reset(bus);
+        return false;
+    }
+
+    onewire_write_byte(bus, ONEWIRE_CMD_SEARCH_ROM);
+
+    uint64_t id = bus->search_rom;
+    uint8_t last_zero = 0;
+
+    for (uint8_t position = 1; position <= 64; position++) {
+        uint64_t mask = 1ULL << (position - 1);
+
+        // every device sends its bit, then the complement (wired-and)
+        bool bit = onewire_read_bit(bus);
+        bool complement = onewire_read_bit(bus);
+        bool direction;
+
+        if (bit && complement) {
+            // nobody answered
+            onewire_search_reset(bus);
+            return false;
+        }
+
+        if (bit != complement) {
+            // all remaining devices agree
+            direction = bit;
+        } else {
+            // discrepancy: repeat the previous path before it, take 1 at it, 0 after it
+            if (position < bus->last_discrepancy) {
+                direction = (id & mask) != 0;
+            } else {
+                direction = (position == bus->last_discrepancy);
+            }
+            if (!direction) {
+                last_zero = position;
+            }
+        }
+
+        if (direction) {
+            id |= mask;
+        } else {
+            id &= ~mask;
+        }
+        // devices whose bit differs drop out until the next reset
+        onewire_write_bit(bus, direction);
+    }
+
+    bus->last_discrepancy = last_zero;
+    bus->last_device = (last_zero == 0);
+    bus->search_rom = id;
+
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(id >> (8 * i));
+    }
+    if (onewire_crc8(bytes, sizeof(bytes)) != 0) {
+        return false;
+    }
+
+    *rom = id;
+    return true;
+}
+
+uint8_t onewire_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        for (int b = 0; b < 8; b++) {
+            uint8_t mix = (crc ^ byte) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file onewire_gpio.c
+ * @author Anthony Yalong
+ * @brief 1-Wire slot timing on an open-drain GPIO
+ */
+
+#include "onewire.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "ONEWIRE";
+
+// ============================================================================
+// 1-Wire Timing (standard speed, microseconds)
+// ============================================================================
+#define ONEWIRE_RESET_LOW_US        480
+#define ONEWIRE_PRESENCE_SAMPLE_US  70
+#define ONEWIRE_RESET_RECOVERY_US   410
+#define ONEWIRE_WRITE1_LOW_US       6
+#define ONEWIRE_WRITE1_HIGH_US      64
+#define ONEWIRE_WRITE0_LOW_US       60
+#define ONEWIRE_WRITE0_HIGH_US      10
+#define ONEWIRE_READ_LOW_US         6
+#define ONEWIRE_READ_SAMPLE_US      9
+#define ONEWIRE_READ_RECOVERY_US    55
+
+// slots are a few tens of microseconds - an interrupt inside one corrupts the bit,
+// and so would a cache miss: the slot functions run from iram
+static portMUX_TYPE onewire_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t onewire_init(onewire_bus_t *bus, gpio_num_t pin) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (bus == NULL) {
+        ESP_LOGE(TAG, "onewire bus pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // open drain so a released line is pulled up by the bus resistor
+    gpio_config_t config = {
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pin_bit_mask = (1ULL << pin),
+        .intr_type = GPIO_INTR_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+    };
+    ret = gpio_config(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize onewire gpio pin");
+        return ret;
+    }
+
+    ret = gpio_set_level(pin, 1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to release onewire bus");
+        return ret;
+    }
+
+    bus->pin = pin;
+    onewire_search_reset(bus);
+
+    ESP_LOGI(TAG, "onewire bus initialized on gpio %d", pin);
+    return ESP_OK;
+}
+
+bool IRAM_ATTR onewire_reset(onewire_bus_t *bus) {
+    bool presence;
+
+    // the 480 us low pulse only has a minimum, it may be stretched safely
+    gpio_set_level(bus->pin, 0);
+    esp_rom_delay_us(ONEWIRE_RESET_LOW_US);
+
+    portENTER_CRITICAL(&onewire_spinlock);
+    gpio_set_level(bus->pin, 1);
+    esp_rom_delay_us(ONEWIRE_PRESENCE_SAMPLE_US);
+    presence = (gpio_get_level(bus->pin) == 0);
+    portEXIT_CRITICAL(&onewire_spinlock);
+
+    esp_rom_delay_us(ONEWIRE_RESET_RECOVERY_US);
+    return presence;
+}
+
+void IRAM_ATTR onewire_write_bit(onewire_bus_t *bus, bool bit) {
+    portENTER_CRITICAL(&onewire_spinlock);
+    gpio_set_level(bus->pin, 0);
+    esp_rom_delay_us(bit ? ONEWIRE_WRITE1_LOW_US : ONEWIRE_WRITE0_LOW_US);
+    gpio_set_level(bus->pin, 1);
+    esp_rom_delay_us(bit ? ONEWIRE_WRITE1_HIGH_US : ONEWIRE_WRITE0_HIGH_US);
+    portEXIT_CRITICAL(&onewire_spinlock);
+}
+
+bool IRAM_ATTR onewire_read_bit(onewire_bus_t *bus) {
+    bool bit;
+
+    portENTER_CRITICAL(&onewire_spinlock);
+    gpio_set_level(bus->pin, 0);
+    esp_rom_delay_us(ONEWIRE_READ_LOW_US);
+    gpio_set_level(bus->pin, 1);
+    esp_rom_delay_us(ONEWIRE_READ_SAMPLE_US);
+    bit = gpio_get_level(bus->pin);
+    portEXIT_CRITICAL(&onewire_spinlock);
+
+    esp_rom_delay_us(ONEWIRE_READ_RECOVERY_US);
+    return bit;
+}
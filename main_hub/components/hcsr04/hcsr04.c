@@ -5,6 +5,9 @@
  */
 
 #include "hcsr04.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
 #include "esp_rom_sys.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -12,6 +15,32 @@
 
 static const char *TAG = "HCSR04";
 
+// echo loops run from iram: a cache miss (lines evicted by ble or a flash
+// write) would otherwise stretch the measured echo. gpio_get_level needs
+// CONFIG_GPIO_CTRL_FUNC_IN_IRAM (sdkconfig.defaults), esp_timer_get_time is in iram
+#if HCSR04_IRAM
+#define HCSR04_HOT_PATH         IRAM_ATTR
+#else
+#define HCSR04_HOT_PATH
+#endif
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Wait for the echo pin to leave a level
+ *
+ * @param sensor Pointer to sensor structure
+ * @param level Level to wait out
+ * @param start_us Time the wait is measured from
+ * @return int64_t Time the level changed, -1 on timeout
+ */
+static int64_t wait_echo(hcsr04_sensor_t *sensor, int level, int64_t start_us);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
 esp_err_t hcsr04_init(hcsr04_sensor_t *sensor, gpio_num_t trig_pin, gpio_num_t echo_pin, uint32_t timeout) {
     // error management
     esp_err_t ret;
@@ -56,6 +85,8 @@ esp_err_t hcsr04_init(hcsr04_sensor_t *sensor, gpio_num_t trig_pin, gpio_num_t e
     sensor->echo_pin = echo_pin;
     sensor->last_distance_cm = 0.0;
     sensor->timeout_us = timeout;
+    sensor->last_pulse_us = 0;
+    hcsr04_reset_timing(sensor);
 
     ESP_LOGI(TAG, "successfully initialized hcsr04 sensor");
     return ESP_OK;
@@ -75,35 +106,39 @@ esp_err_t hcsr04_read_distance(hcsr04_sensor_t *sensor) {
     esp_rom_delay_us(10);
     gpio_set_level(sensor->trig_pin, 0);
     
-    // wait for ECHO to go HIGH (with timeout)
-    int64_t start_time = esp_timer_get_time();
-    while (gpio_get_level(sensor->echo_pin) == 0) {
-        if ((esp_timer_get_time() - start_time) > sensor->timeout_us) {
-            ESP_LOGW(TAG, "timeout waiting for ECHO HIGH");
-            return ESP_ERR_TIMEOUT;
-        }
+#if HCSR04_TIMING_STATS
+    sensor->stall_cycles = HCSR04_STALL_US * esp_rom_get_cpu_ticks_per_us();
+    sensor->timing.reads++;
+#endif
+
+    // wait for ECHO to go HIGH (with timeout), record when it did
+    int64_t echo_start = wait_echo(sensor, 0, esp_timer_get_time());
+    if (echo_start < 0) {
+        ESP_LOGW(TAG, "timeout waiting for ECHO HIGH");
+        return ESP_ERR_TIMEOUT;
     }
     
-    // record when ECHO went HIGH
-    int64_t echo_start = esp_timer_get_time();
-    
-    // wait for ECHO to go LOW (with timeout)
-    while (gpio_get_level(sensor->echo_pin) == 1) {
-        if ((esp_timer_get_time() - echo_start) > sensor->timeout_us) {
-            ESP_LOGW(TAG, "timeout waiting for ECHO LOW");
-            return ESP_ERR_TIMEOUT;
-        }
+#if HCSR04_TIMING_STATS
+    uint32_t stalls = sensor->timing.stalls;
+#endif
+
+    // wait for ECHO to go LOW (with timeout), record when it did
+    int64_t echo_end = wait_echo(sensor, 1, echo_start);
+#if HCSR04_TIMING_STATS
+    if (sensor->timing.stalls != stalls) {
+        sensor->timing.stalled_reads++;
+    }
+#endif
+    if (echo_end < 0) {
+        ESP_LOGW(TAG, "timeout waiting for ECHO LOW");
+        return ESP_ERR_TIMEOUT;
     }
-    
-    // record when ECHO went LOW
-    int64_t echo_end = esp_timer_get_time();
     
     // calculate pulse width
     int64_t pulse_width = echo_end - echo_start;
+    sensor->last_pulse_us = pulse_width;
     
-    // calculate distance: speed of sound = 343 m/s = 0.0343 cm/μs
-    // distance = (pulse_width * 0.0343) / 2
-    sensor->last_distance_cm = (pulse_width * 0.034) / 2.0;
+    sensor->last_distance_cm = hcsr04_pulse_to_cm(pulse_width);
     ESP_LOGD(TAG, "distance: %.2f cm (pulse: %lld us)", sensor->last_distance_cm, pulse_width);
     
     ESP_LOGI(TAG, "successfully read distance of hcsr04 sensor: %0.02f", sensor->last_distance_cm);
@@ -117,4 +152,52 @@ float hcsr04_get_last_distance(const hcsr04_sensor_t *sensor) {
         return 0.0;
     }
     return sensor->last_distance_cm;
-}
\ No newline at end of file
+}
+
+void hcsr04_get_timing(const hcsr04_sensor_t *sensor, hcsr04_timing_t *timing) {
+    if (sensor == NULL || timing == NULL) {
+        return;
+    }
+#if HCSR04_TIMING_STATS
+    *timing = sensor->timing;
+#else
+    memset(timing, 0, sizeof(*timing));
+#endif
+}
+
+void hcsr04_reset_timing(hcsr04_sensor_t *sensor) {
+#if HCSR04_TIMING_STATS
+    memset(&sensor->timing, 0, sizeof(sensor->timing));
+#endif
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static int64_t HCSR04_HOT_PATH wait_echo(hcsr04_sensor_t *sensor, int level, int64_t start_us) {
+#if HCSR04_TIMING_STATS
+    uint32_t last = esp_cpu_get_cycle_count();
+#endif
+
+    while (gpio_get_level(sensor->echo_pin) == level) {
+        int64_t now = esp_timer_get_time();
+        if ((now - start_us) > sensor->timeout_us) {
+            return -1;
+        }
+
+#if HCSR04_TIMING_STATS
+        uint32_t cycles = esp_cpu_get_cycle_count() - last;
+        last += cycles;
+        sensor->timing.polls++;
+        sensor->timing.poll_cycles += cycles;
+        if (cycles > sensor->timing.max_poll_cycles) {
+            sensor->timing.max_poll_cycles = cycles;
+        }
+        if (cycles > sensor->stall_cycles) {
+            sensor->timing.stalls++;
+        }
+#endif
+    }
+
+    return esp_timer_get_time();
+}
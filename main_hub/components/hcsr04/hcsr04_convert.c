@@ -0,0 +1,16 @@
+/**
+ * @file hcsr04_convert.c
+ * @author Anthony Yalong
+ * @brief HC-SR04 echo width to distance conversion
+ */
+
+#include "hcsr04.h"
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+float hcsr04_pulse_to_cm(int64_t pulse_us) {
+    // calculate distance: speed of sound = 343 m/s = 0.0343 cm/μs
+    // distance = (pulse_width * 0.0343) / 2
+    return (pulse_us * 0.034) / 2.0;
+}
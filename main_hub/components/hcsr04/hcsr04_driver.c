@@ -0,0 +1,67 @@
+/**
+ * @file hcsr04_driver.c
+ * @author Anthony Yalong
+ * @brief HC-SR04 sensor interface for the sensor registry
+ */
+
+#include "hcsr04.h"
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Initialize from an hcsr04_config_t
+ *
+ * @param sensor Pointer to sensor structure
+ * @param config Pointer to hcsr04_config_t
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG without a config
+ */
+static esp_err_t hcsr04_driver_init(void *sensor, const void *config);
+
+/**
+ * @brief Trigger and time the echo in one go (up to twice the timeout)
+ *
+ * @param sensor Pointer to sensor structure
+ * @param wait_us Unused
+ * @return esp_err_t ESP_OK on success, ESP_ERR_TIMEOUT if no echo
+ */
+static esp_err_t hcsr04_driver_poll(void *sensor, uint32_t *wait_us);
+
+/**
+ * @brief Last distance and echo width
+ *
+ * @param sensor Pointer to sensor structure
+ * @param sample Output sample
+ */
+static void hcsr04_driver_get(const void *sensor, sensor_sample_t *sample);
+
+const sensor_driver_t hcsr04_driver = {
+    .name = "hcsr04",
+    .caps = SENSOR_CAP_DISTANCE | SENSOR_CAP_BLOCKING,
+    .init = hcsr04_driver_init,
+    .start = NULL,
+    .poll = hcsr04_driver_poll,
+    .get = hcsr04_driver_get,
+};
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t hcsr04_driver_init(void *sensor, const void *config) {
+    const hcsr04_config_t *hcsr04_config = (const hcsr04_config_t *)config;
+    if (hcsr04_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return hcsr04_init((hcsr04_sensor_t *)sensor, hcsr04_config->trig_pin, hcsr04_config->echo_pin,
+                       hcsr04_config->timeout_us);
+}
+
+static esp_err_t hcsr04_driver_poll(void *sensor, uint32_t *wait_us) {
+    return hcsr04_read_distance((hcsr04_sensor_t *)sensor);
+}
+
+static void hcsr04_driver_get(const void *sensor, sensor_sample_t *sample) {
+    const hcsr04_sensor_t *hcsr04 = (const hcsr04_sensor_t *)sensor;
+    sample->pulse_us = (int32_t)hcsr04->last_pulse_us;
+    sample->distance_cm = hcsr04->last_distance_cm;
+}
@@ -11,6 +11,31 @@
 #include <stdint.h>
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "sensor.h"
+
+// configuration
+#ifndef HCSR04_IRAM
+#define HCSR04_IRAM             1           // echo loops in iram (0: flash, baseline for comparison)
+#endif
+#ifndef HCSR04_TIMING_STATS
+#define HCSR04_TIMING_STATS     0           // measurement mode: poll cycles and stalls
+#endif
+#define HCSR04_STALL_US         5           // a poll this long was stalled (cache miss, flash write, interrupt)
+
+/**
+ * @brief Echo timing statistics (measurement mode)
+ *
+ * Poll cycles come from the cpu cycle counter: read from a task pinned to
+ * one core.
+ */
+typedef struct {
+    uint32_t reads;
+    uint32_t polls;            // echo pin polls
+    uint64_t poll_cycles;      // cycles spent in them
+    uint32_t max_poll_cycles;  // slowest single poll
+    uint32_t stalls;           // polls longer than HCSR04_STALL_US
+    uint32_t stalled_reads;    // reads with a stall while the echo was high
+} hcsr04_timing_t;
 
 /**
  * @brief HC-SR04 ultrasonic sensor structure
@@ -20,8 +45,29 @@ typedef struct {
     gpio_num_t echo_pin;       // GPIO pin for echo signal
     float last_distance_cm;    // Last measured distance in cm
     uint32_t timeout_us;       // Echo timeout in microseconds
+    int64_t last_pulse_us;     // Last echo width in microseconds
+#if HCSR04_TIMING_STATS
+    hcsr04_timing_t timing;
+    uint32_t stall_cycles;
+#endif
 } hcsr04_sensor_t;
 
+/**
+ * @brief HC-SR04 configuration (sensor interface)
+ */
+typedef struct {
+    gpio_num_t trig_pin;
+    gpio_num_t echo_pin;
+    uint32_t timeout_us;       // echo timeout
+} hcsr04_config_t;
+
+/**
+ * @brief Sensor interface for the registry - init takes an hcsr04_config_t,
+ *        samples carry distance and echo width (SENSOR_CAP_DISTANCE); the
+ *        read busy-waits the echo (SENSOR_CAP_BLOCKING)
+ */
+extern const sensor_driver_t hcsr04_driver;
+
 /**
  * @brief Initialize HC-SR04 ultrasonic sensor
  * 
@@ -47,6 +93,16 @@ esp_err_t hcsr04_init(hcsr04_sensor_t *sensor, gpio_num_t trig_pin, gpio_num_t e
  */
 esp_err_t hcsr04_read_distance(hcsr04_sensor_t *sensor);
 
+/**
+ * @brief Convert an echo width to distance
+ *
+ * Pure function, shared by the driver, the simulator and the benchmarks.
+ *
+ * @param pulse_us Echo width in microseconds (there and back)
+ * @return float Distance in cm
+ */
+float hcsr04_pulse_to_cm(int64_t pulse_us);
+
 /**
  * @brief Get last measured distance
  * 
@@ -55,4 +111,21 @@ esp_err_t hcsr04_read_distance(hcsr04_sensor_t *sensor);
  */
 float hcsr04_get_last_distance(const hcsr04_sensor_t *sensor);
 
+/**
+ * @brief Get echo timing statistics
+ *
+ * Zeroed unless built with HCSR04_TIMING_STATS.
+ *
+ * @param sensor Pointer to sensor structure
+ * @param timing Output statistics
+ */
+void hcsr04_get_timing(const hcsr04_sensor_t *sensor, hcsr04_timing_t *timing);
+
+/**
+ * @brief Reset echo timing statistics
+ *
+ * @param sensor Pointer to sensor structure
+ */
+void hcsr04_reset_timing(hcsr04_sensor_t *sensor);
+
 #endif  // HCSR04_H
\ No newline at end of file
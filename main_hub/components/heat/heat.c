@@ -0,0 +1,179 @@
+/**
+ * @file heat.c
+ * @author Anthony Yalong
+ * @brief Fixed temperature and rate of rise detection implementation
+ */
+
+#include "heat.h"
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "HEAT";
+
+// slope units: 0.1 C per 0.1 s to 0.1 C per minute
+#define HEAT_DS_PER_MIN         600
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Add or remove a sample from the running sums
+ *
+ * @param detector Pointer to detector structure
+ * @param sample Sample
+ * @param sign 1 to add, -1 to remove
+ */
+static void heat_accumulate(heat_detector_t *detector, const heat_sample_t *sample, int sign);
+
+/**
+ * @brief Move the time base to the oldest sample and rebuild the sums
+ *
+ * @param detector Pointer to detector structure
+ */
+static void heat_rebase(heat_detector_t *detector);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t heat_init(heat_detector_t *detector, float fixed_c, float rate_c_min, uint32_t window_ms) {
+    // sanity check
+    if (detector == NULL || !(rate_c_min > 0.0f) || window_ms == 0) {
+        ESP_LOGE(TAG, "invalid detector parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(detector, 0, sizeof(*detector));
+    detector->fixed_dc = (int16_t)lroundf(fixed_c * 10.0f);
+    detector->rate_dc_min = (int32_t)lroundf(rate_c_min * 10.0f);
+    detector->window_ds = window_ms / 100;
+    return ESP_OK;
+}
+
+heat_event_type_t heat_update(heat_detector_t *detector, int64_t time_us, float temperature_c,
+                              heat_event_t *event) {
+    detector->stats.readings++;
+
+    // integer sample relative to the time base
+    if (detector->count == 0) {
+        detector->base_us = time_us;
+    }
+    heat_sample_t sample = {
+        .time_ds = (int32_t)((time_us - detector->base_us) / 100000),
+        .value_dc = (int16_t)lroundf(temperature_c * 10.0f),
+    };
+
+    // drop samples that left the window (or the oldest when full)
+    while (detector->count > 0 &&
+           (sample.time_ds - detector->samples[detector->head].time_ds > detector->window_ds ||
+            detector->count == HEAT_WINDOW_MAX)) {
+        heat_accumulate(detector, &detector->samples[detector->head], -1);
+        detector->head = (detector->head + 1) % HEAT_WINDOW_MAX;
+        detector->count--;
+    }
+    if (detector->count == 0) {
+        detector->base_us = time_us;
+        sample.time_ds = 0;
+    }
+
+    detector->samples[(detector->head + detector->count) % HEAT_WINDOW_MAX] = sample;
+    detector->count++;
+    heat_accumulate(detector, &sample, 1);
+    if (sample.time_ds > HEAT_REBASE_DS) {
+        heat_rebase(detector);
+    }
+
+    // least-squares slope: (n*sum_ty - sum_t*sum_y) / (n*sum_tt - sum_t^2)
+    bool rising = false;
+    bool steady = true;
+    int32_t span_ds = (detector->samples[(detector->head + detector->count - 1) % HEAT_WINDOW_MAX].time_ds -
+                       detector->samples[detector->head].time_ds);
+    detector->rate_c_min = 0.0f;
+    if (detector->count >= HEAT_MIN_SAMPLES && span_ds >= detector->window_ds / 2) {
+        int64_t n = detector->count;
+        int64_t numerator = n * detector->sum_ty - detector->sum_t * detector->sum_y;
+        int64_t denominator = n * detector->sum_tt - detector->sum_t * detector->sum_t;
+        if (denominator > 0) {
+            // compare without dividing: rate >= threshold <=> numerator * 600 >= threshold * denominator
+            rising = numerator * HEAT_DS_PER_MIN >= (int64_t)detector->rate_dc_min * denominator;
+            steady = 2 * numerator * HEAT_DS_PER_MIN < (int64_t)detector->rate_dc_min * denominator;
+            detector->rate_c_min = (float)numerator * HEAT_DS_PER_MIN / denominator / 10.0f;
+            if (detector->rate_c_min > detector->stats.max_rate_c_min) {
+                detector->stats.max_rate_c_min = detector->rate_c_min;
+            }
+        }
+    }
+
+    // thresholds must hold for a few readings (one bad read cannot alarm)
+    bool hot = sample.value_dc >= detector->fixed_dc;
+    detector->fixed_run = hot ? detector->fixed_run + (detector->fixed_run < UINT8_MAX) : 0;
+    detector->rate_run = rising ? detector->rate_run + (detector->rate_run < UINT8_MAX) : 0;
+    uint8_t cause = ((detector->fixed_run >= HEAT_CONFIRM_COUNT) ? HEAT_CAUSE_FIXED : 0) |
+                    ((detector->rate_run >= HEAT_CONFIRM_COUNT) ? HEAT_CAUSE_RATE : 0);
+
+    heat_event_type_t type = HEAT_EVENT_NONE;
+    if (!detector->alarm) {
+        if (cause != 0) {
+            detector->alarm = true;
+            detector->clear_run = 0;
+            detector->stats.alarms++;
+            type = HEAT_EVENT_ALARM;
+        }
+    } else {
+        // clear once well below the fixed threshold and rising at under half the rate
+        bool quiet = sample.value_dc < detector->fixed_dc - HEAT_HYSTERESIS_DC && steady;
+        detector->clear_run = quiet ? detector->clear_run + 1 : 0;
+        if (detector->clear_run >= HEAT_CLEAR_COUNT) {
+            detector->alarm = false;
+            type = HEAT_EVENT_CLEAR;
+        }
+    }
+
+    if (type != HEAT_EVENT_NONE && event != NULL) {
+        event->type = type;
+        event->cause = cause;
+        event->time_us = time_us;
+        event->temperature_c = temperature_c;
+        event->rate_c_min = detector->rate_c_min;
+    }
+    return type;
+}
+
+void heat_miss(heat_detector_t *detector) {
+    // the window is by time: stale samples are dropped on the next reading
+    detector->stats.failures++;
+}
+
+void heat_get_stats(const heat_detector_t *detector, heat_stats_t *stats) {
+    if (detector == NULL || stats == NULL) {
+        return;
+    }
+    *stats = detector->stats;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void heat_accumulate(heat_detector_t *detector, const heat_sample_t *sample, int sign) {
+    int64_t t = sample->time_ds;
+    int64_t y = sample->value_dc;
+    detector->sum_t += sign * t;
+    detector->sum_y += sign * y;
+    detector->sum_tt += sign * t * t;
+    detector->sum_ty += sign * t * y;
+}
+
+static void heat_rebase(heat_detector_t *detector) {
+    // runs once a day at most; the window is small
+    int32_t shift = detector->samples[detector->head].time_ds;
+    detector->base_us += (int64_t)shift * 100000;
+    detector->sum_t = 0;
+    detector->sum_y = 0;
+    detector->sum_tt = 0;
+    detector->sum_ty = 0;
+    for (int i = 0; i < detector->count; i++) {
+        heat_sample_t *sample = &detector->samples[(detector->head + i) % HEAT_WINDOW_MAX];
+        sample->time_ds -= shift;
+        heat_accumulate(detector, sample, 1);
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file heat.h
+ * @author Anthony Yalong
+ * @brief Heat detection on a temperature series - fixed temperature and
+ *        rate of rise from a sliding-window least-squares slope
+ */
+#ifndef HEAT_H
+#define HEAT_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// configuration
+#define HEAT_WINDOW_MAX         32      // samples held (window / sample period must fit)
+#define HEAT_MIN_SAMPLES        6       // fewer valid samples in the window: no rate estimate
+#define HEAT_CONFIRM_COUNT      3       // consecutive readings past a threshold before an alarm
+#define HEAT_CLEAR_COUNT        20      // consecutive quiet readings before the alarm clears
+#define HEAT_HYSTERESIS_DC      20      // fixed threshold clears 2 C below (0.1 C units)
+#define HEAT_REBASE_DS          1000000 // sums re-based to the oldest sample after ~28 h (0.1 s units)
+
+// alarm causes
+#define HEAT_CAUSE_FIXED        0x01
+#define HEAT_CAUSE_RATE         0x02
+
+/**
+ * @brief Event types
+ */
+typedef enum {
+    HEAT_EVENT_NONE = 0,
+    HEAT_EVENT_ALARM,
+    HEAT_EVENT_CLEAR,
+} heat_event_type_t;
+
+/**
+ * @brief Event reported on an alarm transition
+ */
+typedef struct {
+    heat_event_type_t type;
+    uint8_t cause;                  // HEAT_CAUSE_* (alarm only)
+    int64_t time_us;
+    float temperature_c;
+    float rate_c_min;               // window slope, 0 if not enough samples
+} heat_event_t;
+
+/**
+ * @brief Detector statistics
+ */
+typedef struct {
+    uint32_t readings;
+    uint32_t failures;              // reads that returned an error
+    uint32_t alarms;
+    float max_rate_c_min;           // steepest slope seen
+} heat_stats_t;
+
+/**
+ * @brief Sample in the window (integer, so the running sums stay exact)
+ */
+typedef struct {
+    int32_t time_ds;                // 0.1 s since the base
+    int16_t value_dc;               // 0.1 C
+} heat_sample_t;
+
+/**
+ * @brief Heat detector structure (single writer)
+ */
+typedef struct {
+    // thresholds
+    int16_t fixed_dc;               // 0.1 C
+    int32_t rate_dc_min;            // 0.1 C per minute
+    int32_t window_ds;
+
+    // window and its least-squares sums
+    heat_sample_t samples[HEAT_WINDOW_MAX];
+    uint8_t head;                   // oldest sample
+    uint8_t count;
+    int64_t base_us;
+    int64_t sum_t;
+    int64_t sum_y;
+    int64_t sum_tt;
+    int64_t sum_ty;
+
+    // alarm state
+    bool alarm;
+    uint8_t fixed_run;
+    uint8_t rate_run;
+    uint8_t clear_run;
+    float rate_c_min;               // latest slope
+    heat_stats_t stats;
+} heat_detector_t;
+
+/**
+ * @brief Initialize a detector
+ *
+ * @param detector Pointer to detector structure
+ * @param fixed_c Fixed temperature threshold
+ * @param rate_c_min Rate of rise threshold, C per minute
+ * @param window_ms Slope window (at most HEAT_WINDOW_MAX samples long)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad parameters
+ */
+esp_err_t heat_init(heat_detector_t *detector, float fixed_c, float rate_c_min, uint32_t window_ms);
+
+/**
+ * @brief Feed a temperature reading
+ *
+ * O(1): the sample is added to running sums of t, y, t*t and t*y and
+ * samples older than the window are subtracted, so the slope needs no
+ * pass over the window. The window is by time - failed reads only leave
+ * fewer samples, and no rate is estimated from fewer than HEAT_MIN_SAMPLES
+ * or less than half a window. A fit over the window also averages out
+ * whole-degree steps. Either threshold has to hold for HEAT_CONFIRM_COUNT
+ * readings before the alarm is raised.
+ *
+ * @param detector Pointer to detector structure
+ * @param time_us Reading time, increasing
+ * @param temperature_c Temperature
+ * @param event Filled in on an alarm or clear
+ * @return heat_event_type_t Transition, HEAT_EVENT_NONE if unchanged
+ */
+heat_event_type_t heat_update(heat_detector_t *detector, int64_t time_us, float temperature_c,
+                              heat_event_t *event);
+
+/**
+ * @brief Report a failed read (timeout or checksum)
+ *
+ * @param detector Pointer to detector structure
+ */
+void heat_miss(heat_detector_t *detector);
+
+/**
+ * @brief Get detector statistics
+ *
+ * @param detector Pointer to detector structure
+ * @param stats Output statistics
+ */
+void heat_get_stats(const heat_detector_t *detector, heat_stats_t *stats);
+
+#endif  // HEAT_H
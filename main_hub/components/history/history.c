@@ -0,0 +1,254 @@
+/**
+ * @file history.c
+ * @author Anthony Yalong
+ * @brief In-RAM sensor history implementation
+ */
+
+#include "history.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "lockprof.h"
+
+static const char *TAG = "HISTORY";
+
+// fixed point scale per decimals setting
+static const int32_t history_scale[] = { 1, 10, 100, 1000 };
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Sequence number of the oldest record still in the ring
+ *
+ * @param history Pointer to history structure (lock held)
+ * @return uint32_t Oldest sequence number
+ */
+static uint32_t history_oldest(const history_t *history);
+
+/**
+ * @brief Format a fixed point value without floating point
+ *
+ * @param value Stored value
+ * @param decimals Fixed point digits
+ * @param buf Output buffer
+ * @param len Buffer length
+ * @return int Characters written
+ */
+static int history_format_value(int16_t value, uint8_t decimals, char *buf, size_t len);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t history_init(history_t *history) {
+    // sanity check
+    if (history == NULL) {
+        ESP_LOGE(TAG, "history pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(history, 0, sizeof(*history));
+    history->mutex = xSemaphoreCreateMutex();
+    if (history->mutex == NULL) {
+        ESP_LOGE(TAG, "failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    LOCKPROF_REGISTER(history->mutex, "history", LOCKPROF_MUTEX);
+
+    return ESP_OK;
+}
+
+esp_err_t history_add_channel(history_t *history, const char *name, uint8_t decimals, int *channel) {
+    // sanity check
+    if (history == NULL || name == NULL || channel == NULL ||
+        decimals >= sizeof(history_scale) / sizeof(history_scale[0])) {
+        ESP_LOGE(TAG, "invalid channel parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (history->channel_count >= HISTORY_MAX_CHANNELS) {
+        ESP_LOGE(TAG, "no free history channels");
+        return ESP_ERR_NO_MEM;
+    }
+
+    history_channel_t *entry = &history->channels[history->channel_count];
+    strncpy(entry->name, name, HISTORY_NAME_LEN - 1);
+    entry->decimals = decimals;
+    *channel = history->channel_count++;
+    return ESP_OK;
+}
+
+int history_find_channel(const history_t *history, const char *name) {
+    if (history == NULL || name == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < history->channel_count; i++) {
+        if (strcmp(history->channels[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t history_record(history_t *history, int channel, uint32_t time_s, float value) {
+    // sanity check
+    if (history == NULL || channel < 0 || channel >= history->channel_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // scale and round to the channel's fixed point, saturating
+    float scaled = value * history_scale[history->channels[channel].decimals];
+    scaled += (scaled < 0.0f) ? -0.5f : 0.5f;
+    if (scaled > INT16_MAX) {
+        scaled = INT16_MAX;
+    } else if (scaled < INT16_MIN) {
+        scaled = INT16_MIN;
+    }
+
+    history_record_t record = {
+        .time_s = time_s,
+        .channel = (uint16_t)channel,
+        .value = (int16_t)scaled,
+    };
+
+    LOCKPROF_TAKE(history->mutex, portMAX_DELAY);
+    history->records[history->head & (HISTORY_CAPACITY - 1)] = record;
+    history->head++;
+    if (time_s >= history->newest_s) {
+        history->newest_s = time_s;
+    } else if (history->newest_s - time_s > history->late_s) {
+        history->late_s = history->newest_s - time_s;
+    }
+    LOCKPROF_GIVE(history->mutex);
+    return ESP_OK;
+}
+
+void history_cursor_init(history_t *history, history_cursor_t *cursor, uint32_t from_s, uint32_t to_s,
+                         uint32_t channel_mask) {
+    if (history == NULL || cursor == NULL) {
+        return;
+    }
+
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->from_s = from_s;
+    cursor->to_s = to_s;
+    cursor->channel_mask = channel_mask;
+
+    // no record comes more than late_s behind an earlier one, so everything before a
+    // record older than from_s - late_s is older than from_s: binary search on that
+    LOCKPROF_TAKE(history->mutex, portMAX_DELAY);
+    uint32_t seek_s = (from_s > history->late_s) ? from_s - history->late_s : 0;
+    uint32_t low = history_oldest(history);
+    uint32_t high = history->head;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (history->records[mid & (HISTORY_CAPACITY - 1)].time_s < seek_s) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    cursor->next = low;
+    LOCKPROF_GIVE(history->mutex);
+}
+
+size_t history_read(history_t *history, history_cursor_t *cursor, history_record_t *records, size_t max) {
+    if (history == NULL || cursor == NULL || records == NULL || cursor->done) {
+        return 0;
+    }
+
+    size_t count = 0;
+    uint32_t scanned = 0;
+
+    LOCKPROF_TAKE(history->mutex, portMAX_DELAY);
+
+    // the writer lapped the cursor - continue from the oldest surviving record
+    uint32_t oldest = history_oldest(history);
+    if (cursor->next < oldest) {
+        cursor->skipped += oldest - cursor->next;
+        cursor->next = oldest;
+    }
+
+    while (count < max && scanned < HISTORY_SCAN_LIMIT && cursor->next < history->head) {
+        const history_record_t *record = &history->records[cursor->next & (HISTORY_CAPACITY - 1)];
+
+        // past to_s by more than the lag, nothing later can be in range
+        if (record->time_s > cursor->to_s && record->time_s - cursor->to_s > history->late_s) {
+            cursor->done = true;
+            break;
+        }
+        cursor->next++;
+        scanned++;
+        if (record->time_s >= cursor->from_s && record->time_s <= cursor->to_s &&
+            record->channel < HISTORY_MAX_CHANNELS && (cursor->channel_mask & (1UL << record->channel))) {
+            records[count++] = *record;
+        }
+    }
+    if (cursor->next >= history->head) {
+        cursor->done = true;
+    }
+    cursor->scanned += scanned;
+
+    LOCKPROF_GIVE(history->mutex);
+    return count;
+}
+
+int history_format_row(const history_t *history, history_format_t format, const history_record_t *record,
+                       bool first, char *buf, size_t len) {
+    if (history == NULL || record == NULL || buf == NULL || record->channel >= history->channel_count) {
+        return 0;
+    }
+
+    const history_channel_t *channel = &history->channels[record->channel];
+    char value[8];
+    history_format_value(record->value, channel->decimals, value, sizeof(value));
+
+    if (format == HISTORY_FORMAT_JSON) {
+        return snprintf(buf, len, "%s{\"t\":%lu,\"ch\":\"%s\",\"v\":%s}", first ? "\n" : ",\n",
+                        (unsigned long)record->time_s, channel->name, value);
+    }
+    return snprintf(buf, len, "%lu,%s,%s\n", (unsigned long)record->time_s, channel->name, value);
+}
+
+void history_get_export_stats(history_t *history, history_export_stats_t *stats) {
+    if (history == NULL || stats == NULL) {
+        return;
+    }
+    LOCKPROF_TAKE(history->mutex, portMAX_DELAY);
+    *stats = history->last_export;
+    LOCKPROF_GIVE(history->mutex);
+}
+
+void history_set_export_stats(history_t *history, const history_export_stats_t *stats) {
+    if (history == NULL || stats == NULL) {
+        return;
+    }
+    LOCKPROF_TAKE(history->mutex, portMAX_DELAY);
+    history->last_export = *stats;
+    LOCKPROF_GIVE(history->mutex);
+}
+
+const char *history_format_header(history_format_t format) {
+    return (format == HISTORY_FORMAT_JSON) ? "[" : "time_s,channel,value\n";
+}
+
+const char *history_format_footer(history_format_t format) {
+    return (format == HISTORY_FORMAT_JSON) ? "\n]\n" : "";
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static uint32_t history_oldest(const history_t *history) {
+    return (history->head > HISTORY_CAPACITY) ? history->head - HISTORY_CAPACITY : 0;
+}
+
+static int history_format_value(int16_t value, uint8_t decimals, char *buf, size_t len) {
+    int32_t magnitude = (value < 0) ? -(int32_t)value : value;
+    int32_t scale = history_scale[decimals];
+
+    if (decimals == 0) {
+        return snprintf(buf, len, "%ld", (long)value);
+    }
+    return snprintf(buf, len, "%s%ld.%0*ld", (value < 0) ? "-" : "", (long)(magnitude / scale), decimals,
+                    (long)(magnitude % scale));
+}
@@ -0,0 +1,184 @@
+/**
+ * @file history_http.c
+ * @author Anthony Yalong
+ * @brief Streaming history export implementation
+ */
+
+#include "history_http.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "HISTORY_HTTP";
+
+// query string limits
+#define HISTORY_HTTP_QUERY_LEN      256
+#define HISTORY_HTTP_VALUE_LEN      192
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Parse the export query into cursor filters and format
+ *
+ * @param req Request
+ * @param history Pointer to history structure
+ * @param from_s Output first second
+ * @param to_s Output last second
+ * @param channel_mask Output channel mask
+ * @param format Output format
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown channel or format, or an
+ *                   escape other than %2C in the channel list
+ */
+static esp_err_t history_http_parse_query(httpd_req_t *req, history_t *history, uint32_t *from_s, uint32_t *to_s,
+                                          uint32_t *channel_mask, history_format_t *format);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t history_http_export_handler(httpd_req_t *req) {
+    // error management
+    esp_err_t ret = ESP_OK;
+
+    history_t *history = (history_t *)req->user_ctx;
+    int64_t start = esp_timer_get_time();
+    size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t heap_min = heap_before;
+
+    uint32_t from_s;
+    uint32_t to_s;
+    uint32_t channel_mask;
+    history_format_t format;
+    if (history_http_parse_query(req, history, &from_s, &to_s, &channel_mask, &format) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "unknown channel or format");
+    }
+
+    httpd_resp_set_type(req, (format == HISTORY_FORMAT_JSON) ? "application/json" : "text/csv");
+    httpd_resp_set_hdr(req, "Content-Disposition", (format == HISTORY_FORMAT_JSON) ?
+                       "attachment; filename=\"history.json\"" : "attachment; filename=\"history.csv\"");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    // one chunk buffer and one record batch, whatever the range
+    char chunk[HISTORY_HTTP_CHUNK_LEN];
+    history_record_t batch[HISTORY_HTTP_BATCH];
+    history_export_stats_t stats = { 0 };
+    history_cursor_t cursor;
+    size_t used = snprintf(chunk, sizeof(chunk), "%s", history_format_header(format));
+
+    history_cursor_init(history, &cursor, from_s, to_s, channel_mask);
+    while (!cursor.done && ret == ESP_OK) {
+        size_t count = history_read(history, &cursor, batch, HISTORY_HTTP_BATCH);
+
+        for (size_t i = 0; i < count && ret == ESP_OK; i++) {
+            // flush before a row could overflow the chunk
+            if (used + HISTORY_ROW_MAX > sizeof(chunk)) {
+                ret = httpd_resp_send_chunk(req, chunk, used);
+                stats.bytes += used;
+                used = 0;
+
+                size_t heap_now = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+                if (heap_now < heap_min) {
+                    heap_min = heap_now;
+                }
+            }
+            used += history_format_row(history, format, &batch[i], stats.rows == 0, chunk + used,
+                                       sizeof(chunk) - used);
+            stats.rows++;
+        }
+    }
+
+    if (ret == ESP_OK && used + HISTORY_ROW_MAX > sizeof(chunk)) {
+        ret = httpd_resp_send_chunk(req, chunk, used);
+        stats.bytes += used;
+        used = 0;
+    }
+    if (ret == ESP_OK) {
+        used += snprintf(chunk + used, sizeof(chunk) - used, "%s", history_format_footer(format));
+        ret = httpd_resp_send_chunk(req, chunk, used);
+        stats.bytes += used;
+    }
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "export aborted after %lu rows (client gone)", stats.rows);
+        return ret;
+    }
+
+    stats.scanned = cursor.scanned;
+    stats.skipped = cursor.skipped;
+    stats.elapsed_us = esp_timer_get_time() - start;
+    stats.peak_heap_delta = (int32_t)heap_before - (int32_t)heap_min;
+    history_set_export_stats(history, &stats);
+
+    ESP_LOGI(TAG, "exported %lu rows (%lu scanned, %lu overwritten) in %lld ms: %llu rows/s, peak heap delta %ld B",
+             stats.rows, stats.scanned, stats.skipped, stats.elapsed_us / 1000,
+             stats.elapsed_us ? (uint64_t)stats.rows * 1000000ULL / stats.elapsed_us : 0, stats.peak_heap_delta);
+    return ESP_OK;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t history_http_parse_query(httpd_req_t *req, history_t *history, uint32_t *from_s, uint32_t *to_s,
+                                          uint32_t *channel_mask, history_format_t *format) {
+    char query[HISTORY_HTTP_QUERY_LEN];
+    char value[HISTORY_HTTP_VALUE_LEN];
+
+    // defaults: everything, csv
+    *from_s = 0;
+    *to_s = UINT32_MAX;
+    *channel_mask = UINT32_MAX;
+    *format = HISTORY_FORMAT_CSV;
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
+        return ESP_OK;
+    }
+
+    if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+        *from_s = strtoul(value, NULL, 10);
+    }
+    if (httpd_query_key_value(query, "to", value, sizeof(value)) == ESP_OK) {
+        *to_s = strtoul(value, NULL, 10);
+    }
+    if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) {
+        if (strcmp(value, "json") == 0) {
+            *format = HISTORY_FORMAT_JSON;
+        } else if (strcmp(value, "csv") != 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // comma separated channel names (url-encoded commas arrive as %2C, no
+    // other escape can be part of a channel name)
+    if (httpd_query_key_value(query, "channels", value, sizeof(value)) == ESP_OK) {
+        *channel_mask = 0;
+        for (char *name = value; *name != '\0';) {
+            size_t length = strcspn(name, ",%");
+            size_t skip = 1;
+            if (name[length] == '%') {
+                if (name[length + 1] != '2' || (name[length + 2] != 'C' && name[length + 2] != 'c')) {
+                    return ESP_ERR_INVALID_ARG;
+                }
+                skip = 3;
+            }
+            char separator = name[length];
+            name[length] = '\0';
+
+            int channel = history_find_channel(history, name);
+            if (channel < 0) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            *channel_mask |= 1UL << channel;
+
+            if (separator == '\0') {
+                break;
+            }
+            name += length + skip;
+        }
+    }
+    return ESP_OK;
+}
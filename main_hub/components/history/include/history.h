@@ -0,0 +1,205 @@
+/**
+ * @file history.h
+ * @author Anthony Yalong
+ * @brief In-RAM sensor history - a fixed ring of compact records with
+ *        cursors for streaming export (time range and channel filters)
+ */
+#ifndef HISTORY_H
+#define HISTORY_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// configuration
+#define HISTORY_CAPACITY            4096    // records (8 bytes each), power of two
+#define HISTORY_MAX_CHANNELS        32      // channel filter is a 32-bit mask
+#define HISTORY_NAME_LEN            16
+#define HISTORY_SCAN_LIMIT          256     // records inspected per read under the lock
+#define HISTORY_ROW_MAX             64      // longest formatted row
+
+/**
+ * @brief Stored record - value in the channel's fixed point
+ */
+typedef struct {
+    uint32_t time_s;            // seconds since boot
+    uint16_t channel;
+    int16_t value;              // value * 10^decimals
+} history_record_t;
+
+/**
+ * @brief Channel description
+ */
+typedef struct {
+    char name[HISTORY_NAME_LEN];
+    uint8_t decimals;           // fixed point digits, 0-3
+} history_channel_t;
+
+/**
+ * @brief Export formats
+ */
+typedef enum {
+    HISTORY_FORMAT_CSV = 0,
+    HISTORY_FORMAT_JSON,
+} history_format_t;
+
+/**
+ * @brief Read cursor - survives concurrent writes; records overwritten
+ *        before they are read are skipped and counted
+ */
+typedef struct {
+    uint32_t next;              // sequence number of the next record
+    uint32_t from_s;
+    uint32_t to_s;
+    uint32_t channel_mask;
+    uint32_t scanned;           // records inspected
+    uint32_t skipped;           // records lost to the writer mid-export
+    bool done;
+} history_cursor_t;
+
+/**
+ * @brief Export statistics (last completed export)
+ */
+typedef struct {
+    uint32_t rows;
+    uint32_t scanned;           // records inspected, matching or not
+    uint32_t skipped;
+    uint32_t bytes;
+    int64_t elapsed_us;
+    int32_t peak_heap_delta;    // largest free-heap drop during the export
+} history_export_stats_t;
+
+/**
+ * @brief History structure
+ */
+typedef struct {
+    history_record_t records[HISTORY_CAPACITY];
+    uint32_t head;              // sequence number of the next write
+    uint32_t newest_s;          // latest record time appended
+    uint32_t late_s;            // furthest any record arrived behind newest_s
+    history_channel_t channels[HISTORY_MAX_CHANNELS];
+    uint8_t channel_count;
+    history_export_stats_t last_export;
+    SemaphoreHandle_t mutex;
+} history_t;
+
+/**
+ * @brief Initialize an empty history
+ *
+ * @param history Pointer to history structure
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the mutex cannot be created
+ */
+esp_err_t history_init(history_t *history);
+
+/**
+ * @brief Register a channel
+ *
+ * @param history Pointer to history structure
+ * @param name Channel name used in exports and filters
+ * @param decimals Fixed point digits stored (values must fit int16 after scaling)
+ * @param channel Output channel index
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM when all channels are used
+ */
+esp_err_t history_add_channel(history_t *history, const char *name, uint8_t decimals, int *channel);
+
+/**
+ * @brief Find a channel by name
+ *
+ * @param history Pointer to history structure
+ * @param name Channel name
+ * @return int Channel index, -1 if unknown
+ */
+int history_find_channel(const history_t *history, const char *name);
+
+/**
+ * @brief Append a record (oldest record is overwritten when full)
+ *
+ * Records are kept in arrival order. A time behind the newest one (a
+ * compressed channel's point closed a sample late, interleaved with other
+ * channels) is allowed; the ring tracks the furthest such lag and cursors
+ * widen their seek and end checks by it.
+ *
+ * @param history Pointer to history structure
+ * @param channel Channel index
+ * @param time_s Seconds since boot
+ * @param value Value, saturated to the channel's fixed point range
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown channel
+ */
+esp_err_t history_record(history_t *history, int channel, uint32_t time_s, float value);
+
+/**
+ * @brief Start a cursor at or before the first record at or after from_s
+ *
+ * @param history Pointer to history structure
+ * @param cursor Output cursor
+ * @param from_s First second included
+ * @param to_s Last second included
+ * @param channel_mask Channels included (bit per channel index)
+ */
+void history_cursor_init(history_t *history, history_cursor_t *cursor, uint32_t from_s, uint32_t to_s,
+                         uint32_t channel_mask);
+
+/**
+ * @brief Copy the next matching records out of the ring
+ *
+ * Inspects at most HISTORY_SCAN_LIMIT records per call, so the lock is
+ * held briefly; may return 0 before the cursor is done. Records come in
+ * arrival order, so a late one can follow a newer one.
+ *
+ * @param history Pointer to history structure
+ * @param cursor Cursor
+ * @param records Output records
+ * @param max Output capacity
+ * @return size_t Records copied
+ */
+size_t history_read(history_t *history, history_cursor_t *cursor, history_record_t *records, size_t max);
+
+/**
+ * @brief Format one record as a row (with separator/prefix for JSON)
+ *
+ * @param history Pointer to history structure
+ * @param format Output format
+ * @param record Record to format
+ * @param first First row of the export
+ * @param buf Output buffer
+ * @param len Buffer length, HISTORY_ROW_MAX always fits
+ * @return int Characters written
+ */
+int history_format_row(const history_t *history, history_format_t format, const history_record_t *record,
+                       bool first, char *buf, size_t len);
+
+/**
+ * @brief Get statistics of the last completed export
+ *
+ * @param history Pointer to history structure
+ * @param stats Output statistics
+ */
+void history_get_export_stats(history_t *history, history_export_stats_t *stats);
+
+/**
+ * @brief Store export statistics (called by the exporter)
+ *
+ * @param history Pointer to history structure
+ * @param stats Statistics of the finished export
+ */
+void history_set_export_stats(history_t *history, const history_export_stats_t *stats);
+
+/**
+ * @brief Export header (CSV column names or JSON array start)
+ *
+ * @return const char* Header text
+ */
+const char *history_format_header(history_format_t format);
+
+/**
+ * @brief Export footer (JSON array end)
+ *
+ * @return const char* Footer text
+ */
+const char *history_format_footer(history_format_t format);
+
+#endif  // HISTORY_H
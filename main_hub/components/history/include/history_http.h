@@ -0,0 +1,31 @@
+/**
+ * @file history_http.h
+ * @author Anthony Yalong
+ * @brief Streaming history export over HTTP (chunked transfer encoding)
+ */
+#ifndef HISTORY_HTTP_H
+#define HISTORY_HTTP_H
+
+// imports
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "history.h"
+
+// configuration
+#define HISTORY_HTTP_CHUNK_LEN      1024    // formatted rows per chunk
+#define HISTORY_HTTP_BATCH          32      // records copied out per read
+
+/**
+ * @brief GET handler - user_ctx is the history_t to export
+ *
+ * Query: from, to (seconds since boot), channels (comma separated names,
+ * default all), format (csv or json, default csv). Rows are formatted into
+ * one fixed chunk buffer and sent as they fill it, so memory use does not
+ * depend on the range exported.
+ *
+ * @param req Request
+ * @return esp_err_t Send result
+ */
+esp_err_t history_http_export_handler(httpd_req_t *req);
+
+#endif  // HISTORY_HTTP_H
@@ -0,0 +1,96 @@
+/**
+ * @file keypad.h
+ * @author Anthony Yalong
+ * @brief Interrupt-driven matrix keypad driver with debounce and typematic
+ *        key events
+ */
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+// configuration
+#define KEYPAD_MAX_ROWS             4
+#define KEYPAD_MAX_COLS             4
+#define KEYPAD_SCAN_PERIOD_MS       5       // scan interval while any key is down
+#define KEYPAD_DEBOUNCE_SCANS       2       // identical scans to accept a change
+#define KEYPAD_REPEAT_DELAY_MS      500     // hold time before the first repeat
+#define KEYPAD_REPEAT_RATE_MS       100     // repeat interval
+#define KEYPAD_EVENT_QUEUE_LEN      16
+#define KEYPAD_TASK_STACK_SIZE      3072
+#define KEYPAD_TASK_PRIORITY        5
+
+/**
+ * @brief Key event types
+ */
+typedef enum {
+    KEYPAD_EVENT_PRESS = 0,
+    KEYPAD_EVENT_REPEAT,        // typematic repeat of a held key
+    KEYPAD_EVENT_RELEASE,
+} keypad_event_type_t;
+
+/**
+ * @brief Key event
+ */
+typedef struct {
+    keypad_event_type_t type;
+    char key;                   // character from the key map
+    int64_t wake_time_us;       // column interrupt that started this scan burst
+    int64_t event_time_us;      // time the event was queued
+} keypad_event_t;
+
+/**
+ * @brief Keypad structure
+ */
+typedef struct {
+    gpio_num_t rows[KEYPAD_MAX_ROWS];
+    gpio_num_t cols[KEYPAD_MAX_COLS];
+    uint8_t row_count;
+    uint8_t col_count;
+    const char *keymap;         // row-major, row_count * col_count characters
+
+    uint16_t stable;            // debounced key bitmap (bit = row * col_count + col)
+    uint16_t candidate;         // last raw scan
+    uint8_t candidate_scans;    // consecutive scans equal to candidate
+    int8_t held_key;            // key index for typematic, -1 if none
+    int64_t next_repeat_us;
+
+    volatile int64_t wake_time_us;
+    QueueHandle_t event_queue;
+    TaskHandle_t task;
+    uint32_t wakeups;           // interrupt wake-ups (idle exits)
+    uint32_t scans;             // total scans performed
+} keypad_t;
+
+/**
+ * @brief Initialize keypad GPIOs, event queue, scan task and column interrupts
+ *
+ * @param keypad Pointer to keypad structure
+ * @param rows Row pins (driven, open-drain)
+ * @param row_count Number of rows (1-KEYPAD_MAX_ROWS)
+ * @param cols Column pins (inputs with pull-ups, interrupt capable)
+ * @param col_count Number of columns (1-KEYPAD_MAX_COLS)
+ * @param keymap Row-major key characters, row_count * col_count long
+ * @return esp_err_t ESP_OK on success, error code otherwise
+ */
+esp_err_t keypad_init(keypad_t *keypad, const gpio_num_t *rows, uint8_t row_count,
+                      const gpio_num_t *cols, uint8_t col_count, const char *keymap);
+
+/**
+ * @brief Receive the next key event
+ *
+ * @param keypad Pointer to keypad structure
+ * @param event Output event
+ * @param timeout Ticks to wait
+ * @return bool true if an event was received
+ */
+bool keypad_receive(keypad_t *keypad, keypad_event_t *event, TickType_t timeout);
+
+#endif  // KEYPAD_H
@@ -0,0 +1,77 @@
+/**
+ * @file keypad_pin.h
+ * @author Anthony Yalong
+ * @brief Arm/disarm PIN storage and constant-time verification
+ */
+#ifndef KEYPAD_PIN_H
+#define KEYPAD_PIN_H
+
+// imports
+#include <stdbool.h>
+#include "esp_err.h"
+
+// configuration
+#define KEYPAD_PIN_MIN_LEN          4
+#define KEYPAD_PIN_MAX_LEN          8
+#define KEYPAD_PIN_SALT_LEN         16
+#define KEYPAD_PIN_HASH_LEN         32      // sha-256
+#define KEYPAD_PIN_MAX_FAILURES     5       // failures before lockout
+#define KEYPAD_PIN_LOCKOUT_MS       30000
+
+// nvs layout
+#define KEYPAD_PIN_NAMESPACE        "keypad"
+#define KEYPAD_PIN_SALT_KEY         "pin_salt"
+#define KEYPAD_PIN_HASH_KEY         "pin_hash"
+
+/**
+ * @brief Store a new PIN as salted SHA-256 in NVS
+ *
+ * A fresh random salt is generated on every call; the PIN itself is
+ * never stored.
+ *
+ * @param pin NUL-terminated digit string, KEYPAD_PIN_MIN_LEN-KEYPAD_PIN_MAX_LEN long
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on a bad PIN,
+ *                   NVS error code otherwise
+ */
+esp_err_t keypad_pin_set(const char *pin);
+
+/**
+ * @brief Check whether a PIN has been provisioned
+ *
+ * @return bool true if a PIN hash is stored in NVS
+ */
+bool keypad_pin_is_set(void);
+
+/**
+ * @brief Verify a PIN against the stored hash
+ *
+ * The digest comparison touches every byte regardless of where the first
+ * mismatch is. After KEYPAD_PIN_MAX_FAILURES consecutive failures all
+ * attempts are refused for KEYPAD_PIN_LOCKOUT_MS.
+ *
+ * @param pin NUL-terminated entered PIN
+ * @param match Set to true if the PIN matched
+ * @return esp_err_t ESP_OK if the check ran (see match),
+ *                   ESP_ERR_INVALID_STATE while locked out,
+ *                   ESP_ERR_NOT_FOUND if no PIN is provisioned,
+ *                   ESP_ERR_INVALID_ARG on NULL arguments
+ */
+esp_err_t keypad_pin_verify(const char *pin, bool *match);
+
+/**
+ * @brief Replace the PIN, authenticated by the current one
+ *
+ * The current PIN goes through keypad_pin_verify(), so a wrong one counts
+ * towards the lockout. The new PIN is only checked and stored on a match.
+ *
+ * @param current NUL-terminated current PIN
+ * @param pin NUL-terminated new PIN, KEYPAD_PIN_MIN_LEN-KEYPAD_PIN_MAX_LEN digits
+ * @param match Set to true if the current PIN matched
+ * @return esp_err_t ESP_OK if the check ran and, on a match, the new PIN
+ *                   was stored; keypad_pin_verify() errors,
+ *                   ESP_ERR_INVALID_ARG on a bad new PIN, NVS error code
+ *                   otherwise
+ */
+esp_err_t keypad_pin_change(const char *current, const char *pin, bool *match);
+
+#endif  // KEYPAD_PIN_H
@@ -0,0 +1,328 @@
+/**
+ * @file keypad.c
+ * @author Anthony Yalong
+ * @brief Interrupt-driven matrix keypad driver implementation
+ */
+
+#include "keypad.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+static const char *TAG = "KEYPAD";
+
+// column settle time after selecting a row
+#define KEYPAD_SETTLE_US            10
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Column isr - masks column interrupts and wakes the scan task
+ *
+ * Columns use low-level interrupts, so a key already held when idle is
+ * re-armed fires immediately instead of being missed.
+ *
+ * @param arg Pointer to keypad structure
+ */
+static void keypad_isr(void *arg);
+
+/**
+ * @brief Scan timer callback - paces scans below the tick period
+ *
+ * @param arg Pointer to keypad structure
+ */
+static void keypad_scan_timer_cb(void *arg);
+
+/**
+ * @brief Scan task - idles on the column interrupt, scans until all keys are released
+ *
+ * @param pvParameters Pointer to keypad structure
+ */
+static void keypad_task(void *pvParameters);
+
+/**
+ * @brief Drive one row low and read every column, for each row
+ *
+ * @param keypad Pointer to keypad structure
+ * @return uint16_t Raw key bitmap
+ */
+static uint16_t keypad_scan(keypad_t *keypad);
+
+/**
+ * @brief Debounce a raw scan and queue press/release/repeat events
+ *
+ * @param keypad Pointer to keypad structure
+ * @param raw Raw key bitmap
+ * @param now_us Scan time
+ */
+static void keypad_process(keypad_t *keypad, uint16_t raw, int64_t now_us);
+
+/**
+ * @brief Queue one event (dropped if the queue is full)
+ *
+ * @param keypad Pointer to keypad structure
+ * @param type Event type
+ * @param index Key index
+ * @param now_us Event time
+ */
+static void keypad_queue_event(keypad_t *keypad, keypad_event_type_t type, int index, int64_t now_us);
+
+/**
+ * @brief Set every row to the same level
+ *
+ * @param keypad Pointer to keypad structure
+ * @param level 0 to drive low, 1 to release
+ */
+static void keypad_set_rows(keypad_t *keypad, uint32_t level);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t keypad_init(keypad_t *keypad, const gpio_num_t *rows, uint8_t row_count,
+                      const gpio_num_t *cols, uint8_t col_count, const char *keymap) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (keypad == NULL || rows == NULL || cols == NULL || keymap == NULL ||
+        row_count == 0 || row_count > KEYPAD_MAX_ROWS || col_count == 0 || col_count > KEYPAD_MAX_COLS ||
+        strlen(keymap) != (size_t)row_count * col_count) {
+        ESP_LOGE(TAG, "invalid keypad parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(keypad, 0, sizeof(*keypad));
+    memcpy(keypad->rows, rows, row_count * sizeof(gpio_num_t));
+    memcpy(keypad->cols, cols, col_count * sizeof(gpio_num_t));
+    keypad->row_count = row_count;
+    keypad->col_count = col_count;
+    keypad->keymap = keymap;
+    keypad->held_key = -1;
+
+    // rows: open drain so two keys in one column never short two driven rows
+    uint64_t row_mask = 0;
+    for (uint8_t i = 0; i < row_count; i++) {
+        row_mask |= (1ULL << rows[i]);
+    }
+    gpio_config_t row_config = {
+        .pin_bit_mask = row_mask,
+        .mode = GPIO_MODE_OUTPUT_OD,
+        .intr_type = GPIO_INTR_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE
+    };
+    ret = gpio_config(&row_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to config row gpio");
+        return ret;
+    }
+
+    // columns: pulled up, low level while a key in the driven row is down
+    uint64_t col_mask = 0;
+    for (uint8_t i = 0; i < col_count; i++) {
+        col_mask |= (1ULL << cols[i]);
+    }
+    gpio_config_t col_config = {
+        .pin_bit_mask = col_mask,
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_LOW_LEVEL,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_ENABLE
+    };
+    ret = gpio_config(&col_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to config column gpio");
+        return ret;
+    }
+
+    // interrupts stay masked until the task enters idle
+    for (uint8_t i = 0; i < col_count; i++) {
+        gpio_intr_disable(cols[i]);
+    }
+
+    keypad->event_queue = xQueueCreate(KEYPAD_EVENT_QUEUE_LEN, sizeof(keypad_event_t));
+    if (keypad->event_queue == NULL) {
+        ESP_LOGE(TAG, "failed to create event queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // scan task must exist before the isr can notify it
+    if (xTaskCreate(keypad_task, "keypad_task", KEYPAD_TASK_STACK_SIZE, keypad,
+                    KEYPAD_TASK_PRIORITY, &keypad->task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create scan task");
+        vQueueDelete(keypad->event_queue);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // service may already be installed by another driver (all install it in iram)
+    ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "failed to install gpio isr service");
+        return ret;
+    }
+    for (uint8_t i = 0; i < col_count; i++) {
+        ret = gpio_isr_handler_add(cols[i], keypad_isr, keypad);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to add isr for gpio %d", cols[i]);
+            return ret;
+        }
+    }
+
+    ESP_LOGI(TAG, "keypad initialized (%dx%d)", row_count, col_count);
+    return ESP_OK;
+}
+
+bool keypad_receive(keypad_t *keypad, keypad_event_t *event, TickType_t timeout) {
+    if (keypad == NULL || event == NULL) {
+        ESP_LOGE(TAG, "keypad or event pointer is NULL");
+        return false;
+    }
+    return xQueueReceive(keypad->event_queue, event, timeout) == pdTRUE;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void IRAM_ATTR keypad_isr(void *arg) {
+    keypad_t *keypad = (keypad_t *)arg;
+    BaseType_t higher_priority_woken = pdFALSE;
+
+    // level interrupt would fire continuously while the key is held
+    // (gpio_intr_disable is in iram with CONFIG_GPIO_CTRL_FUNC_IN_IRAM)
+    for (uint8_t i = 0; i < keypad->col_count; i++) {
+        gpio_intr_disable(keypad->cols[i]);
+    }
+    keypad->wake_time_us = esp_timer_get_time();
+
+    vTaskNotifyGiveFromISR(keypad->task, &higher_priority_woken);
+    portYIELD_FROM_ISR(higher_priority_woken);
+}
+
+static void keypad_scan_timer_cb(void *arg) {
+    keypad_t *keypad = (keypad_t *)arg;
+
+    xTaskNotifyGive(keypad->task);
+}
+
+static void keypad_task(void *pvParameters) {
+    keypad_t *keypad = (keypad_t *)pvParameters;
+    esp_timer_handle_t scan_timer;
+
+    // scan period is below the rtos tick, so pace scans from esp_timer
+    esp_timer_create_args_t timer_args = {
+        .callback = keypad_scan_timer_cb,
+        .arg = keypad,
+        .name = "keypad_scan",
+    };
+    if (esp_timer_create(&timer_args, &scan_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create scan timer");
+        vTaskDelete(NULL);
+    }
+
+    while (1) {
+        // idle: all rows low so any key pulls its column low
+        keypad_set_rows(keypad, 0);
+        for (uint8_t i = 0; i < keypad->col_count; i++) {
+            gpio_intr_enable(keypad->cols[i]);
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        keypad->wakeups++;
+
+        // scan burst until every key is released and debounced
+        esp_timer_start_periodic(scan_timer, KEYPAD_SCAN_PERIOD_MS * 1000);
+        do {
+            keypad_process(keypad, keypad_scan(keypad), esp_timer_get_time());
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } while (keypad->stable != 0 || keypad->candidate != 0 ||
+                 keypad->candidate_scans < KEYPAD_DEBOUNCE_SCANS);
+        esp_timer_stop(scan_timer);
+
+        // drop a timer notification that raced with the stop
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+
+    vTaskDelete(NULL);
+}
+
+static uint16_t keypad_scan(keypad_t *keypad) {
+    uint16_t raw = 0;
+
+    keypad_set_rows(keypad, 1);
+    for (uint8_t r = 0; r < keypad->row_count; r++) {
+        gpio_set_level(keypad->rows[r], 0);
+        esp_rom_delay_us(KEYPAD_SETTLE_US);
+
+        for (uint8_t c = 0; c < keypad->col_count; c++) {
+            if (gpio_get_level(keypad->cols[c]) == 0) {
+                raw |= 1U << (r * keypad->col_count + c);
+            }
+        }
+        gpio_set_level(keypad->rows[r], 1);
+    }
+
+    keypad->scans++;
+    return raw;
+}
+
+static void keypad_process(keypad_t *keypad, uint16_t raw, int64_t now_us) {
+    // debounce: accept a bitmap once it has been seen on consecutive scans
+    if (raw == keypad->candidate) {
+        if (keypad->candidate_scans < UINT8_MAX) {
+            keypad->candidate_scans++;
+        }
+    } else {
+        keypad->candidate = raw;
+        keypad->candidate_scans = 1;
+    }
+
+    if (keypad->candidate_scans >= KEYPAD_DEBOUNCE_SCANS && keypad->candidate != keypad->stable) {
+        uint16_t changed = keypad->candidate ^ keypad->stable;
+        int key_count = keypad->row_count * keypad->col_count;
+
+        for (int i = 0; i < key_count; i++) {
+            if (!(changed & (1U << i))) {
+                continue;
+            }
+            if (keypad->candidate & (1U << i)) {
+                // newest press owns the typematic repeat
+                keypad_queue_event(keypad, KEYPAD_EVENT_PRESS, i, now_us);
+                keypad->held_key = i;
+                keypad->next_repeat_us = now_us + KEYPAD_REPEAT_DELAY_MS * 1000LL;
+            } else {
+                keypad_queue_event(keypad, KEYPAD_EVENT_RELEASE, i, now_us);
+                if (keypad->held_key == i) {
+                    keypad->held_key = -1;
+                }
+            }
+        }
+        keypad->stable = keypad->candidate;
+    }
+
+    // typematic repeat
+    if (keypad->held_key >= 0 && now_us >= keypad->next_repeat_us) {
+        keypad_queue_event(keypad, KEYPAD_EVENT_REPEAT, keypad->held_key, now_us);
+        keypad->next_repeat_us += KEYPAD_REPEAT_RATE_MS * 1000LL;
+    }
+}
+
+static void keypad_queue_event(keypad_t *keypad, keypad_event_type_t type, int index, int64_t now_us) {
+    keypad_event_t event = {
+        .type = type,
+        .key = keypad->keymap[index],
+        .wake_time_us = keypad->wake_time_us,
+        .event_time_us = now_us,
+    };
+
+    if (xQueueSend(keypad->event_queue, &event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "event queue full, dropped key %c", event.key);
+    }
+}
+
+static void keypad_set_rows(keypad_t *keypad, uint32_t level) {
+    for (uint8_t r = 0; r < keypad->row_count; r++) {
+        gpio_set_level(keypad->rows[r], level);
+    }
+}
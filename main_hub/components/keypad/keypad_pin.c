@@ -0,0 +1,213 @@
+/**
+ * @file keypad_pin.c
+ * @author Anthony Yalong
+ * @brief Arm/disarm PIN storage and constant-time verification implementation
+ */
+
+#include "keypad_pin.h"
+#include <stdint.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+#include "nvs.h"
+
+static const char *TAG = "KEYPAD_PIN";
+
+// lockout state (verification is called from the keypad task only)
+static uint8_t failures = 0;
+static int64_t lockout_until_us = 0;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Validate PIN length and characters
+ *
+ * @param pin NUL-terminated PIN
+ * @return bool true if the PIN is 4-8 decimal digits
+ */
+static bool pin_is_valid(const char *pin);
+
+/**
+ * @brief SHA-256 of salt || pin
+ *
+ * @param salt Salt bytes
+ * @param pin NUL-terminated PIN
+ * @param digest Output digest
+ */
+static void pin_hash(const uint8_t *salt, const char *pin, uint8_t *digest);
+
+/**
+ * @brief Load salt and hash from NVS
+ *
+ * @param salt Output salt
+ * @param hash Output hash
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if not provisioned
+ */
+static esp_err_t pin_load(uint8_t *salt, uint8_t *hash);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t keypad_pin_set(const char *pin) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (!pin_is_valid(pin)) {
+        ESP_LOGE(TAG, "pin must be %d-%d digits", KEYPAD_PIN_MIN_LEN, KEYPAD_PIN_MAX_LEN);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t salt[KEYPAD_PIN_SALT_LEN];
+    uint8_t hash[KEYPAD_PIN_HASH_LEN];
+    esp_fill_random(salt, sizeof(salt));
+    pin_hash(salt, pin, hash);
+
+    nvs_handle_t handle;
+    ret = nvs_open(KEYPAD_PIN_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs");
+        return ret;
+    }
+    ret = nvs_set_blob(handle, KEYPAD_PIN_SALT_KEY, salt, sizeof(salt));
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, KEYPAD_PIN_HASH_KEY, hash, sizeof(hash));
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to store pin");
+        return ret;
+    }
+
+    failures = 0;
+    lockout_until_us = 0;
+    ESP_LOGI(TAG, "pin updated");
+    return ESP_OK;
+}
+
+bool keypad_pin_is_set(void) {
+    uint8_t salt[KEYPAD_PIN_SALT_LEN];
+    uint8_t hash[KEYPAD_PIN_HASH_LEN];
+
+    return pin_load(salt, hash) == ESP_OK;
+}
+
+esp_err_t keypad_pin_verify(const char *pin, bool *match) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (pin == NULL || match == NULL) {
+        ESP_LOGE(TAG, "pin or match pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+    *match = false;
+
+    if (esp_timer_get_time() < lockout_until_us) {
+        ESP_LOGW(TAG, "locked out");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t salt[KEYPAD_PIN_SALT_LEN];
+    uint8_t stored[KEYPAD_PIN_HASH_LEN];
+    ret = pin_load(salt, stored);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // malformed entries still hash, so timing does not reveal the length check
+    uint8_t entered[KEYPAD_PIN_HASH_LEN];
+    pin_hash(salt, pin, entered);
+
+    // constant time: no early exit on the first differing byte
+    uint8_t diff = pin_is_valid(pin) ? 0 : 1;
+    for (size_t i = 0; i < KEYPAD_PIN_HASH_LEN; i++) {
+        diff |= entered[i] ^ stored[i];
+    }
+
+    if (diff == 0) {
+        *match = true;
+        failures = 0;
+        return ESP_OK;
+    }
+
+    if (++failures >= KEYPAD_PIN_MAX_FAILURES) {
+        lockout_until_us = esp_timer_get_time() + KEYPAD_PIN_LOCKOUT_MS * 1000LL;
+        failures = 0;
+        ESP_LOGW(TAG, "%d failed attempts, locked for %d s", KEYPAD_PIN_MAX_FAILURES, KEYPAD_PIN_LOCKOUT_MS / 1000);
+    }
+    return ESP_OK;
+}
+
+esp_err_t keypad_pin_change(const char *current, const char *pin, bool *match) {
+    // error management
+    esp_err_t ret;
+
+    ret = keypad_pin_verify(current, match);
+    if (ret != ESP_OK || !*match) {
+        return ret;
+    }
+    return keypad_pin_set(pin);
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static bool pin_is_valid(const char *pin) {
+    if (pin == NULL) {
+        return false;
+    }
+
+    size_t len = strlen(pin);
+    if (len < KEYPAD_PIN_MIN_LEN || len > KEYPAD_PIN_MAX_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (pin[i] < '0' || pin[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void pin_hash(const uint8_t *salt, const char *pin, uint8_t *digest) {
+    mbedtls_sha256_context ctx;
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, salt, KEYPAD_PIN_SALT_LEN);
+    mbedtls_sha256_update(&ctx, (const unsigned char *)pin, strlen(pin));
+    mbedtls_sha256_finish(&ctx, digest);
+    mbedtls_sha256_free(&ctx);
+}
+
+static esp_err_t pin_load(uint8_t *salt, uint8_t *hash) {
+    // error management
+    esp_err_t ret;
+
+    nvs_handle_t handle;
+    ret = nvs_open(KEYPAD_PIN_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t salt_len = KEYPAD_PIN_SALT_LEN;
+    size_t hash_len = KEYPAD_PIN_HASH_LEN;
+    ret = nvs_get_blob(handle, KEYPAD_PIN_SALT_KEY, salt, &salt_len);
+    if (ret == ESP_OK) {
+        ret = nvs_get_blob(handle, KEYPAD_PIN_HASH_KEY, hash, &hash_len);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK || salt_len != KEYPAD_PIN_SALT_LEN || hash_len != KEYPAD_PIN_HASH_LEN) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
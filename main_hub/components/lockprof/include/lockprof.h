@@ -0,0 +1,176 @@
+/**
+ * @file lockprof.h
+ * @author Anthony Yalong
+ * @brief Lock contention profiler - instrumented wrappers for FreeRTOS
+ *        mutexes, semaphores and queues. Built with LOCKPROF_ENABLED=0
+ *        (the default) the wrappers are the plain FreeRTOS calls.
+ */
+#ifndef LOCKPROF_H
+#define LOCKPROF_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// configuration
+#ifndef LOCKPROF_ENABLED
+#define LOCKPROF_ENABLED        0       // idf.py -DLOCK_PROFILE=1 build
+#endif
+#define LOCKPROF_MAX_LOCKS      12
+#define LOCKPROF_MAX_OWNERS     8       // tasks tracked per lock, the rest share the last slot
+#define LOCKPROF_NAME_LEN       16
+#define LOCKPROF_BUCKETS        16      // log2 us: 0, 1, 2-3, 4-7 ... 16.4 ms and over
+#define LOCKPROF_REPORT_TOP     8       // locks listed in the report
+#define LOCKPROF_TASK_STACK     3072
+#define LOCKPROF_TASK_PRIORITY  1
+
+// wrappers - task context only, same arguments and results as FreeRTOS
+#if LOCKPROF_ENABLED
+#define LOCKPROF_REGISTER(handle, name, kind)       lockprof_register((handle), (name), (kind))
+#define LOCKPROF_TAKE(sem, timeout)                 lockprof_take((sem), (timeout))
+#define LOCKPROF_GIVE(sem)                          lockprof_give((sem))
+#define LOCKPROF_SEND(queue, item, timeout)         lockprof_send((queue), (item), (timeout))
+#define LOCKPROF_RECEIVE(queue, item, timeout)      lockprof_receive((queue), (item), (timeout))
+#define LOCKPROF_START_REPORTER(period_ms)          lockprof_start_reporter((period_ms))
+#else
+#define LOCKPROF_REGISTER(handle, name, kind)       ((void)0)
+#define LOCKPROF_TAKE(sem, timeout)                 xSemaphoreTake((sem), (timeout))
+#define LOCKPROF_GIVE(sem)                          xSemaphoreGive((sem))
+#define LOCKPROF_SEND(queue, item, timeout)         xQueueSend((queue), (item), (timeout))
+#define LOCKPROF_RECEIVE(queue, item, timeout)      xQueueReceive((queue), (item), (timeout))
+#define LOCKPROF_START_REPORTER(period_ms)          ((void)0)
+#endif
+
+/**
+ * @brief Primitive kinds
+ */
+typedef enum {
+    LOCKPROF_MUTEX = 0,         // wait to take, hold until give, per owner
+    LOCKPROF_SEMAPHORE,         // wait to take only (signals have no holder)
+    LOCKPROF_QUEUE,             // wait to send (queue full), depth on receive
+} lockprof_kind_t;
+
+/**
+ * @brief Per-task statistics on one lock
+ */
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskHandle_t task;
+    uint32_t acquires;
+    uint32_t contended;
+    uint64_t wait_us;
+    uint64_t hold_us;
+    uint32_t max_hold_us;
+} lockprof_owner_t;
+
+/**
+ * @brief Lock statistics
+ */
+typedef struct {
+    char name[LOCKPROF_NAME_LEN];
+    void *handle;
+    lockprof_kind_t kind;
+    uint32_t acquires;          // takes, or sends for a queue
+    uint32_t contended;         // had to block (taken, or queue full)
+    uint32_t timeouts;
+    uint64_t wait_us;
+    uint32_t max_wait_us;
+    uint64_t hold_us;
+    uint32_t max_hold_us;
+    uint32_t wait_hist[LOCKPROF_BUCKETS];
+    uint32_t hold_hist[LOCKPROF_BUCKETS];
+    uint32_t received;          // queue only
+    uint32_t max_depth;         // queue only, messages waiting
+    lockprof_owner_t owners[LOCKPROF_MAX_OWNERS];
+    uint8_t owner_count;
+    TaskHandle_t holder;        // mutex only, current holder
+    int64_t acquired_us;
+} lockprof_lock_t;
+
+/**
+ * @brief Profile a primitive (unregistered handles pass straight through)
+ *
+ * @param handle Mutex, semaphore or queue
+ * @param name Name in the report
+ * @param kind Primitive kind
+ */
+void lockprof_register(void *handle, const char *name, lockprof_kind_t kind);
+
+/**
+ * @brief xSemaphoreTake with wait, contention and (mutex) owner accounting
+ *
+ * Tries without blocking first, so a lock that was free is never counted as
+ * contended however long the timestamp calls take.
+ *
+ * @param sem Semaphore or mutex
+ * @param timeout Ticks to block
+ * @return BaseType_t pdTRUE if taken
+ */
+BaseType_t lockprof_take(SemaphoreHandle_t sem, TickType_t timeout);
+
+/**
+ * @brief xSemaphoreGive with hold time accounting for mutexes
+ *
+ * @param sem Semaphore or mutex
+ * @return BaseType_t pdTRUE if given
+ */
+BaseType_t lockprof_give(SemaphoreHandle_t sem);
+
+/**
+ * @brief xQueueSend with wait accounting (a full queue is contention)
+ *
+ * @param queue Queue
+ * @param item Item to copy in
+ * @param timeout Ticks to block while full
+ * @return BaseType_t pdTRUE if sent
+ */
+BaseType_t lockprof_send(QueueHandle_t queue, const void *item, TickType_t timeout);
+
+/**
+ * @brief xQueueReceive with depth accounting (consumer idle time is not recorded)
+ *
+ * @param queue Queue
+ * @param item Item to copy out
+ * @param timeout Ticks to block while empty
+ * @return BaseType_t pdTRUE if received
+ */
+BaseType_t lockprof_receive(QueueHandle_t queue, void *item, TickType_t timeout);
+
+/**
+ * @brief Number of registered primitives
+ *
+ * @return int Count
+ */
+int lockprof_count(void);
+
+/**
+ * @brief Copy one primitive's statistics
+ *
+ * @param index Registration order
+ * @param lock Output statistics
+ * @return bool false if index is out of range
+ */
+bool lockprof_get(int index, lockprof_lock_t *lock);
+
+/**
+ * @brief Clear all statistics (registrations are kept)
+ */
+void lockprof_reset(void);
+
+/**
+ * @brief Log the worst offenders, by total time spent waiting
+ */
+void lockprof_log_report(void);
+
+/**
+ * @brief Log the report periodically from a low-priority task
+ *
+ * @param period_ms Report period
+ */
+void lockprof_start_reporter(uint32_t period_ms);
+
+#endif  // LOCKPROF_H
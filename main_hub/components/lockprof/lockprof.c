@@ -0,0 +1,360 @@
+/**
+ * @file lockprof.c
+ * @author Anthony Yalong
+ * @brief Lock contention profiler implementation
+ */
+
+#include "lockprof.h"
+#include <stddef.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "LOCKPROF";
+
+// registered primitives; statistics are updated under a spinlock so
+// counting semaphores and queues with several users stay consistent
+static lockprof_lock_t locks[LOCKPROF_MAX_LOCKS];
+static int lock_count;
+static portMUX_TYPE lockprof_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Find a registered primitive
+ *
+ * @param handle Primitive handle
+ * @return lockprof_lock_t* Statistics, NULL if not registered
+ */
+static lockprof_lock_t *lockprof_find(const void *handle);
+
+/**
+ * @brief Find or add the calling task's owner slot
+ *
+ * @param lock Lock statistics
+ * @param task Calling task
+ * @return lockprof_owner_t* Owner slot (the last slot once the table is full)
+ */
+static lockprof_owner_t *lockprof_owner(lockprof_lock_t *lock, TaskHandle_t task);
+
+/**
+ * @brief Account one acquire attempt
+ *
+ * @param lock Lock statistics
+ * @param task Calling task
+ * @param wait_us Time spent in the call
+ * @param contended Had to block
+ * @param acquired Succeeded
+ */
+static void lockprof_record_wait(lockprof_lock_t *lock, TaskHandle_t task, uint32_t wait_us, bool contended,
+                                 bool acquired);
+
+/**
+ * @brief Histogram bucket of a duration
+ *
+ * @param us Duration
+ * @return int Bucket (log2)
+ */
+static int lockprof_bucket(uint32_t us);
+
+/**
+ * @brief Upper bound of the bucket holding a percentile
+ *
+ * @param hist Histogram
+ * @param total Samples in it
+ * @param percent Percentile
+ * @return uint32_t Bucket upper bound (us)
+ */
+static uint32_t lockprof_percentile(const uint32_t *hist, uint32_t total, uint32_t percent);
+
+/**
+ * @brief Report task
+ *
+ * @param pvParameters Report period in ms
+ */
+static void lockprof_task(void *pvParameters);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+void lockprof_register(void *handle, const char *name, lockprof_kind_t kind) {
+    if (handle == NULL || name == NULL) {
+        return;
+    }
+
+    bool added = false;
+    portENTER_CRITICAL(&lockprof_spinlock);
+    if (lock_count < LOCKPROF_MAX_LOCKS && lockprof_find(handle) == NULL) {
+        lockprof_lock_t *lock = &locks[lock_count];
+        memset(lock, 0, sizeof(*lock));
+        strncpy(lock->name, name, LOCKPROF_NAME_LEN - 1);
+        lock->handle = handle;
+        lock->kind = kind;
+        lock_count++;
+        added = true;
+    }
+    portEXIT_CRITICAL(&lockprof_spinlock);
+
+    if (!added) {
+        ESP_LOGW(TAG, "%s not profiled (table full or registered twice)", name);
+    }
+}
+
+BaseType_t lockprof_take(SemaphoreHandle_t sem, TickType_t timeout) {
+    lockprof_lock_t *lock = lockprof_find(sem);
+    if (lock == NULL) {
+        return xSemaphoreTake(sem, timeout);
+    }
+
+    int64_t start = esp_timer_get_time();
+    bool contended = false;
+    BaseType_t ret = xSemaphoreTake(sem, 0);
+    if (ret != pdTRUE && timeout != 0) {
+        contended = true;
+        ret = xSemaphoreTake(sem, timeout);
+    }
+    int64_t now = esp_timer_get_time();
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&lockprof_spinlock);
+    lockprof_record_wait(lock, task, now - start, contended, ret == pdTRUE);
+    if (ret == pdTRUE && lock->kind == LOCKPROF_MUTEX) {
+        lock->holder = task;
+        lock->acquired_us = now;
+    }
+    portEXIT_CRITICAL(&lockprof_spinlock);
+    return ret;
+}
+
+BaseType_t lockprof_give(SemaphoreHandle_t sem) {
+    lockprof_lock_t *lock = lockprof_find(sem);
+    if (lock == NULL || lock->kind != LOCKPROF_MUTEX) {
+        return xSemaphoreGive(sem);
+    }
+
+    // account before giving, the next holder overwrites the start time
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lockprof_spinlock);
+    if (lock->holder == task) {
+        uint32_t hold_us = now - lock->acquired_us;
+        lockprof_owner_t *owner = lockprof_owner(lock, task);
+        lock->holder = NULL;
+        lock->hold_us += hold_us;
+        lock->hold_hist[lockprof_bucket(hold_us)]++;
+        if (hold_us > lock->max_hold_us) {
+            lock->max_hold_us = hold_us;
+        }
+        owner->hold_us += hold_us;
+        if (hold_us > owner->max_hold_us) {
+            owner->max_hold_us = hold_us;
+        }
+    }
+    portEXIT_CRITICAL(&lockprof_spinlock);
+    return xSemaphoreGive(sem);
+}
+
+BaseType_t lockprof_send(QueueHandle_t queue, const void *item, TickType_t timeout) {
+    lockprof_lock_t *lock = lockprof_find(queue);
+    if (lock == NULL) {
+        return xQueueSend(queue, item, timeout);
+    }
+
+    int64_t start = esp_timer_get_time();
+    bool contended = false;
+    BaseType_t ret = xQueueSend(queue, item, 0);
+    if (ret != pdTRUE && timeout != 0) {
+        contended = true;
+        ret = xQueueSend(queue, item, timeout);
+    }
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lockprof_spinlock);
+    lockprof_record_wait(lock, xTaskGetCurrentTaskHandle(), now - start, contended || ret != pdTRUE,
+                         ret == pdTRUE);
+    portEXIT_CRITICAL(&lockprof_spinlock);
+    return ret;
+}
+
+BaseType_t lockprof_receive(QueueHandle_t queue, void *item, TickType_t timeout) {
+    lockprof_lock_t *lock = lockprof_find(queue);
+    if (lock == NULL) {
+        return xQueueReceive(queue, item, timeout);
+    }
+
+    BaseType_t ret = xQueueReceive(queue, item, timeout);
+    if (ret == pdTRUE) {
+        // depth including the message just taken
+        uint32_t depth = uxQueueMessagesWaiting(queue) + 1;
+        portENTER_CRITICAL(&lockprof_spinlock);
+        lock->received++;
+        if (depth > lock->max_depth) {
+            lock->max_depth = depth;
+        }
+        portEXIT_CRITICAL(&lockprof_spinlock);
+    }
+    return ret;
+}
+
+int lockprof_count(void) {
+    return lock_count;
+}
+
+bool lockprof_get(int index, lockprof_lock_t *lock) {
+    if (lock == NULL || index < 0 || index >= lock_count) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&lockprof_spinlock);
+    *lock = locks[index];
+    portEXIT_CRITICAL(&lockprof_spinlock);
+    return true;
+}
+
+void lockprof_reset(void) {
+    portENTER_CRITICAL(&lockprof_spinlock);
+    for (int i = 0; i < lock_count; i++) {
+        lockprof_lock_t *lock = &locks[i];
+        size_t keep = offsetof(lockprof_lock_t, acquires);
+        memset((uint8_t *)lock + keep, 0, offsetof(lockprof_lock_t, holder) - keep);
+    }
+    portEXIT_CRITICAL(&lockprof_spinlock);
+}
+
+void lockprof_log_report(void) {
+    static lockprof_lock_t snapshot[LOCKPROF_MAX_LOCKS];
+    int order[LOCKPROF_MAX_LOCKS];
+    int count = lock_count;
+
+    // copy out, then rank by total wait without holding the spinlock
+    for (int i = 0; i < count; i++) {
+        lockprof_get(i, &snapshot[i]);
+        order[i] = i;
+    }
+    for (int i = 1; i < count; i++) {
+        for (int j = i; j > 0 && snapshot[order[j]].wait_us > snapshot[order[j - 1]].wait_us; j--) {
+            int swap = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = swap;
+        }
+    }
+
+    ESP_LOGI(TAG, "---- lock contention, worst first (wait/hold in us) ----");
+    for (int i = 0; i < count && i < LOCKPROF_REPORT_TOP; i++) {
+        const lockprof_lock_t *lock = &snapshot[order[i]];
+        if (lock->acquires == 0) {
+            continue;
+        }
+
+        // the owner that waited longest
+        const lockprof_owner_t *worst = &lock->owners[0];
+        for (int o = 1; o < lock->owner_count; o++) {
+            if (lock->owners[o].wait_us > worst->wait_us) {
+                worst = &lock->owners[o];
+            }
+        }
+
+        ESP_LOGI(TAG, "%-16s %lu %s, %.1f%% contended, %lu timeouts, wait total %llu avg %llu p99<%lu max %lu",
+                 lock->name, lock->acquires, (lock->kind == LOCKPROF_QUEUE) ? "sends" : "takes",
+                 100.0f * lock->contended / lock->acquires, lock->timeouts, lock->wait_us,
+                 lock->wait_us / lock->acquires, lockprof_percentile(lock->wait_hist, lock->acquires, 99),
+                 lock->max_wait_us);
+        if (lock->kind == LOCKPROF_MUTEX) {
+            ESP_LOGI(TAG, "%-16s hold avg %llu p99<%lu max %lu", "", lock->hold_us / lock->acquires,
+                     lockprof_percentile(lock->hold_hist, lock->acquires, 99), lock->max_hold_us);
+        } else if (lock->kind == LOCKPROF_QUEUE) {
+            ESP_LOGI(TAG, "%-16s %lu received, max depth %lu", "", lock->received, lock->max_depth);
+        }
+        if (lock->owner_count > 0) {
+            ESP_LOGI(TAG, "%-16s worst waiter %s: %lu of %lu contended, wait %llu, hold max %lu", "", worst->name,
+                     worst->contended, worst->acquires, worst->wait_us, worst->max_hold_us);
+        }
+    }
+}
+
+void lockprof_start_reporter(uint32_t period_ms) {
+    if (xTaskCreate(lockprof_task, "lockprof_task", LOCKPROF_TASK_STACK, (void *)(uintptr_t)period_ms,
+                    LOCKPROF_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create report task");
+    }
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static lockprof_lock_t *lockprof_find(const void *handle) {
+    // a dozen entries, registered at start-up and never removed
+    for (int i = 0; i < lock_count; i++) {
+        if (locks[i].handle == handle) {
+            return &locks[i];
+        }
+    }
+    return NULL;
+}
+
+static lockprof_owner_t *lockprof_owner(lockprof_lock_t *lock, TaskHandle_t task) {
+    for (int i = 0; i < lock->owner_count; i++) {
+        if (lock->owners[i].task == task) {
+            return &lock->owners[i];
+        }
+    }
+    if (lock->owner_count == LOCKPROF_MAX_OWNERS) {
+        return &lock->owners[LOCKPROF_MAX_OWNERS - 1];
+    }
+
+    lockprof_owner_t *owner = &lock->owners[lock->owner_count++];
+    owner->task = task;
+    strncpy(owner->name, pcTaskGetName(task), configMAX_TASK_NAME_LEN - 1);
+    if (lock->owner_count == LOCKPROF_MAX_OWNERS) {
+        strncpy(owner->name, "(others)", configMAX_TASK_NAME_LEN - 1);
+    }
+    return owner;
+}
+
+static void lockprof_record_wait(lockprof_lock_t *lock, TaskHandle_t task, uint32_t wait_us, bool contended,
+                                 bool acquired) {
+    lockprof_owner_t *owner = lockprof_owner(lock, task);
+
+    lock->acquires++;
+    lock->wait_us += wait_us;
+    lock->wait_hist[lockprof_bucket(wait_us)]++;
+    if (wait_us > lock->max_wait_us) {
+        lock->max_wait_us = wait_us;
+    }
+    owner->acquires++;
+    owner->wait_us += wait_us;
+    if (contended) {
+        lock->contended++;
+        owner->contended++;
+    }
+    if (!acquired) {
+        lock->timeouts++;
+    }
+}
+
+static int lockprof_bucket(uint32_t us) {
+    int bucket = (us == 0) ? 0 : 32 - __builtin_clz(us);
+    return (bucket < LOCKPROF_BUCKETS) ? bucket : LOCKPROF_BUCKETS - 1;
+}
+
+static uint32_t lockprof_percentile(const uint32_t *hist, uint32_t total, uint32_t percent) {
+    uint64_t target = ((uint64_t)total * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < LOCKPROF_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            return (i == 0) ? 1 : (1u << i);
+        }
+    }
+    return 1u << (LOCKPROF_BUCKETS - 1);
+}
+
+static void lockprof_task(void *pvParameters) {
+    TickType_t period = pdMS_TO_TICKS((uint32_t)(uintptr_t)pvParameters);
+
+    while (1) {
+        vTaskDelay(period);
+        lockprof_log_report();
+    }
+}
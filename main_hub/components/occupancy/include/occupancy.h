@@ -0,0 +1,152 @@
+/**
+ * @file occupancy.h
+ * @author Anthony Yalong
+ * @brief Per-zone occupancy rollups - motion episodes and dwell time in a
+ *        7x24 hour-of-week ring per zone, fixed RAM, persisted to NVS
+ */
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// configuration
+#ifndef OCCUPANCY_MAX_ZONES
+#define OCCUPANCY_MAX_ZONES         16      // 680 bytes each
+#endif
+#define OCCUPANCY_SLOTS             (7 * 24)    // hour of week, sunday 00:00 first
+#define OCCUPANCY_NAME_LEN          16      // also the nvs key, 15 characters max
+#define OCCUPANCY_MAX_SOURCES       8       // event sources mapped to zones
+#define OCCUPANCY_MAX_SENSORS       32      // sensors (pins, nodes) per source
+#define OCCUPANCY_NVS_PARTITION     "occupancy"
+#define OCCUPANCY_NAMESPACE         "occupancy"
+
+/**
+ * @brief Hour-of-week rollup of one zone
+ */
+typedef struct {
+    uint16_t episodes[OCCUPANCY_SLOTS];     // episodes starting in the hour
+    uint16_t dwell_s[OCCUPANCY_SLOTS];      // occupied seconds in the hour
+} occupancy_rollup_t;
+
+/**
+ * @brief Zone
+ */
+typedef struct {
+    char name[OCCUPANCY_NAME_LEN];
+    occupancy_rollup_t rollup;
+    bool dirty;                 // changed since the last save
+} occupancy_zone_t;
+
+/**
+ * @brief Statistics
+ */
+typedef struct {
+    uint32_t episodes;          // episodes recorded
+    uint32_t dropped;           // episodes older than the ring
+    uint32_t unmapped;          // episodes from sensors without a zone
+    uint32_t saves;             // zones written to nvs
+} occupancy_stats_t;
+
+/**
+ * @brief Occupancy structure
+ */
+typedef struct {
+    occupancy_zone_t zones[OCCUPANCY_MAX_ZONES];
+    uint8_t zone_count;
+    uint8_t zone_map[OCCUPANCY_MAX_SOURCES][OCCUPANCY_MAX_SENSORS];     // zone + 1, 0 unmapped
+    time_t hour_start;          // start of the current local hour (0 before the first episode)
+    uint16_t slot;              // slot of the current hour
+    occupancy_stats_t stats;
+    SemaphoreHandle_t mutex;
+} occupancy_t;
+
+/**
+ * @brief Initialize an empty occupancy table
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the mutex cannot be created
+ */
+esp_err_t occupancy_init(occupancy_t *occupancy);
+
+/**
+ * @brief Add a zone, or map another sensor to an existing zone of the same name
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @param name Zone name
+ * @param source Event source feeding the zone
+ * @param sensor Sensor within the source (pin index, node id)
+ * @param zone Output zone index (can be NULL)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM when all zones are used
+ */
+esp_err_t occupancy_add_zone(occupancy_t *occupancy, const char *name, uint8_t source, uint8_t sensor, int *zone);
+
+/**
+ * @brief Zone fed by a sensor
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @param source Event source
+ * @param sensor Sensor within the source
+ * @return int Zone index, -1 if unmapped
+ */
+int occupancy_find_zone(const occupancy_t *occupancy, uint8_t source, uint8_t sensor);
+
+/**
+ * @brief Fold a finished motion episode into its zone's rollup
+ *
+ * Counts the episode in the hour it started and splits its dwell time over
+ * the local hours it spans. Moving into a new hour clears the week-old
+ * slots passed over (once per hour, not per episode).
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @param source Event source
+ * @param sensor Sensor within the source
+ * @param start Episode start (wall clock)
+ * @param duration_s Episode length in seconds
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the sensor has no
+ *                   zone, ESP_ERR_INVALID_STATE if the episode is older than the ring
+ */
+esp_err_t occupancy_record_episode(occupancy_t *occupancy, uint8_t source, uint8_t sensor, time_t start,
+                                   uint32_t duration_s);
+
+/**
+ * @brief Copy one zone's rollup (for export)
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @param zone Zone index
+ * @param rollup Output rollup
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown zone
+ */
+esp_err_t occupancy_get_rollup(occupancy_t *occupancy, int zone, occupancy_rollup_t *rollup);
+
+/**
+ * @brief Restore rollups of the added zones from NVS (matched by name)
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @return esp_err_t ESP_OK on success (nothing stored is not an error),
+ *                   error code from nvs otherwise
+ */
+esp_err_t occupancy_load(occupancy_t *occupancy);
+
+/**
+ * @brief Write changed zones to NVS
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @return esp_err_t ESP_OK on success, error code from nvs otherwise
+ */
+esp_err_t occupancy_save(occupancy_t *occupancy);
+
+/**
+ * @brief Get statistics
+ *
+ * @param occupancy Pointer to occupancy structure
+ * @param stats Output statistics
+ */
+void occupancy_get_stats(occupancy_t *occupancy, occupancy_stats_t *stats);
+
+#endif  // OCCUPANCY_H
@@ -0,0 +1,30 @@
+/**
+ * @file occupancy_http.h
+ * @author Anthony Yalong
+ * @brief Occupancy rollup export over HTTP (chunked transfer encoding)
+ */
+#ifndef OCCUPANCY_HTTP_H
+#define OCCUPANCY_HTTP_H
+
+// imports
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "occupancy.h"
+
+// configuration
+#define OCCUPANCY_HTTP_CHUNK_LEN    1024
+
+/**
+ * @brief GET handler - user_ctx is the occupancy_t to export
+ *
+ * Query: zone (name, default all), format (csv or json, default json).
+ * CSV rows are zone,day,hour,episodes,dwell_s; JSON is one object per zone
+ * with 168-entry episodes and dwell_s arrays, sunday 00:00 first. One zone
+ * is copied out at a time, so memory use does not grow with zones.
+ *
+ * @param req Request
+ * @return esp_err_t Send result
+ */
+esp_err_t occupancy_http_export_handler(httpd_req_t *req);
+
+#endif  // OCCUPANCY_HTTP_H
@@ -0,0 +1,398 @@
+/**
+ * @file occupancy.c
+ * @author Anthony Yalong
+ * @brief Per-zone occupancy rollup implementation
+ */
+
+#include "occupancy.h"
+#include <string.h>
+#include "esp_log.h"
+#include "lockprof.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+static const char *TAG = "OCCUPANCY";
+
+// nvs key of the ring position (zone names cannot start with '_')
+#define OCCUPANCY_POSITION_KEY      "_position"
+#define OCCUPANCY_HOUR_S            3600
+
+/**
+ * @brief Ring position, stored with the rollups so stale hours are cleared after a restart
+ */
+typedef struct {
+    int64_t hour_start;
+    uint16_t slot;
+} occupancy_position_t;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Hour-of-week slot of a time and the start of its local hour
+ *
+ * @param time Wall clock time
+ * @param hour_start Output start of the local hour
+ * @return uint16_t Slot (sunday 00:00 = 0)
+ */
+static uint16_t occupancy_slot_of(time_t time, time_t *hour_start);
+
+/**
+ * @brief Move the ring to the hour containing time, clearing the slots passed over
+ *
+ * @param occupancy Pointer to occupancy structure (lock held)
+ * @param time Wall clock time
+ */
+static void occupancy_advance(occupancy_t *occupancy, time_t time);
+
+/**
+ * @brief Move the ring to the current hour, so hours without episodes read as empty
+ *
+ * @param occupancy Pointer to occupancy structure (lock held)
+ */
+static void occupancy_advance_now(occupancy_t *occupancy);
+
+/**
+ * @brief Saturating add to a 16-bit counter
+ *
+ * @param counter Counter
+ * @param amount Amount to add
+ */
+static void occupancy_add(uint16_t *counter, uint32_t amount);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t occupancy_init(occupancy_t *occupancy) {
+    // sanity check
+    if (occupancy == NULL) {
+        ESP_LOGE(TAG, "occupancy pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(occupancy, 0, sizeof(*occupancy));
+    occupancy->mutex = xSemaphoreCreateMutex();
+    if (occupancy->mutex == NULL) {
+        ESP_LOGE(TAG, "failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    LOCKPROF_REGISTER(occupancy->mutex, "occupancy", LOCKPROF_MUTEX);
+
+    return ESP_OK;
+}
+
+esp_err_t occupancy_add_zone(occupancy_t *occupancy, const char *name, uint8_t source, uint8_t sensor, int *zone) {
+    // sanity check
+    if (occupancy == NULL || name == NULL || name[0] == '\0' || name[0] == '_' ||
+        strlen(name) >= OCCUPANCY_NAME_LEN || source >= OCCUPANCY_MAX_SOURCES || sensor >= OCCUPANCY_MAX_SENSORS) {
+        ESP_LOGE(TAG, "invalid zone parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+
+    // several sensors can feed one zone
+    int index = -1;
+    for (int i = 0; i < occupancy->zone_count; i++) {
+        if (strcmp(occupancy->zones[i].name, name) == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        if (occupancy->zone_count >= OCCUPANCY_MAX_ZONES) {
+            LOCKPROF_GIVE(occupancy->mutex);
+            ESP_LOGE(TAG, "no free zones");
+            return ESP_ERR_NO_MEM;
+        }
+        index = occupancy->zone_count++;
+        strcpy(occupancy->zones[index].name, name);
+    }
+    occupancy->zone_map[source][sensor] = index + 1;
+
+    LOCKPROF_GIVE(occupancy->mutex);
+
+    if (zone != NULL) {
+        *zone = index;
+    }
+    return ESP_OK;
+}
+
+int occupancy_find_zone(const occupancy_t *occupancy, uint8_t source, uint8_t sensor) {
+    if (occupancy == NULL || source >= OCCUPANCY_MAX_SOURCES || sensor >= OCCUPANCY_MAX_SENSORS) {
+        return -1;
+    }
+    return (int)occupancy->zone_map[source][sensor] - 1;
+}
+
+esp_err_t occupancy_record_episode(occupancy_t *occupancy, uint8_t source, uint8_t sensor, time_t start,
+                                   uint32_t duration_s) {
+    // sanity check
+    if (occupancy == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int index = occupancy_find_zone(occupancy, source, sensor);
+
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+    if (index < 0) {
+        occupancy->stats.unmapped++;
+        LOCKPROF_GIVE(occupancy->mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // the ring follows the newest time seen
+    time_t end = start + duration_s;
+    occupancy_advance(occupancy, end);
+
+    // older than a week: gone from the ring; partly older: keep the recent part
+    time_t oldest = occupancy->hour_start - (time_t)(OCCUPANCY_SLOTS - 1) * OCCUPANCY_HOUR_S;
+    if (end < oldest) {
+        occupancy->stats.dropped++;
+        LOCKPROF_GIVE(occupancy->mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (start < oldest) {
+        duration_s -= oldest - start;
+        start = oldest;
+    }
+
+    // start slot - the current hour needs no calendar conversion
+    time_t hour_start = occupancy->hour_start;
+    uint16_t slot = occupancy->slot;
+    if (start < occupancy->hour_start) {
+        slot = occupancy_slot_of(start, &hour_start);
+    }
+
+    occupancy_rollup_t *rollup = &occupancy->zones[index].rollup;
+    occupancy_add(&rollup->episodes[slot], 1);
+
+    // split the dwell time at hour boundaries (at most one step per hour spanned)
+    time_t now = start;
+    uint32_t remaining = duration_s;
+    for (int step = 0; step < OCCUPANCY_SLOTS && remaining > 0; step++) {
+        uint32_t in_hour = hour_start + OCCUPANCY_HOUR_S - now;
+        uint32_t part = (remaining < in_hour) ? remaining : in_hour;
+        occupancy_add(&rollup->dwell_s[slot], part);
+
+        remaining -= part;
+        now += part;
+        hour_start += OCCUPANCY_HOUR_S;
+        slot = (slot + 1) % OCCUPANCY_SLOTS;
+    }
+
+    occupancy->zones[index].dirty = true;
+    occupancy->stats.episodes++;
+    LOCKPROF_GIVE(occupancy->mutex);
+    return ESP_OK;
+}
+
+esp_err_t occupancy_get_rollup(occupancy_t *occupancy, int zone, occupancy_rollup_t *rollup) {
+    // sanity check
+    if (occupancy == NULL || rollup == NULL || zone < 0 || zone >= occupancy->zone_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+    occupancy_advance_now(occupancy);
+    *rollup = occupancy->zones[zone].rollup;
+    LOCKPROF_GIVE(occupancy->mutex);
+    return ESP_OK;
+}
+
+esp_err_t occupancy_load(occupancy_t *occupancy) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (occupancy == NULL) {
+        ESP_LOGE(TAG, "occupancy pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // rollups live in their own nvs partition
+    ret = nvs_flash_init_partition(OCCUPANCY_NVS_PARTITION);
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase_partition(OCCUPANCY_NVS_PARTITION);
+        ret = nvs_flash_init_partition(OCCUPANCY_NVS_PARTITION);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize %s partition", OCCUPANCY_NVS_PARTITION);
+        return ret;
+    }
+
+    nvs_handle_t handle;
+    ret = nvs_open_from_partition(OCCUPANCY_NVS_PARTITION, OCCUPANCY_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs");
+        return ret;
+    }
+
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+
+    // rollups without their ring position cannot be aged, ignore them
+    occupancy_position_t position;
+    size_t length = sizeof(position);
+    ret = nvs_get_blob(handle, OCCUPANCY_POSITION_KEY, &position, &length);
+    if (ret == ESP_OK && length == sizeof(position) && position.slot < OCCUPANCY_SLOTS) {
+        occupancy->hour_start = (time_t)position.hour_start;
+        occupancy->slot = position.slot;
+
+        int restored = 0;
+        for (int i = 0; i < occupancy->zone_count; i++) {
+            length = sizeof(occupancy_rollup_t);
+            if (nvs_get_blob(handle, occupancy->zones[i].name, &occupancy->zones[i].rollup, &length) == ESP_OK &&
+                length == sizeof(occupancy_rollup_t)) {
+                restored++;
+            } else {
+                memset(&occupancy->zones[i].rollup, 0, sizeof(occupancy_rollup_t));
+            }
+        }
+        ESP_LOGI(TAG, "restored %d of %d zones", restored, occupancy->zone_count);
+    }
+
+    LOCKPROF_GIVE(occupancy->mutex);
+    nvs_close(handle);
+    return ESP_OK;
+}
+
+esp_err_t occupancy_save(occupancy_t *occupancy) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (occupancy == NULL) {
+        ESP_LOGE(TAG, "occupancy pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t handle;
+    ret = nvs_open_from_partition(OCCUPANCY_NVS_PARTITION, OCCUPANCY_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs");
+        return ret;
+    }
+
+    // hours that passed without episodes are stored cleared
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+    occupancy_advance_now(occupancy);
+    LOCKPROF_GIVE(occupancy->mutex);
+
+    // copy each dirty zone out so the flash write happens without the lock
+    static occupancy_rollup_t rollup;
+    occupancy_position_t position;
+    bool written[OCCUPANCY_MAX_ZONES] = { false };
+    int saved = 0;
+    for (int i = 0; i < occupancy->zone_count && ret == ESP_OK; i++) {
+        LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+        bool dirty = occupancy->zones[i].dirty;
+        if (dirty) {
+            rollup = occupancy->zones[i].rollup;
+            occupancy->zones[i].dirty = false;
+        }
+        LOCKPROF_GIVE(occupancy->mutex);
+
+        if (dirty) {
+            ret = nvs_set_blob(handle, occupancy->zones[i].name, &rollup, sizeof(rollup));
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "failed to store zone %s: %s", occupancy->zones[i].name, esp_err_to_name(ret));
+                LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+                occupancy->zones[i].dirty = true;
+                LOCKPROF_GIVE(occupancy->mutex);
+            } else {
+                written[i] = true;
+                saved++;
+            }
+        }
+    }
+
+    if (ret == ESP_OK && saved > 0) {
+        LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+        position.hour_start = occupancy->hour_start;
+        position.slot = occupancy->slot;
+        LOCKPROF_GIVE(occupancy->mutex);
+
+        ret = nvs_set_blob(handle, OCCUPANCY_POSITION_KEY, &position, sizeof(position));
+    }
+    if (ret == ESP_OK && saved > 0) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    // nothing of a failed save is committed, the zones written before the failure stay dirty
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+    for (int i = 0; i < occupancy->zone_count && ret != ESP_OK; i++) {
+        occupancy->zones[i].dirty |= written[i];
+    }
+    if (ret == ESP_OK) {
+        occupancy->stats.saves += saved;
+    }
+    LOCKPROF_GIVE(occupancy->mutex);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to store occupancy rollups: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void occupancy_get_stats(occupancy_t *occupancy, occupancy_stats_t *stats) {
+    if (occupancy == NULL || stats == NULL) {
+        return;
+    }
+    LOCKPROF_TAKE(occupancy->mutex, portMAX_DELAY);
+    *stats = occupancy->stats;
+    LOCKPROF_GIVE(occupancy->mutex);
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static uint16_t occupancy_slot_of(time_t time, time_t *hour_start) {
+    struct tm local;
+    localtime_r(&time, &local);
+    *hour_start = time - local.tm_min * 60 - local.tm_sec;
+    return local.tm_wday * 24 + local.tm_hour;
+}
+
+static void occupancy_advance(occupancy_t *occupancy, time_t time) {
+    // first episode ever sets the position
+    if (occupancy->hour_start == 0) {
+        occupancy->slot = occupancy_slot_of(time, &occupancy->hour_start);
+        return;
+    }
+
+    // same hour (the common case) or a late episode: nothing to age
+    if (time < occupancy->hour_start + OCCUPANCY_HOUR_S) {
+        return;
+    }
+
+    // clear the hours passed over, they now hold week-old data
+    time_t hours = (time - occupancy->hour_start) / OCCUPANCY_HOUR_S;
+    int clear = (hours < OCCUPANCY_SLOTS) ? (int)hours : OCCUPANCY_SLOTS;
+    for (int i = 1; i <= clear; i++) {
+        uint16_t slot = (occupancy->slot + i) % OCCUPANCY_SLOTS;
+        for (int z = 0; z < occupancy->zone_count; z++) {
+            occupancy->zones[z].rollup.episodes[slot] = 0;
+            occupancy->zones[z].rollup.dwell_s[slot] = 0;
+            occupancy->zones[z].dirty = true;
+        }
+    }
+
+    occupancy->slot = occupancy_slot_of(time, &occupancy->hour_start);
+}
+
+static void occupancy_advance_now(occupancy_t *occupancy) {
+    // an unset clock reads 1970, behind the ring - age only once the clock has caught up
+    time_t now = time(NULL);
+    if (occupancy->hour_start != 0 && now >= occupancy->hour_start) {
+        occupancy_advance(occupancy, now);
+    }
+}
+
+static void occupancy_add(uint16_t *counter, uint32_t amount) {
+    uint32_t sum = *counter + amount;
+    *counter = (sum > UINT16_MAX) ? UINT16_MAX : (uint16_t)sum;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file occupancy_http.c
+ * @author Anthony Yalong
+ * @brief Occupancy rollup export implementation
+ */
+
+#include "occupancy_http.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "OCCUPANCY_HTTP";
+
+// query string limits
+#define OCCUPANCY_HTTP_QUERY_LEN    64
+#define OCCUPANCY_HTTP_ROW_MAX      64      // longest csv row or json fragment
+
+/**
+ * @brief Chunked writer state
+ */
+typedef struct {
+    httpd_req_t *req;
+    char buf[OCCUPANCY_HTTP_CHUNK_LEN];
+    size_t used;
+    esp_err_t ret;
+} occupancy_http_writer_t;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Append formatted text, flushing a chunk first if it could overflow
+ *
+ * @param writer Writer state (errors are sticky)
+ * @param fmt printf format (output must fit in OCCUPANCY_HTTP_ROW_MAX)
+ */
+static void occupancy_http_printf(occupancy_http_writer_t *writer, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Write one zone in the requested format
+ *
+ * @param writer Writer state
+ * @param name Zone name
+ * @param rollup Zone rollup
+ * @param json true for json, false for csv
+ * @param first true for the first zone of the response
+ */
+static void occupancy_http_write_zone(occupancy_http_writer_t *writer, const char *name,
+                                      const occupancy_rollup_t *rollup, bool json, bool first);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t occupancy_http_export_handler(httpd_req_t *req) {
+    occupancy_t *occupancy = (occupancy_t *)req->user_ctx;
+    char query[OCCUPANCY_HTTP_QUERY_LEN];
+    char zone[OCCUPANCY_NAME_LEN] = "";
+    char format[8] = "json";
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "zone", zone, sizeof(zone));
+        httpd_query_key_value(query, "format", format, sizeof(format));
+    }
+    bool json = strcmp(format, "json") == 0;
+    if (!json && strcmp(format, "csv") != 0) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "unknown format");
+    }
+
+    // zone names are fixed after setup, only the rollups need the lock
+    int selected = -1;
+    if (zone[0] != '\0') {
+        for (int i = 0; i < occupancy->zone_count; i++) {
+            if (strcmp(occupancy->zones[i].name, zone) == 0) {
+                selected = i;
+                break;
+            }
+        }
+        if (selected < 0) {
+            return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "unknown zone");
+        }
+    }
+
+    httpd_resp_set_type(req, json ? "application/json" : "text/csv");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    // writer and one zone copy live in static storage, the server runs one handler at a time
+    static occupancy_http_writer_t writer;
+    static occupancy_rollup_t rollup;
+    writer.req = req;
+    writer.used = 0;
+    writer.ret = ESP_OK;
+
+    occupancy_http_printf(&writer, "%s", json ? "{\"zones\":[" : "zone,day,hour,episodes,dwell_s\n");
+    bool first = true;
+    for (int i = 0; i < occupancy->zone_count && writer.ret == ESP_OK; i++) {
+        if (selected >= 0 && i != selected) {
+            continue;
+        }
+        // ages the ring to the clock first, so idle hours export as zero
+        occupancy_get_rollup(occupancy, i, &rollup);
+        occupancy_http_write_zone(&writer, occupancy->zones[i].name, &rollup, json, first);
+        first = false;
+    }
+    if (json) {
+        occupancy_http_printf(&writer, "]}\n");
+    }
+
+    if (writer.ret == ESP_OK && writer.used > 0) {
+        writer.ret = httpd_resp_send_chunk(req, writer.buf, writer.used);
+    }
+    if (writer.ret == ESP_OK) {
+        writer.ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (writer.ret != ESP_OK) {
+        ESP_LOGW(TAG, "export aborted (client gone)");
+    }
+    return writer.ret;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void occupancy_http_printf(occupancy_http_writer_t *writer, const char *fmt, ...) {
+    if (writer->ret != ESP_OK) {
+        return;
+    }
+
+    if (writer->used + OCCUPANCY_HTTP_ROW_MAX > sizeof(writer->buf)) {
+        writer->ret = httpd_resp_send_chunk(writer->req, writer->buf, writer->used);
+        writer->used = 0;
+        if (writer->ret != ESP_OK) {
+            return;
+        }
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    writer->used += vsnprintf(writer->buf + writer->used, sizeof(writer->buf) - writer->used, fmt, args);
+    va_end(args);
+}
+
+static void occupancy_http_write_zone(occupancy_http_writer_t *writer, const char *name,
+                                      const occupancy_rollup_t *rollup, bool json, bool first) {
+    if (!json) {
+        for (int slot = 0; slot < OCCUPANCY_SLOTS; slot++) {
+            occupancy_http_printf(writer, "%s,%d,%d,%u,%u\n", name, slot / 24, slot % 24,
+                                  rollup->episodes[slot], rollup->dwell_s[slot]);
+        }
+        return;
+    }
+
+    occupancy_http_printf(writer, "%s{\"zone\":\"%s\",\"episodes\":[", first ? "" : ",", name);
+    for (int slot = 0; slot < OCCUPANCY_SLOTS; slot++) {
+        occupancy_http_printf(writer, "%s%u", slot ? "," : "", rollup->episodes[slot]);
+    }
+    occupancy_http_printf(writer, "],\"dwell_s\":[");
+    for (int slot = 0; slot < OCCUPANCY_SLOTS; slot++) {
+        occupancy_http_printf(writer, "%s%u", slot ? "," : "", rollup->dwell_s[slot]);
+    }
+    occupancy_http_printf(writer, "]}");
+}
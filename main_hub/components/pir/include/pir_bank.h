@@ -0,0 +1,102 @@
+/**
+ * @file pir_bank.h
+ * @author Anthony Yalong
+ * @brief Interrupt-driven bank of PIR sensors with bit-parallel debouncing
+ */
+
+#ifndef PIR_BANK_H
+#define PIR_BANK_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// configuration
+#define PIR_BANK_MAX_PINS           32    // one 32-bit input register (GPIO 0-31)
+#define PIR_BANK_DEBOUNCE_SAMPLES   4     // consecutive samples needed to accept a change
+#define PIR_BANK_EVENT_QUEUE_LEN    16
+#define PIR_BANK_TASK_STACK_SIZE    3072
+#define PIR_BANK_TASK_PRIORITY      5
+
+// pir bank edge event
+typedef struct {
+    gpio_num_t pin;            // gpio pin that changed
+    bool rising;               // true = LOW->HIGH (motion), false = HIGH->LOW
+    int64_t timestamp_us;      // time of the debounce pass that accepted the edge
+} pir_bank_event_t;
+
+// pir bank structure
+typedef struct {
+    uint32_t pin_mask;         // bank pins as a GPIO_IN bit mask
+    uint32_t state;            // debounced levels, one bit per pin
+    uint32_t cnt0;             // vertical counter bit 0, one bit per pin
+    uint32_t cnt1;             // vertical counter bit 1, one bit per pin
+    uint32_t sample_period_ms; // time between debounce passes while unstable
+    uint32_t motion_count;     // total debounced rising edges across the bank
+    QueueHandle_t event_queue; // pir_bank_event_t queue
+    TaskHandle_t task;         // debounce task woken by the shared isr
+} pir_bank_t;
+
+/**
+ * @brief Initialize a PIR bank and start its debounce task
+ *
+ * Configures all pins as inputs with any-edge interrupts routed to a single
+ * shared ISR. The ISR only wakes the debounce task, which samples the whole
+ * input register once per pass until every pin is stable again. A failure
+ * part way through removes the handlers, task and queue already set up.
+ *
+ * @param bank Pointer to PIR bank structure
+ * @param pins Array of GPIO pins (GPIO 0-31)
+ * @param count Number of pins (1-PIR_BANK_MAX_PINS)
+ * @param debounce_ms Debounce interval in milliseconds, split across PIR_BANK_DEBOUNCE_SAMPLES passes
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad parameters,
+ *                   ESP_ERR_NO_MEM if the queue or task cannot be created
+ */
+esp_err_t pir_bank_init(pir_bank_t *bank, const gpio_num_t *pins, size_t count, uint32_t debounce_ms);
+
+/**
+ * @brief Run one bit-parallel debounce pass over all bank pins
+ *
+ * Uses 2-bit vertical counters: a pin's debounced state toggles only after
+ * PIR_BANK_DEBOUNCE_SAMPLES consecutive samples differ from it. Cost is a
+ * handful of word operations regardless of the number of pins.
+ *
+ * @param bank Pointer to PIR bank structure
+ * @param sample Raw input levels (GPIO_IN register value)
+ * @return uint32_t Mask of pins whose debounced state toggled in this pass
+ */
+uint32_t pir_bank_debounce(pir_bank_t *bank, uint32_t sample);
+
+/**
+ * @brief Wait for the next debounced edge event
+ *
+ * @param bank Pointer to PIR bank structure
+ * @param event Output event
+ * @param timeout Ticks to wait
+ * @return true if an event was received, false on timeout
+ */
+bool pir_bank_receive(pir_bank_t *bank, pir_bank_event_t *event, TickType_t timeout);
+
+/**
+ * @brief Get debounced levels of all bank pins
+ *
+ * @param bank Pointer to PIR bank structure
+ * @return uint32_t Bit mask of pins currently HIGH (motion)
+ */
+uint32_t pir_bank_get_state(const pir_bank_t *bank);
+
+/**
+ * @brief Get total number of debounced motion events across the bank
+ *
+ * @param bank Pointer to PIR bank structure
+ * @return uint32_t Total rising edges since initialization
+ */
+uint32_t pir_bank_get_motion_count(const pir_bank_t *bank);
+
+#endif  // PIR_BANK_H
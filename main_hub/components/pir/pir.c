@@ -11,6 +11,15 @@
 
 static const char *TAG = "PIR";
 
+/**
+ * @brief Edge detection and debounce on one sampled level
+ *
+ * @param pir Pointer to PIR sensor structure
+ * @param current_time Sample time (microseconds)
+ * @param current_state Sampled output level
+ */
+static void pir_update_level(pir_sensor_t *pir, int64_t current_time, bool current_state);
+
 esp_err_t pir_init(pir_sensor_t *pir, gpio_num_t pin, uint32_t debounce_time) {
     // logging
     esp_err_t ret;
@@ -41,6 +50,11 @@ esp_err_t pir_init(pir_sensor_t *pir, gpio_num_t pin, uint32_t debounce_time) {
     pir->motion_count = 0;
     pir->debounce_ms = debounce_time;
     pir->last_trigger_time = 0;
+    pir->hold_ms = PIR_DEFAULT_HOLD_TIME_MS;
+    pir->in_episode = false;
+    pir->episode_start_time = 0;
+    pir->last_motion_time = 0;
+    pir->retrigger_count = 0;
 
     ESP_LOGI(TAG, "pir initialized");
     return ESP_OK;
@@ -54,26 +68,19 @@ bool pir_read(pir_sensor_t *pir) {
 
     // read current state
     bool current_state = gpio_get_level(pir->pin_num);
-    int64_t current_time = esp_timer_get_time();
-
-    // detect rising edge (LOW -> HIGH)
-    if (current_state && !pir->last_state) {
-        // debounce timing
-        int64_t time_diff_ms = (current_time - pir->last_trigger_time) / 1000;
-        
-        if (time_diff_ms >= pir->debounce_ms) {
-            pir->motion_count++;
-            pir->last_trigger_time = current_time;
-            ESP_LOGD(TAG, "motion detected! count: %lu", pir->motion_count);
-        }
-    }
-
-    // update last state
-    pir->last_state = current_state;
+    pir_update_level(pir, esp_timer_get_time(), current_state);
 
     return current_state;
 }
 
+bool pir_get_level(const pir_sensor_t *pir) {
+    if (pir == NULL) {
+        ESP_LOGE(TAG, "pir pointer is NULL");
+        return false;
+    }
+    return gpio_get_level(pir->pin_num);
+}
+
 uint32_t pir_get_motion_count(const pir_sensor_t *pir) {
     if (pir == NULL) {
         ESP_LOGE(TAG, "pir pointer is NULL");
@@ -82,9 +89,93 @@ uint32_t pir_get_motion_count(const pir_sensor_t *pir) {
     return pir->motion_count;
 }
 
+void pir_set_hold_time(pir_sensor_t *pir, uint32_t hold_time) {
+    if (pir != NULL) {
+        pir->hold_ms = hold_time;
+    }
+}
+
+pir_episode_type_t pir_poll_episode(pir_sensor_t *pir, pir_episode_t *episode) {
+    if (pir == NULL || episode == NULL) {
+        ESP_LOGE(TAG, "pir or episode pointer is NULL");
+        return PIR_EPISODE_NONE;
+    }
+
+    return pir_update_episode(pir, esp_timer_get_time(), gpio_get_level(pir->pin_num), episode);
+}
+
+pir_episode_type_t pir_update_episode(pir_sensor_t *pir, int64_t current_time, bool motion, pir_episode_t *episode) {
+    if (pir == NULL || episode == NULL) {
+        ESP_LOGE(TAG, "pir or episode pointer is NULL");
+        return PIR_EPISODE_NONE;
+    }
+
+    // debounced rising edge shows up as a motion_count change
+    uint32_t count_before = pir->motion_count;
+    pir_update_level(pir, current_time, motion);
+    bool new_trigger = pir->motion_count != count_before;
+
+    if (motion) {
+        pir->last_motion_time = current_time;
+    }
+
+    // quiet -> motion: open episode
+    if (!pir->in_episode) {
+        if (!new_trigger) {
+            return PIR_EPISODE_NONE;
+        }
+        pir->in_episode = true;
+        pir->episode_start_time = current_time;
+        pir->retrigger_count = 0;
+
+        episode->type = PIR_EPISODE_START;
+        episode->start_time_us = current_time;
+        episode->duration_us = 0;
+        episode->retrigger_count = 0;
+        ESP_LOGD(TAG, "episode start");
+        return PIR_EPISODE_START;
+    }
+
+    // retriggers extend the open episode
+    if (new_trigger) {
+        pir->retrigger_count++;
+    }
+
+    // output LOW for the hold time: close episode
+    int64_t quiet_ms = (current_time - pir->last_motion_time) / 1000;
+    if (motion || quiet_ms < pir->hold_ms) {
+        return PIR_EPISODE_NONE;
+    }
+    pir->in_episode = false;
+
+    episode->type = PIR_EPISODE_END;
+    episode->start_time_us = pir->episode_start_time;
+    episode->duration_us = pir->last_motion_time - pir->episode_start_time;
+    episode->retrigger_count = pir->retrigger_count;
+    ESP_LOGD(TAG, "episode end: %lld ms, %lu retriggers", episode->duration_us / 1000, pir->retrigger_count);
+    return PIR_EPISODE_END;
+}
+
 void pir_reset_motion_count(pir_sensor_t *pir) {
     if (pir != NULL) {
         pir->motion_count = 0;
         ESP_LOGI(TAG, "Motion count reset");
     }
-}
\ No newline at end of file
+}
+
+static void pir_update_level(pir_sensor_t *pir, int64_t current_time, bool current_state) {
+    // detect rising edge (LOW -> HIGH)
+    if (current_state && !pir->last_state) {
+        // debounce timing
+        int64_t time_diff_ms = (current_time - pir->last_trigger_time) / 1000;
+        
+        if (time_diff_ms >= pir->debounce_ms) {
+            pir->motion_count++;
+            pir->last_trigger_time = current_time;
+            ESP_LOGD(TAG, "motion detected! count: %lu", pir->motion_count);
+        }
+    }
+
+    // update last state
+    pir->last_state = current_state;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file pir_bank.c
+ * @author Anthony Yalong
+ * @brief Interrupt-driven PIR bank implementation
+ */
+
+#include "pir_bank.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+static const char *TAG = "PIR_BANK";
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Shared GPIO ISR for all bank pins - wakes the debounce task
+ *
+ * @param arg Pointer to PIR bank structure
+ */
+static void pir_bank_isr(void *arg);
+
+/**
+ * @brief Debounce task - runs passes while any pin is unstable, then sleeps
+ *
+ * @param pvParameters Pointer to PIR bank structure
+ */
+static void pir_bank_task(void *pvParameters);
+
+/**
+ * @brief Undo a partial initialization - removes the first added ISR
+ *        handlers, deletes the debounce task and frees the event queue
+ *
+ * @param bank Pointer to PIR bank structure
+ * @param pins Bank pins, in the order their handlers were added
+ * @param added Number of handlers added before the failure
+ */
+static void pir_bank_release(pir_bank_t *bank, const gpio_num_t *pins, size_t added);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t pir_bank_init(pir_bank_t *bank, const gpio_num_t *pins, size_t count, uint32_t debounce_ms) {
+    // error management
+    esp_err_t ret;
+
+    // parameter check
+    if (bank == NULL || pins == NULL || count == 0 || count > PIR_BANK_MAX_PINS) {
+        ESP_LOGE(TAG, "invalid pir bank parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // build pin mask (single 32-bit input register)
+    uint32_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (pins[i] < 0 || pins[i] >= PIR_BANK_MAX_PINS) {
+            ESP_LOGE(TAG, "gpio %d outside input register 0", pins[i]);
+            return ESP_ERR_INVALID_ARG;
+        }
+        mask |= (1UL << pins[i]);
+    }
+
+    // configure gpio
+    gpio_config_t bank_config = {
+        .pin_bit_mask = mask,
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_ANYEDGE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE
+    };
+    ret = gpio_config(&bank_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to config pir bank gpio");
+        return ret;
+    }
+
+    // initialize bank structure
+    bank->pin_mask = mask;
+    bank->state = REG_READ(GPIO_IN_REG) & mask;
+    bank->cnt0 = UINT32_MAX;
+    bank->cnt1 = UINT32_MAX;
+    bank->sample_period_ms = debounce_ms / PIR_BANK_DEBOUNCE_SAMPLES;
+    if (bank->sample_period_ms == 0) {
+        bank->sample_period_ms = 1;
+    }
+    bank->motion_count = 0;
+    bank->event_queue = xQueueCreate(PIR_BANK_EVENT_QUEUE_LEN, sizeof(pir_bank_event_t));
+    if (bank->event_queue == NULL) {
+        ESP_LOGE(TAG, "failed to create event queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // debounce task must exist before the isr can notify it
+    if (xTaskCreate(pir_bank_task, "pir_bank_task", PIR_BANK_TASK_STACK_SIZE, bank,
+                    PIR_BANK_TASK_PRIORITY, &bank->task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create debounce task");
+        vQueueDelete(bank->event_queue);
+        bank->event_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // one isr shared by every pin (service may already be installed by another driver);
+    // iram so edges are still taken while flash is being written
+    ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "failed to install gpio isr service");
+        pir_bank_release(bank, pins, 0);
+        return ret;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ret = gpio_isr_handler_add(pins[i], pir_bank_isr, bank);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to add isr for gpio %d", pins[i]);
+            pir_bank_release(bank, pins, i);
+            return ret;
+        }
+    }
+
+    ESP_LOGI(TAG, "pir bank initialized (%d pins, mask 0x%08lx)", (int)count, mask);
+    return ESP_OK;
+}
+
+uint32_t pir_bank_debounce(pir_bank_t *bank, uint32_t sample) {
+    // pins whose raw level disagrees with the debounced state
+    uint32_t delta = (sample ^ bank->state) & bank->pin_mask;
+
+    // 2-bit vertical counters: reset to 3 where delta == 0, count down where delta == 1
+    bank->cnt0 = ~(bank->cnt0 & delta);
+    bank->cnt1 = bank->cnt0 ^ (bank->cnt1 & delta);
+
+    // counter wrapped (4 consecutive differing samples) -> accept change
+    uint32_t toggled = delta & bank->cnt0 & bank->cnt1;
+    bank->state ^= toggled;
+
+    return toggled;
+}
+
+bool pir_bank_receive(pir_bank_t *bank, pir_bank_event_t *event, TickType_t timeout) {
+    if (bank == NULL || event == NULL) {
+        ESP_LOGE(TAG, "pir bank or event pointer is NULL");
+        return false;
+    }
+    return xQueueReceive(bank->event_queue, event, timeout) == pdTRUE;
+}
+
+uint32_t pir_bank_get_state(const pir_bank_t *bank) {
+    if (bank == NULL) {
+        ESP_LOGE(TAG, "pir bank pointer is NULL");
+        return 0;
+    }
+    return bank->state;
+}
+
+uint32_t pir_bank_get_motion_count(const pir_bank_t *bank) {
+    if (bank == NULL) {
+        ESP_LOGE(TAG, "pir bank pointer is NULL");
+        return 0;
+    }
+    return bank->motion_count;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void IRAM_ATTR pir_bank_isr(void *arg) {
+    pir_bank_t *bank = (pir_bank_t *)arg;
+    BaseType_t higher_priority_woken = pdFALSE;
+
+    // any number of simultaneous edges collapses into one wake-up
+    vTaskNotifyGiveFromISR(bank->task, &higher_priority_woken);
+    portYIELD_FROM_ISR(higher_priority_woken);
+}
+
+static void pir_bank_task(void *pvParameters) {
+    pir_bank_t *bank = (pir_bank_t *)pvParameters;
+
+    // at least one tick between passes so a debounce interval never collapses to zero
+    TickType_t sample_delay = pdMS_TO_TICKS(bank->sample_period_ms);
+    if (sample_delay == 0) {
+        sample_delay = 1;
+    }
+
+    while (1) {
+        // idle until any bank pin changes
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t unstable;
+        do {
+            // one register read and one timestamp per pass for all pins
+            uint32_t sample = REG_READ(GPIO_IN_REG);
+            int64_t now = esp_timer_get_time();
+            uint32_t toggled = pir_bank_debounce(bank, sample);
+
+            // emit one event per accepted edge
+            while (toggled) {
+                int pin = __builtin_ctz(toggled);
+                toggled &= toggled - 1;
+
+                pir_bank_event_t event = {
+                    .pin = (gpio_num_t)pin,
+                    .rising = (bank->state >> pin) & 1,
+                    .timestamp_us = now,
+                };
+                if (event.rising) {
+                    bank->motion_count++;
+                }
+                if (xQueueSend(bank->event_queue, &event, 0) != pdTRUE) {
+                    ESP_LOGW(TAG, "event queue full, dropped gpio %d edge", pin);
+                }
+            }
+
+            // keep sampling while any pin disagrees with its debounced state
+            unstable = (sample ^ bank->state) & bank->pin_mask;
+            if (unstable) {
+                vTaskDelay(sample_delay);
+            }
+        } while (unstable);
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void pir_bank_release(pir_bank_t *bank, const gpio_num_t *pins, size_t added) {
+    for (size_t i = 0; i < added; i++) {
+        gpio_isr_handler_remove(pins[i]);
+    }
+
+    // edges on the configured pins no longer reach anything
+    for (uint32_t mask = bank->pin_mask; mask; mask &= mask - 1) {
+        gpio_intr_disable((gpio_num_t)__builtin_ctz(mask));
+    }
+
+    vTaskDelete(bank->task);
+    bank->task = NULL;
+    vQueueDelete(bank->event_queue);
+    bank->event_queue = NULL;
+}
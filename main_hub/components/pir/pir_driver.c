@@ -0,0 +1,72 @@
+/**
+ * @file pir_driver.c
+ * @author Anthony Yalong
+ * @brief PIR sensor interface for the sensor registry
+ */
+
+#include "pir.h"
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Initialize from a pir_config_t
+ *
+ * @param sensor Pointer to PIR sensor structure
+ * @param config Pointer to pir_config_t
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG without a config
+ */
+static esp_err_t pir_driver_init(void *sensor, const void *config);
+
+/**
+ * @brief Nothing to wait for - the level is read when the sample is taken
+ *
+ * @param sensor Pointer to PIR sensor structure
+ * @param wait_us Unused
+ * @return esp_err_t ESP_OK
+ */
+static esp_err_t pir_driver_poll(void *sensor, uint32_t *wait_us);
+
+/**
+ * @brief Sample the output level
+ *
+ * @param sensor Pointer to PIR sensor structure
+ * @param sample Output sample
+ */
+static void pir_driver_get(const void *sensor, sensor_sample_t *sample);
+
+const sensor_driver_t pir_driver = {
+    .name = "pir",
+    .caps = SENSOR_CAP_LEVEL,
+    .init = pir_driver_init,
+    .start = NULL,
+    .poll = pir_driver_poll,
+    .get = pir_driver_get,
+};
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t pir_driver_init(void *sensor, const void *config) {
+    // error management
+    esp_err_t ret;
+
+    const pir_config_t *pir_config = (const pir_config_t *)config;
+    if (pir_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ret = pir_init((pir_sensor_t *)sensor, pir_config->pin, pir_config->debounce_ms);
+    if (ret == ESP_OK) {
+        pir_set_hold_time((pir_sensor_t *)sensor, pir_config->hold_ms);
+    }
+    return ret;
+}
+
+static esp_err_t pir_driver_poll(void *sensor, uint32_t *wait_us) {
+    return ESP_OK;
+}
+
+static void pir_driver_get(const void *sensor, sensor_sample_t *sample) {
+    sample->level = pir_get_level((const pir_sensor_t *)sensor);
+}
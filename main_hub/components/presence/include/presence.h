@@ -0,0 +1,186 @@
+/**
+ * @file presence.h
+ * @author Anthony Yalong
+ * @brief Passive BLE presence engine - resolves known devices from
+ *        advertisements and tracks present/away with RSSI hysteresis
+ */
+#ifndef PRESENCE_H
+#define PRESENCE_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "mbedtls/aes.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// configuration
+#define PRESENCE_MAX_DEVICES        16
+#define PRESENCE_NAME_LEN           16
+#define PRESENCE_CACHE_SETS         64      // address -> device cache sets, power of two
+#define PRESENCE_CACHE_WAYS         2       // entries per set, way 0 most recent
+#define PRESENCE_RSSI_SHIFT         3       // rssi ema weight 1/8
+#define PRESENCE_CHECK_PERIOD_MS    1000    // away timeout check
+
+/**
+ * @brief Known device identity (persisted in NVS)
+ *
+ * Byte order matches NimBLE: addresses and keys little endian.
+ */
+typedef struct {
+    char name[PRESENCE_NAME_LEN];
+    uint8_t addr[6];            // identity (public or static random) address
+    uint8_t irk[16];            // identity resolving key
+    bool has_irk;               // false: match the identity address only
+} presence_identity_t;
+
+/**
+ * @brief Presence event types
+ */
+typedef enum {
+    PRESENCE_EVENT_ARRIVED = 0,
+    PRESENCE_EVENT_LEFT,
+} presence_event_type_t;
+
+/**
+ * @brief Presence event
+ */
+typedef struct {
+    presence_event_type_t type;
+    uint8_t index;              // device index
+    const char *name;
+    int8_t rssi;                // smoothed rssi at the transition (dBm)
+    uint8_t present_count;      // devices present after this event
+} presence_event_t;
+
+/**
+ * @brief Event callback - runs in the ble host or esp_timer task with the
+ *        engine locked, must not call back into presence
+ */
+typedef void (*presence_event_cb_t)(const presence_event_t *event, void *arg);
+
+/**
+ * @brief Resolution statistics
+ */
+typedef struct {
+    uint32_t adverts;           // observations
+    uint32_t cache_hits;
+    uint32_t aes_ops;           // ah() evaluations on cache misses
+    uint32_t matches;           // adverts from known devices
+    uint64_t resolve_cycles;    // cpu cycles spent identifying senders
+} presence_stats_t;
+
+/**
+ * @brief Per-device tracking state
+ */
+typedef struct {
+    presence_identity_t id;
+    mbedtls_aes_context aes;    // irk key schedule, expanded once
+    int32_t rssi_ema;           // smoothed rssi, dBm * 16
+    bool seen;                  // ema seeded
+    bool present;
+    int64_t last_seen_us;
+} presence_device_t;
+
+/**
+ * @brief Address cache entry
+ */
+typedef struct {
+    uint8_t addr[6];
+    int8_t index;               // device index, -1 for a known stranger
+    bool valid;
+} presence_cache_entry_t;
+
+/**
+ * @brief Presence engine structure
+ */
+typedef struct {
+    presence_device_t devices[PRESENCE_MAX_DEVICES];
+    uint8_t count;
+    uint8_t present_count;
+    int8_t enter_rssi;
+    int8_t exit_rssi;
+    uint32_t away_timeout_ms;
+
+    presence_cache_entry_t cache[PRESENCE_CACHE_SETS][PRESENCE_CACHE_WAYS];
+    presence_event_cb_t callback;
+    void *callback_arg;
+    SemaphoreHandle_t mutex;
+    esp_timer_handle_t timer;
+    presence_stats_t stats;
+} presence_t;
+
+/**
+ * @brief Initialize the presence engine (no devices)
+ *
+ * @param presence Pointer to presence structure
+ * @param enter_rssi Smoothed RSSI at or above which a device becomes present (dBm)
+ * @param exit_rssi Smoothed RSSI below which a present device leaves (dBm, < enter_rssi)
+ * @param away_timeout_ms Time without adverts after which a device leaves
+ * @param callback Arrival/departure callback (can be NULL)
+ * @param arg User argument for callback
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad thresholds,
+ *                   ESP_ERR_NO_MEM if the mutex could not be created
+ */
+esp_err_t presence_init(presence_t *presence, int8_t enter_rssi, int8_t exit_rssi, uint32_t away_timeout_ms,
+                        presence_event_cb_t callback, void *arg);
+
+/**
+ * @brief Add a known device
+ *
+ * @param presence Pointer to presence structure
+ * @param identity Device identity
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t presence_add_device(presence_t *presence, const presence_identity_t *identity);
+
+/**
+ * @brief Add every device stored in NVS
+ *
+ * @param presence Pointer to presence structure
+ * @return esp_err_t ESP_OK on success (also with nothing stored), NVS error otherwise
+ */
+esp_err_t presence_load(presence_t *presence);
+
+/**
+ * @brief Store the current device table in NVS
+ *
+ * @param presence Pointer to presence structure
+ * @return esp_err_t ESP_OK on success, NVS error otherwise
+ */
+esp_err_t presence_save(presence_t *presence);
+
+/**
+ * @brief Start the periodic away timeout check
+ *
+ * @param presence Pointer to presence structure
+ * @return esp_err_t ESP_OK on success, error code otherwise
+ */
+esp_err_t presence_start(presence_t *presence);
+
+/**
+ * @brief Feed one advertisement
+ *
+ * Identity addresses are compared directly; resolvable private addresses
+ * are tried against each IRK. Either way the result is cached per address,
+ * so a device is resolved once per address rotation rather than per advert.
+ *
+ * @param presence Pointer to presence structure
+ * @param random_addr true for a random address (static, resolvable or non-resolvable)
+ * @param addr Advertiser address, little endian
+ * @param rssi Advert RSSI (dBm)
+ * @return int Device index, -1 if not a known device
+ */
+int presence_observe(presence_t *presence, bool random_addr, const uint8_t *addr, int8_t rssi);
+
+/**
+ * @brief Get resolution statistics
+ *
+ * @param presence Pointer to presence structure
+ * @param stats Output statistics
+ */
+void presence_get_stats(presence_t *presence, presence_stats_t *stats);
+
+#endif  // PRESENCE_H
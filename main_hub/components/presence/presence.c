@@ -0,0 +1,430 @@
+/**
+ * @file presence.c
+ * @author Anthony Yalong
+ * @brief Passive BLE presence engine implementation
+ */
+
+#include "presence.h"
+#include <string.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "lockprof.h"
+#include "nvs.h"
+
+static const char *TAG = "PRESENCE";
+
+// nvs layout
+#define PRESENCE_NAMESPACE          "presence"
+#define PRESENCE_DEVICES_KEY        "devices"
+
+// smoothed rssi fixed point (dBm * 16)
+#define PRESENCE_RSSI_SCALE         16
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Identify the sender of an address (cache miss path)
+ *
+ * @param presence Pointer to presence structure
+ * @param random_addr Address is random
+ * @param addr Address, little endian
+ * @return int Device index, -1 if unknown
+ */
+static int presence_identify(presence_t *presence, bool random_addr, const uint8_t *addr);
+
+/**
+ * @brief Check a resolvable private address against one IRK
+ *
+ * ah(k, prand) = e(k, 0^104 || prand) mod 2^24 (Core Vol 3 Part H 2.2.2).
+ *
+ * @param aes Expanded IRK
+ * @param addr Resolvable private address, little endian
+ * @return bool true if the hash part matches
+ */
+static bool presence_rpa_matches(mbedtls_aes_context *aes, const uint8_t *addr);
+
+/**
+ * @brief Cache set for an address
+ *
+ * @param addr Address
+ * @return uint32_t Set index
+ */
+static uint32_t presence_cache_set(const uint8_t *addr);
+
+/**
+ * @brief Update smoothed rssi and present/away state of one device
+ *
+ * @param presence Pointer to presence structure
+ * @param index Device index
+ * @param rssi Advert rssi
+ * @param now_us Observation time
+ */
+static void presence_track(presence_t *presence, int index, int8_t rssi, int64_t now_us);
+
+/**
+ * @brief Mark a device away and notify
+ *
+ * @param presence Pointer to presence structure
+ * @param index Device index
+ */
+static void presence_leave(presence_t *presence, int index);
+
+/**
+ * @brief Notify the callback of a transition
+ *
+ * @param presence Pointer to presence structure
+ * @param type Event type
+ * @param index Device index
+ */
+static void presence_notify(presence_t *presence, presence_event_type_t type, int index);
+
+/**
+ * @brief Periodic timer callback - devices not heard from in time leave
+ *
+ * @param arg Pointer to presence structure
+ */
+static void presence_check_timeouts(void *arg);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t presence_init(presence_t *presence, int8_t enter_rssi, int8_t exit_rssi, uint32_t away_timeout_ms,
+                        presence_event_cb_t callback, void *arg) {
+    // sanity check
+    if (presence == NULL || exit_rssi >= enter_rssi || away_timeout_ms == 0) {
+        ESP_LOGE(TAG, "invalid presence parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(presence, 0, sizeof(*presence));
+    presence->enter_rssi = enter_rssi;
+    presence->exit_rssi = exit_rssi;
+    presence->away_timeout_ms = away_timeout_ms;
+    presence->callback = callback;
+    presence->callback_arg = arg;
+
+    presence->mutex = xSemaphoreCreateMutex();
+    if (presence->mutex == NULL) {
+        ESP_LOGE(TAG, "failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    LOCKPROF_REGISTER(presence->mutex, "presence", LOCKPROF_MUTEX);
+
+    return ESP_OK;
+}
+
+esp_err_t presence_add_device(presence_t *presence, const presence_identity_t *identity) {
+    // sanity check
+    if (presence == NULL || identity == NULL) {
+        ESP_LOGE(TAG, "presence or identity pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    LOCKPROF_TAKE(presence->mutex, portMAX_DELAY);
+    if (presence->count >= PRESENCE_MAX_DEVICES) {
+        LOCKPROF_GIVE(presence->mutex);
+        ESP_LOGE(TAG, "device table full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    presence_device_t *device = &presence->devices[presence->count];
+    memset(device, 0, sizeof(*device));
+    device->id = *identity;
+    device->id.name[PRESENCE_NAME_LEN - 1] = '\0';
+
+    // expand the key schedule once; mbedtls wants the key big endian
+    if (identity->has_irk) {
+        uint8_t key[16];
+        for (int i = 0; i < 16; i++) {
+            key[i] = identity->irk[15 - i];
+        }
+        mbedtls_aes_init(&device->aes);
+        mbedtls_aes_setkey_enc(&device->aes, key, 128);
+    }
+    presence->count++;
+
+    // strangers cached so far may be this device
+    memset(presence->cache, 0, sizeof(presence->cache));
+    LOCKPROF_GIVE(presence->mutex);
+
+    ESP_LOGI(TAG, "added device %s (%s)", device->id.name, identity->has_irk ? "irk" : "identity address");
+    return ESP_OK;
+}
+
+esp_err_t presence_load(presence_t *presence) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (presence == NULL) {
+        ESP_LOGE(TAG, "presence pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t handle;
+    ret = nvs_open(PRESENCE_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs");
+        return ret;
+    }
+
+    static presence_identity_t identities[PRESENCE_MAX_DEVICES];
+    size_t length = sizeof(identities);
+    ret = nvs_get_blob(handle, PRESENCE_DEVICES_KEY, identities, &length);
+    nvs_close(handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to read device table");
+        return ret;
+    }
+
+    for (size_t i = 0; i < length / sizeof(presence_identity_t); i++) {
+        presence_add_device(presence, &identities[i]);
+    }
+    return ESP_OK;
+}
+
+esp_err_t presence_save(presence_t *presence) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (presence == NULL) {
+        ESP_LOGE(TAG, "presence pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    static presence_identity_t identities[PRESENCE_MAX_DEVICES];
+    LOCKPROF_TAKE(presence->mutex, portMAX_DELAY);
+    uint8_t count = presence->count;
+    for (uint8_t i = 0; i < count; i++) {
+        identities[i] = presence->devices[i].id;
+    }
+    LOCKPROF_GIVE(presence->mutex);
+
+    nvs_handle_t handle;
+    ret = nvs_open(PRESENCE_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs");
+        return ret;
+    }
+    ret = nvs_set_blob(handle, PRESENCE_DEVICES_KEY, identities, count * sizeof(presence_identity_t));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to store device table");
+    }
+    return ret;
+}
+
+esp_err_t presence_start(presence_t *presence) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (presence == NULL) {
+        ESP_LOGE(TAG, "presence pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = presence_check_timeouts,
+        .arg = presence,
+        .name = "presence",
+    };
+    ret = esp_timer_create(&timer_args, &presence->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create timeout timer");
+        return ret;
+    }
+
+    ret = esp_timer_start_periodic(presence->timer, PRESENCE_CHECK_PERIOD_MS * 1000ULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start timeout timer");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "presence engine started with %d devices", presence->count);
+    return ESP_OK;
+}
+
+int presence_observe(presence_t *presence, bool random_addr, const uint8_t *addr, int8_t rssi) {
+    if (presence == NULL || addr == NULL) {
+        return -1;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    LOCKPROF_TAKE(presence->mutex, portMAX_DELAY);
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    presence->stats.adverts++;
+
+    // adverts repeat from the same address until it rotates, so most hit here
+    int index;
+    presence_cache_entry_t *set = presence->cache[presence_cache_set(addr)];
+    if (set[0].valid && memcmp(set[0].addr, addr, 6) == 0) {
+        index = set[0].index;
+        presence->stats.cache_hits++;
+    } else if (set[1].valid && memcmp(set[1].addr, addr, 6) == 0) {
+        // keep way 0 most recently used
+        presence_cache_entry_t hit = set[1];
+        set[1] = set[0];
+        set[0] = hit;
+        index = hit.index;
+        presence->stats.cache_hits++;
+    } else {
+        // miss: evict the least recently used way
+        index = presence_identify(presence, random_addr, addr);
+        set[1] = set[0];
+        memcpy(set[0].addr, addr, 6);
+        set[0].index = (int8_t)index;
+        set[0].valid = true;
+    }
+    presence->stats.resolve_cycles += esp_cpu_get_cycle_count() - start;
+
+    if (index >= 0) {
+        presence->stats.matches++;
+        presence_track(presence, index, rssi, now_us);
+    }
+
+    LOCKPROF_GIVE(presence->mutex);
+    return index;
+}
+
+void presence_get_stats(presence_t *presence, presence_stats_t *stats) {
+    if (presence == NULL || stats == NULL) {
+        return;
+    }
+
+    LOCKPROF_TAKE(presence->mutex, portMAX_DELAY);
+    *stats = presence->stats;
+    LOCKPROF_GIVE(presence->mutex);
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static int presence_identify(presence_t *presence, bool random_addr, const uint8_t *addr) {
+    // identity addresses: public, or static random (top bits 11)
+    for (uint8_t i = 0; i < presence->count; i++) {
+        if (memcmp(presence->devices[i].id.addr, addr, 6) == 0) {
+            return i;
+        }
+    }
+
+    // resolvable private address: top bits 01
+    if (!random_addr || (addr[5] & 0xC0) != 0x40) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < presence->count; i++) {
+        if (!presence->devices[i].id.has_irk) {
+            continue;
+        }
+        presence->stats.aes_ops++;
+        if (presence_rpa_matches(&presence->devices[i].aes, addr)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool presence_rpa_matches(mbedtls_aes_context *aes, const uint8_t *addr) {
+    uint8_t block[16] = { 0 };
+    uint8_t out[16];
+
+    // prand is addr[3..5]; aes block is big endian
+    block[13] = addr[5];
+    block[14] = addr[4];
+    block[15] = addr[3];
+    mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, block, out);
+
+    // hash is addr[0..2]
+    return out[15] == addr[0] && out[14] == addr[1] && out[13] == addr[2];
+}
+
+static uint32_t presence_cache_set(const uint8_t *addr) {
+    uint32_t hash = 0;
+
+    for (int i = 0; i < 6; i++) {
+        hash = hash * 31 + addr[i];
+    }
+    return hash & (PRESENCE_CACHE_SETS - 1);
+}
+
+static void presence_track(presence_t *presence, int index, int8_t rssi, int64_t now_us) {
+    presence_device_t *device = &presence->devices[index];
+    int32_t sample = rssi * PRESENCE_RSSI_SCALE;
+
+    // exponential moving average, seeded by the first advert
+    if (!device->seen) {
+        device->rssi_ema = sample;
+        device->seen = true;
+    } else {
+        device->rssi_ema += (sample - device->rssi_ema) >> PRESENCE_RSSI_SHIFT;
+    }
+    device->last_seen_us = now_us;
+
+    // hysteresis: enter above enter_rssi, leave below exit_rssi
+    if (!device->present && device->rssi_ema >= presence->enter_rssi * PRESENCE_RSSI_SCALE) {
+        device->present = true;
+        presence->present_count++;
+        presence_notify(presence, PRESENCE_EVENT_ARRIVED, index);
+    } else if (device->present && device->rssi_ema < presence->exit_rssi * PRESENCE_RSSI_SCALE) {
+        presence_leave(presence, index);
+    }
+}
+
+static void presence_leave(presence_t *presence, int index) {
+    presence->devices[index].present = false;
+    presence->present_count--;
+    presence_notify(presence, PRESENCE_EVENT_LEFT, index);
+}
+
+static void presence_notify(presence_t *presence, presence_event_type_t type, int index) {
+    presence_device_t *device = &presence->devices[index];
+
+    ESP_LOGI(TAG, "%s %s (rssi %ld dBm, %d present)", device->id.name,
+             type == PRESENCE_EVENT_ARRIVED ? "arrived" : "left",
+             device->rssi_ema / PRESENCE_RSSI_SCALE, presence->present_count);
+
+    if (presence->callback != NULL) {
+        presence_event_t event = {
+            .type = type,
+            .index = (uint8_t)index,
+            .name = device->id.name,
+            .rssi = (int8_t)(device->rssi_ema / PRESENCE_RSSI_SCALE),
+            .present_count = presence->present_count,
+        };
+        presence->callback(&event, presence->callback_arg);
+    }
+}
+
+static void presence_check_timeouts(void *arg) {
+    presence_t *presence = (presence_t *)arg;
+    int64_t now_us = esp_timer_get_time();
+    int64_t timeout_us = presence->away_timeout_ms * 1000LL;
+
+    LOCKPROF_TAKE(presence->mutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < presence->count; i++) {
+        presence_device_t *device = &presence->devices[i];
+        if (!device->seen || now_us - device->last_seen_us < timeout_us) {
+            continue;
+        }
+
+        // silent device: reseed the ema on its next advert
+        device->seen = false;
+        if (device->present) {
+            presence_leave(presence, i);
+        }
+    }
+    LOCKPROF_GIVE(presence->mutex);
+}
@@ -0,0 +1,304 @@
+/**
+ * @file replay.h
+ * @author Anthony Yalong
+ * @brief Input record/replay - driver-level sensor inputs and the decisions
+ *        they led to, recorded compactly into a flash ring and fed back
+ *        into the unchanged hub logic to reproduce those decisions
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// configuration
+#ifndef REPLAY_MODE
+#define REPLAY_MODE                 0       // 0 off, 1 record, 2 replay instead of the sensors (idf.py -DREPLAY=1 build)
+#endif
+#define REPLAY_PARTITION_SUBTYPE    0x41    // custom data subtype (partitions.csv)
+#define REPLAY_PAGE_SIZE            4096    // one flash sector, erased before it is written
+#define REPLAY_PAGE_MAGIC           0x594c5052  // "RPLY"
+#define REPLAY_RECORD_MAX           24      // encoded record, bytes (worst case, typical 2-4)
+#define REPLAY_FIFO_LEN             4       // decisions per input, replay side
+#define REPLAY_FLUSH_MS             5000    // open page written out at least this often
+#define REPLAY_TASK_STACK           3072
+#define REPLAY_TASK_PRIORITY        1
+#define REPLAY_DIGEST_INIT          0x811c9dc5u // fnv-1a offset basis
+
+/**
+ * @brief Input streams, one per driver
+ */
+typedef enum {
+    REPLAY_PIR = 0,             // pir output level per poll
+    REPLAY_DISTANCE,            // hc-sr04 echo width or no echo
+    REPLAY_CLIMATE,             // dht11 bytes or a failed read
+    REPLAY_REMOTE,              // remote node link and motion reports
+    REPLAY_STREAM_COUNT,
+} replay_stream_t;
+
+/**
+ * @brief Record kinds
+ */
+typedef enum {
+    REPLAY_INPUT = 0,           // a driver input on its stream
+    REPLAY_DECISION,            // digest of an event the last input of its stream produced
+    REPLAY_GAP,                 // records lost on a stream (ram pages full)
+} replay_kind_t;
+
+/**
+ * @brief One record
+ */
+typedef struct {
+    replay_kind_t kind;
+    replay_stream_t stream;
+    int64_t time_us;            // input time as the hub used it (inputs only)
+    union {
+        struct {
+            bool level;
+        } pir;
+        struct {
+            bool ok;            // echo received
+            int32_t pulse_us;   // echo width
+        } distance;
+        struct {
+            bool ok;            // frame received with a good checksum
+            uint8_t humidity;   // %
+            uint8_t temperature; // C
+        } climate;
+        struct {
+            bool connected;
+            bool motion;
+        } remote;
+        uint32_t digest;        // decision
+        uint32_t lost;          // gap: records dropped
+    };
+} replay_record_t;
+
+/**
+ * @brief Delta state of the codec - reset at every page so pages decode alone
+ */
+typedef struct {
+    uint32_t period_us[REPLAY_STREAM_COUNT];    // nominal input spacing, 0 = irregular
+    int64_t last_us[REPLAY_STREAM_COUNT];       // previous input time per stream
+    int32_t last_pulse_us;
+} replay_codec_t;
+
+/**
+ * @brief Page header, at the start of every flash sector
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t sequence;          // page count since the log was first written
+    uint16_t session;           // boot count since the log was first written
+    uint8_t first;              // first page of its session
+    uint8_t reserved;
+    int64_t base_us;            // delta origin for every stream
+    uint32_t period_us[REPLAY_STREAM_COUNT];
+} replay_page_header_t;
+
+/**
+ * @brief Recording cost and volume
+ */
+typedef struct {
+    uint32_t records;           // stored
+    uint32_t dropped;           // lost while both ram pages were full
+    uint64_t bytes;             // encoded, headers included
+    uint32_t pages;             // closed
+    uint64_t record_cycles;     // cpu cycles in replay_input/replay_decision (0 on the linux target)
+    uint32_t max_record_cycles;
+    uint32_t flash_writes;
+    uint64_t flash_us;          // writer task time in erase and write
+    uint32_t max_flash_us;
+} replay_stats_t;
+
+/**
+ * @brief Replay outcome
+ */
+typedef struct {
+    uint16_t session;
+    bool truncated;             // the session's first pages were overwritten, state was not replayed from boot
+    uint32_t pages;
+    uint32_t inputs;
+    uint32_t decisions;         // recorded
+    uint32_t matched;
+    uint32_t mismatched;        // produced a different event
+    uint32_t missing;           // recorded, not produced
+    uint32_t extra;             // produced, not recorded
+    uint32_t lost;              // records the recording dropped
+    int64_t first_divergence_us; // input time of the first difference, -1 if none
+    int64_t start_us;
+    int64_t end_us;
+} replay_result_t;
+
+/**
+ * @brief Input callback - feeds one recorded input into the hub logic
+ *
+ * @param record Input record
+ * @param arg User argument
+ */
+typedef void (*replay_input_cb_t)(const replay_record_t *record, void *arg);
+
+/**
+ * @brief Page buffer in ram - recorded into, then written out by the writer task
+ */
+typedef struct {
+    uint8_t *data;              // REPLAY_PAGE_SIZE bytes, allocated when recording starts
+    uint32_t index;             // flash page
+    uint32_t fill;              // bytes encoded
+    uint32_t flushed;           // bytes written to flash
+    bool open;                  // being recorded into
+    bool busy;                  // holds data not yet written
+    replay_codec_t codec;
+} replay_page_t;
+
+/**
+ * @brief Recorder / replayer structure
+ */
+typedef struct {
+    const esp_partition_t *partition;
+    uint32_t page_count;
+    volatile int mode;          // REPLAY_MODE of the running side, 0 until started
+
+    // recording, under the spinlock
+    replay_page_t pages[2];
+    uint8_t current;            // page being recorded into
+    uint32_t next_index;        // next flash page
+    uint32_t sequence;
+    uint16_t session;
+    bool first;
+    uint32_t period_us[REPLAY_STREAM_COUNT];
+    uint32_t lost[REPLAY_STREAM_COUNT];
+    replay_stats_t stats;
+    portMUX_TYPE spinlock;
+    TaskHandle_t writer;
+
+    // replaying, in the replay task
+    uint32_t produced[REPLAY_STREAM_COUNT][REPLAY_FIFO_LEN];
+    uint8_t produced_count[REPLAY_STREAM_COUNT];
+    int64_t replayed_us[REPLAY_STREAM_COUNT];   // last input fed per stream
+    replay_result_t *result;
+} replay_t;
+
+/**
+ * @brief Start recording into the replay partition
+ *
+ * A new session starts on a fresh page after the newest one in the log;
+ * the oldest pages are erased as the ring wraps. Records go into one of
+ * two ram pages, the writer task writes them out every REPLAY_FLUSH_MS
+ * and whenever a page fills.
+ *
+ * @param replay Pointer to replay structure (must stay valid)
+ * @param period_us Nominal spacing of each stream's inputs (0 = irregular)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND without a replay
+ *                   partition, ESP_ERR_NO_MEM if the pages or the task could
+ *                   not be allocated
+ */
+esp_err_t replay_record_start(replay_t *replay, const uint32_t period_us[REPLAY_STREAM_COUNT]);
+
+/**
+ * @brief Record one driver input - call before the hub acts on it
+ *
+ * Bounded: encodes at most REPLAY_RECORD_MAX bytes into ram under a
+ * spinlock, never blocks and never touches flash. With both ram pages
+ * waiting for the writer the record is dropped and counted, and replay
+ * reports the gap. No-op unless recording.
+ *
+ * @param replay Pointer to replay structure
+ * @param record Input record (kind REPLAY_INPUT)
+ */
+void replay_input(replay_t *replay, const replay_record_t *record);
+
+/**
+ * @brief Record or check a decision - an event produced by the last input
+ *        of a stream
+ *
+ * Recording: stored after that input. Replaying: compared with the
+ * recorded one. No-op otherwise.
+ *
+ * @param replay Pointer to replay structure
+ * @param stream Stream whose input produced the event
+ * @param digest Event digest (replay_digest())
+ */
+void replay_decision(replay_t *replay, replay_stream_t stream, uint32_t digest);
+
+/**
+ * @brief Get the recording cost and volume so far
+ *
+ * @param replay Pointer to replay structure
+ * @param stats Output statistics
+ */
+void replay_get_stats(replay_t *replay, replay_stats_t *stats);
+
+/**
+ * @brief Replay a recorded session in the calling task
+ *
+ * Feeds every input of the session to the callback in recorded order and
+ * compares the decisions the hub makes (replay_decision()) with the
+ * recorded ones. Exact from a session's first page; a session whose first
+ * pages were overwritten starts from whatever state the hub is in, so its
+ * early decisions may differ until the trackers settle.
+ *
+ * @param replay Pointer to replay structure
+ * @param sessions_back 0 for the newest session in the log, 1 for the one before...
+ * @param input Input callback
+ * @param arg User argument
+ * @param result Output outcome
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND without a replay
+ *                   partition or that session, ESP_ERR_NO_MEM without memory
+ *                   for a page, error code from flash reads otherwise
+ */
+esp_err_t replay_run(replay_t *replay, int sessions_back, replay_input_cb_t input, void *arg,
+                     replay_result_t *result);
+
+/**
+ * @brief Reset the codec for a new page
+ *
+ * @param codec Codec state
+ * @param base_us Delta origin
+ * @param period_us Nominal spacing per stream
+ */
+void replay_codec_reset(replay_codec_t *codec, int64_t base_us, const uint32_t period_us[REPLAY_STREAM_COUNT]);
+
+/**
+ * @brief Encode one record
+ *
+ * Header byte (kind, stream, flags), input time as whole periods and a
+ * remainder since the stream's previous input, payload as deltas.
+ * Pure function, shared by the recorder and the benchmarks.
+ *
+ * @param codec Codec state, advanced
+ * @param record Record
+ * @param out Output bytes
+ * @return size_t Encoded length
+ */
+size_t replay_encode(replay_codec_t *codec, const replay_record_t *record, uint8_t out[REPLAY_RECORD_MAX]);
+
+/**
+ * @brief Decode one record
+ *
+ * @param codec Codec state, advanced
+ * @param data Encoded bytes
+ * @param length Bytes available
+ * @param record Output record
+ * @return size_t Bytes consumed, 0 at the end of the page's records or on
+ *                a malformed record
+ */
+size_t replay_decode(replay_codec_t *codec, const uint8_t *data, size_t length, replay_record_t *record);
+
+/**
+ * @brief Fold bytes into a decision digest (fnv-1a)
+ *
+ * @param digest Running digest, REPLAY_DIGEST_INIT to start
+ * @param data Bytes
+ * @param length Byte count
+ * @return uint32_t Updated digest
+ */
+uint32_t replay_digest(uint32_t digest, const void *data, size_t length);
+
+#endif  // REPLAY_H
@@ -0,0 +1,544 @@
+/**
+ * @file replay.c
+ * @author Anthony Yalong
+ * @brief Input record/replay implementation
+ */
+
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_cpu.h"
+#endif
+
+static const char *TAG = "REPLAY";
+
+// cost of a record call: cpu cycles on the target, the simulator's benchmarks time the host
+#if CONFIG_IDF_TARGET_LINUX
+#define REPLAY_CYCLES()         0
+#else
+#define REPLAY_CYCLES()         esp_cpu_get_cycle_count()
+#endif
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Find the replay partition and the newest page in it
+ *
+ * @param replay Pointer to replay structure
+ * @param newest Output header of the newest page (magic 0 if the log is empty)
+ * @param newest_index Output flash page of the newest page
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND without a partition,
+ *                   error code from flash reads otherwise
+ */
+static esp_err_t replay_scan(replay_t *replay, replay_page_header_t *newest, uint32_t *newest_index);
+
+/**
+ * @brief Store one record in the open ram page, moving to the other page
+ *        when it is full - spinlock held
+ *
+ * @param replay Pointer to replay structure
+ * @param record Record
+ * @param notify Set when a page was closed (wake the writer)
+ * @return bool false if both pages are waiting for the writer (dropped)
+ */
+static bool replay_store(replay_t *replay, const replay_record_t *record, bool *notify);
+
+/**
+ * @brief Open a ram page on the next flash page - spinlock held
+ *
+ * @param replay Pointer to replay structure
+ * @param page Page buffer (not busy)
+ * @param base_us Delta origin
+ */
+static void replay_open_page(replay_t *replay, replay_page_t *page, int64_t base_us);
+
+/**
+ * @brief Record an input or decision with its cost and any pending gap
+ *
+ * @param replay Pointer to replay structure
+ * @param record Record
+ */
+static void replay_append(replay_t *replay, const replay_record_t *record);
+
+/**
+ * @brief Writer task - writes the ram pages out, oldest first
+ *
+ * @param pvParameters Pointer to replay structure
+ */
+static void replay_writer_task(void *pvParameters);
+
+/**
+ * @brief Write a ram page's new bytes to flash, erasing the sector first
+ *
+ * @param replay Pointer to replay structure
+ * @param page Page buffer
+ */
+static void replay_flush(replay_t *replay, replay_page_t *page);
+
+/**
+ * @brief Replay one decoded record - feed an input or check a decision
+ *
+ * @param replay Pointer to replay structure
+ * @param record Record
+ * @param input Input callback
+ * @param arg User argument
+ */
+static void replay_apply(replay_t *replay, const replay_record_t *record, replay_input_cb_t input, void *arg);
+
+/**
+ * @brief Note a difference from the recording
+ *
+ * @param replay Pointer to replay structure
+ * @param stream Stream the difference is on
+ */
+static void replay_diverged(replay_t *replay, replay_stream_t stream);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t replay_record_start(replay_t *replay, const uint32_t period_us[REPLAY_STREAM_COUNT]) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (replay == NULL || period_us == NULL) {
+        ESP_LOGE(TAG, "replay or period pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(replay, 0, sizeof(*replay));
+    replay_page_header_t newest;
+    uint32_t newest_index;
+    ret = replay_scan(replay, &newest, &newest_index);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // new session on the page after the newest
+    if (newest.magic == REPLAY_PAGE_MAGIC) {
+        replay->next_index = (newest_index + 1) % replay->page_count;
+        replay->sequence = newest.sequence + 1;
+        replay->session = newest.session + 1;
+    }
+    replay->first = true;
+    memcpy(replay->period_us, period_us, sizeof(replay->period_us));
+    portMUX_INITIALIZE(&replay->spinlock);
+
+    for (int i = 0; i < 2; i++) {
+        replay->pages[i].data = malloc(REPLAY_PAGE_SIZE);
+        if (replay->pages[i].data == NULL) {
+            ESP_LOGE(TAG, "no memory for the page buffers");
+            free(replay->pages[0].data);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (xTaskCreate(replay_writer_task, "replay_writer", REPLAY_TASK_STACK, replay, REPLAY_TASK_PRIORITY,
+                    &replay->writer) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create writer task");
+        free(replay->pages[0].data);
+        free(replay->pages[1].data);
+        return ESP_ERR_NO_MEM;
+    }
+
+    replay->mode = 1;
+    ESP_LOGI(TAG, "recording session %u from page %lu of %lu", replay->session, replay->next_index,
+             replay->page_count);
+    return ESP_OK;
+}
+
+void replay_input(replay_t *replay, const replay_record_t *record) {
+    if (replay->mode == 1) {
+        replay_append(replay, record);
+    }
+}
+
+void replay_decision(replay_t *replay, replay_stream_t stream, uint32_t digest) {
+    if (replay->mode == 1) {
+        replay_record_t record = {
+            .kind = REPLAY_DECISION,
+            .stream = stream,
+            .digest = digest,
+        };
+        replay_append(replay, &record);
+    } else if (replay->mode == 2) {
+        // compared when the recorded decision comes up
+        if (replay->produced_count[stream] < REPLAY_FIFO_LEN) {
+            replay->produced[stream][replay->produced_count[stream]++] = digest;
+        } else {
+            replay->result->extra++;
+            replay_diverged(replay, stream);
+        }
+    }
+}
+
+void replay_get_stats(replay_t *replay, replay_stats_t *stats) {
+    portENTER_CRITICAL(&replay->spinlock);
+    *stats = replay->stats;
+    portEXIT_CRITICAL(&replay->spinlock);
+}
+
+esp_err_t replay_run(replay_t *replay, int sessions_back, replay_input_cb_t input, void *arg,
+                     replay_result_t *result) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (replay == NULL || input == NULL || result == NULL || sessions_back < 0) {
+        ESP_LOGE(TAG, "replay, callback or result pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(replay, 0, sizeof(*replay));
+    replay_page_header_t newest;
+    uint32_t newest_index;
+    ret = replay_scan(replay, &newest, &newest_index);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (newest.magic != REPLAY_PAGE_MAGIC) {
+        ESP_LOGE(TAG, "nothing recorded");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // the session's oldest surviving page
+    uint16_t session = newest.session - sessions_back;
+    replay_page_header_t header;
+    replay_page_header_t start = { 0 };
+    uint32_t start_index = 0;
+    for (uint32_t i = 0; i < replay->page_count; i++) {
+        ret = esp_partition_read(replay->partition, i * REPLAY_PAGE_SIZE, &header, sizeof(header));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (header.magic == REPLAY_PAGE_MAGIC && header.session == session &&
+            (start.magic != REPLAY_PAGE_MAGIC || header.sequence < start.sequence)) {
+            start = header;
+            start_index = i;
+        }
+    }
+    if (start.magic != REPLAY_PAGE_MAGIC) {
+        ESP_LOGE(TAG, "session %u not in the log", session);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t *data = malloc(REPLAY_PAGE_SIZE);
+    if (data == NULL) {
+        ESP_LOGE(TAG, "no memory for a page");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->session = session;
+    result->truncated = !start.first;
+    result->first_divergence_us = -1;
+    replay->result = result;
+    replay->mode = 2;
+    ESP_LOGI(TAG, "replaying session %u%s", session, result->truncated ? " (oldest pages overwritten)" : "");
+
+    // pages follow each other in the ring until the session or the sequence breaks
+    uint32_t index = start_index;
+    uint32_t sequence = start.sequence;
+    do {
+        ret = esp_partition_read(replay->partition, index * REPLAY_PAGE_SIZE, data, REPLAY_PAGE_SIZE);
+        if (ret != ESP_OK) {
+            break;
+        }
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != REPLAY_PAGE_MAGIC || header.session != session || header.sequence != sequence) {
+            break;
+        }
+
+        // copied out of the packed header, the codec reads them as aligned words
+        replay_codec_t codec;
+        uint32_t period_us[REPLAY_STREAM_COUNT];
+        memcpy(period_us, header.period_us, sizeof(period_us));
+        replay_codec_reset(&codec, header.base_us, period_us);
+        replay_record_t record;
+        size_t offset = sizeof(header);
+        size_t used;
+        while ((used = replay_decode(&codec, data + offset, REPLAY_PAGE_SIZE - offset, &record)) > 0) {
+            offset += used;
+            replay_apply(replay, &record, input, arg);
+        }
+        result->pages++;
+
+        // a tick per page keeps the idle task (and its watchdog) running
+        vTaskDelay(1);
+        index = (index + 1) % replay->page_count;
+        sequence++;
+    } while (index != start_index);
+
+    // decisions produced after the last recorded one
+    for (int i = 0; i < REPLAY_STREAM_COUNT; i++) {
+        if (replay->produced_count[i] > 0) {
+            result->extra += replay->produced_count[i];
+            replay_diverged(replay, i);
+        }
+    }
+
+    replay->mode = 0;
+    free(data);
+    return ret;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t replay_scan(replay_t *replay, replay_page_header_t *newest, uint32_t *newest_index) {
+    // error management
+    esp_err_t ret;
+
+    replay->partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, REPLAY_PARTITION_SUBTYPE, NULL);
+    if (replay->partition == NULL) {
+        ESP_LOGE(TAG, "no replay partition");
+        return ESP_ERR_NOT_FOUND;
+    }
+    replay->page_count = replay->partition->size / REPLAY_PAGE_SIZE;
+
+    memset(newest, 0, sizeof(*newest));
+    *newest_index = 0;
+    for (uint32_t i = 0; i < replay->page_count; i++) {
+        replay_page_header_t header;
+        ret = esp_partition_read(replay->partition, i * REPLAY_PAGE_SIZE, &header, sizeof(header));
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to read page %lu", i);
+            return ret;
+        }
+        if (header.magic == REPLAY_PAGE_MAGIC &&
+            (newest->magic != REPLAY_PAGE_MAGIC || header.sequence > newest->sequence)) {
+            *newest = header;
+            *newest_index = i;
+        }
+    }
+    return ESP_OK;
+}
+
+static bool replay_store(replay_t *replay, const replay_record_t *record, bool *notify) {
+    replay_page_t *page = &replay->pages[replay->current];
+    int64_t time_us = (record->kind == REPLAY_INPUT) ? record->time_us : esp_timer_get_time();
+    uint8_t encoded[REPLAY_RECORD_MAX];
+    replay_codec_t codec;
+    size_t length;
+
+    if (!page->open) {
+        if (page->busy) {
+            return false;
+        }
+        replay_open_page(replay, page, time_us);
+    }
+
+    // encode against a copy, the page keeps its state if the record does not fit
+    codec = page->codec;
+    length = replay_encode(&codec, record, encoded);
+    if (page->fill + length > REPLAY_PAGE_SIZE) {
+        page->open = false;
+        replay->stats.pages++;
+        *notify = true;
+
+        replay->current ^= 1;
+        page = &replay->pages[replay->current];
+        if (page->busy) {
+            return false;
+        }
+        replay_open_page(replay, page, time_us);
+        codec = page->codec;
+        length = replay_encode(&codec, record, encoded);
+    }
+
+    memcpy(page->data + page->fill, encoded, length);
+    page->fill += length;
+    page->codec = codec;
+    replay->stats.records++;
+    replay->stats.bytes += length;
+    return true;
+}
+
+static void replay_open_page(replay_t *replay, replay_page_t *page, int64_t base_us) {
+    replay_page_header_t header = {
+        .magic = REPLAY_PAGE_MAGIC,
+        .sequence = replay->sequence++,
+        .session = replay->session,
+        .first = replay->first,
+        .base_us = base_us,
+    };
+    memcpy(header.period_us, replay->period_us, sizeof(header.period_us));
+    replay->first = false;
+
+    // the rest stays erased (0xFF), which ends the page's records
+    memset(page->data, 0xff, REPLAY_PAGE_SIZE);
+    memcpy(page->data, &header, sizeof(header));
+    page->index = replay->next_index;
+    replay->next_index = (replay->next_index + 1) % replay->page_count;
+    page->fill = sizeof(header);
+    page->flushed = 0;
+    page->open = true;
+    page->busy = true;
+    replay_codec_reset(&page->codec, base_us, replay->period_us);
+    replay->stats.bytes += sizeof(header);
+}
+
+static void replay_append(replay_t *replay, const replay_record_t *record) {
+    bool notify = false;
+
+    portENTER_CRITICAL(&replay->spinlock);
+    uint32_t start = REPLAY_CYCLES();
+
+    // a gap goes in first, so replay knows the stream's history is incomplete
+    if (replay->lost[record->stream] > 0) {
+        replay_record_t gap = {
+            .kind = REPLAY_GAP,
+            .stream = record->stream,
+            .lost = replay->lost[record->stream],
+        };
+        if (replay_store(replay, &gap, &notify)) {
+            replay->lost[record->stream] = 0;
+        }
+    }
+    if (replay->lost[record->stream] > 0 || !replay_store(replay, record, &notify)) {
+        replay->lost[record->stream]++;
+        replay->stats.dropped++;
+    }
+
+    uint32_t cycles = REPLAY_CYCLES() - start;
+    replay->stats.record_cycles += cycles;
+    if (cycles > replay->stats.max_record_cycles) {
+        replay->stats.max_record_cycles = cycles;
+    }
+    portEXIT_CRITICAL(&replay->spinlock);
+
+    if (notify) {
+        xTaskNotifyGive(replay->writer);
+    }
+}
+
+static void replay_writer_task(void *pvParameters) {
+    replay_t *replay = (replay_t *)pvParameters;
+    uint32_t reported = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(REPLAY_FLUSH_MS));
+
+        // the closed page first, then the open one
+        portENTER_CRITICAL(&replay->spinlock);
+        uint8_t current = replay->current;
+        portEXIT_CRITICAL(&replay->spinlock);
+        replay_flush(replay, &replay->pages[current ^ 1]);
+        replay_flush(replay, &replay->pages[current]);
+
+        // cost report once per closed page
+        replay_stats_t stats;
+        replay_get_stats(replay, &stats);
+        if (stats.pages != reported) {
+            reported = stats.pages;
+            ESP_LOGI(TAG, "%lu pages, %lu records, %llu bytes (%.1f per record), %lu dropped; "
+                     "record %llu cycles avg, %lu max; flash %llu us avg, %lu max",
+                     stats.pages, stats.records, stats.bytes,
+                     stats.records ? (double)stats.bytes / stats.records : 0.0, stats.dropped,
+                     stats.records ? stats.record_cycles / stats.records : 0, stats.max_record_cycles,
+                     stats.flash_writes ? stats.flash_us / stats.flash_writes : 0, stats.max_flash_us);
+        }
+    }
+}
+
+static void replay_flush(replay_t *replay, replay_page_t *page) {
+    // error management
+    esp_err_t ret = ESP_OK;
+
+    portENTER_CRITICAL(&replay->spinlock);
+    bool busy = page->busy;
+    uint32_t fill = page->fill;
+    uint32_t flushed = page->flushed;
+    portEXIT_CRITICAL(&replay->spinlock);
+    if (!busy) {
+        return;
+    }
+
+    // bytes below fill are final, the recorder only appends
+    if (fill > flushed) {
+        int64_t start = esp_timer_get_time();
+        size_t offset = page->index * REPLAY_PAGE_SIZE;
+        if (flushed == 0) {
+            ret = esp_partition_erase_range(replay->partition, offset, REPLAY_PAGE_SIZE);
+        }
+        if (ret == ESP_OK) {
+            ret = esp_partition_write(replay->partition, offset + flushed, page->data + flushed, fill - flushed);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "failed to write page %lu (%d)", page->index, ret);
+        }
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+        portENTER_CRITICAL(&replay->spinlock);
+        replay->stats.flash_writes++;
+        replay->stats.flash_us += elapsed;
+        if (elapsed > replay->stats.max_flash_us) {
+            replay->stats.max_flash_us = elapsed;
+        }
+        portEXIT_CRITICAL(&replay->spinlock);
+    }
+
+    // a closed page that is all out can take records again
+    portENTER_CRITICAL(&replay->spinlock);
+    page->flushed = fill;
+    if (!page->open && page->flushed == page->fill) {
+        page->busy = false;
+    }
+    portEXIT_CRITICAL(&replay->spinlock);
+}
+
+static void replay_apply(replay_t *replay, const replay_record_t *record, replay_input_cb_t input, void *arg) {
+    replay_result_t *result = replay->result;
+    replay_stream_t stream = record->stream;
+
+    switch (record->kind) {
+        case REPLAY_INPUT:
+            // decisions of the previous input that were never recorded
+            if (replay->produced_count[stream] > 0) {
+                result->extra += replay->produced_count[stream];
+                replay->produced_count[stream] = 0;
+                replay_diverged(replay, stream);
+            }
+            if (result->inputs++ == 0) {
+                result->start_us = record->time_us;
+            }
+            result->end_us = record->time_us;
+            replay->replayed_us[stream] = record->time_us;
+            input(record, arg);
+            break;
+
+        case REPLAY_DECISION:
+            result->decisions++;
+            if (replay->produced_count[stream] == 0) {
+                result->missing++;
+                replay_diverged(replay, stream);
+                break;
+            }
+            if (replay->produced[stream][0] == record->digest) {
+                result->matched++;
+            } else {
+                result->mismatched++;
+                replay_diverged(replay, stream);
+            }
+            replay->produced_count[stream]--;
+            memmove(replay->produced[stream], replay->produced[stream] + 1,
+                    replay->produced_count[stream] * sizeof(replay->produced[stream][0]));
+            break;
+
+        case REPLAY_GAP:
+            result->lost += record->lost;
+            break;
+    }
+}
+
+static void replay_diverged(replay_t *replay, replay_stream_t stream) {
+    if (replay->result->first_divergence_us < 0) {
+        replay->result->first_divergence_us = replay->replayed_us[stream];
+        ESP_LOGW(TAG, "stream %d diverges from the recording at %lld us", stream, replay->replayed_us[stream]);
+    }
+}
@@ -0,0 +1,266 @@
+/**
+ * @file replay_codec.c
+ * @author Anthony Yalong
+ * @brief Replay record encoding
+ *
+ * Header byte: kind (2 bits, 3 is reserved so an erased 0xFF ends a page),
+ * stream (2 bits), flags (4 bits). Inputs then carry their time since the
+ * stream's previous input: whole periods only when not exactly one (flag),
+ * and the remainder, both zigzag varints. Echo widths are deltas, dht11
+ * bytes are stored as read.
+ */
+
+#include "replay.h"
+#include <string.h>
+
+// header byte
+#define REPLAY_KIND_SHIFT       6
+#define REPLAY_STREAM_SHIFT     4
+#define REPLAY_FLAG_VALUE       0x01    // pir level, echo or frame received, remote link up
+#define REPLAY_FLAG_MOTION      0x02    // remote motion
+#define REPLAY_FLAG_PERIODS     0x08    // period count follows (not exactly one)
+#define REPLAY_KIND_END         3       // 0xFF: erased flash
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Append an unsigned varint (7 bits per byte, low first)
+ *
+ * @param out Output buffer
+ * @param value Value
+ * @return size_t Bytes written
+ */
+static size_t put_varint(uint8_t *out, uint64_t value);
+
+/**
+ * @brief Read an unsigned varint
+ *
+ * @param data Encoded bytes
+ * @param length Bytes available
+ * @param value Output value
+ * @return size_t Bytes consumed, 0 if truncated or over 10 bytes
+ */
+static size_t get_varint(const uint8_t *data, size_t length, uint64_t *value);
+
+/**
+ * @brief Map a signed value to unsigned, small magnitudes first
+ *
+ * @param value Signed value
+ * @return uint64_t Zigzag value
+ */
+static uint64_t zigzag(int64_t value);
+
+/**
+ * @brief Inverse of zigzag()
+ *
+ * @param value Zigzag value
+ * @return int64_t Signed value
+ */
+static int64_t unzigzag(uint64_t value);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+void replay_codec_reset(replay_codec_t *codec, int64_t base_us, const uint32_t period_us[REPLAY_STREAM_COUNT]) {
+    for (int i = 0; i < REPLAY_STREAM_COUNT; i++) {
+        codec->period_us[i] = period_us[i];
+        codec->last_us[i] = base_us;
+    }
+    codec->last_pulse_us = 0;
+}
+
+size_t replay_encode(replay_codec_t *codec, const replay_record_t *record, uint8_t out[REPLAY_RECORD_MAX]) {
+    size_t n = 1;
+    uint8_t flags = 0;
+
+    switch (record->kind) {
+        case REPLAY_DECISION:
+            // little endian, as read back
+            for (int i = 0; i < 4; i++) {
+                out[n++] = (uint8_t)(record->digest >> (8 * i));
+            }
+            break;
+
+        case REPLAY_GAP:
+            n += put_varint(out + n, record->lost);
+            break;
+
+        case REPLAY_INPUT: {
+            // time as whole periods and a remainder (jitter) since the stream's previous input
+            int64_t delta = record->time_us - codec->last_us[record->stream];
+            int64_t period = codec->period_us[record->stream];
+            int64_t periods = 0;
+            if (period > 0) {
+                periods = (delta >= 0) ? (delta + period / 2) / period : -((-delta + period / 2) / period);
+            }
+            if (periods != 1) {
+                flags |= REPLAY_FLAG_PERIODS;
+                n += put_varint(out + n, zigzag(periods));
+            }
+            n += put_varint(out + n, zigzag(delta - periods * period));
+            codec->last_us[record->stream] = record->time_us;
+
+            switch (record->stream) {
+                case REPLAY_PIR:
+                    flags |= record->pir.level ? REPLAY_FLAG_VALUE : 0;
+                    break;
+
+                case REPLAY_DISTANCE:
+                    if (record->distance.ok) {
+                        flags |= REPLAY_FLAG_VALUE;
+                        n += put_varint(out + n, zigzag((int64_t)record->distance.pulse_us - codec->last_pulse_us));
+                        codec->last_pulse_us = record->distance.pulse_us;
+                    }
+                    break;
+
+                case REPLAY_CLIMATE:
+                    if (record->climate.ok) {
+                        flags |= REPLAY_FLAG_VALUE;
+                        out[n++] = record->climate.humidity;
+                        out[n++] = record->climate.temperature;
+                    }
+                    break;
+
+                default:
+                    flags |= (record->remote.connected ? REPLAY_FLAG_VALUE : 0) |
+                             (record->remote.motion ? REPLAY_FLAG_MOTION : 0);
+                    break;
+            }
+            break;
+        }
+    }
+
+    out[0] = (uint8_t)((record->kind << REPLAY_KIND_SHIFT) | (record->stream << REPLAY_STREAM_SHIFT) | flags);
+    return n;
+}
+
+size_t replay_decode(replay_codec_t *codec, const uint8_t *data, size_t length, replay_record_t *record) {
+    uint64_t value;
+    size_t used;
+
+    if (length == 0 || (data[0] >> REPLAY_KIND_SHIFT) == REPLAY_KIND_END) {
+        return 0;
+    }
+
+    memset(record, 0, sizeof(*record));
+    record->kind = (replay_kind_t)(data[0] >> REPLAY_KIND_SHIFT);
+    record->stream = (replay_stream_t)((data[0] >> REPLAY_STREAM_SHIFT) & 0x03);
+    uint8_t flags = data[0] & 0x0f;
+    size_t n = 1;
+
+    switch (record->kind) {
+        case REPLAY_DECISION:
+            if (length < n + 4) {
+                return 0;
+            }
+            for (int i = 0; i < 4; i++) {
+                record->digest |= (uint32_t)data[n++] << (8 * i);
+            }
+            return n;
+
+        case REPLAY_GAP:
+            used = get_varint(data + n, length - n, &value);
+            record->lost = (uint32_t)value;
+            return used ? n + used : 0;
+
+        default:
+            break;
+    }
+
+    // input time
+    int64_t periods = 1;
+    if (flags & REPLAY_FLAG_PERIODS) {
+        used = get_varint(data + n, length - n, &value);
+        if (used == 0) {
+            return 0;
+        }
+        periods = unzigzag(value);
+        n += used;
+    }
+    used = get_varint(data + n, length - n, &value);
+    if (used == 0) {
+        return 0;
+    }
+    n += used;
+    record->time_us = codec->last_us[record->stream] + periods * codec->period_us[record->stream] + unzigzag(value);
+    codec->last_us[record->stream] = record->time_us;
+
+    switch (record->stream) {
+        case REPLAY_PIR:
+            record->pir.level = flags & REPLAY_FLAG_VALUE;
+            break;
+
+        case REPLAY_DISTANCE:
+            record->distance.ok = flags & REPLAY_FLAG_VALUE;
+            if (record->distance.ok) {
+                used = get_varint(data + n, length - n, &value);
+                if (used == 0) {
+                    return 0;
+                }
+                n += used;
+                codec->last_pulse_us += (int32_t)unzigzag(value);
+                record->distance.pulse_us = codec->last_pulse_us;
+            }
+            break;
+
+        case REPLAY_CLIMATE:
+            record->climate.ok = flags & REPLAY_FLAG_VALUE;
+            if (record->climate.ok) {
+                if (length < n + 2) {
+                    return 0;
+                }
+                record->climate.humidity = data[n++];
+                record->climate.temperature = data[n++];
+            }
+            break;
+
+        default:
+            record->remote.connected = flags & REPLAY_FLAG_VALUE;
+            record->remote.motion = flags & REPLAY_FLAG_MOTION;
+            break;
+    }
+    return n;
+}
+
+uint32_t replay_digest(uint32_t digest, const void *data, size_t length) {
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < length; i++) {
+        digest = (digest ^ bytes[i]) * 16777619u;
+    }
+    return digest;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static size_t get_varint(const uint8_t *data, size_t length, uint64_t *value) {
+    *value = 0;
+    for (size_t n = 0; n < length && n < 10; n++) {
+        *value |= (uint64_t)(data[n] & 0x7f) << (7 * n);
+        if ((data[n] & 0x80) == 0) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
@@ -0,0 +1,141 @@
+/**
+ * @file sample_clock.h
+ * @author Anthony Yalong
+ * @brief Hardware-timer sampling clock for jitter-free periodic sensor reads
+ */
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gptimer.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// configuration
+#define SAMPLE_CLOCK_MAX_CHANNELS   8
+#define SAMPLE_CLOCK_RESOLUTION_HZ  1000000  // 1 tick = 1 us
+
+/**
+ * @brief Period jitter statistics
+ */
+typedef struct {
+    int64_t last_time_us;      // previous wake-up time
+    uint32_t samples;          // periods measured
+    int32_t min_error_us;      // most negative period error
+    int32_t max_error_us;      // most positive period error
+    uint64_t abs_error_sum_us; // sum of |period error|
+    uint32_t overruns;         // wake-ups that covered more than one period
+} sample_jitter_t;
+
+/**
+ * @brief Sampling channel
+ */
+typedef struct {
+    TaskHandle_t task;         // task notified on each period
+    uint64_t period_us;        // channel period
+    uint64_t next_due_us;      // next fire time on the timer count
+    sample_jitter_t jitter;    // wake-up jitter measured in the owning task
+} sample_clock_channel_t;
+
+/**
+ * @brief Sample clock structure
+ */
+typedef struct {
+    gptimer_handle_t timer;
+    sample_clock_channel_t channels[SAMPLE_CLOCK_MAX_CHANNELS];
+    uint8_t channel_count;
+    bool running;
+    volatile uint32_t fired;   // channels fired and not yet taken, bit per channel
+} sample_clock_t;
+
+/**
+ * @brief Initialize sample clock on a free general-purpose timer
+ *
+ * @param clock Pointer to sample clock structure
+ * @return esp_err_t ESP_OK on success, error code from gptimer otherwise
+ */
+esp_err_t sample_clock_init(sample_clock_t *clock);
+
+/**
+ * @brief Register a periodic channel
+ *
+ * Channel fires at phase_us + k * period_us after sample_clock_start().
+ * Give channels with commensurate periods different phases so they never
+ * fire at the same instant.
+ *
+ * @param clock Pointer to sample clock structure
+ * @param task Task to notify each period
+ * @param period_us Period in microseconds
+ * @param phase_us Offset of the first fire in microseconds
+ * @param channel Output channel index
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_STATE if already running,
+ *                   ESP_ERR_NO_MEM if all channels are used
+ */
+esp_err_t sample_clock_add_channel(sample_clock_t *clock, TaskHandle_t task,
+                                   uint32_t period_us, uint32_t phase_us, int *channel);
+
+/**
+ * @brief Start the timer - channels fire from now on
+ *
+ * @param clock Pointer to sample clock structure
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sample_clock_start(sample_clock_t *clock);
+
+/**
+ * @brief Block the calling task until its channel fires
+ *
+ * Must be called from the task registered for the channel. Records
+ * wake-up jitter for the channel.
+ *
+ * @param clock Pointer to sample clock structure
+ * @param channel Channel index
+ */
+void sample_clock_wait(sample_clock_t *clock, int channel);
+
+/**
+ * @brief Block the calling task until one of its channels fires
+ *
+ * For a task that owns several channels (one per thing it samples). Must
+ * not be mixed with sample_clock_wait() in the same task. Records wake-up
+ * jitter for each channel returned.
+ *
+ * @param clock Pointer to sample clock structure
+ * @param timeout Longest wait in ticks (portMAX_DELAY: no limit)
+ * @return uint32_t Channels that fired since the last call, bit per
+ *                  channel index; 0 on timeout
+ */
+uint32_t sample_clock_wait_any(sample_clock_t *clock, TickType_t timeout);
+
+/**
+ * @brief Get jitter statistics of a channel
+ *
+ * @param clock Pointer to sample clock structure
+ * @param channel Channel index
+ * @return const sample_jitter_t* Pointer to statistics, NULL on bad channel
+ */
+const sample_jitter_t *sample_clock_get_jitter(const sample_clock_t *clock, int channel);
+
+/**
+ * @brief Record one wake-up in a jitter accumulator
+ *
+ * Usable with any scheduler, e.g. after vTaskDelayUntil() for comparison.
+ *
+ * @param jitter Pointer to jitter statistics
+ * @param now_us Wake-up time (esp_timer_get_time())
+ * @param period_us Expected period in microseconds
+ */
+void sample_jitter_record(sample_jitter_t *jitter, int64_t now_us, uint32_t period_us);
+
+/**
+ * @brief Log jitter statistics
+ *
+ * @param name Channel name for the log line
+ * @param jitter Pointer to jitter statistics
+ */
+void sample_jitter_log(const char *name, const sample_jitter_t *jitter);
+
+#endif  // SAMPLE_CLOCK_H
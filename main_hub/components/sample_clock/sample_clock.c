@@ -0,0 +1,261 @@
+/**
+ * @file sample_clock.c
+ * @author Anthony Yalong
+ * @brief Hardware-timer sampling clock implementation
+ */
+
+#include "sample_clock.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "SAMPLE_CLOCK";
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Timer alarm callback - notifies due channels and arms the next alarm
+ *
+ * Runs in ISR context. Every channel whose deadline has passed is notified
+ * and advanced by whole periods; the alarm is then moved to the earliest
+ * remaining deadline.
+ *
+ * @param timer Timer handle
+ * @param edata Alarm event data (count at alarm)
+ * @param user_ctx Pointer to sample clock structure
+ * @return bool true if a higher priority task was woken
+ */
+static bool sample_clock_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata,
+                                  void *user_ctx);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t sample_clock_init(sample_clock_t *clock) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (clock == NULL) {
+        ESP_LOGE(TAG, "sample clock pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    clock->channel_count = 0;
+    clock->running = false;
+    clock->fired = 0;
+
+    // 1 MHz up-counting timer, alarms re-armed manually
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = SAMPLE_CLOCK_RESOLUTION_HZ,
+    };
+    ret = gptimer_new_timer(&timer_config, &clock->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to allocate gptimer");
+        return ret;
+    }
+
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = sample_clock_on_alarm,
+    };
+    ret = gptimer_register_event_callbacks(clock->timer, &callbacks, clock);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to register alarm callback");
+        return ret;
+    }
+
+    ret = gptimer_enable(clock->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to enable gptimer");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "sample clock initialized");
+    return ESP_OK;
+}
+
+esp_err_t sample_clock_add_channel(sample_clock_t *clock, TaskHandle_t task,
+                                   uint32_t period_us, uint32_t phase_us, int *channel) {
+    // sanity check
+    if (clock == NULL || task == NULL || period_us == 0 || channel == NULL) {
+        ESP_LOGE(TAG, "invalid channel parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (clock->running) {
+        ESP_LOGE(TAG, "channels must be added before start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (clock->channel_count >= SAMPLE_CLOCK_MAX_CHANNELS) {
+        ESP_LOGE(TAG, "no free channels");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // first fire at the phase offset
+    sample_clock_channel_t *ch = &clock->channels[clock->channel_count];
+    ch->task = task;
+    ch->period_us = period_us;
+    ch->next_due_us = phase_us;
+    ch->jitter = (sample_jitter_t){ 0 };
+
+    *channel = clock->channel_count++;
+    ESP_LOGI(TAG, "channel %d: period %lu us, phase %lu us", *channel, period_us, phase_us);
+    return ESP_OK;
+}
+
+esp_err_t sample_clock_start(sample_clock_t *clock) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (clock == NULL || clock->channel_count == 0) {
+        ESP_LOGE(TAG, "no channels to start");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // earliest first deadline
+    uint64_t first_due = clock->channels[0].next_due_us;
+    for (int i = 1; i < clock->channel_count; i++) {
+        if (clock->channels[i].next_due_us < first_due) {
+            first_due = clock->channels[i].next_due_us;
+        }
+    }
+
+    gptimer_alarm_config_t alarm = {
+        .alarm_count = first_due,
+    };
+    ret = gptimer_set_alarm_action(clock->timer, &alarm);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to set first alarm");
+        return ret;
+    }
+
+    clock->running = true;
+    ret = gptimer_start(clock->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start gptimer");
+        clock->running = false;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "sample clock started with %d channels", clock->channel_count);
+    return ESP_OK;
+}
+
+void sample_clock_wait(sample_clock_t *clock, int channel) {
+    // one notification per period; the alarm counts periods that fire again
+    // before the task took the last one as overruns
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+
+    if (clock == NULL || channel < 0 || channel >= clock->channel_count) {
+        return;
+    }
+
+    sample_clock_channel_t *ch = &clock->channels[channel];
+    __atomic_fetch_and(&clock->fired, ~(1u << channel), __ATOMIC_RELAXED);
+    sample_jitter_record(&ch->jitter, now, ch->period_us);
+}
+
+uint32_t sample_clock_wait_any(sample_clock_t *clock, TickType_t timeout) {
+    // notifications from all of the task's channels add up, the fired bits tell them apart
+    ulTaskNotifyTake(pdTRUE, timeout);
+    int64_t now = esp_timer_get_time();
+
+    if (clock == NULL) {
+        return 0;
+    }
+
+    // only this task's channels, other tasks take their own
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t mine = 0;
+    for (int i = 0; i < clock->channel_count; i++) {
+        if (clock->channels[i].task == self) {
+            mine |= 1u << i;
+        }
+    }
+    uint32_t fired = __atomic_fetch_and(&clock->fired, ~mine, __ATOMIC_RELAXED) & mine;
+
+    for (int i = 0; i < clock->channel_count; i++) {
+        if (fired & (1u << i)) {
+            sample_jitter_record(&clock->channels[i].jitter, now, clock->channels[i].period_us);
+        }
+    }
+    return fired;
+}
+
+const sample_jitter_t *sample_clock_get_jitter(const sample_clock_t *clock, int channel) {
+    if (clock == NULL || channel < 0 || channel >= clock->channel_count) {
+        return NULL;
+    }
+    return &clock->channels[channel].jitter;
+}
+
+void sample_jitter_record(sample_jitter_t *jitter, int64_t now_us, uint32_t period_us) {
+    if (jitter == NULL) {
+        return;
+    }
+
+    // first wake-up only sets the reference point
+    if (jitter->last_time_us != 0) {
+        int32_t error = (int32_t)(now_us - jitter->last_time_us - period_us);
+
+        if (jitter->samples == 0 || error < jitter->min_error_us) {
+            jitter->min_error_us = error;
+        }
+        if (jitter->samples == 0 || error > jitter->max_error_us) {
+            jitter->max_error_us = error;
+        }
+        jitter->abs_error_sum_us += (error < 0) ? -error : error;
+        jitter->samples++;
+    }
+    jitter->last_time_us = now_us;
+}
+
+void sample_jitter_log(const char *name, const sample_jitter_t *jitter) {
+    if (name == NULL || jitter == NULL || jitter->samples == 0) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "%s: %lu periods, error min %ld us, max %ld us, mean |error| %llu us, overruns %lu",
+             name, jitter->samples, jitter->min_error_us, jitter->max_error_us,
+             jitter->abs_error_sum_us / jitter->samples, jitter->overruns);
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static bool sample_clock_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata,
+                                  void *user_ctx) {
+    sample_clock_t *clock = (sample_clock_t *)user_ctx;
+    BaseType_t higher_priority_woken = pdFALSE;
+    uint64_t now = edata->count_value;
+    uint64_t next_due = UINT64_MAX;
+
+    for (int i = 0; i < clock->channel_count; i++) {
+        sample_clock_channel_t *ch = &clock->channels[i];
+
+        // deadlines advance by whole periods so phase never drifts
+        if (ch->next_due_us <= now) {
+            if (__atomic_fetch_or(&clock->fired, 1u << i, __ATOMIC_RELAXED) & (1u << i)) {
+                ch->jitter.overruns++;
+            }
+            vTaskNotifyGiveFromISR(ch->task, &higher_priority_woken);
+            do {
+                ch->next_due_us += ch->period_us;
+            } while (ch->next_due_us <= now);
+        }
+
+        if (ch->next_due_us < next_due) {
+            next_due = ch->next_due_us;
+        }
+    }
+
+    gptimer_alarm_config_t alarm = {
+        .alarm_count = next_due,
+    };
+    gptimer_set_alarm_action(timer, &alarm);
+
+    return higher_priority_woken == pdTRUE;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file sensor.h
+ * @author Anthony Yalong
+ * @brief Sensor driver interface and registry - every registered sensor is
+ *        sampled from one task paced by the sampling clock
+ */
+#ifndef SENSOR_H
+#define SENSOR_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sample_clock.h"
+
+// configuration
+#define SENSOR_REGISTRY_MAX         SAMPLE_CLOCK_MAX_CHANNELS  // one clock channel per instance
+#define SENSOR_TASK_STACK           4096    // sample callbacks run the hub logic
+#define SENSOR_REPORT_PERIOD_MS     3600000 // dispatch cost logged hourly (0: never)
+
+/**
+ * @brief Capabilities - values a driver's samples carry and how it reads
+ */
+typedef enum {
+    SENSOR_CAP_LEVEL        = 1 << 0,   // digital level (motion)
+    SENSOR_CAP_DISTANCE     = 1 << 1,   // distance and echo width
+    SENSOR_CAP_TEMPERATURE  = 1 << 2,
+    SENSOR_CAP_HUMIDITY     = 1 << 3,
+    SENSOR_CAP_SPLIT        = 1 << 4,   // start, then the result after a wait the task sleeps through
+    SENSOR_CAP_BLOCKING     = 1 << 5,   // poll busy-waits on the line, bounded by the driver's timeout
+} sensor_cap_t;
+
+/**
+ * @brief One sample
+ */
+typedef struct {
+    int64_t time_us;            // when the read completed
+    esp_err_t status;           // ESP_OK, or the read's error (values are then the last good ones)
+    bool level;                 // SENSOR_CAP_LEVEL
+    int32_t pulse_us;           // SENSOR_CAP_DISTANCE: echo width
+    float distance_cm;          // SENSOR_CAP_DISTANCE
+    float temperature;          // SENSOR_CAP_TEMPERATURE, C
+    float humidity;             // SENSOR_CAP_HUMIDITY, %
+} sensor_sample_t;
+
+/**
+ * @brief Driver interface - one const instance per driver type, operating
+ *        on that driver's own state (pir_sensor_t, hcsr04_sensor_t...)
+ */
+typedef struct {
+    const char *name;
+    uint32_t caps;              // sensor_cap_t bits
+
+    /**
+     * @brief Initialize the sensor state and hardware
+     *
+     * @param sensor Driver state
+     * @param config Driver configuration (pir_config_t, hcsr04_config_t...)
+     * @return esp_err_t ESP_OK on success, error code from the driver otherwise
+     */
+    esp_err_t (*init)(void *sensor, const void *config);
+
+    /**
+     * @brief Start a sample - NULL if there is nothing to start
+     *
+     * @param sensor Driver state
+     * @param wait_us Output time before the first poll
+     * @return esp_err_t ESP_OK if started, error code from the driver otherwise
+     */
+    esp_err_t (*start)(void *sensor, uint32_t *wait_us);
+
+    /**
+     * @brief Poll or complete the sample
+     *
+     * @param sensor Driver state
+     * @param wait_us Output time before the next poll (ESP_ERR_NOT_FINISHED)
+     * @return esp_err_t ESP_OK when complete, ESP_ERR_NOT_FINISHED to poll
+     *                   again, error code from the driver otherwise
+     */
+    esp_err_t (*poll)(void *sensor, uint32_t *wait_us);
+
+    /**
+     * @brief Get the last sample's values
+     *
+     * @param sensor Driver state
+     * @param sample Output sample (values only, time and status are set by the registry)
+     */
+    void (*get)(const void *sensor, sensor_sample_t *sample);
+} sensor_driver_t;
+
+/**
+ * @brief Sample callback - runs in the registry task
+ *
+ * @param sample Completed sample
+ * @param arg User argument
+ */
+typedef void (*sensor_sample_cb_t)(const sensor_sample_t *sample, void *arg);
+
+/**
+ * @brief Dispatch cost
+ *
+ * Cycles from the cpu cycle counter (0 on the linux target): the registry
+ * task's whole pass, and the part spent in drivers and callbacks. The
+ * difference is the registry's own overhead.
+ */
+typedef struct {
+    uint32_t wakes;             // clock wake-ups and poll timeouts
+    uint32_t dispatches;        // driver start/poll calls
+    uint32_t samples;           // completed, errors included
+    uint32_t errors;
+    uint32_t busy_skips;        // due again while the last sample was still pending
+    uint64_t pass_cycles;
+    uint64_t driver_cycles;     // start, poll and get
+    uint64_t callback_cycles;
+    uint32_t max_overhead_cycles;   // largest registry-only share of one pass
+} sensor_stats_t;
+
+/**
+ * @brief Registered sensor
+ */
+typedef struct {
+    const sensor_driver_t *driver;
+    void *sensor;               // driver state
+    uint32_t period_us;
+    uint32_t phase_us;
+    sensor_sample_cb_t callback;
+    void *arg;
+    int channel;                // sample clock channel, -1 until started
+    bool pending;               // started, not yet complete
+    int64_t poll_us;            // next poll while pending
+} sensor_instance_t;
+
+/**
+ * @brief Registry structure
+ */
+typedef struct {
+    sample_clock_t *clock;
+    sensor_instance_t instances[SENSOR_REGISTRY_MAX];
+    uint8_t count;
+    TaskHandle_t task;
+    sensor_stats_t stats;
+} sensor_registry_t;
+
+/**
+ * @brief Initialize an empty registry
+ *
+ * @param registry Pointer to registry structure
+ * @param clock Sampling clock the instances are paced by (not yet started)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on a null pointer
+ */
+esp_err_t sensor_registry_init(sensor_registry_t *registry, sample_clock_t *clock);
+
+/**
+ * @brief Initialize a sensor through its driver and register it
+ *
+ * Costs the instance entry only: no task, no stack, one clock channel once
+ * started.
+ *
+ * @param registry Pointer to registry structure
+ * @param driver Driver interface
+ * @param sensor Driver state (must stay valid)
+ * @param config Driver configuration, only used during the call
+ * @param period_us Sampling period
+ * @param phase_us Offset of the first sample (keep instances apart)
+ * @param callback Called with every completed sample
+ * @param arg User argument
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the registry is
+ *                   full, ESP_ERR_INVALID_STATE if already started, error
+ *                   code from the driver's init otherwise
+ */
+esp_err_t sensor_registry_add(sensor_registry_t *registry, const sensor_driver_t *driver, void *sensor,
+                              const void *config, uint32_t period_us, uint32_t phase_us,
+                              sensor_sample_cb_t callback, void *arg);
+
+/**
+ * @brief Create the registry task and give every instance a clock channel
+ *
+ * Call before sample_clock_start(); instances are sampled once the clock
+ * runs. A registry that is never started reads nothing.
+ *
+ * @param registry Pointer to registry structure
+ * @param priority Task priority
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the task cannot be
+ *                   created, error code from the clock otherwise
+ */
+esp_err_t sensor_registry_start(sensor_registry_t *registry, UBaseType_t priority);
+
+/**
+ * @brief One pass of the registry - start every due instance, poll every
+ *        pending one whose wait is over, deliver completed samples
+ *
+ * Called by the registry task on each wake-up; exposed so the dispatch
+ * cost can be measured without the clock.
+ *
+ * @param registry Pointer to registry structure
+ * @param due Instances due, bit per instance index
+ * @param now_us Wake-up time
+ * @return int64_t Time of the earliest pending poll, INT64_MAX if none
+ */
+int64_t sensor_registry_step(sensor_registry_t *registry, uint32_t due, int64_t now_us);
+
+/**
+ * @brief Get the dispatch cost so far
+ *
+ * @param registry Pointer to registry structure
+ * @param stats Output statistics
+ */
+void sensor_registry_get_stats(const sensor_registry_t *registry, sensor_stats_t *stats);
+
+#endif  // SENSOR_H
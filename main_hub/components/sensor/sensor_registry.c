@@ -0,0 +1,272 @@
+/**
+ * @file sensor_registry.c
+ * @author Anthony Yalong
+ * @brief Sensor registry implementation
+ */
+
+#include "sensor.h"
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_cpu.h"
+#endif
+
+static const char *TAG = "SENSOR";
+
+// dispatch cost: cpu cycles on the target, the simulator's benchmarks time the host
+#if CONFIG_IDF_TARGET_LINUX
+#define SENSOR_CYCLES()         0
+#else
+#define SENSOR_CYCLES()         esp_cpu_get_cycle_count()
+#endif
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Start, poll and deliver one instance
+ *
+ * @param registry Pointer to registry structure
+ * @param instance Instance
+ * @param due Its clock channel fired
+ * @param now_us Wake-up time
+ * @return int64_t Time of its next poll, INT64_MAX if nothing is pending
+ */
+static int64_t sensor_run(sensor_registry_t *registry, sensor_instance_t *instance, bool due, int64_t now_us);
+
+/**
+ * @brief Registry task - sleeps until a channel fires or a pending sample
+ *        can be polled, then runs one pass
+ *
+ * @param pvParameters Pointer to registry structure
+ */
+static void sensor_registry_task(void *pvParameters);
+
+/**
+ * @brief Log the dispatch cost
+ *
+ * @param registry Pointer to registry structure
+ */
+static void sensor_registry_report(const sensor_registry_t *registry);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t sensor_registry_init(sensor_registry_t *registry, sample_clock_t *clock) {
+    // sanity check
+    if (registry == NULL || clock == NULL) {
+        ESP_LOGE(TAG, "registry or clock pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(registry, 0, sizeof(*registry));
+    registry->clock = clock;
+    return ESP_OK;
+}
+
+esp_err_t sensor_registry_add(sensor_registry_t *registry, const sensor_driver_t *driver, void *sensor,
+                              const void *config, uint32_t period_us, uint32_t phase_us,
+                              sensor_sample_cb_t callback, void *arg) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (registry == NULL || driver == NULL || driver->poll == NULL || driver->get == NULL || sensor == NULL ||
+        period_us == 0 || callback == NULL) {
+        ESP_LOGE(TAG, "invalid sensor parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (registry->task != NULL) {
+        ESP_LOGE(TAG, "sensors must be added before start");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (registry->count >= SENSOR_REGISTRY_MAX) {
+        ESP_LOGE(TAG, "registry full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (driver->init != NULL) {
+        ret = driver->init(sensor, config);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to initialize %s", driver->name);
+            return ret;
+        }
+    }
+
+    registry->instances[registry->count++] = (sensor_instance_t){
+        .driver = driver,
+        .sensor = sensor,
+        .period_us = period_us,
+        .phase_us = phase_us,
+        .callback = callback,
+        .arg = arg,
+        .channel = -1,
+    };
+    ESP_LOGI(TAG, "%s: period %lu us, phase %lu us", driver->name, period_us, phase_us);
+    return ESP_OK;
+}
+
+esp_err_t sensor_registry_start(sensor_registry_t *registry, UBaseType_t priority) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (registry == NULL || registry->count == 0) {
+        ESP_LOGE(TAG, "no sensors to start");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // the task blocks until the clock runs, channels need its handle
+    if (xTaskCreate(sensor_registry_task, "sensor_task", SENSOR_TASK_STACK, registry, priority,
+                    &registry->task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create sensor task");
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < registry->count; i++) {
+        sensor_instance_t *instance = &registry->instances[i];
+        ret = sample_clock_add_channel(registry->clock, registry->task, instance->period_us, instance->phase_us,
+                                       &instance->channel);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "no clock channel for %s", instance->driver->name);
+            return ret;
+        }
+    }
+
+    ESP_LOGI(TAG, "sensor task started with %d sensors", registry->count);
+    return ESP_OK;
+}
+
+int64_t sensor_registry_step(sensor_registry_t *registry, uint32_t due, int64_t now_us) {
+    sensor_stats_t *stats = &registry->stats;
+    uint32_t start = SENSOR_CYCLES();
+    uint64_t work = stats->driver_cycles + stats->callback_cycles;
+    int64_t next_poll_us = INT64_MAX;
+
+    for (int i = 0; i < registry->count; i++) {
+        int64_t poll_us = sensor_run(registry, &registry->instances[i], (due >> i) & 1, now_us);
+        next_poll_us = (poll_us < next_poll_us) ? poll_us : next_poll_us;
+    }
+
+    // the registry's own share: the pass less the drivers and callbacks in it
+    uint32_t pass = SENSOR_CYCLES() - start;
+    uint32_t overhead = pass - (uint32_t)(stats->driver_cycles + stats->callback_cycles - work);
+    stats->wakes++;
+    stats->pass_cycles += pass;
+    if (overhead > stats->max_overhead_cycles) {
+        stats->max_overhead_cycles = overhead;
+    }
+    return next_poll_us;
+}
+
+void sensor_registry_get_stats(const sensor_registry_t *registry, sensor_stats_t *stats) {
+    if (registry == NULL || stats == NULL) {
+        return;
+    }
+    *stats = registry->stats;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static int64_t sensor_run(sensor_registry_t *registry, sensor_instance_t *instance, bool due, int64_t now_us) {
+    const sensor_driver_t *driver = instance->driver;
+    sensor_stats_t *stats = &registry->stats;
+    esp_err_t ret = ESP_OK;
+    uint32_t wait_us = 0;
+    uint32_t start;
+
+    // due while the last sample is still pending: that period is skipped
+    if (due && instance->pending) {
+        stats->busy_skips++;
+    } else if (due) {
+        if (driver->start != NULL) {
+            start = SENSOR_CYCLES();
+            ret = driver->start(instance->sensor, &wait_us);
+            stats->driver_cycles += SENSOR_CYCLES() - start;
+            stats->dispatches++;
+        }
+        instance->pending = true;
+        instance->poll_us = now_us + wait_us;
+    }
+    if (!instance->pending) {
+        return INT64_MAX;
+    }
+
+    // a sample that failed to start completes at once with its error
+    if (ret == ESP_OK) {
+        if (now_us < instance->poll_us) {
+            return instance->poll_us;
+        }
+        start = SENSOR_CYCLES();
+        ret = driver->poll(instance->sensor, &wait_us);
+        stats->driver_cycles += SENSOR_CYCLES() - start;
+        stats->dispatches++;
+        if (ret == ESP_ERR_NOT_FINISHED) {
+            instance->poll_us = now_us + wait_us;
+            return instance->poll_us;
+        }
+    }
+
+    sensor_sample_t sample = { 0 };
+    start = SENSOR_CYCLES();
+    driver->get(instance->sensor, &sample);
+    stats->driver_cycles += SENSOR_CYCLES() - start;
+    sample.time_us = esp_timer_get_time();
+    sample.status = ret;
+    instance->pending = false;
+    stats->samples++;
+    stats->errors += (ret != ESP_OK);
+
+    start = SENSOR_CYCLES();
+    instance->callback(&sample, instance->arg);
+    stats->callback_cycles += SENSOR_CYCLES() - start;
+    return INT64_MAX;
+}
+
+static void sensor_registry_task(void *pvParameters) {
+    sensor_registry_t *registry = (sensor_registry_t *)pvParameters;
+    const int64_t tick_us = (int64_t)portTICK_PERIOD_MS * 1000;
+    int64_t next_poll_us = INT64_MAX;
+    int64_t report_us = esp_timer_get_time() + (int64_t)SENSOR_REPORT_PERIOD_MS * 1000;
+
+    while (1) {
+        // sleep until a channel fires or the earliest pending poll; one tick
+        // more, a timeout of n ticks can end just after n - 1
+        TickType_t timeout = portMAX_DELAY;
+        if (next_poll_us != INT64_MAX) {
+            int64_t wait_us = next_poll_us - esp_timer_get_time();
+            timeout = (wait_us > 0) ? (TickType_t)((wait_us + tick_us - 1) / tick_us) + 1 : 0;
+        }
+        uint32_t fired = sample_clock_wait_any(registry->clock, timeout);
+        int64_t now_us = esp_timer_get_time();
+
+        uint32_t due = 0;
+        for (int i = 0; i < registry->count; i++) {
+            int channel = registry->instances[i].channel;
+            if (channel >= 0 && (fired & (1u << channel))) {
+                due |= 1u << i;
+            }
+        }
+        next_poll_us = sensor_registry_step(registry, due, now_us);
+
+        if (SENSOR_REPORT_PERIOD_MS > 0 && now_us >= report_us) {
+            sensor_registry_report(registry);
+            report_us += (int64_t)SENSOR_REPORT_PERIOD_MS * 1000;
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void sensor_registry_report(const sensor_registry_t *registry) {
+    const sensor_stats_t *stats = &registry->stats;
+    uint64_t overhead = stats->pass_cycles - stats->driver_cycles - stats->callback_cycles;
+
+    ESP_LOGI(TAG, "%d sensors: %lu wakes, %lu dispatches, %lu samples (%lu errors, %lu skipped)",
+             registry->count, stats->wakes, stats->dispatches, stats->samples, stats->errors, stats->busy_skips);
+    ESP_LOGI(TAG, "cycles: registry %llu per wake (max %lu), drivers %llu, callbacks %llu",
+             stats->wakes ? overhead / stats->wakes : 0, stats->max_overhead_cycles, stats->driver_cycles,
+             stats->callback_cycles);
+}
@@ -0,0 +1,208 @@
+/**
+ * @file ssd1306.h
+ * @author Anthony Yalong
+ * @brief I2C SSD1306 128x64 OLED display driver with dirty-range flushing
+ */
+#ifndef SSD1306_H
+#define SSD1306_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/i2c.h"
+#include "esp_err.h"
+
+// display geometry
+#define SSD1306_WIDTH           128
+#define SSD1306_HEIGHT          64
+#define SSD1306_PAGES           (SSD1306_HEIGHT / 8)
+#define SSD1306_BUFFER_SIZE     (SSD1306_WIDTH * SSD1306_PAGES)
+
+// font geometry (5x7 glyph + 1 column spacing)
+#define SSD1306_FONT_WIDTH      5
+#define SSD1306_CHAR_WIDTH      (SSD1306_FONT_WIDTH + 1)
+
+// control bytes
+#define SSD1306_CONTROL_CMD     0x00
+#define SSD1306_CONTROL_DATA    0x40
+
+// commands
+#define SSD1306_CMD_DISPLAY_OFF     0xAE
+#define SSD1306_CMD_DISPLAY_ON      0xAF
+#define SSD1306_CMD_SET_CONTRAST    0x81
+#define SSD1306_CMD_ENTIRE_ON_RESUME 0xA4
+#define SSD1306_CMD_NORMAL_DISPLAY  0xA6
+#define SSD1306_CMD_SET_MUX_RATIO   0xA8
+#define SSD1306_CMD_SET_OFFSET      0xD3
+#define SSD1306_CMD_SET_START_LINE  0x40
+#define SSD1306_CMD_SET_CLOCK_DIV   0xD5
+#define SSD1306_CMD_SET_PRECHARGE   0xD9
+#define SSD1306_CMD_SET_COM_PINS    0xDA
+#define SSD1306_CMD_SET_VCOM_DESEL  0xDB
+#define SSD1306_CMD_CHARGE_PUMP     0x8D
+#define SSD1306_CMD_MEMORY_MODE     0x20
+#define SSD1306_CMD_COLUMN_ADDR     0x21
+#define SSD1306_CMD_PAGE_ADDR       0x22
+#define SSD1306_CMD_SEG_REMAP       0xA1
+#define SSD1306_CMD_COM_SCAN_DEC    0xC8
+
+// i2c timeout
+#define SSD1306_I2C_TIMEOUT_MS  1000
+
+// marker for a page with no dirty columns
+#define SSD1306_CLEAN           0xFF
+
+/**
+ * @brief Flush statistics
+ */
+typedef struct {
+    uint32_t flushes;           // flush calls that sent data
+    uint32_t transactions;      // i2c transactions issued
+    uint32_t bytes_sent;        // bytes on the wire (address + control + payload)
+    uint32_t last_flush_bytes;  // bytes sent by the most recent flush
+    int64_t last_flush_us;      // duration of the most recent flush
+} ssd1306_stats_t;
+
+/**
+ * @brief SSD1306 handle structure
+ */
+typedef struct {
+    i2c_port_t i2c_port;
+    uint8_t addr;
+    uint8_t framebuffer[SSD1306_BUFFER_SIZE];
+    uint8_t dirty_start[SSD1306_PAGES];  // first dirty column per page (SSD1306_CLEAN if none)
+    uint8_t dirty_end[SSD1306_PAGES];    // last dirty column per page (inclusive)
+    bool display_on;
+    uint32_t sleep_timeout_ms;           // 0 = never sleep
+    int64_t last_motion_time_us;
+    ssd1306_stats_t stats;
+} ssd1306_handle_t;
+
+/**
+ * @brief Initialize SSD1306 display
+ *
+ * Sends the power-up sequence (horizontal addressing mode) and clears
+ * the display RAM.
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param i2c_port I2C port number (I2C_NUM_0 or I2C_NUM_1)
+ * @param addr I2C address of display (typically 0x3C or 0x3D)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t ssd1306_init(ssd1306_handle_t *oled, i2c_port_t i2c_port, uint8_t addr);
+
+/**
+ * @brief Clear framebuffer
+ *
+ * Only columns that were lit are marked dirty.
+ *
+ * @param oled Pointer to SSD1306 handle
+ */
+void ssd1306_clear(ssd1306_handle_t *oled);
+
+/**
+ * @brief Clear a horizontal span of one page
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param col First column (0-127)
+ * @param page Page (0-7)
+ * @param width Number of columns to clear
+ */
+void ssd1306_clear_region(ssd1306_handle_t *oled, uint8_t col, uint8_t page, uint8_t width);
+
+/**
+ * @brief Set or clear a single pixel
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param x Column (0-127)
+ * @param y Row (0-63)
+ * @param on true = lit, false = dark
+ */
+void ssd1306_draw_pixel(ssd1306_handle_t *oled, uint8_t x, uint8_t y, bool on);
+
+/**
+ * @brief Draw a string with the built-in 5x7 font
+ *
+ * Characters outside 0x20-0x7E are drawn as '?'. Text is clipped at the
+ * right edge of the display.
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param col Starting column in pixels (0-127)
+ * @param page Text row (0-7)
+ * @param str String to draw
+ * @return uint8_t Column after the last drawn character
+ */
+uint8_t ssd1306_draw_string(ssd1306_handle_t *oled, uint8_t col, uint8_t page, const char *str);
+
+/**
+ * @brief Draw a full text line, blanking the rest of the page
+ *
+ * Formats like printf, draws from column 0 and clears any columns left over
+ * from a longer previous line.
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param page Text row (0-7)
+ * @param format Format string
+ * @param ... Variable arguments
+ */
+void ssd1306_printf_line(ssd1306_handle_t *oled, uint8_t page, const char *format, ...);
+
+/**
+ * @brief Send dirty framebuffer ranges to the display
+ *
+ * Each dirty page is sent as one command burst (column/page window) and
+ * one data burst. Clean pages are skipped.
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t ssd1306_flush(ssd1306_handle_t *oled);
+
+/**
+ * @brief Turn display panel on or off (display RAM is retained)
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param on true = on, false = sleep
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t ssd1306_display_on(ssd1306_handle_t *oled, bool on);
+
+/**
+ * @brief Set motion-based sleep timeout
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @param timeout_ms Time without motion before the panel sleeps (0 = never)
+ */
+void ssd1306_set_sleep_timeout(ssd1306_handle_t *oled, uint32_t timeout_ms);
+
+/**
+ * @brief Report motion - wakes the panel and restarts the sleep timer
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t ssd1306_notify_motion(ssd1306_handle_t *oled);
+
+/**
+ * @brief Put the panel to sleep if the motion timeout has expired
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t ssd1306_sleep_check(ssd1306_handle_t *oled);
+
+/**
+ * @brief Get flush statistics
+ *
+ * @param oled Pointer to SSD1306 handle
+ * @return const ssd1306_stats_t* Pointer to statistics
+ */
+const ssd1306_stats_t *ssd1306_get_stats(const ssd1306_handle_t *oled);
+
+/**
+ * @brief Reset flush statistics
+ *
+ * @param oled Pointer to SSD1306 handle
+ */
+void ssd1306_reset_stats(ssd1306_handle_t *oled);
+
+#endif  // SSD1306_H
@@ -0,0 +1,409 @@
+/**
+ * @file ssd1306.c
+ * @author Anthony Yalong
+ * @brief I2C SSD1306 128x64 OLED display driver implementation
+ */
+
+#include "ssd1306.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "SSD1306";
+
+// ============================================================================
+// Font (5x7, ASCII 0x20-0x7E, column-major, LSB = top row)
+// ============================================================================
+#define FONT_FIRST_CHAR 0x20
+#define FONT_LAST_CHAR  0x7E
+
+static const uint8_t font5x7[][SSD1306_FONT_WIDTH] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // '!'
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // '"'
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // '#'
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // '$'
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // '%'
+    {0x36, 0x49, 0x56, 0x20, 0x50}, // '&'
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '''
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // '('
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // ')'
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, // '*'
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // '+'
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ','
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // '-'
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // '.'
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // '/'
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // '0'
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // '1'
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // '2'
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // '3'
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // '4'
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // '5'
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // '6'
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // '7'
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // '8'
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // '9'
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // ':'
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ';'
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // '<'
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // '='
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // '>'
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // '?'
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, // '@'
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // 'A'
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // 'B'
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // 'C'
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // 'D'
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // 'E'
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // 'F'
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // 'G'
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // 'H'
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // 'I'
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // 'J'
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // 'K'
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // 'L'
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // 'M'
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // 'N'
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // 'O'
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // 'P'
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // 'Q'
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // 'R'
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // 'S'
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // 'T'
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // 'U'
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // 'V'
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // 'W'
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // 'X'
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // 'Y'
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // 'Z'
+    {0x00, 0x7F, 0x41, 0x41, 0x00}, // '['
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // '\'
+    {0x00, 0x41, 0x41, 0x7F, 0x00}, // ']'
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // '^'
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // '_'
+    {0x00, 0x01, 0x02, 0x04, 0x00}, // '`'
+    {0x20, 0x54, 0x54, 0x54, 0x78}, // 'a'
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, // 'b'
+    {0x38, 0x44, 0x44, 0x44, 0x20}, // 'c'
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, // 'd'
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // 'e'
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, // 'f'
+    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // 'g'
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, // 'h'
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, // 'i'
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, // 'j'
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, // 'k'
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, // 'l'
+    {0x7C, 0x04, 0x18, 0x04, 0x78}, // 'm'
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, // 'n'
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // 'o'
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, // 'p'
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, // 'q'
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, // 'r'
+    {0x48, 0x54, 0x54, 0x54, 0x20}, // 's'
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, // 't'
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // 'u'
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // 'v'
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // 'w'
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // 'x'
+    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // 'y'
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, // 'z'
+    {0x00, 0x08, 0x36, 0x41, 0x00}, // '{'
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, // '|'
+    {0x00, 0x41, 0x36, 0x08, 0x00}, // '}'
+    {0x08, 0x04, 0x08, 0x10, 0x08}, // '~'
+};
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static esp_err_t ssd1306_write(ssd1306_handle_t *oled, uint8_t control,
+                               const uint8_t *data, size_t len) {
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (oled->addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, control, true);
+    i2c_master_write(cmd, data, len, true);
+    i2c_master_stop(cmd);
+    esp_err_t err = i2c_master_cmd_begin(oled->i2c_port, cmd, pdMS_TO_TICKS(SSD1306_I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete(cmd);
+
+    // address + control + payload
+    oled->stats.transactions++;
+    oled->stats.bytes_sent += len + 2;
+
+    return err;
+}
+
+static esp_err_t ssd1306_send_commands(ssd1306_handle_t *oled, const uint8_t *cmds, size_t len) {
+    return ssd1306_write(oled, SSD1306_CONTROL_CMD, cmds, len);
+}
+
+static void mark_dirty(ssd1306_handle_t *oled, uint8_t page, uint8_t col) {
+    if (oled->dirty_start[page] == SSD1306_CLEAN) {
+        oled->dirty_start[page] = col;
+        oled->dirty_end[page] = col;
+        return;
+    }
+    if (col < oled->dirty_start[page]) {
+        oled->dirty_start[page] = col;
+    }
+    if (col > oled->dirty_end[page]) {
+        oled->dirty_end[page] = col;
+    }
+}
+
+static void set_column(ssd1306_handle_t *oled, uint8_t page, uint8_t col, uint8_t value) {
+    uint8_t *cell = &oled->framebuffer[page * SSD1306_WIDTH + col];
+
+    // unchanged bytes never reach the bus
+    if (*cell != value) {
+        *cell = value;
+        mark_dirty(oled, page, col);
+    }
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+esp_err_t ssd1306_init(ssd1306_handle_t *oled, i2c_port_t i2c_port, uint8_t addr) {
+    if (oled == NULL) {
+        ESP_LOGE(TAG, "ssd1306 handle is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(oled, 0, sizeof(*oled));
+    oled->i2c_port = i2c_port;
+    oled->addr = addr;
+    memset(oled->dirty_start, SSD1306_CLEAN, sizeof(oled->dirty_start));
+
+    // power-up sequence for 128x64 panels with internal charge pump
+    static const uint8_t init_cmds[] = {
+        SSD1306_CMD_DISPLAY_OFF,
+        SSD1306_CMD_SET_CLOCK_DIV, 0x80,
+        SSD1306_CMD_SET_MUX_RATIO, SSD1306_HEIGHT - 1,
+        SSD1306_CMD_SET_OFFSET, 0x00,
+        SSD1306_CMD_SET_START_LINE | 0x00,
+        SSD1306_CMD_CHARGE_PUMP, 0x14,
+        SSD1306_CMD_MEMORY_MODE, 0x00,      // horizontal addressing
+        SSD1306_CMD_SEG_REMAP,
+        SSD1306_CMD_COM_SCAN_DEC,
+        SSD1306_CMD_SET_COM_PINS, 0x12,
+        SSD1306_CMD_SET_CONTRAST, 0xCF,
+        SSD1306_CMD_SET_PRECHARGE, 0xF1,
+        SSD1306_CMD_SET_VCOM_DESEL, 0x40,
+        SSD1306_CMD_ENTIRE_ON_RESUME,
+        SSD1306_CMD_NORMAL_DISPLAY,
+        SSD1306_CMD_DISPLAY_ON,
+    };
+    esp_err_t err = ssd1306_send_commands(oled, init_cmds, sizeof(init_cmds));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "failed to send init sequence");
+        return err;
+    }
+    oled->display_on = true;
+    oled->last_motion_time_us = esp_timer_get_time();
+
+    // display ram content is undefined after power-up - push a full blank frame
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        oled->dirty_start[page] = 0;
+        oled->dirty_end[page] = SSD1306_WIDTH - 1;
+    }
+    err = ssd1306_flush(oled);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "failed to clear display ram");
+        return err;
+    }
+    ssd1306_reset_stats(oled);
+
+    ESP_LOGI(TAG, "SSD1306 initialized at address 0x%02X (%dx%d)", addr, SSD1306_WIDTH, SSD1306_HEIGHT);
+    return ESP_OK;
+}
+
+void ssd1306_clear(ssd1306_handle_t *oled) {
+    if (oled == NULL) {
+        return;
+    }
+
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        ssd1306_clear_region(oled, 0, page, SSD1306_WIDTH);
+    }
+}
+
+void ssd1306_clear_region(ssd1306_handle_t *oled, uint8_t col, uint8_t page, uint8_t width) {
+    if (oled == NULL || page >= SSD1306_PAGES) {
+        return;
+    }
+
+    for (uint16_t x = col; x < SSD1306_WIDTH && x < (uint16_t)col + width; x++) {
+        set_column(oled, page, x, 0x00);
+    }
+}
+
+void ssd1306_draw_pixel(ssd1306_handle_t *oled, uint8_t x, uint8_t y, bool on) {
+    if (oled == NULL || x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+        return;
+    }
+
+    uint8_t page = y / 8;
+    uint8_t mask = 1 << (y % 8);
+    uint8_t value = oled->framebuffer[page * SSD1306_WIDTH + x];
+    set_column(oled, page, x, on ? (value | mask) : (value & ~mask));
+}
+
+uint8_t ssd1306_draw_string(ssd1306_handle_t *oled, uint8_t col, uint8_t page, const char *str) {
+    if (oled == NULL || str == NULL || page >= SSD1306_PAGES) {
+        return col;
+    }
+
+    while (*str && col < SSD1306_WIDTH) {
+        char c = *str++;
+        if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
+            c = '?';
+        }
+        const uint8_t *glyph = font5x7[c - FONT_FIRST_CHAR];
+
+        for (uint8_t i = 0; i < SSD1306_CHAR_WIDTH && col < SSD1306_WIDTH; i++, col++) {
+            set_column(oled, page, col, (i < SSD1306_FONT_WIDTH) ? glyph[i] : 0x00);
+        }
+    }
+
+    return col;
+}
+
+void ssd1306_printf_line(ssd1306_handle_t *oled, uint8_t page, const char *format, ...) {
+    if (oled == NULL || format == NULL) {
+        return;
+    }
+
+    char buffer[SSD1306_WIDTH / SSD1306_CHAR_WIDTH + 1];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    uint8_t end = ssd1306_draw_string(oled, 0, page, buffer);
+    ssd1306_clear_region(oled, end, page, SSD1306_WIDTH - end);
+}
+
+esp_err_t ssd1306_flush(ssd1306_handle_t *oled) {
+    if (oled == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    uint32_t bytes_before = oled->stats.bytes_sent;
+    bool sent = false;
+
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        if (oled->dirty_start[page] == SSD1306_CLEAN) {
+            continue;
+        }
+
+        uint8_t start = oled->dirty_start[page];
+        uint8_t end = oled->dirty_end[page];
+
+        // restrict the address window to the dirty range of this page
+        uint8_t window[] = {
+            SSD1306_CMD_COLUMN_ADDR, start, end,
+            SSD1306_CMD_PAGE_ADDR, page, page,
+        };
+        esp_err_t err = ssd1306_send_commands(oled, window, sizeof(window));
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "failed to set window for page %d", page);
+            return err;
+        }
+
+        // whole range in one data burst
+        err = ssd1306_write(oled, SSD1306_CONTROL_DATA,
+                            &oled->framebuffer[page * SSD1306_WIDTH + start], end - start + 1);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "failed to write page %d", page);
+            return err;
+        }
+
+        oled->dirty_start[page] = SSD1306_CLEAN;
+        sent = true;
+    }
+
+    if (sent) {
+        oled->stats.flushes++;
+        oled->stats.last_flush_bytes = oled->stats.bytes_sent - bytes_before;
+        oled->stats.last_flush_us = esp_timer_get_time() - start_time;
+        ESP_LOGD(TAG, "flushed %lu bytes in %lld us", oled->stats.last_flush_bytes, oled->stats.last_flush_us);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t ssd1306_display_on(ssd1306_handle_t *oled, bool on) {
+    if (oled == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t cmd = on ? SSD1306_CMD_DISPLAY_ON : SSD1306_CMD_DISPLAY_OFF;
+    esp_err_t err = ssd1306_send_commands(oled, &cmd, 1);
+    if (err == ESP_OK) {
+        oled->display_on = on;
+    }
+
+    return err;
+}
+
+void ssd1306_set_sleep_timeout(ssd1306_handle_t *oled, uint32_t timeout_ms) {
+    if (oled != NULL) {
+        oled->sleep_timeout_ms = timeout_ms;
+    }
+}
+
+esp_err_t ssd1306_notify_motion(ssd1306_handle_t *oled) {
+    if (oled == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    oled->last_motion_time_us = esp_timer_get_time();
+    if (!oled->display_on) {
+        ESP_LOGD(TAG, "motion - waking display");
+        return ssd1306_display_on(oled, true);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t ssd1306_sleep_check(ssd1306_handle_t *oled) {
+    if (oled == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!oled->display_on || oled->sleep_timeout_ms == 0) {
+        return ESP_OK;
+    }
+
+    int64_t idle_ms = (esp_timer_get_time() - oled->last_motion_time_us) / 1000;
+    if (idle_ms >= oled->sleep_timeout_ms) {
+        ESP_LOGD(TAG, "no motion for %lld ms - display sleeping", idle_ms);
+        return ssd1306_display_on(oled, false);
+    }
+
+    return ESP_OK;
+}
+
+const ssd1306_stats_t *ssd1306_get_stats(const ssd1306_handle_t *oled) {
+    if (oled == NULL) {
+        return NULL;
+    }
+    return &oled->stats;
+}
+
+void ssd1306_reset_stats(ssd1306_handle_t *oled) {
+    if (oled != NULL) {
+        memset(&oled->stats, 0, sizeof(oled->stats));
+    }
+}
@@ -0,0 +1,160 @@
+/**
+ * @file stress.h
+ * @author Anthony Yalong
+ * @brief Synthetic load generator - injects events into the hub pipeline at
+ *        stepped rates, optionally under cpu and flash-write background load,
+ *        and reports the highest rate that keeps latency and drops in budget
+ */
+#ifndef STRESS_H
+#define STRESS_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// configuration
+#ifndef STRESS_MODE
+#define STRESS_MODE                 0       // 0 off, 1 alongside the sensors, 2 instead of them (idf.py -DSTRESS=1 build)
+#endif
+#define STRESS_MAX_STEPS            12
+#define STRESS_TICK_US              1000    // generator tick, due events are injected together
+#define STRESS_SUB_BUCKETS          8       // latency histogram: 8 buckets per octave, within 12.5%
+#define STRESS_BUCKETS              (20 * STRESS_SUB_BUCKETS)
+#define STRESS_MIN_ACHIEVED_PCT     95      // of the offered rate, below it the generator was the limit
+#define STRESS_FLASH_BLOB_LEN       1024    // per nvs commit
+#define STRESS_TASK_STACK           4096
+#define STRESS_TASK_PRIORITY        5       // generator, as the pir task
+#define STRESS_LOAD_PRIORITY        4       // background loads, as the event task
+
+/**
+ * @brief Synthetic event kinds
+ */
+typedef enum {
+    STRESS_MOTION = 0,          // local pir episode start/end (motion storm)
+    STRESS_REMOTE,              // remote node motion (flood)
+    STRESS_DISTANCE,            // ultrasonic sample, fast back-and-forth (rapid distance changes)
+    STRESS_KIND_COUNT,
+} stress_kind_t;
+
+/**
+ * @brief Inject one synthetic event - runs in the generator task
+ *
+ * @param kind Event kind
+ * @param sequence Per-kind count, e.g. even starts and odd ends an episode
+ * @param time_us Injection time (esp_timer_get_time())
+ * @param arg User argument
+ */
+typedef void (*stress_inject_cb_t)(stress_kind_t kind, uint32_t sequence, int64_t time_us, void *arg);
+
+/**
+ * @brief Running count of missed sensor periods (e.g. sample clock overruns)
+ *
+ * @param arg User argument
+ * @return uint32_t Overruns since boot
+ */
+typedef uint32_t (*stress_overrun_cb_t)(void *arg);
+
+/**
+ * @brief Stress run configuration
+ */
+typedef struct {
+    uint32_t rates[STRESS_MAX_STEPS];       // offered events/s, ascending, 0 ends the list
+    uint32_t step_ms;                       // injection time per step
+    uint32_t settle_ms;                     // drain time after each step, still counted
+    uint8_t weights[STRESS_KIND_COUNT];     // event mix, relative
+    uint8_t cpu_load_pct;                   // busy share per core in the loaded pass (0 = none)
+    uint16_t flash_writes_per_s;            // nvs commits in the loaded pass (0 = none)
+    uint32_t slo_p99_us;                    // pipeline latency budget
+    uint32_t slo_max_us;
+    uint32_t slo_max_drops;                 // per step
+    uint32_t slo_max_overruns;              // per step
+    stress_inject_cb_t inject;
+    stress_overrun_cb_t overruns;           // can be NULL
+    void *arg;
+} stress_config_t;
+
+/**
+ * @brief Result of one rate step
+ */
+typedef struct {
+    uint32_t offered;           // events/s
+    uint32_t injected;
+    uint32_t delivered;         // latencies recorded
+    uint32_t dropped;
+    uint32_t overruns;          // sensor periods missed
+    uint32_t generator_lag;     // generator ticks missed
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t min_free_heap;
+    int32_t heap_drift;         // free heap at the end minus at the start
+    bool loaded;                // background loads running
+    bool pass;
+} stress_step_t;
+
+/**
+ * @brief Stress generator structure
+ */
+typedef struct {
+    stress_config_t config;
+    stress_step_t steps[2 * STRESS_MAX_STEPS];  // quiet pass, then loaded pass
+    uint8_t step_count;
+    uint32_t capacity[2];       // highest passing rate, quiet and loaded
+    volatile bool running;      // a step is being measured
+    volatile bool loads_on;
+    volatile bool done;
+
+    // current step, under the spinlock
+    uint32_t hist[STRESS_BUCKETS];
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t max_us;
+    portMUX_TYPE spinlock;
+
+    esp_timer_handle_t timer;
+    TaskHandle_t task;
+} stress_t;
+
+/**
+ * @brief Start a stress run in its own task
+ *
+ * Steps through the rates with no background load, then again with the
+ * cpu and flash loads if any are configured; each pass stops at its first
+ * failing step. The capacity report is logged when the run ends.
+ *
+ * @param stress Pointer to stress structure (must stay valid)
+ * @param config Run configuration
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on bad config,
+ *                   ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t stress_start(stress_t *stress, const stress_config_t *config);
+
+/**
+ * @brief Record one event leaving the pipeline
+ *
+ * Call from the consumer once the event is handled. No-op between steps.
+ *
+ * @param stress Pointer to stress structure
+ * @param latency_us Handling end minus event time
+ */
+void stress_record_latency(stress_t *stress, int64_t latency_us);
+
+/**
+ * @brief Record one event the pipeline dropped (queue full)
+ *
+ * @param stress Pointer to stress structure
+ */
+void stress_record_drop(stress_t *stress);
+
+/**
+ * @brief Log the capacity report
+ *
+ * @param stress Pointer to stress structure
+ */
+void stress_log_report(const stress_t *stress);
+
+#endif  // STRESS_H
@@ -0,0 +1,397 @@
+/**
+ * @file stress.c
+ * @author Anthony Yalong
+ * @brief Synthetic load generator implementation
+ */
+
+#include "stress.h"
+#include <string.h>
+#include "esp_app_desc.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+static const char *TAG = "STRESS";
+
+// background load window: busy for cpu_load_pct of it, asleep for the rest
+#define STRESS_LOAD_WINDOW_MS   100
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Generator task - runs the quiet and loaded passes, then reports
+ *
+ * @param pvParameters Pointer to stress structure
+ */
+static void stress_task(void *pvParameters);
+
+/**
+ * @brief Inject at one rate for a step, let the pipeline drain, evaluate
+ *
+ * @param stress Pointer to stress structure
+ * @param rate Offered events/s
+ * @param step Output step result
+ */
+static void stress_run_step(stress_t *stress, uint32_t rate, stress_step_t *step);
+
+/**
+ * @brief Generator tick - wakes the generator task
+ *
+ * @param arg Pointer to stress structure
+ */
+static void stress_tick(void *arg);
+
+/**
+ * @brief Cpu load task - one per core, busy for cpu_load_pct of each window
+ *
+ * @param pvParameters Pointer to stress structure
+ */
+static void stress_cpu_task(void *pvParameters);
+
+/**
+ * @brief Flash load task - nvs blob commits at flash_writes_per_s
+ *
+ * @param pvParameters Pointer to stress structure
+ */
+static void stress_flash_task(void *pvParameters);
+
+/**
+ * @brief Latency histogram bucket (log-linear)
+ *
+ * @param us Latency
+ * @return int Bucket
+ */
+static int stress_bucket(uint32_t us);
+
+/**
+ * @brief Upper bound of the bucket holding a percentile
+ *
+ * @param hist Histogram
+ * @param total Samples in it
+ * @param percent Percentile
+ * @return uint32_t Bucket upper bound (us)
+ */
+static uint32_t stress_percentile(const uint32_t *hist, uint32_t total, uint32_t percent);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t stress_start(stress_t *stress, const stress_config_t *config) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (stress == NULL || config == NULL || config->inject == NULL || config->rates[0] == 0 ||
+        config->step_ms == 0) {
+        ESP_LOGE(TAG, "stress pointer, inject callback, rates or step time missing");
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t weight = 0;
+    for (int i = 0; i < STRESS_KIND_COUNT; i++) {
+        weight += config->weights[i];
+    }
+    if (weight == 0) {
+        ESP_LOGE(TAG, "event mix is empty");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->cpu_load_pct > 90) {
+        // idle tasks must still run or the task watchdog fires
+        ESP_LOGE(TAG, "cpu load above 90%%");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stress, 0, sizeof(*stress));
+    stress->config = *config;
+    portMUX_INITIALIZE(&stress->spinlock);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = stress_tick,
+        .arg = stress,
+        .name = "stress_tick",
+    };
+    ret = esp_timer_create(&timer_args, &stress->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create generator timer");
+        return ret;
+    }
+
+    if (xTaskCreate(stress_task, "stress_task", STRESS_TASK_STACK, stress, STRESS_TASK_PRIORITY, &stress->task) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "failed to create generator task");
+        esp_timer_delete(stress->timer);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // loads idle until the loaded pass
+    if (config->cpu_load_pct > 0) {
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            xTaskCreatePinnedToCore(stress_cpu_task, "stress_cpu", 2048, stress, STRESS_LOAD_PRIORITY, NULL, core);
+        }
+    }
+    if (config->flash_writes_per_s > 0) {
+        xTaskCreate(stress_flash_task, "stress_flash", 3072, stress, STRESS_LOAD_PRIORITY, NULL);
+    }
+
+    ESP_LOGW(TAG, "stress run started: synthetic events go through the live pipeline");
+    return ESP_OK;
+}
+
+void stress_record_latency(stress_t *stress, int64_t latency_us) {
+    if (stress == NULL || !stress->running) {
+        return;
+    }
+
+    uint32_t us = (latency_us < 0) ? 0 : (latency_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency_us;
+    int bucket = stress_bucket(us);
+    portENTER_CRITICAL(&stress->spinlock);
+    stress->hist[bucket]++;
+    stress->delivered++;
+    if (us > stress->max_us) {
+        stress->max_us = us;
+    }
+    portEXIT_CRITICAL(&stress->spinlock);
+}
+
+void stress_record_drop(stress_t *stress) {
+    if (stress == NULL || !stress->running) {
+        return;
+    }
+
+    portENTER_CRITICAL(&stress->spinlock);
+    stress->dropped++;
+    portEXIT_CRITICAL(&stress->spinlock);
+}
+
+void stress_log_report(const stress_t *stress) {
+    if (stress == NULL) {
+        return;
+    }
+
+    const stress_config_t *config = &stress->config;
+    const esp_app_desc_t *app = esp_app_get_description();
+    char elf[9];
+    esp_app_get_elf_sha256(elf, sizeof(elf));
+
+    ESP_LOGI(TAG, "==== capacity report ====");
+    ESP_LOGI(TAG, "build %s %s, %s %s, idf %s, elf %s, %s", app->project_name, app->version, app->date, app->time,
+             app->idf_ver, elf, (STRESS_MODE == 2) ? "synthetic events only" : "alongside the sensors");
+    ESP_LOGI(TAG, "mix motion/remote/distance %u/%u/%u, %lu s steps, slo p99 %lu us, max %lu us, "
+             "%lu drops, %lu overruns", config->weights[STRESS_MOTION], config->weights[STRESS_REMOTE],
+             config->weights[STRESS_DISTANCE], config->step_ms / 1000, config->slo_p99_us, config->slo_max_us,
+             config->slo_max_drops, config->slo_max_overruns);
+    ESP_LOGI(TAG, "%6s %6s %8s %9s %7s %8s %5s %8s %8s %8s %8s %6s", "rate/s", "load", "injected", "delivered",
+             "dropped", "overruns", "lag", "p50 us", "p99 us", "max us", "min heap", "drift");
+    for (int i = 0; i < stress->step_count; i++) {
+        const stress_step_t *step = &stress->steps[i];
+        ESP_LOGI(TAG, "%6lu %6s %8lu %9lu %7lu %8lu %5lu %8lu %8lu %8lu %8lu %6ld%s", step->offered,
+                 step->loaded ? "loaded" : "quiet", step->injected, step->delivered, step->dropped, step->overruns,
+                 step->generator_lag, step->p50_us, step->p99_us, step->max_us, step->min_free_heap,
+                 step->heap_drift, step->pass ? "" : "  <-- slo broken");
+    }
+    ESP_LOGI(TAG, "max sustainable: %lu events/s quiet", stress->capacity[0]);
+    if (config->cpu_load_pct > 0 || config->flash_writes_per_s > 0) {
+        ESP_LOGI(TAG, "max sustainable: %lu events/s with cpu %u%% per core, %u nvs commits/s", stress->capacity[1],
+                 config->cpu_load_pct, config->flash_writes_per_s);
+    }
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void stress_task(void *pvParameters) {
+    stress_t *stress = (stress_t *)pvParameters;
+    const stress_config_t *config = &stress->config;
+    int passes = (config->cpu_load_pct > 0 || config->flash_writes_per_s > 0) ? 2 : 1;
+
+    esp_timer_start_periodic(stress->timer, STRESS_TICK_US);
+    for (int pass = 0; pass < passes; pass++) {
+        stress->loads_on = (pass == 1);
+        if (pass == 1) {
+            vTaskDelay(pdMS_TO_TICKS(config->settle_ms));
+        }
+
+        // a pass ends at its first broken step, capacity is the step before
+        for (int i = 0; i < STRESS_MAX_STEPS && config->rates[i] != 0; i++) {
+            stress_step_t *step = &stress->steps[stress->step_count++];
+            stress_run_step(stress, config->rates[i], step);
+            step->loaded = (pass == 1);
+            ESP_LOGI(TAG, "%lu events/s %s: p99 %lu us, %lu dropped - %s", step->offered,
+                     step->loaded ? "loaded" : "quiet", step->p99_us, step->dropped, step->pass ? "ok" : "slo broken");
+            if (!step->pass) {
+                break;
+            }
+            stress->capacity[pass] = step->offered;
+        }
+    }
+    stress->loads_on = false;
+    esp_timer_stop(stress->timer);
+    stress->done = true;
+
+    stress_log_report(stress);
+    vTaskDelete(NULL);
+}
+
+static void stress_run_step(stress_t *stress, uint32_t rate, stress_step_t *step) {
+    const stress_config_t *config = &stress->config;
+    uint32_t sequence[STRESS_KIND_COUNT] = { 0 };
+    uint32_t weight = 0;
+    for (int i = 0; i < STRESS_KIND_COUNT; i++) {
+        weight += config->weights[i];
+    }
+
+    memset(step, 0, sizeof(*step));
+    step->offered = rate;
+    uint32_t overruns_start = config->overruns ? config->overruns(config->arg) : 0;
+    uint32_t heap_start = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    step->min_free_heap = heap_start;
+
+    portENTER_CRITICAL(&stress->spinlock);
+    memset(stress->hist, 0, sizeof(stress->hist));
+    stress->delivered = 0;
+    stress->dropped = 0;
+    stress->max_us = 0;
+    stress->running = true;
+    portEXIT_CRITICAL(&stress->spinlock);
+
+    // credit in micro-events, so rates below one per tick come out even
+    uint64_t credit = 0;
+    uint32_t rng = 0x9e3779b9u ^ rate;
+    ulTaskNotifyTake(pdTRUE, 0);
+    int64_t end = esp_timer_get_time() + (int64_t)config->step_ms * 1000;
+    int64_t now = esp_timer_get_time();
+    while (now < end) {
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        step->generator_lag += ticks - 1;
+        credit += (uint64_t)rate * STRESS_TICK_US * ticks;
+
+        // injections slower than the rate leave credit over, dropped at the end
+        now = esp_timer_get_time();
+        while (credit >= 1000000 && now < end) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            uint32_t pick = rng % weight;
+            int kind = 0;
+            while (pick >= config->weights[kind]) {
+                pick -= config->weights[kind++];
+            }
+            config->inject((stress_kind_t)kind, sequence[kind]++, now, config->arg);
+            step->injected++;
+            credit -= 1000000;
+            now = esp_timer_get_time();
+        }
+
+        uint32_t heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        if (heap < step->min_free_heap) {
+            step->min_free_heap = heap;
+        }
+    }
+
+    // events still queued belong to this step
+    vTaskDelay(pdMS_TO_TICKS(config->settle_ms));
+    portENTER_CRITICAL(&stress->spinlock);
+    stress->running = false;
+    step->delivered = stress->delivered;
+    step->dropped = stress->dropped;
+    step->max_us = stress->max_us;
+    portEXIT_CRITICAL(&stress->spinlock);
+
+    step->p50_us = stress_percentile(stress->hist, step->delivered, 50);
+    step->p99_us = stress_percentile(stress->hist, step->delivered, 99);
+    step->overruns = config->overruns ? config->overruns(config->arg) - overruns_start : 0;
+    step->heap_drift = (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT) - (int32_t)heap_start;
+
+    uint64_t wanted = (uint64_t)rate * config->step_ms / 1000;
+    step->pass = (uint64_t)step->injected * 100 >= wanted * STRESS_MIN_ACHIEVED_PCT &&
+                 step->p99_us <= config->slo_p99_us && step->max_us <= config->slo_max_us &&
+                 step->dropped <= config->slo_max_drops && step->overruns <= config->slo_max_overruns;
+}
+
+static void stress_tick(void *arg) {
+    stress_t *stress = (stress_t *)arg;
+    xTaskNotifyGive(stress->task);
+}
+
+static void stress_cpu_task(void *pvParameters) {
+    stress_t *stress = (stress_t *)pvParameters;
+    uint32_t busy_ms = STRESS_LOAD_WINDOW_MS * stress->config.cpu_load_pct / 100;
+    volatile uint32_t spin = 0;
+
+    while (!stress->done) {
+        if (!stress->loads_on) {
+            vTaskDelay(pdMS_TO_TICKS(STRESS_LOAD_WINDOW_MS));
+            continue;
+        }
+        int64_t until = esp_timer_get_time() + (int64_t)busy_ms * 1000;
+        while (esp_timer_get_time() < until) {
+            spin++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(STRESS_LOAD_WINDOW_MS - busy_ms));
+    }
+    vTaskDelete(NULL);
+}
+
+static void stress_flash_task(void *pvParameters) {
+    stress_t *stress = (stress_t *)pvParameters;
+    static uint8_t blob[STRESS_FLASH_BLOB_LEN];
+    TickType_t period = pdMS_TO_TICKS(1000 / stress->config.flash_writes_per_s);
+    nvs_handle_t handle;
+
+    if (nvs_open("stress", NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs, no flash load");
+        vTaskDelete(NULL);
+    }
+
+    // every commit disables the flash cache on both cores
+    TickType_t last_wake = xTaskGetTickCount();
+    while (!stress->done) {
+        if (!stress->loads_on) {
+            vTaskDelay(pdMS_TO_TICKS(STRESS_LOAD_WINDOW_MS));
+            last_wake = xTaskGetTickCount();
+            continue;
+        }
+        blob[0]++;
+        nvs_set_blob(handle, "blob", blob, sizeof(blob));
+        nvs_commit(handle);
+        vTaskDelayUntil(&last_wake, (period > 0) ? period : 1);
+    }
+
+    nvs_erase_key(handle, "blob");
+    nvs_commit(handle);
+    nvs_close(handle);
+    vTaskDelete(NULL);
+}
+
+static int stress_bucket(uint32_t us) {
+    // exact below 8 us, then 8 buckets per power of two
+    if (us < STRESS_SUB_BUCKETS) {
+        return us;
+    }
+    int octave = 31 - __builtin_clz(us);
+    int bucket = (octave - 2) * STRESS_SUB_BUCKETS + ((us >> (octave - 3)) & (STRESS_SUB_BUCKETS - 1));
+    return (bucket < STRESS_BUCKETS) ? bucket : STRESS_BUCKETS - 1;
+}
+
+static uint32_t stress_percentile(const uint32_t *hist, uint32_t total, uint32_t percent) {
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = ((uint64_t)total * percent + 99) / 100;
+    uint64_t seen = 0;
+    int bucket = STRESS_BUCKETS - 1;
+    for (int i = 0; i < STRESS_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            bucket = i;
+            break;
+        }
+    }
+    if (bucket < STRESS_SUB_BUCKETS) {
+        return bucket;
+    }
+    int octave = bucket / STRESS_SUB_BUCKETS + 2;
+    uint32_t sub = bucket % STRESS_SUB_BUCKETS;
+    return ((STRESS_SUB_BUCKETS + sub + 1) << (octave - 3)) - 1;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file webui.h
+ * @author Anthony Yalong
+ * @brief Web dashboard served zero-copy from a memory-mapped flash partition
+ */
+#ifndef WEBUI_H
+#define WEBUI_H
+
+// imports
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "esp_partition.h"
+#include "webui_assets.h"
+
+// configuration
+#define WEBUI_PARTITION_LABEL       "webui"
+#define WEBUI_PARTITION_SUBTYPE     0x40    // custom data subtype (partitions.csv)
+#define WEBUI_STATUS_BUF_LEN        768     // /api/status json, on the server stack
+#define WEBUI_MAX_SOCKETS           7
+#define WEBUI_TASK_PRIORITY         2       // below every sensor task
+#define WEBUI_STACK_SIZE            6144    // room for streaming handlers' chunk buffers
+
+/**
+ * @brief Status callback - writes the /api/status json document
+ *
+ * @return int Length written, negative or >= len on failure
+ */
+typedef int (*webui_status_cb_t)(char *buf, size_t len, void *arg);
+
+/**
+ * @brief Asset serving statistics
+ */
+typedef struct {
+    uint32_t requests;          // asset requests (200 + 304 + 404)
+    uint32_t not_modified;      // 304 replies from etag revalidation
+    uint32_t not_found;
+    uint64_t bytes_sent;        // asset bodies
+    uint64_t handler_us;        // total time inside the asset handler
+    int32_t max_heap_delta;     // largest free-heap drop across one request
+    uint32_t min_free_heap;     // heap low-water mark
+} webui_stats_t;
+
+/**
+ * @brief Web ui structure
+ */
+typedef struct {
+    webui_assets_t assets;
+    esp_partition_mmap_handle_t mmap_handle;
+    httpd_handle_t server;
+    webui_status_cb_t status_cb;
+    void *status_arg;
+    webui_stats_t stats;
+} webui_t;
+
+/**
+ * @brief Map the webui partition and start the http server
+ *
+ * Only the packed image (not the whole partition) is mapped. Assets are
+ * sent straight from the mapping with their stored Content-Encoding and a
+ * strong ETag; If-None-Match revalidation answers 304 without a body.
+ *
+ * @param webui Pointer to web ui structure
+ * @param status_cb Callback for /api/status (can be NULL)
+ * @param arg User argument for status_cb
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the partition is
+ *                   missing, ESP_ERR_INVALID_VERSION if it holds no image,
+ *                   error code from mmap or httpd otherwise
+ */
+esp_err_t webui_start(webui_t *webui, webui_status_cb_t status_cb, void *arg);
+
+/**
+ * @brief Register an application handler (e.g. an export endpoint)
+ *
+ * The asset wildcard is moved behind it so the new uri is matched first.
+ *
+ * @param webui Pointer to started web ui structure
+ * @param uri Handler to register
+ * @return esp_err_t ESP_OK on success, error code from httpd otherwise
+ */
+esp_err_t webui_register_uri(webui_t *webui, const httpd_uri_t *uri);
+
+/**
+ * @brief Get asset serving statistics
+ *
+ * @param webui Pointer to web ui structure
+ * @param stats Output statistics
+ */
+void webui_get_stats(const webui_t *webui, webui_stats_t *stats);
+
+#endif  // WEBUI_H
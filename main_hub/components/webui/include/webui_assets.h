@@ -0,0 +1,88 @@
+/**
+ * @file webui_assets.h
+ * @author Anthony Yalong
+ * @brief Read-only index over a packed web ui image (tools/webui_pack.py).
+ *        Lookups return pointers into the image itself - nothing is copied.
+ */
+#ifndef WEBUI_ASSETS_H
+#define WEBUI_ASSETS_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// image layout (must match tools/webui_pack.py)
+#define WEBUI_ASSETS_MAGIC          "WUI1"
+#define WEBUI_ASSETS_PATH_LEN       56
+#define WEBUI_ASSETS_TYPE_LEN       32
+#define WEBUI_ASSETS_ETAG_LEN       24
+#define WEBUI_ASSETS_FLAG_GZIP      0x01
+
+/**
+ * @brief Image header
+ */
+typedef struct {
+    char magic[4];
+    uint32_t count;             // index entries
+    uint32_t size;              // header + index + data
+    uint32_t reserved;
+} webui_assets_header_t;
+
+/**
+ * @brief Index entry (sorted by path)
+ */
+typedef struct {
+    char path[WEBUI_ASSETS_PATH_LEN];
+    char content_type[WEBUI_ASSETS_TYPE_LEN];
+    char etag[WEBUI_ASSETS_ETAG_LEN];   // quoted strong etag
+    uint32_t offset;            // from image start
+    uint32_t length;            // stored (possibly gzip) length
+    uint32_t flags;
+    uint32_t reserved;
+} webui_assets_entry_t;
+
+/**
+ * @brief Opened image
+ */
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+    const webui_assets_entry_t *entries;
+    uint32_t count;
+} webui_assets_t;
+
+/**
+ * @brief Asset found by a lookup (points into the image)
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    const char *content_type;
+    const char *etag;
+    bool gzip;
+} webui_asset_t;
+
+/**
+ * @brief Validate an image and open its index
+ *
+ * @param assets Pointer to assets structure
+ * @param base Image start (e.g. a memory-mapped partition)
+ * @param size Bytes available at base
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_VERSION on bad magic,
+ *                   ESP_ERR_INVALID_SIZE if the index or data runs past size
+ */
+esp_err_t webui_assets_open(webui_assets_t *assets, const void *base, size_t size);
+
+/**
+ * @brief Find an asset by request path (binary search)
+ *
+ * @param assets Pointer to assets structure
+ * @param path Request path without query string, e.g. "/app.js"
+ * @param asset Output asset
+ * @return bool true if found
+ */
+bool webui_assets_find(const webui_assets_t *assets, const char *path, webui_asset_t *asset);
+
+#endif  // WEBUI_ASSETS_H
@@ -0,0 +1,273 @@
+/**
+ * @file webui.c
+ * @author Anthony Yalong
+ * @brief Web dashboard server implementation
+ */
+
+#include "webui.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "WEBUI";
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Serve a packed asset ("/" is the index page)
+ *
+ * @param req Request
+ * @return esp_err_t Send result
+ */
+static esp_err_t webui_asset_handler(httpd_req_t *req);
+
+/**
+ * @brief Serve /api/status from the status callback
+ *
+ * @param req Request
+ * @return esp_err_t Send result
+ */
+static esp_err_t webui_status_handler(httpd_req_t *req);
+
+/**
+ * @brief Serve /api/webui - asset serving statistics
+ *
+ * @param req Request
+ * @return esp_err_t Send result
+ */
+static esp_err_t webui_stats_handler(httpd_req_t *req);
+
+/**
+ * @brief Map the packed image from the webui partition
+ *
+ * @param webui Pointer to web ui structure
+ * @return esp_err_t ESP_OK on success, error code otherwise
+ */
+static esp_err_t webui_map_partition(webui_t *webui);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t webui_start(webui_t *webui, webui_status_cb_t status_cb, void *arg) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (webui == NULL) {
+        ESP_LOGE(TAG, "webui pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(webui, 0, sizeof(*webui));
+    webui->status_cb = status_cb;
+    webui->status_arg = arg;
+    webui->stats.min_free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    ret = webui_map_partition(webui);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // wildcard matching for assets; lru purge keeps new clients from being refused
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    config.lru_purge_enable = true;
+    config.max_open_sockets = WEBUI_MAX_SOCKETS;
+    config.task_priority = WEBUI_TASK_PRIORITY;
+    config.stack_size = WEBUI_STACK_SIZE;
+
+    ret = httpd_start(&webui->server, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start http server");
+        esp_partition_munmap(webui->mmap_handle);
+        return ret;
+    }
+
+    // api handlers before the asset wildcard, matched in registration order
+    const httpd_uri_t handlers[] = {
+        { .uri = "/api/status", .method = HTTP_GET, .handler = webui_status_handler, .user_ctx = webui },
+        { .uri = "/api/webui", .method = HTTP_GET, .handler = webui_stats_handler, .user_ctx = webui },
+        { .uri = "/*", .method = HTTP_GET, .handler = webui_asset_handler, .user_ctx = webui },
+    };
+    for (size_t i = 0; i < sizeof(handlers) / sizeof(handlers[0]); i++) {
+        httpd_register_uri_handler(webui->server, &handlers[i]);
+    }
+
+    ESP_LOGI(TAG, "web ui started: %lu assets, %u byte image mapped", webui->assets.count, webui->assets.size);
+    return ESP_OK;
+}
+
+esp_err_t webui_register_uri(webui_t *webui, const httpd_uri_t *uri) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (webui == NULL || webui->server == NULL || uri == NULL) {
+        ESP_LOGE(TAG, "web ui not started or uri is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // handlers match in registration order, the wildcard has to stay last
+    httpd_unregister_uri_handler(webui->server, "/*", HTTP_GET);
+    ret = httpd_register_uri_handler(webui->server, uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to register %s", uri->uri);
+    }
+
+    const httpd_uri_t assets = { .uri = "/*", .method = HTTP_GET, .handler = webui_asset_handler, .user_ctx = webui };
+    httpd_register_uri_handler(webui->server, &assets);
+    return ret;
+}
+
+void webui_get_stats(const webui_t *webui, webui_stats_t *stats) {
+    if (webui == NULL || stats == NULL) {
+        return;
+    }
+    *stats = webui->stats;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t webui_asset_handler(httpd_req_t *req) {
+    // error management
+    esp_err_t ret;
+
+    webui_t *webui = (webui_t *)req->user_ctx;
+    int64_t start = esp_timer_get_time();
+    size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    webui->stats.requests++;
+
+    // strip the query string, "/" serves the index
+    char path[WEBUI_ASSETS_PATH_LEN];
+    size_t length = strcspn(req->uri, "?");
+    if (length >= sizeof(path)) {
+        webui->stats.not_found++;
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "not found");
+    }
+    memcpy(path, req->uri, length);
+    path[length] = '\0';
+    if (strcmp(path, "/") == 0) {
+        strcpy(path, "/index.html");
+    }
+
+    webui_asset_t asset;
+    if (!webui_assets_find(&webui->assets, path, &asset)) {
+        webui->stats.not_found++;
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "not found");
+    }
+
+    // etag is a content hash, so browsers revalidate instead of refetching
+    httpd_resp_set_hdr(req, "ETag", asset.etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    char if_none_match[WEBUI_ASSETS_ETAG_LEN];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strcmp(if_none_match, asset.etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        ret = httpd_resp_send(req, NULL, 0);
+        webui->stats.not_modified++;
+    } else {
+        httpd_resp_set_type(req, asset.content_type);
+        if (asset.gzip) {
+            httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        }
+
+        // body goes from the flash mapping to the socket, no staging buffer
+        ret = httpd_resp_send(req, (const char *)asset.data, asset.length);
+        webui->stats.bytes_sent += asset.length;
+    }
+
+    // heap impact of this request (lwip may still hold unacked segments)
+    size_t heap_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    int32_t delta = (int32_t)heap_before - (int32_t)heap_after;
+    if (delta > webui->stats.max_heap_delta) {
+        webui->stats.max_heap_delta = delta;
+    }
+    if (heap_after < webui->stats.min_free_heap) {
+        webui->stats.min_free_heap = heap_after;
+    }
+    webui->stats.handler_us += esp_timer_get_time() - start;
+    return ret;
+}
+
+static esp_err_t webui_status_handler(httpd_req_t *req) {
+    webui_t *webui = (webui_t *)req->user_ctx;
+    char buf[WEBUI_STATUS_BUF_LEN];
+
+    if (webui->status_cb == NULL) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "no status");
+    }
+
+    int length = webui->status_cb(buf, sizeof(buf), webui->status_arg);
+    if (length < 0 || length >= (int)sizeof(buf)) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "status too large");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, buf, length);
+}
+
+static esp_err_t webui_stats_handler(httpd_req_t *req) {
+    webui_t *webui = (webui_t *)req->user_ctx;
+    webui_stats_t stats = webui->stats;
+    char buf[256];
+
+    int length = snprintf(buf, sizeof(buf),
+                          "{\"requests\":%lu,\"not_modified\":%lu,\"not_found\":%lu,\"bytes_sent\":%llu,"
+                          "\"avg_handler_us\":%llu,\"max_heap_delta\":%ld,\"min_free_heap\":%lu,\"free_heap\":%u}",
+                          stats.requests, stats.not_modified, stats.not_found, stats.bytes_sent,
+                          stats.requests ? stats.handler_us / stats.requests : 0, stats.max_heap_delta,
+                          stats.min_free_heap, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, buf, length);
+}
+
+static esp_err_t webui_map_partition(webui_t *webui) {
+    // error management
+    esp_err_t ret;
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, WEBUI_PARTITION_SUBTYPE,
+                                                                WEBUI_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGE(TAG, "no %s partition in the partition table", WEBUI_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // header first, so only the image is mapped
+    webui_assets_header_t header;
+    ret = esp_partition_read(partition, 0, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to read webui partition");
+        return ret;
+    }
+    if (memcmp(header.magic, WEBUI_ASSETS_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "webui partition holds no image - flash it with idf.py flash");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header.size > partition->size) {
+        ESP_LOGE(TAG, "webui image larger than its partition");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const void *mapped;
+    ret = esp_partition_mmap(partition, 0, header.size, ESP_PARTITION_MMAP_DATA, &mapped, &webui->mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to map webui partition");
+        return ret;
+    }
+
+    ret = webui_assets_open(&webui->assets, mapped, header.size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "corrupt webui image");
+        esp_partition_munmap(webui->mmap_handle);
+        return ret;
+    }
+    return ESP_OK;
+}
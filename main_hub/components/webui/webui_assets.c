@@ -0,0 +1,75 @@
+/**
+ * @file webui_assets.c
+ * @author Anthony Yalong
+ * @brief Packed web ui image index implementation
+ */
+
+#include "webui_assets.h"
+#include <string.h>
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t webui_assets_open(webui_assets_t *assets, const void *base, size_t size) {
+    // sanity check
+    if (assets == NULL || base == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const webui_assets_header_t *header = (const webui_assets_header_t *)base;
+    if (size < sizeof(*header) || memcmp(header->magic, WEBUI_ASSETS_MAGIC, 4) != 0) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header->size > size ||
+        header->count > (header->size - sizeof(*header)) / sizeof(webui_assets_entry_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // every entry must stay inside the image and be terminated
+    const webui_assets_entry_t *entries = (const webui_assets_entry_t *)(header + 1);
+    for (uint32_t i = 0; i < header->count; i++) {
+        const webui_assets_entry_t *entry = &entries[i];
+        if (entry->offset > header->size || entry->length > header->size - entry->offset ||
+            memchr(entry->path, '\0', WEBUI_ASSETS_PATH_LEN) == NULL ||
+            memchr(entry->content_type, '\0', WEBUI_ASSETS_TYPE_LEN) == NULL ||
+            memchr(entry->etag, '\0', WEBUI_ASSETS_ETAG_LEN) == NULL) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    assets->base = (const uint8_t *)base;
+    assets->size = header->size;
+    assets->entries = entries;
+    assets->count = header->count;
+    return ESP_OK;
+}
+
+bool webui_assets_find(const webui_assets_t *assets, const char *path, webui_asset_t *asset) {
+    if (assets == NULL || path == NULL || asset == NULL) {
+        return false;
+    }
+
+    // index is sorted by the packer
+    uint32_t low = 0;
+    uint32_t high = assets->count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const webui_assets_entry_t *entry = &assets->entries[mid];
+        int cmp = strcmp(path, entry->path);
+
+        if (cmp == 0) {
+            asset->data = assets->base + entry->offset;
+            asset->length = entry->length;
+            asset->content_type = entry->content_type;
+            asset->etag = entry->etag;
+            asset->gzip = (entry->flags & WEBUI_ASSETS_FLAG_GZIP) != 0;
+            return true;
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file hub_events.h
+ * @author Anthony Yalong
+ * @brief Hub event definitions shared by sensor tasks and event consumers.
+ *        Sensor tasks publish state transitions here instead of raw samples.
+ */
+
+#ifndef HUB_EVENTS_H
+#define HUB_EVENTS_H
+
+// imports
+#include <stdint.h>
+
+// event queue configuration
+#define HUB_EVENT_QUEUE_LEN     32
+
+// event sources
+typedef enum {
+    HUB_SOURCE_LOCAL_PIR = 0,
+    HUB_SOURCE_REMOTE_NODE,
+    HUB_SOURCE_ANALOG,
+    HUB_SOURCE_ACOUSTIC,
+    HUB_SOURCE_ACCEL,
+    HUB_SOURCE_KEYPAD,
+    HUB_SOURCE_PRESENCE,
+    HUB_SOURCE_ULTRASONIC,
+    HUB_SOURCE_ENVIRONMENT,
+} hub_event_source_t;
+
+// event types
+typedef enum {
+    HUB_EVENT_MOTION_START = 0,
+    HUB_EVENT_MOTION_END,
+    HUB_EVENT_ANALOG_ALARM,
+    HUB_EVENT_ANALOG_CLEAR,
+    HUB_EVENT_ANALOG_TREND,
+    HUB_EVENT_GLASS_BREAK,
+    HUB_EVENT_TAMPER_START,
+    HUB_EVENT_TAMPER_END,
+    HUB_EVENT_ARMED,
+    HUB_EVENT_DISARMED,
+    HUB_EVENT_PIN_REJECTED,
+    HUB_EVENT_APPROACHING,
+    HUB_EVENT_RECEDING,
+    HUB_EVENT_LOITERING,
+    HUB_EVENT_HEAT_ALARM,
+    HUB_EVENT_HEAT_CLEAR,
+} hub_event_type_t;
+
+// hub event
+typedef struct {
+    hub_event_type_t type;
+    hub_event_source_t source;
+    int64_t timestamp_us;           // time the event was generated
+    union {
+        struct {
+            int64_t start_time_us;  // episode start
+            int64_t duration_us;    // end only: first to last motion
+            uint32_t retrigger_count; // end only: motion events after the first
+        } motion;
+        struct {
+            uint8_t channel;        // analog channel index
+            int32_t level;          // decimated level (raw adc units)
+            int32_t trend;          // rising trend estimate
+        } analog;
+        struct {
+            float impact_ratio;     // impact energy over noise floor
+            float hf_ratio;         // peak high-band ratio during shatter
+        } acoustic;
+        struct {
+            uint32_t rms_mg;        // batch rms of dynamic acceleration
+            uint32_t peak_mg;       // batch peak single-axis deviation
+        } vibration;
+        struct {
+            uint8_t channel;        // ultrasonic channel index
+            int16_t distance_cm;    // filtered distance
+            int16_t velocity_cm_s;  // radial, negative when approaching
+            uint8_t confidence;     // 0-100
+        } approach;
+        struct {
+            uint8_t cause;          // HEAT_CAUSE_* bits (alarm only)
+            float temperature_c;
+            float rate_c_min;       // window slope, C per minute
+        } heat;
+    };
+} hub_event_t;
+
+#endif  // HUB_EVENTS_H
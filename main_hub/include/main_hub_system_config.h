@@ -10,11 +10,14 @@
 
 // imports
 #include <driver/gpio.h>
+#include <hal/adc_types.h>
 #include <esp_err.h>
+#include "compressor.h"
 
 // pir configuration
 #define PIR_GPIO_PIN        GPIO_NUM_13
 #define PIR_DEBOUNCE_TIME_MS 50
+#define PIR_EPISODE_HOLD_TIME_MS 10000
 
 // hcsr04 configuration
 #define HCSR04_PIN_TRIG      GPIO_NUM_12
@@ -22,9 +25,117 @@
 #define HCSR04_TIMEOUT_US    30000
 #define HCSR04_DISTANCE_CHANGE_THRESHOLD_CM 1.0 
 
+// approach tracker configuration (alpha-beta filter on the ultrasonic series)
+#define APPROACH_ALPHA          0.8f            // critically damped: beta = alpha^2 / (2 - alpha)
+#define APPROACH_BETA           0.53f
+#define APPROACH_SPEED_CM_S     30.0f           // radial speed for approaching / receding
+#define APPROACH_NEAR_CM        150.0f          // still target within this range is loitering
+#define APPROACH_LOITER_MS      5000
+
 // dht11 configuration
 #define DHT11_GPIO_PIN      GPIO_NUM_27
 
+// heat detector configuration (fixed temperature and rate of rise on the dht11 series)
+#define HEAT_FIXED_C            50.0f           // dht11 ceiling: a saturated reading is at least this
+#define HEAT_RATE_C_MIN         8.3f            // 15 F/min, the usual rate-of-rise setting
+#define HEAT_WINDOW_MS          60000           // slope window, 20 readings (shorter windows put cooking near the threshold)
+
+// ds18b20 zone temperature bus configuration
+#define DS18B20_GPIO_PIN    GPIO_NUM_23
+#define DS18B20_RESOLUTION  12              // bits, 750 ms conversion
+
+// sample clock configuration (microseconds) - phases keep channels from coinciding
+#define PIR_SAMPLE_PERIOD_US            100000
+#define PIR_SAMPLE_PHASE_US             10000
+#define ULTRASONIC_SAMPLE_PERIOD_US     200000
+#define ULTRASONIC_SAMPLE_PHASE_US      60000
+#define DHT11_SAMPLE_PERIOD_US          3000000
+#define DHT11_SAMPLE_PHASE_US           25000   // 18 ms start signal and ~5 ms frame end before the echo
+#define DS18B20_SAMPLE_PERIOD_US        10000000
+#define DS18B20_SAMPLE_PHASE_US         85000
+
+// analog sensor configuration (adc1 continuous mode)
+#define ANALOG_SAMPLE_FREQ_HZ           20000           // total, 5 kHz per channel
+#define ANALOG_DECIMATION_LOG2          6               // 5 kHz / 64 = 78 Hz outputs
+#define ANALOG_REPORT_EVERY             78              // level report ~1 s
+#define ANALOG_GAS_CHANNEL              ADC_CHANNEL_6   // GPIO 34 (MQ-2)
+#define ANALOG_GAS_THRESHOLD            2500
+#define ANALOG_SMOKE_CHANNEL            ADC_CHANNEL_7   // GPIO 35
+#define ANALOG_SMOKE_THRESHOLD          2000
+#define ANALOG_LIGHT_CHANNEL            ADC_CHANNEL_4   // GPIO 32 (LDR divider)
+#define ANALOG_SOUND_CHANNEL            ADC_CHANNEL_5   // GPIO 33 (mic amplifier)
+#define ANALOG_SOUND_THRESHOLD          600
+#define ANALOG_HYSTERESIS               100
+#define ANALOG_TREND_THRESHOLD          64              // 4 adc units per output, sustained
+
+// acoustic sensor configuration (i2s mems microphone)
+#define ACOUSTIC_BCLK_PIN               GPIO_NUM_26
+#define ACOUSTIC_WS_PIN                 GPIO_NUM_25
+#define ACOUSTIC_DIN_PIN                GPIO_NUM_36     // input-only pin is enough for data in
+
+// keypad configuration (3x4 membrane keypad, arm/disarm)
+#define KEYPAD_ROW_PINS         { GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19 }
+#define KEYPAD_COL_PINS         { GPIO_NUM_5, GPIO_NUM_15, GPIO_NUM_2 }
+#define KEYPAD_KEYMAP           "123456789*0#"
+#define KEYPAD_ENTRY_TIMEOUT_MS 10000           // partial entry discarded after this
+
+// presence configuration (passive ble scan for household phones)
+#define PRESENCE_ENTER_RSSI     -75             // dBm, smoothed rssi to become present
+#define PRESENCE_EXIT_RSSI      -88             // dBm, smoothed rssi to leave
+#define PRESENCE_AWAY_TIMEOUT_MS 120000         // no adverts for this long = away
+#define PRESENCE_AUTO_ARM       1               // arm when the last device leaves
+#define PRESENCE_SCAN_ITVL      0x0050          // 50 ms (0.625 ms units)
+#define PRESENCE_SCAN_WINDOW    0x0030          // 30 ms
+
+// web ui configuration (wifi station, dashboard from the webui partition)
+#define WIFI_SSID               ""              // empty disables wifi and the web ui
+#define WIFI_PASSWORD           ""
+
+// history configuration (in-ram store, exported at /api/history)
+// samples are compressed before they are stored: deadband for stepwise
+// sensors, swinging door for slowly varying ones; deviations are the
+// reconstruction error bound in channel units
+#define HISTORY_MAX_INTERVAL_MS         300000          // a point per channel at least every 5 min
+#define HISTORY_DISTANCE_MODE           COMPRESSOR_SWINGING_DOOR
+#define HISTORY_DISTANCE_DEVIATION      2.0f            // cm
+#define HISTORY_TEMPERATURE_MODE        COMPRESSOR_DEADBAND
+#define HISTORY_TEMPERATURE_DEVIATION   1.0f            // C, whole degrees: drops +/-1 flicker (accuracy +/-2)
+#define HISTORY_HUMIDITY_MODE           COMPRESSOR_DEADBAND
+#define HISTORY_HUMIDITY_DEVIATION      2.0f            // %, whole percent (accuracy +/-5)
+#define HISTORY_ZONE_MODE               COMPRESSOR_SWINGING_DOOR
+#define HISTORY_ZONE_DEVIATION          0.1f            // C
+#define HISTORY_ANALOG_MODE             COMPRESSOR_SWINGING_DOOR
+#define HISTORY_ANALOG_DEVIATION        16.0f           // adc units
+
+// occupancy configuration (hour-of-week rollups per zone, exported at /api/occupancy)
+// zones map a motion event source and sensor index to a named zone; one zone
+// can be fed by several sensors
+#define OCCUPANCY_ZONES                 { { "hub", HUB_SOURCE_LOCAL_PIR, 0 } }
+#define OCCUPANCY_PERSIST_PERIOD_MS     3600000         // dirty rollups written to nvs hourly
+#define OCCUPANCY_CLOCK_VALID           1704067200      // 2024-01-01, episodes before the first sntp sync are not counted
+#define SNTP_SERVER                     "pool.ntp.org"
+#define HUB_TIMEZONE                    "UTC0"          // posix tz, slots are local hours
+
+// profiling configuration
+#define LOCKPROF_REPORT_PERIOD_MS       60000           // lock contention report (idf.py -DLOCK_PROFILE=1 build)
+
+// stress configuration (idf.py -DSTRESS=1 build, -DSTRESS=2 with the sampled sensors off)
+// synthetic events step up through the rates until the pipeline breaks its
+// budget, then again under cpu and flash-write background load
+#define STRESS_RATES                    { 10, 20, 50, 100, 200, 500, 1000, 2000 }   // events/s
+#define STRESS_STEP_MS                  20000
+#define STRESS_SETTLE_MS                2000            // queue drain after each step
+#define STRESS_WEIGHTS                  { 1, 1, 1 }     // motion storm, remote flood, distance changes
+#define STRESS_CPU_LOAD_PCT             50              // per core, loaded pass
+#define STRESS_FLASH_WRITES_PER_S       5               // 1 kB nvs commits, loaded pass
+#define STRESS_SLO_P99_US               100000          // publish to handled
+#define STRESS_SLO_MAX_US               1000000
+#define STRESS_SLO_MAX_DROPS            0
+#define STRESS_SLO_MAX_OVERRUNS         0               // sampling clock periods missed
+
+// replay configuration (idf.py -DREPLAY=1 build records the sensor inputs, -DREPLAY=2 replays them)
+#define REPLAY_SESSION                  0               // sessions back from the newest, 1 if the hub restarted since
+
 // i2c Configuration
 #define I2C_MASTER_SCL_IO       GPIO_NUM_22
 #define I2C_MASTER_SDA_IO       GPIO_NUM_21
@@ -32,6 +143,13 @@
 #define I2C_MASTER_FREQ_HZ      100000
 #define I2C_MASTER_TIMEOUT_MS   1000
 
+// adxl345 tamper sensor configuration (shares the i2c bus)
+#define ADXL345_ADDR            0x53
+#define ADXL345_INT_PIN         GPIO_NUM_4
+#define ADXL345_WATERMARK       25              // 125 ms batches at 200 Hz
+#define ADXL345_RMS_THRESHOLD_MG  40
+#define ADXL345_PEAK_THRESHOLD_MG 150
+
 // lcd Configuration
 #define LCD_ADDR                0x27
 #define LCD_COLUMNS             16
@@ -5,14 +5,22 @@
  */
 
 // imports
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/i2c.h"
 #include "driver/gpio.h"
 #include "nvs_flash.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "esp_netif_sntp.h"
 #include "esp_nimble_hci.h"
 #include "nimble/nimble_port.h"
 #include "nimble/nimble_port_freertos.h"
@@ -22,9 +30,30 @@
 #include "services/gatt/ble_svc_gatt.h"
 #include "pir.h"
 #include "hcsr04.h"
+#include "approach.h"
 #include "dht11.h"
+#include "heat.h"
+#include "ds18b20.h"
 #include "lcd_i2c.h"
+#include "sample_clock.h"
+#include "sensor.h"
+#include "analog_sensor.h"
+#include "acoustic.h"
+#include "adxl345.h"
+#include "keypad.h"
+#include "keypad_pin.h"
+#include "presence.h"
+#include "webui.h"
+#include "history.h"
+#include "history_http.h"
+#include "compressor.h"
+#include "occupancy.h"
+#include "occupancy_http.h"
+#include "lockprof.h"
+#include "stress.h"
+#include "replay.h"
 #include "main_hub_system_config.h"
+#include "hub_events.h"
 
 static const char *TAG = "MAIN_HUB";
 
@@ -44,18 +73,96 @@ static struct {
     float humidity;
     bool remote_motion_detected;
     bool remote_connected;
+    int32_t analog_levels[ANALOG_MAX_CHANNELS];
+    float zone_temperatures[DS18B20_MAX_DEVICES];
+    uint8_t zone_count;
+    bool armed;
     SemaphoreHandle_t mutex;
 } sensor_data;
 
+// hub event queue (hub_event_t)
+static QueueHandle_t event_queue;
+
+// synthetic load generator (stress builds only)
+static stress_t stress;
+
+// sensor input recorder / replayer (replay builds only)
+static replay_t replay;
+
 // ============================================================================
 // sensor instances
 // ============================================================================
 
 static pir_sensor_t pir_sensor;
 static hcsr04_sensor_t ultrasonic_sensor;
+static approach_tracker_t approach_tracker;
 static dht11_sensor_t dht11_sensor;
+static heat_detector_t heat_detector;
+static ds18b20_bus_t zone_sensors;
 static lcd_handle_t lcd;
 
+// sampling clock: pir, hc-sr04 and dht11 share one registry task, the zone bus has its own
+static sample_clock_t sample_clock;
+static sensor_registry_t sensors;
+static int zone_channel = -1;
+
+// analog sensors (index order = analog_channels order)
+static analog_sensor_t analog_engine;
+static const analog_channel_config_t analog_channels[] = {
+    { ANALOG_GAS_CHANNEL, ANALOG_DECIMATION_LOG2, false, ANALOG_GAS_THRESHOLD, ANALOG_HYSTERESIS,
+      ANALOG_TREND_THRESHOLD, ANALOG_REPORT_EVERY },
+    { ANALOG_SMOKE_CHANNEL, ANALOG_DECIMATION_LOG2, false, ANALOG_SMOKE_THRESHOLD, ANALOG_HYSTERESIS,
+      ANALOG_TREND_THRESHOLD, ANALOG_REPORT_EVERY },
+    { ANALOG_LIGHT_CHANNEL, ANALOG_DECIMATION_LOG2, false, 0, 0, 0, ANALOG_REPORT_EVERY },
+    { ANALOG_SOUND_CHANNEL, ANALOG_DECIMATION_LOG2, true, ANALOG_SOUND_THRESHOLD, ANALOG_HYSTERESIS,
+      0, ANALOG_REPORT_EVERY },
+};
+
+static const char *analog_names[] = { "gas", "smoke", "light", "sound" };
+
+// glass-break detection
+static acoustic_sensor_t acoustic_sensor;
+
+// enclosure tamper detection
+static adxl345_sensor_t tamper_sensor;
+
+// arm/disarm keypad
+static keypad_t keypad;
+static const gpio_num_t keypad_rows[] = KEYPAD_ROW_PINS;
+static const gpio_num_t keypad_cols[] = KEYPAD_COL_PINS;
+
+// phone presence (auto arm/disarm)
+static presence_t presence;
+static bool presence_ready = false;
+
+// web dashboard
+static webui_t webui;
+
+// sensor history (streamed by /api/history), sampled channels fed through a compressor
+typedef struct {
+    int channel;
+    compressor_t compressor;
+} history_feed_t;
+
+static history_t history;
+static int history_motion_channel;
+static history_feed_t history_distance;
+static history_feed_t history_temperature;
+static history_feed_t history_humidity;
+static history_feed_t history_analog[ANALOG_MAX_CHANNELS];
+static history_feed_t history_zones[DS18B20_MAX_DEVICES];
+
+// occupancy rollups (streamed by /api/occupancy), fed by motion episodes
+typedef struct {
+    const char *name;
+    hub_event_source_t source;
+    uint8_t sensor;
+} occupancy_zone_config_t;
+
+static occupancy_t occupancy;
+static bool occupancy_ready = false;
+static const occupancy_zone_config_t occupancy_zones[] = OCCUPANCY_ZONES;
+
 // ble connection handle
 static uint16_t ble_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 
@@ -71,25 +178,236 @@ static uint16_t ble_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 esp_err_t i2c_master_init(void);
 
 /**
- * @brief pir motion sensor task - polls sensor every 100ms
+ * @brief publish an event to the hub event queue (non-blocking)
+ * 
+ * @param event event to publish
+ */
+static void hub_event_publish(const hub_event_t *event);
+
+/**
+ * @brief record the digest of an event produced by a recorded input (replaying: check it)
+ * 
+ * @param event event being published
+ */
+static void hub_event_replay(const hub_event_t *event);
+
+/**
+ * @brief set the armed state and publish the transition (no event if unchanged)
+ * 
+ * @param armed new armed state
+ * @param source who requested the change
+ */
+static void hub_set_armed(bool armed, hub_event_source_t source);
+
+/**
+ * @brief analog engine callback - level reports update shared data, detections become hub events
+ * 
+ * @param event analog event
+ * @param arg user argument
+ */
+static void analog_event_handler(const analog_event_t *event, void *arg);
+
+/**
+ * @brief acoustic callback - publishes glass-break detections
+ * 
+ * @param event glass-break detection
+ * @param arg user argument
+ */
+static void acoustic_event_handler(const acoustic_event_t *event, void *arg);
+
+/**
+ * @brief accelerometer callback - publishes tamper episodes
+ * 
+ * @param event tamper event
+ * @param arg user argument
+ */
+static void tamper_event_handler(const adxl345_event_t *event, void *arg);
+
+/**
+ * @brief presence callback - first arrival disarms, last departure arms
+ * 
+ * @param event presence transition
+ * @param arg user argument
+ */
+static void presence_event_handler(const presence_event_t *event, void *arg);
+
+/**
+ * @brief connect to the configured wifi network as a station
+ * 
+ * @return esp_err_t ESP_OK once started (connection completes in the background)
+ */
+static esp_err_t wifi_init_sta(void);
+
+/**
+ * @brief wifi/ip event handler - connects, reconnects and logs the address
+ * 
+ * @param arg user argument
+ * @param base event base
+ * @param id event id
+ * @param data event data
+ */
+static void wifi_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data);
+
+/**
+ * @brief web ui status callback - shared sensor data as json
+ * 
+ * @param buf output buffer
+ * @param len buffer length
+ * @param arg user argument
+ * @return int json length
+ */
+static int webui_status_json(char *buf, size_t len, void *arg);
+
+/**
+ * @brief register the history channels and their compressors (zones after the bus is enumerated)
+ * 
+ * @return esp_err_t ESP_OK on success
+ */
+static esp_err_t history_channels_init(void);
+
+/**
+ * @brief register one compressed history channel
+ * 
+ * @param feed feed to initialize
+ * @param name channel name
+ * @param decimals stored fixed point digits
+ * @param mode compression mode
+ * @param deviation reconstruction error bound
+ * @return esp_err_t ESP_OK on success
+ */
+static esp_err_t history_feed_init(history_feed_t *feed, const char *name, uint8_t decimals,
+                                   compressor_mode_t mode, float deviation);
+
+/**
+ * @brief offer a sample to a history channel, stored only if the compressor emits a point
+ * 
+ * @param feed history feed
+ * @param time_us sample time
+ * @param value sample value
+ */
+static void history_feed_sample(history_feed_t *feed, int64_t time_us, float value);
+
+/**
+ * @brief process one ultrasonic distance - shared data, history and approach events
+ * 
+ * @param now_us sample time
+ * @param distance distance in cm
+ */
+static void ultrasonic_process(int64_t now_us, float distance);
+
+/**
+ * @brief process one pir poll - records it, publishes episode transitions
+ * 
+ * @param now_us sample time
+ * @param level pir output level
+ */
+static void pir_sample(int64_t now_us, bool level);
+
+/**
+ * @brief process one hc-sr04 read - records it, distance or a miss for the tracker
+ * 
+ * @param now_us sample time
+ * @param ok echo received
+ * @param pulse_us echo width
+ */
+static void ultrasonic_sample(int64_t now_us, bool ok, int32_t pulse_us);
+
+/**
+ * @brief process one dht11 read - records it, shared data, history and heat events
+ * 
+ * @param now_us sample time
+ * @param ok frame received with a good checksum
+ * @param humidity relative humidity (%)
+ * @param temperature temperature (C)
+ */
+static void climate_sample(int64_t now_us, bool ok, uint8_t humidity, uint8_t temperature);
+
+/**
+ * @brief process a remote node link change - records it, shared data
+ * 
+ * @param now_us event time
+ * @param connected link up
+ */
+static void remote_link(int64_t now_us, bool connected);
+
+/**
+ * @brief pir sample callback (sensor task)
+ * 
+ * @param sample completed sample
+ * @param arg user argument
+ */
+static void pir_sample_handler(const sensor_sample_t *sample, void *arg);
+
+/**
+ * @brief hc-sr04 sample callback (sensor task)
+ * 
+ * @param sample completed sample
+ * @param arg user argument
+ */
+static void ultrasonic_sample_handler(const sensor_sample_t *sample, void *arg);
+
+/**
+ * @brief dht11 sample callback (sensor task) - whole degrees and percent
+ * 
+ * @param sample completed sample
+ * @param arg user argument
+ */
+static void climate_sample_handler(const sensor_sample_t *sample, void *arg);
+
+/**
+ * @brief replay callback - feeds a recorded input through the same path as the live one
+ * 
+ * @param record input record
+ * @param arg user argument
+ */
+static void replay_feed(const replay_record_t *record, void *arg);
+
+/**
+ * @brief stress callback - injects a synthetic event through the same path as the real source
+ * 
+ * @param kind synthetic event kind
+ * @param sequence per-kind count
+ * @param time_us injection time
+ * @param arg user argument
+ */
+static void stress_inject(stress_kind_t kind, uint32_t sequence, int64_t time_us, void *arg);
+
+/**
+ * @brief stress callback - sampling clock overruns summed over all channels
+ * 
+ * @param arg user argument
+ * @return uint32_t overruns since boot
+ */
+static uint32_t stress_overruns(void *arg);
+
+/**
+ * @brief event task - consumes hub events
  * 
  * @param pvParameters task parameters
  */
-void pir_task(void *pvParameters);
+void event_task(void *pvParameters);
 
 /**
- * @brief ultrasonic distance sensor task - polls sensor every 200ms
+ * @brief ds18b20 zone temperature task - one parallel conversion every 10s on the sampling clock
  * 
  * @param pvParameters task parameters
  */
-void ultrasonic_task(void *pvParameters);
+void zone_temperature_task(void *pvParameters);
 
 /**
- * @brief dht11 temperature/humidity sensor task - polls sensor every 3s
+ * @brief keypad entry task - collects pin digits, verifies on '#', toggles armed state;
+ *        '*' on an empty entry starts a pin change (current '#', new '#', new again '#')
  * 
  * @param pvParameters task parameters
  */
-void dht11_task(void *pvParameters);
+void keypad_entry_task(void *pvParameters);
+
+/**
+ * @brief replay task - feeds a recorded session through the hub logic, logs the result
+ * 
+ * @param pvParameters task parameters
+ */
+void replay_task(void *pvParameters);
 
 /**
  * @brief lcd display task - updates display every 1s
@@ -98,6 +416,13 @@ void dht11_task(void *pvParameters);
  */
 void lcd_task(void *pvParameters);
 
+/**
+ * @brief persist task - writes changed occupancy rollups to nvs every hour
+ * 
+ * @param pvParameters task parameters
+ */
+void persist_task(void *pvParameters);
+
 /**
  * @brief ble client task - scans and connects to remote node
  * 
@@ -121,6 +446,11 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg);
  */
 static void ble_host_task(void *param);
 
+/**
+ * @brief start the passive presence scan
+ */
+static void ble_presence_scan_start(void);
+
 /**
  * @brief callback when ble stack is synced
  */
@@ -160,6 +490,15 @@ void app_main(void) {
         ESP_LOGE(TAG, "failed to create mutex");
         return;
     }
+    LOCKPROF_REGISTER(sensor_data.mutex, "sensor_data", LOCKPROF_MUTEX);
+    
+    // create hub event queue
+    event_queue = xQueueCreate(HUB_EVENT_QUEUE_LEN, sizeof(hub_event_t));
+    if (event_queue == NULL) {
+        ESP_LOGE(TAG, "failed to create event queue");
+        return;
+    }
+    LOCKPROF_REGISTER(event_queue, "event_queue", LOCKPROF_QUEUE);
     
     // initialize sensor data
     sensor_data.motion_detected = false;
@@ -168,6 +507,10 @@ void app_main(void) {
     sensor_data.humidity = 0.0f;
     sensor_data.remote_motion_detected = false;
     sensor_data.remote_connected = false;
+    memset(sensor_data.analog_levels, 0, sizeof(sensor_data.analog_levels));
+    memset(sensor_data.zone_temperatures, 0, sizeof(sensor_data.zone_temperatures));
+    sensor_data.zone_count = 0;
+    sensor_data.armed = false;
     
     // initialize i2c bus
     ret = i2c_master_init();
@@ -191,27 +534,167 @@ void app_main(void) {
     lcd_print(&lcd, "Initializing...");
     vTaskDelay(pdMS_TO_TICKS(2000));
     
+    // sampled sensors register with their driver interface, one task reads them all
+    sensor_registry_init(&sensors, &sample_clock);
+    
     // initialize pir sensor
-    ret = pir_init(&pir_sensor, PIR_GPIO_PIN, PIR_DEBOUNCE_TIME_MS);
+    const pir_config_t pir_config = { PIR_GPIO_PIN, PIR_DEBOUNCE_TIME_MS, PIR_EPISODE_HOLD_TIME_MS };
+    ret = sensor_registry_add(&sensors, &pir_driver, &pir_sensor, &pir_config, PIR_SAMPLE_PERIOD_US,
+                              PIR_SAMPLE_PHASE_US, pir_sample_handler, NULL);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "failed to initialize pir sensor");
         return;
     }
     
     // initialize ultrasonic sensor
-    ret = hcsr04_init(&ultrasonic_sensor, HCSR04_PIN_TRIG, HCSR04_PIN_ECHO, HCSR04_TIMEOUT_US);
+    const hcsr04_config_t hcsr04_config = { HCSR04_PIN_TRIG, HCSR04_PIN_ECHO, HCSR04_TIMEOUT_US };
+    ret = sensor_registry_add(&sensors, &hcsr04_driver, &ultrasonic_sensor, &hcsr04_config,
+                              ULTRASONIC_SAMPLE_PERIOD_US, ULTRASONIC_SAMPLE_PHASE_US, ultrasonic_sample_handler, NULL);
+    if (ret == ESP_OK) {
+        ret = approach_init(&approach_tracker, APPROACH_ALPHA, APPROACH_BETA, APPROACH_SPEED_CM_S,
+                            APPROACH_NEAR_CM, APPROACH_LOITER_MS);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "failed to initialize ultrasonic sensor");
         return;
     }
     
     // initialize dht11 sensor
-    ret = dht11_init(&dht11_sensor, DHT11_GPIO_PIN);
+    const dht11_config_t dht11_config = { DHT11_GPIO_PIN };
+    ret = sensor_registry_add(&sensors, &dht11_driver, &dht11_sensor, &dht11_config, DHT11_SAMPLE_PERIOD_US,
+                              DHT11_SAMPLE_PHASE_US, climate_sample_handler, NULL);
+    if (ret == ESP_OK) {
+        ret = heat_init(&heat_detector, HEAT_FIXED_C, HEAT_RATE_C_MIN, HEAT_WINDOW_MS);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "failed to initialize dht11 sensor");
         return;
     }
     
+    // initialize ds18b20 zone bus (optional - zero sensors found is not an error)
+    ret = ds18b20_init(&zone_sensors, DS18B20_GPIO_PIN);
+    if (ret == ESP_OK && zone_sensors.count > 0) {
+        ret = ds18b20_set_resolution(&zone_sensors, DS18B20_RESOLUTION);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "zone temperature bus not available");
+        zone_sensors.count = 0;
+    }
+    
+    // initialize sensor history (zone channels need the enumerated bus, before any producer starts)
+    ret = history_init(&history);
+    if (ret == ESP_OK) {
+        ret = history_channels_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize history");
+        return;
+    }
+    
+    // initialize occupancy rollups (optional - restored from their own nvs partition)
+    setenv("TZ", HUB_TIMEZONE, 1);
+    tzset();
+    ret = occupancy_init(&occupancy);
+    for (size_t i = 0; i < sizeof(occupancy_zones) / sizeof(occupancy_zones[0]) && ret == ESP_OK; i++) {
+        ret = occupancy_add_zone(&occupancy, occupancy_zones[i].name, occupancy_zones[i].source,
+                                 occupancy_zones[i].sensor, NULL);
+    }
+    if (ret == ESP_OK) {
+        ret = occupancy_load(&occupancy);
+    }
+    occupancy_ready = (ret == ESP_OK);
+    if (!occupancy_ready) {
+        ESP_LOGW(TAG, "occupancy rollups not available");
+    }
+    
+    // initialize analog sensors (optional - hub keeps running without them)
+    ret = analog_sensor_init(&analog_engine, analog_channels,
+                             sizeof(analog_channels) / sizeof(analog_channels[0]),
+                             ANALOG_SAMPLE_FREQ_HZ, analog_event_handler, NULL);
+    if (ret == ESP_OK) {
+        ret = analog_sensor_start(&analog_engine);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "analog sensors not available");
+    }
+    
+    // initialize glass-break detection (optional - hub keeps running without it)
+    ret = acoustic_sensor_init(&acoustic_sensor, acoustic_event_handler, NULL);
+    if (ret == ESP_OK) {
+        ret = acoustic_sensor_start(&acoustic_sensor, ACOUSTIC_BCLK_PIN, ACOUSTIC_WS_PIN, ACOUSTIC_DIN_PIN);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "acoustic sensor not available: %s", esp_err_to_name(ret));
+    }
+    
+    // initialize tamper sensor (optional - hub keeps running without it)
+    ret = adxl345_init(&tamper_sensor, ADXL345_RMS_THRESHOLD_MG, ADXL345_PEAK_THRESHOLD_MG,
+                       tamper_event_handler, NULL);
+    if (ret == ESP_OK) {
+        ret = adxl345_start(&tamper_sensor, I2C_MASTER_NUM, ADXL345_ADDR, ADXL345_INT_PIN, ADXL345_WATERMARK);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "tamper sensor not available");
+    }
+    
+    // initialize keypad (optional - hub keeps running without it)
+    ret = keypad_init(&keypad, keypad_rows, sizeof(keypad_rows) / sizeof(keypad_rows[0]),
+                      keypad_cols, sizeof(keypad_cols) / sizeof(keypad_cols[0]), KEYPAD_KEYMAP);
+    if (ret == ESP_OK && !keypad_pin_is_set()) {
+        // no default pin: arm/disarm stays off the keypad until one is provisioned (keypad_pin_set())
+        ESP_LOGW(TAG, "no keypad pin provisioned");
+        ret = ESP_ERR_NOT_FOUND;
+    }
+    bool keypad_ready = (ret == ESP_OK);
+    if (!keypad_ready) {
+        ESP_LOGW(TAG, "keypad not available");
+    }
+    
+    // initialize presence engine (optional - needs provisioned devices, scan starts on ble sync)
+    ret = presence_init(&presence, PRESENCE_ENTER_RSSI, PRESENCE_EXIT_RSSI, PRESENCE_AWAY_TIMEOUT_MS,
+                        presence_event_handler, NULL);
+    if (ret == ESP_OK) {
+        ret = presence_load(&presence);
+    }
+    if (ret == ESP_OK && presence.count == 0) {
+        ESP_LOGW(TAG, "no presence devices provisioned");
+        ret = ESP_ERR_NOT_FOUND;
+    }
+    if (ret == ESP_OK) {
+        ret = presence_start(&presence);
+    }
+    presence_ready = (ret == ESP_OK);
+    if (!presence_ready) {
+        ESP_LOGW(TAG, "presence detection not available");
+    }
+    
+    // initialize wifi and web ui (optional - needs credentials and a flashed webui partition)
+    ret = (strlen(WIFI_SSID) > 0) ? wifi_init_sta() : ESP_ERR_NOT_FOUND;
+    if (ret == ESP_OK) {
+        ret = webui_start(&webui, webui_status_json, NULL);
+    }
+    if (ret == ESP_OK) {
+        const httpd_uri_t history_uri = {
+            .uri = "/api/history",
+            .method = HTTP_GET,
+            .handler = history_http_export_handler,
+            .user_ctx = &history,
+        };
+        ret = webui_register_uri(&webui, &history_uri);
+    }
+    if (ret == ESP_OK && occupancy_ready) {
+        const httpd_uri_t occupancy_uri = {
+            .uri = "/api/occupancy",
+            .method = HTTP_GET,
+            .handler = occupancy_http_export_handler,
+            .user_ctx = &occupancy,
+        };
+        ret = webui_register_uri(&webui, &occupancy_uri);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "web ui not available");
+    }
+    
     // initialize ble
     ret = nimble_port_init();
     if (ret != ESP_OK) {
@@ -230,14 +713,92 @@ void app_main(void) {
     // start ble host task
     nimble_port_freertos_init(ble_host_task);
     
+    // initialize sampling clock
+    ret = sample_clock_init(&sample_clock);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize sample clock");
+        return;
+    }
+    
+    // record sensor inputs (replay record builds only, optional - hub keeps running without it)
+    if (REPLAY_MODE == 1) {
+        const uint32_t periods[REPLAY_STREAM_COUNT] = {
+            PIR_SAMPLE_PERIOD_US, ULTRASONIC_SAMPLE_PERIOD_US, DHT11_SAMPLE_PERIOD_US, 0,
+        };
+        if (replay_record_start(&replay, periods) != ESP_OK) {
+            ESP_LOGW(TAG, "input recording not available");
+        }
+    }
+    
     ESP_LOGI(TAG, "all sensors and ble initialized");
     
-    // create sensor tasks
-    xTaskCreate(pir_task, "pir_task", 4096, NULL, 5, NULL);
-    xTaskCreate(ultrasonic_task, "ultrasonic_task", 4096, NULL, 4, NULL);
-    xTaskCreate(dht11_task, "dht11_task", 4096, NULL, 3, NULL);
+    // create tasks
+    TaskHandle_t zone_handle = NULL;
+    xTaskCreate(event_task, "event_task", 4096, NULL, 4, NULL);
+    if (zone_sensors.count > 0) {
+        xTaskCreate(zone_temperature_task, "zone_temp_task", 4096, NULL, 3, &zone_handle);
+    }
+    if (keypad_ready) {
+        xTaskCreate(keypad_entry_task, "keypad_entry", 4096, NULL, 5, NULL);
+    }
     xTaskCreate(ble_client_task, "ble_client_task", 4096, NULL, 3, NULL);
     xTaskCreate(lcd_task, "lcd_task", 4096, NULL, 2, NULL);
+    if (occupancy_ready) {
+        xTaskCreate(persist_task, "persist_task", 4096, NULL, 1, NULL);
+    }
+    
+    // sensors are paced by the sampling clock, phases keep them apart
+    // (a stress build without sensors or a replay build leaves the clock stopped and the sensors unread)
+    if (STRESS_MODE != 2 && REPLAY_MODE != 2) {
+        ret = sensor_registry_start(&sensors, 5);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to start sensor task");
+            return;
+        }
+        // the zone task waits for its channel index before its first sample_clock_wait()
+        if (zone_handle != NULL) {
+            if (sample_clock_add_channel(&sample_clock, zone_handle, DS18B20_SAMPLE_PERIOD_US,
+                                         DS18B20_SAMPLE_PHASE_US, &zone_channel) == ESP_OK) {
+                xTaskNotifyGive(zone_handle);
+            } else {
+                ESP_LOGW(TAG, "no clock channel for zone temperatures");
+            }
+        }
+        ret = sample_clock_start(&sample_clock);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to start sample clock");
+            return;
+        }
+    }
+    
+    // recorded inputs instead of the sensors (replay builds only)
+    if (REPLAY_MODE == 2) {
+        xTaskCreate(replay_task, "replay_task", 4096, NULL, 1, NULL);
+    }
+    
+    // lock contention report (lock profiling builds only)
+    LOCKPROF_START_REPORTER(LOCKPROF_REPORT_PERIOD_MS);
+    
+    // synthetic load ramp (stress builds only), logs the capacity report when done
+    if (STRESS_MODE) {
+        const stress_config_t stress_config = {
+            .rates = STRESS_RATES,
+            .step_ms = STRESS_STEP_MS,
+            .settle_ms = STRESS_SETTLE_MS,
+            .weights = STRESS_WEIGHTS,
+            .cpu_load_pct = STRESS_CPU_LOAD_PCT,
+            .flash_writes_per_s = STRESS_FLASH_WRITES_PER_S,
+            .slo_p99_us = STRESS_SLO_P99_US,
+            .slo_max_us = STRESS_SLO_MAX_US,
+            .slo_max_drops = STRESS_SLO_MAX_DROPS,
+            .slo_max_overruns = STRESS_SLO_MAX_OVERRUNS,
+            .inject = stress_inject,
+            .overruns = stress_overruns,
+        };
+        if (stress_start(&stress, &stress_config) != ESP_OK) {
+            ESP_LOGE(TAG, "failed to start stress run");
+        }
+    }
     
     ESP_LOGI(TAG, "all tasks created - system running");
 }
@@ -273,78 +834,746 @@ esp_err_t i2c_master_init(void) {
     return ESP_OK;
 }
 
+static void hub_event_publish(const hub_event_t *event) {
+    hub_event_replay(event);
+    
+    if (LOCKPROF_SEND(event_queue, event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "event queue full, dropped event type %d", event->type);
+        stress_record_drop(&stress);
+    }
+}
+
+static void hub_event_replay(const hub_event_t *event) {
+    replay_stream_t stream;
+    
+    // only events of recorded inputs
+    switch (event->source) {
+        case HUB_SOURCE_LOCAL_PIR:
+            stream = REPLAY_PIR;
+            break;
+        case HUB_SOURCE_ULTRASONIC:
+            stream = REPLAY_DISTANCE;
+            break;
+        case HUB_SOURCE_ENVIRONMENT:
+            stream = REPLAY_CLIMATE;
+            break;
+        default:
+            return;
+    }
+    
+    // field by field, the union's unused bytes are not defined
+    uint32_t digest = replay_digest(REPLAY_DIGEST_INIT, &event->type, sizeof(event->type));
+    digest = replay_digest(digest, &event->timestamp_us, sizeof(event->timestamp_us));
+    if (stream == REPLAY_PIR) {
+        digest = replay_digest(digest, &event->motion.start_time_us, sizeof(event->motion.start_time_us));
+        digest = replay_digest(digest, &event->motion.duration_us, sizeof(event->motion.duration_us));
+        digest = replay_digest(digest, &event->motion.retrigger_count, sizeof(event->motion.retrigger_count));
+    } else if (stream == REPLAY_DISTANCE) {
+        digest = replay_digest(digest, &event->approach.distance_cm, sizeof(event->approach.distance_cm));
+        digest = replay_digest(digest, &event->approach.velocity_cm_s, sizeof(event->approach.velocity_cm_s));
+        digest = replay_digest(digest, &event->approach.confidence, sizeof(event->approach.confidence));
+    } else {
+        digest = replay_digest(digest, &event->heat.cause, sizeof(event->heat.cause));
+        digest = replay_digest(digest, &event->heat.temperature_c, sizeof(event->heat.temperature_c));
+        digest = replay_digest(digest, &event->heat.rate_c_min, sizeof(event->heat.rate_c_min));
+    }
+    replay_decision(&replay, stream, digest);
+}
+
+static void hub_set_armed(bool armed, hub_event_source_t source) {
+    bool changed = false;
+    
+    if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        changed = (sensor_data.armed != armed);
+        sensor_data.armed = armed;
+        LOCKPROF_GIVE(sensor_data.mutex);
+    }
+    
+    if (changed) {
+        hub_event_t event = {
+            .type = armed ? HUB_EVENT_ARMED : HUB_EVENT_DISARMED,
+            .source = source,
+            .timestamp_us = esp_timer_get_time(),
+        };
+        hub_event_publish(&event);
+    }
+}
+
+static void analog_event_handler(const analog_event_t *event, void *arg) {
+    // periodic level reports go to shared data only
+    if (event->type == ANALOG_EVENT_LEVEL) {
+        if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+            sensor_data.analog_levels[event->index] = event->level;
+            LOCKPROF_GIVE(sensor_data.mutex);
+        }
+        history_feed_sample(&history_analog[event->index], esp_timer_get_time(), event->level);
+        return;
+    }
+    
+    hub_event_t hub_event = {
+        .source = HUB_SOURCE_ANALOG,
+        .timestamp_us = esp_timer_get_time(),
+        .analog = {
+            .channel = event->index,
+            .level = event->level,
+            .trend = event->trend,
+        },
+    };
+    switch (event->type) {
+        case ANALOG_EVENT_ALARM:
+            hub_event.type = HUB_EVENT_ANALOG_ALARM;
+            break;
+        case ANALOG_EVENT_CLEAR:
+            hub_event.type = HUB_EVENT_ANALOG_CLEAR;
+            break;
+        default:
+            hub_event.type = HUB_EVENT_ANALOG_TREND;
+            break;
+    }
+    hub_event_publish(&hub_event);
+}
+
+static void acoustic_event_handler(const acoustic_event_t *event, void *arg) {
+    hub_event_t hub_event = {
+        .type = HUB_EVENT_GLASS_BREAK,
+        .source = HUB_SOURCE_ACOUSTIC,
+        .timestamp_us = esp_timer_get_time(),
+        .acoustic = {
+            .impact_ratio = event->impact_ratio,
+            .hf_ratio = event->hf_ratio,
+        },
+    };
+    hub_event_publish(&hub_event);
+}
+
+static void tamper_event_handler(const adxl345_event_t *event, void *arg) {
+    hub_event_t hub_event = {
+        .type = (event->type == ADXL345_EVENT_TAMPER_START) ? HUB_EVENT_TAMPER_START : HUB_EVENT_TAMPER_END,
+        .source = HUB_SOURCE_ACCEL,
+        .timestamp_us = esp_timer_get_time(),
+        .vibration = {
+            .rms_mg = event->batch.rms_mg,
+            .peak_mg = event->batch.peak_mg,
+        },
+    };
+    hub_event_publish(&hub_event);
+}
+
+static void presence_event_handler(const presence_event_t *event, void *arg) {
+    if (event->type == PRESENCE_EVENT_ARRIVED && event->present_count == 1) {
+        hub_set_armed(false, HUB_SOURCE_PRESENCE);
+    } else if (PRESENCE_AUTO_ARM && event->type == PRESENCE_EVENT_LEFT && event->present_count == 0) {
+        hub_set_armed(true, HUB_SOURCE_PRESENCE);
+    }
+}
+
+static esp_err_t history_channels_init(void) {
+    // error management
+    esp_err_t ret;
+    
+    ret = history_add_channel(&history, "motion", 0, &history_motion_channel);
+    if (ret == ESP_OK) {
+        ret = history_feed_init(&history_distance, "distance", 1, HISTORY_DISTANCE_MODE, HISTORY_DISTANCE_DEVIATION);
+    }
+    if (ret == ESP_OK) {
+        ret = history_feed_init(&history_temperature, "temperature", 1, HISTORY_TEMPERATURE_MODE,
+                                HISTORY_TEMPERATURE_DEVIATION);
+    }
+    if (ret == ESP_OK) {
+        ret = history_feed_init(&history_humidity, "humidity", 0, HISTORY_HUMIDITY_MODE, HISTORY_HUMIDITY_DEVIATION);
+    }
+    for (int i = 0; i < (int)(sizeof(analog_channels) / sizeof(analog_channels[0])) && ret == ESP_OK; i++) {
+        ret = history_feed_init(&history_analog[i], analog_names[i], 0, HISTORY_ANALOG_MODE, HISTORY_ANALOG_DEVIATION);
+    }
+    for (int i = 0; i < zone_sensors.count && ret == ESP_OK; i++) {
+        char name[HISTORY_NAME_LEN];
+        snprintf(name, sizeof(name), "zone%d", i);
+        ret = history_feed_init(&history_zones[i], name, 2, HISTORY_ZONE_MODE, HISTORY_ZONE_DEVIATION);
+    }
+    return ret;
+}
+
+static esp_err_t history_feed_init(history_feed_t *feed, const char *name, uint8_t decimals,
+                                   compressor_mode_t mode, float deviation) {
+    esp_err_t ret = history_add_channel(&history, name, decimals, &feed->channel);
+    if (ret == ESP_OK) {
+        ret = compressor_init(&feed->compressor, mode, deviation, HISTORY_MAX_INTERVAL_MS);
+    }
+    return ret;
+}
+
+static void history_feed_sample(history_feed_t *feed, int64_t time_us, float value) {
+    compressor_point_t point;
+    
+    if (compressor_add(&feed->compressor, time_us, value, &point)) {
+        history_record(&history, feed->channel, point.time_us / 1000000, point.value);
+    }
+}
+
+static void ultrasonic_process(int64_t now_us, float distance) {
+    // update shared data
+    if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        sensor_data.distance_cm = distance;
+        LOCKPROF_GIVE(sensor_data.mutex);
+    }
+    history_feed_sample(&history_distance, now_us, distance);
+    
+    // track radial motion, publish approach transitions
+    approach_event_t approach;
+    approach_event_type_t type = approach_update(&approach_tracker, now_us, distance, &approach);
+    if (type != APPROACH_EVENT_NONE) {
+        hub_event_t event = {
+            .type = (type == APPROACH_EVENT_APPROACHING) ? HUB_EVENT_APPROACHING :
+                    (type == APPROACH_EVENT_RECEDING) ? HUB_EVENT_RECEDING : HUB_EVENT_LOITERING,
+            .source = HUB_SOURCE_ULTRASONIC,
+            .timestamp_us = now_us,
+            .approach = {
+                .channel = 0,
+                .distance_cm = (int16_t)approach.distance_cm,
+                .velocity_cm_s = (int16_t)approach.velocity_cm_s,
+                .confidence = approach.confidence,
+            },
+        };
+        hub_event_publish(&event);
+    }
+}
+
+static void pir_sample(int64_t now_us, bool level) {
+    // polls that change nothing (low, was low, no open episode) are not recorded
+    if (level || pir_sensor.last_state || pir_sensor.in_episode) {
+        replay_record_t record = {
+            .kind = REPLAY_INPUT,
+            .stream = REPLAY_PIR,
+            .time_us = now_us,
+            .pir.level = level,
+        };
+        replay_input(&replay, &record);
+    }
+    
+    // only episode transitions leave here
+    pir_episode_t episode;
+    pir_episode_type_t type = pir_update_episode(&pir_sensor, now_us, level, &episode);
+    if (type == PIR_EPISODE_NONE) {
+        return;
+    }
+    bool motion = (type == PIR_EPISODE_START);
+    
+    // update shared data
+    if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        sensor_data.motion_detected = motion;
+        LOCKPROF_GIVE(sensor_data.mutex);
+    }
+    
+    // publish episode
+    hub_event_t event = {
+        .type = motion ? HUB_EVENT_MOTION_START : HUB_EVENT_MOTION_END,
+        .source = HUB_SOURCE_LOCAL_PIR,
+        .timestamp_us = now_us,
+        .motion = {
+            .start_time_us = episode.start_time_us,
+            .duration_us = episode.duration_us,
+            .retrigger_count = episode.retrigger_count,
+        },
+    };
+    hub_event_publish(&event);
+}
+
+static void ultrasonic_sample(int64_t now_us, bool ok, int32_t pulse_us) {
+    replay_record_t record = {
+        .kind = REPLAY_INPUT,
+        .stream = REPLAY_DISTANCE,
+        .time_us = now_us,
+        .distance = { .ok = ok, .pulse_us = pulse_us },
+    };
+    replay_input(&replay, &record);
+    
+    if (ok) {
+        ultrasonic_process(now_us, hcsr04_pulse_to_cm(pulse_us));
+    } else {
+        // no echo (nothing in range or a missed pulse) - the tracker coasts
+        approach_miss(&approach_tracker, now_us);
+    }
+}
+
+static void climate_sample(int64_t now_us, bool ok, uint8_t humidity, uint8_t temperature) {
+    replay_record_t record = {
+        .kind = REPLAY_INPUT,
+        .stream = REPLAY_CLIMATE,
+        .time_us = now_us,
+        .climate = { .ok = ok, .humidity = humidity, .temperature = temperature },
+    };
+    replay_input(&replay, &record);
+    
+    if (!ok) {
+        // timeout or checksum error - the slope window is by time, a gap only thins it
+        heat_miss(&heat_detector);
+        return;
+    }
+    float temp = temperature;
+    
+    // update shared data
+    if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        sensor_data.temperature = temp;
+        sensor_data.humidity = humidity;
+        LOCKPROF_GIVE(sensor_data.mutex);
+    }
+    history_feed_sample(&history_temperature, now_us, temp);
+    history_feed_sample(&history_humidity, now_us, humidity);
+    
+    // fixed temperature and rate of rise
+    heat_event_t heat;
+    heat_event_type_t type = heat_update(&heat_detector, now_us, temp, &heat);
+    if (type != HEAT_EVENT_NONE) {
+        hub_event_t event = {
+            .type = (type == HEAT_EVENT_ALARM) ? HUB_EVENT_HEAT_ALARM : HUB_EVENT_HEAT_CLEAR,
+            .source = HUB_SOURCE_ENVIRONMENT,
+            .timestamp_us = now_us,
+            .heat = {
+                .cause = heat.cause,
+                .temperature_c = heat.temperature_c,
+                .rate_c_min = heat.rate_c_min,
+            },
+        };
+        hub_event_publish(&event);
+    }
+}
+
+static void remote_link(int64_t now_us, bool connected) {
+    // remote motion is not read from the node yet, only the link is recorded
+    replay_record_t record = {
+        .kind = REPLAY_INPUT,
+        .stream = REPLAY_REMOTE,
+        .time_us = now_us,
+        .remote = { .connected = connected, .motion = false },
+    };
+    replay_input(&replay, &record);
+    
+    // update connection status
+    if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        sensor_data.remote_connected = connected;
+        LOCKPROF_GIVE(sensor_data.mutex);
+    }
+}
+
+static void pir_sample_handler(const sensor_sample_t *sample, void *arg) {
+    pir_sample(sample->time_us, sample->level);
+}
+
+static void ultrasonic_sample_handler(const sensor_sample_t *sample, void *arg) {
+    ultrasonic_sample(sample->time_us, sample->status == ESP_OK, sample->pulse_us);
+}
+
+static void climate_sample_handler(const sensor_sample_t *sample, void *arg) {
+    climate_sample(sample->time_us, sample->status == ESP_OK, (uint8_t)sample->humidity,
+                   (uint8_t)sample->temperature);
+}
+
+static void replay_feed(const replay_record_t *record, void *arg) {
+    switch (record->stream) {
+        case REPLAY_PIR:
+            pir_sample(record->time_us, record->pir.level);
+            break;
+        case REPLAY_DISTANCE:
+            ultrasonic_sample(record->time_us, record->distance.ok, record->distance.pulse_us);
+            break;
+        case REPLAY_CLIMATE:
+            climate_sample(record->time_us, record->climate.ok, record->climate.humidity,
+                           record->climate.temperature);
+            break;
+        default:
+            remote_link(record->time_us, record->remote.connected);
+            break;
+    }
+}
+
+static void stress_inject(stress_kind_t kind, uint32_t sequence, int64_t time_us, void *arg) {
+    static int64_t episode_start_us[2];
+    
+    switch (kind) {
+        case STRESS_MOTION:
+        case STRESS_REMOTE: {
+            // even sequence numbers start an episode, odd ones end it
+            bool local = (kind == STRESS_MOTION);
+            bool motion = (sequence % 2 == 0);
+            int64_t *start = &episode_start_us[local ? 0 : 1];
+            if (motion) {
+                *start = time_us;
+            }
+            
+            if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+                if (local) {
+                    sensor_data.motion_detected = motion;
+                } else {
+                    sensor_data.remote_motion_detected = motion;
+                }
+                LOCKPROF_GIVE(sensor_data.mutex);
+            }
+            
+            hub_event_t event = {
+                .type = motion ? HUB_EVENT_MOTION_START : HUB_EVENT_MOTION_END,
+                .source = local ? HUB_SOURCE_LOCAL_PIR : HUB_SOURCE_REMOTE_NODE,
+                .timestamp_us = time_us,
+                .motion = {
+                    .start_time_us = *start,
+                    .duration_us = motion ? 0 : time_us - *start,
+                    .retrigger_count = 0,
+                },
+            };
+            hub_event_publish(&event);
+            break;
+        }
+            
+        case STRESS_DISTANCE: {
+            // 10 cm per sample back and forth over 40-240 cm
+            uint32_t phase = (sequence * 10) % 400;
+            ultrasonic_process(time_us, 40.0f + (float)((phase < 200) ? phase : 400 - phase));
+            break;
+        }
+            
+        case STRESS_KIND_COUNT:
+            break;
+    }
+}
+
+static uint32_t stress_overruns(void *arg) {
+    uint32_t overruns = 0;
+    
+    for (int i = 0; i < sample_clock.channel_count; i++) {
+        overruns += sample_clock.channels[i].jitter.overruns;
+    }
+    return overruns;
+}
+
+static esp_err_t wifi_init_sta(void) {
+    // error management
+    esp_err_t ret;
+    
+    ret = esp_netif_init();
+    if (ret == ESP_OK) {
+        ret = esp_event_loop_create_default();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize network stack");
+        return ret;
+    }
+    esp_netif_create_default_wifi_sta();
+    
+    wifi_init_config_t init_config = WIFI_INIT_CONFIG_DEFAULT();
+    ret = esp_wifi_init(&init_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize wifi");
+        return ret;
+    }
+    esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, wifi_event_handler, NULL);
+    
+    wifi_config_t wifi_config = { 0 };
+    strncpy((char *)wifi_config.sta.ssid, WIFI_SSID, sizeof(wifi_config.sta.ssid));
+    strncpy((char *)wifi_config.sta.password, WIFI_PASSWORD, sizeof(wifi_config.sta.password));
+    esp_wifi_set_mode(WIFI_MODE_STA);
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    
+    ret = esp_wifi_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start wifi");
+        return ret;
+    }
+    
+    // wall clock for occupancy hours, set once the station has an address
+    esp_sntp_config_t sntp_config = ESP_NETIF_SNTP_DEFAULT_CONFIG(SNTP_SERVER);
+    esp_netif_sntp_init(&sntp_config);
+    return ESP_OK;
+}
+
+static void wifi_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    if (base == WIFI_EVENT && (id == WIFI_EVENT_STA_START || id == WIFI_EVENT_STA_DISCONNECTED)) {
+        esp_wifi_connect();
+    } else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)data;
+        ESP_LOGI(TAG, "web ui at http://" IPSTR "/", IP2STR(&event->ip_info.ip));
+    }
+}
+
+static int webui_status_json(char *buf, size_t len, void *arg) {
+    int n = -1;
+    
+    if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        n = snprintf(buf, len,
+                     "{\"armed\":%s,\"motion\":%s,\"remote_connected\":%s,\"remote_motion\":%s,"
+                     "\"distance_cm\":%.1f,\"temperature\":%.1f,\"humidity\":%.1f,\"zones\":[",
+                     sensor_data.armed ? "true" : "false", sensor_data.motion_detected ? "true" : "false",
+                     sensor_data.remote_connected ? "true" : "false",
+                     sensor_data.remote_motion_detected ? "true" : "false",
+                     sensor_data.distance_cm, sensor_data.temperature, sensor_data.humidity);
+        for (int i = 0; i < sensor_data.zone_count && n > 0 && n < (int)len; i++) {
+            n += snprintf(buf + n, len - n, "%s%.2f", i ? "," : "", sensor_data.zone_temperatures[i]);
+        }
+        for (int i = 0; i < (int)(sizeof(analog_channels) / sizeof(analog_channels[0])) && n > 0 && n < (int)len; i++) {
+            n += snprintf(buf + n, len - n, "%s%ld", i ? "," : "],\"analog\":[", sensor_data.analog_levels[i]);
+        }
+        if (n > 0 && n < (int)len) {
+            n += snprintf(buf + n, len - n, "]}");
+        }
+        LOCKPROF_GIVE(sensor_data.mutex);
+    }
+    return n;
+}
+
 // ============================================================================
 // sensor tasks
 // ============================================================================
 
-void pir_task(void *pvParameters) {
-    ESP_LOGI(TAG, "pir task started");
+void event_task(void *pvParameters) {
+    ESP_LOGI(TAG, "event task started");
     
-    TickType_t last_wake = xTaskGetTickCount();
+    hub_event_t event;
     
     while (1) {
-        // read pir sensor
-        bool motion = pir_read(&pir_sensor);
+        if (LOCKPROF_RECEIVE(event_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
         
-        // update shared data
-        if (xSemaphoreTake(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
-            sensor_data.motion_detected = motion;
-            xSemaphoreGive(sensor_data.mutex);
+        switch (event.type) {
+            case HUB_EVENT_MOTION_START:
+                ESP_LOGI(TAG, "motion start (source %d)", event.source);
+                history_record(&history, history_motion_channel, event.timestamp_us / 1000000, 1);
+                break;
+                
+            case HUB_EVENT_MOTION_END:
+                ESP_LOGI(TAG, "motion end (source %d): %lld ms, %lu retriggers",
+                         event.source, event.motion.duration_us / 1000, event.motion.retrigger_count);
+                history_record(&history, history_motion_channel, event.timestamp_us / 1000000, 0);
+                
+                // episode start on the wall clock (esp_timer counts from boot)
+                time_t now = time(NULL);
+                if (occupancy_ready && now >= OCCUPANCY_CLOCK_VALID) {
+                    time_t start = now - (time_t)((esp_timer_get_time() - event.motion.start_time_us) / 1000000);
+                    occupancy_record_episode(&occupancy, event.source, 0, start,
+                                             (uint32_t)(event.motion.duration_us / 1000000));
+                }
+                break;
+                
+            case HUB_EVENT_ANALOG_ALARM:
+                ESP_LOGW(TAG, "analog channel %d alarm: level %ld", event.analog.channel, event.analog.level);
+                break;
+                
+            case HUB_EVENT_ANALOG_CLEAR:
+                ESP_LOGI(TAG, "analog channel %d clear: level %ld", event.analog.channel, event.analog.level);
+                break;
+                
+            case HUB_EVENT_ANALOG_TREND:
+                ESP_LOGW(TAG, "analog channel %d rising: level %ld, trend %ld",
+                         event.analog.channel, event.analog.level, event.analog.trend);
+                break;
+                
+            case HUB_EVENT_GLASS_BREAK:
+                ESP_LOGW(TAG, "glass break: impact x%.0f over floor, high band %.0f%%",
+                         event.acoustic.impact_ratio, event.acoustic.hf_ratio * 100.0f);
+                break;
+                
+            case HUB_EVENT_TAMPER_START:
+                ESP_LOGW(TAG, "tamper start: rms %lu mg, peak %lu mg",
+                         event.vibration.rms_mg, event.vibration.peak_mg);
+                break;
+                
+            case HUB_EVENT_TAMPER_END:
+                ESP_LOGI(TAG, "tamper end");
+                break;
+                
+            case HUB_EVENT_ARMED:
+                ESP_LOGI(TAG, "system armed (source %d)", event.source);
+                break;
+                
+            case HUB_EVENT_DISARMED:
+                ESP_LOGI(TAG, "system disarmed (source %d)", event.source);
+                break;
+                
+            case HUB_EVENT_PIN_REJECTED:
+                ESP_LOGW(TAG, "keypad pin rejected");
+                break;
+                
+            case HUB_EVENT_APPROACHING:
+            case HUB_EVENT_RECEDING:
+            case HUB_EVENT_LOITERING:
+                ESP_LOGI(TAG, "ultrasonic %d %s: %d cm, %d cm/s, confidence %u%%", event.approach.channel,
+                         (event.type == HUB_EVENT_APPROACHING) ? "approaching" :
+                         (event.type == HUB_EVENT_RECEDING) ? "receding" : "loitering",
+                         event.approach.distance_cm, event.approach.velocity_cm_s, event.approach.confidence);
+                break;
+                
+            case HUB_EVENT_HEAT_ALARM:
+                ESP_LOGE(TAG, "HEAT ALARM (%s): %.0f C, rising %.1f C/min",
+                         (event.heat.cause == (HEAT_CAUSE_FIXED | HEAT_CAUSE_RATE)) ? "fixed temperature, rate of rise" :
+                         (event.heat.cause == HEAT_CAUSE_FIXED) ? "fixed temperature" : "rate of rise",
+                         event.heat.temperature_c, event.heat.rate_c_min);
+                break;
+                
+            case HUB_EVENT_HEAT_CLEAR:
+                ESP_LOGW(TAG, "heat alarm cleared: %.0f C", event.heat.temperature_c);
+                break;
         }
         
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(100));
+        // pipeline latency, publish to handled (stress runs only)
+        stress_record_latency(&stress, esp_timer_get_time() - event.timestamp_us);
     }
     
     vTaskDelete(NULL);
 }
 
-void ultrasonic_task(void *pvParameters) {
-    ESP_LOGI(TAG, "ultrasonic task started");
+void zone_temperature_task(void *pvParameters) {
+    ESP_LOGI(TAG, "zone temperature task started (%d sensors)", zone_sensors.count);
     
-    TickType_t last_wake = xTaskGetTickCount();
+    // zone_channel is valid once app_main has registered it (the clock is not running yet)
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     
     while (1) {
-        // read ultrasonic sensor
-        esp_err_t ret = hcsr04_read_distance(&ultrasonic_sensor);
+        // wait for this sensor's sampling clock channel
+        sample_clock_wait(&sample_clock, zone_channel);
         
-        if (ret == ESP_OK) {
-            float distance = hcsr04_get_last_distance(&ultrasonic_sensor);
-            
-            // update shared data
-            if (xSemaphoreTake(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
-                sensor_data.distance_cm = distance;
-                xSemaphoreGive(sensor_data.mutex);
-            }
+        // all sensors convert together, so this takes ~one conversion time
+        esp_err_t ret = ds18b20_acquire(&zone_sensors);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_CRC) {
+            ESP_LOGW(TAG, "zone temperature acquisition failed (%d)", ret);
+            continue;
         }
         
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(200));
+        // update shared data (sensors that failed crc keep their last value)
+        if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+            for (uint8_t i = 0; i < zone_sensors.count; i++) {
+                if (zone_sensors.valid[i]) {
+                    sensor_data.zone_temperatures[i] = zone_sensors.temperatures[i];
+                }
+            }
+            sensor_data.zone_count = zone_sensors.count;
+            LOCKPROF_GIVE(sensor_data.mutex);
+        }
+        int64_t now_us = esp_timer_get_time();
+        for (uint8_t i = 0; i < zone_sensors.count; i++) {
+            if (zone_sensors.valid[i]) {
+                history_feed_sample(&history_zones[i], now_us, zone_sensors.temperatures[i]);
+            }
+        }
     }
     
     vTaskDelete(NULL);
 }
 
-void dht11_task(void *pvParameters) {
-    ESP_LOGI(TAG, "dht11 task started");
+void keypad_entry_task(void *pvParameters) {
+    ESP_LOGI(TAG, "keypad entry task started");
     
-    TickType_t last_wake = xTaskGetTickCount();
+    // entries of a pin change: current, new, new again
+    char entries[3][KEYPAD_PIN_MAX_LEN + 1];
+    char *entry = entries[0];
+    int change_step = -1;       // -1 arm/disarm, 0-2 the pin change entry being typed
+    size_t length = 0;
+    keypad_event_t key;
     
     while (1) {
-        // read dht11 sensor
-        esp_err_t ret = dht11_read(&dht11_sensor);
+        // a partial entry or pin change expires, an empty entry waits forever
+        bool partial = (length > 0 || change_step >= 0);
+        TickType_t timeout = partial ? pdMS_TO_TICKS(KEYPAD_ENTRY_TIMEOUT_MS) : portMAX_DELAY;
+        if (!keypad_receive(&keypad, &key, timeout)) {
+            ESP_LOGI(TAG, "pin entry timed out");
+            memset(entries, 0, sizeof(entries));
+            entry = entries[0];
+            change_step = -1;
+            length = 0;
+            continue;
+        }
         
-        if (ret == ESP_OK) {
-            float temp = dht11_get_temperature(&dht11_sensor);
-            float humidity = dht11_get_humidity(&dht11_sensor);
+        // repeats and releases carry no pin input
+        if (key.type != KEYPAD_EVENT_PRESS) {
+            continue;
+        }
+        ESP_LOGD(TAG, "key %c: %lld us from wake-up", key.key, esp_timer_get_time() - key.wake_time_us);
+        
+        if (key.key >= '0' && key.key <= '9') {
+            if (length < KEYPAD_PIN_MAX_LEN) {
+                entry[length++] = key.key;
+            }
+        } else if (key.key == '*') {
+            // clear entry, or start a pin change from an empty one
+            if (length == 0 && change_step < 0) {
+                ESP_LOGI(TAG, "pin change: current pin, then new pin twice");
+                change_step = 0;
+            }
+            length = 0;
+        } else if (key.key == '#' && change_step >= 0) {
+            entry[length] = '\0';
+            length = 0;
+            if (change_step < 2) {
+                entry = entries[++change_step];
+                continue;
+            }
+            
+            // the new pin is only stored if the current one matches and both entries agree
+            bool match = false;
+            esp_err_t ret = ESP_ERR_INVALID_ARG;
+            if (strcmp(entries[1], entries[2]) == 0) {
+                ret = keypad_pin_change(entries[0], entries[1], &match);
+            } else {
+                ESP_LOGW(TAG, "pin change: new pins differ");
+            }
+            memset(entries, 0, sizeof(entries));
+            entry = entries[0];
+            change_step = -1;
             
-            // update shared data
-            if (xSemaphoreTake(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
-                sensor_data.temperature = temp;
-                sensor_data.humidity = humidity;
-                xSemaphoreGive(sensor_data.mutex);
+            if (ret == ESP_OK && match) {
+                ESP_LOGI(TAG, "keypad pin changed");
+            } else {
+                hub_event_t event = {
+                    .type = HUB_EVENT_PIN_REJECTED,
+                    .source = HUB_SOURCE_KEYPAD,
+                    .timestamp_us = esp_timer_get_time(),
+                };
+                hub_event_publish(&event);
+            }
+        } else if (key.key == '#') {
+            entry[length] = '\0';
+            length = 0;
+            
+            bool match = false;
+            esp_err_t ret = keypad_pin_verify(entry, &match);
+            memset(entries, 0, sizeof(entries));
+            
+            if (ret == ESP_OK && match) {
+                bool armed = false;
+                if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+                    armed = sensor_data.armed;
+                    LOCKPROF_GIVE(sensor_data.mutex);
+                }
+                hub_set_armed(!armed, HUB_SOURCE_KEYPAD);
+            } else {
+                hub_event_t event = {
+                    .type = HUB_EVENT_PIN_REJECTED,
+                    .source = HUB_SOURCE_KEYPAD,
+                    .timestamp_us = esp_timer_get_time(),
+                };
+                hub_event_publish(&event);
             }
         }
-        
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(3000));
+    }
+    
+    vTaskDelete(NULL);
+}
+
+void replay_task(void *pvParameters) {
+    ESP_LOGI(TAG, "replay task started");
+    
+    replay_result_t result;
+    esp_err_t ret = replay_run(&replay, REPLAY_SESSION, replay_feed, NULL, &result);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "replay failed (%d)", ret);
+    } else if (result.mismatched || result.missing || result.extra || result.lost) {
+        ESP_LOGW(TAG, "session %u%s: %lu inputs over %lld s, decisions differ: %lu recorded, %lu matched, "
+                 "%lu different, %lu missing, %lu extra, %lu inputs lost; first at %lld us", result.session,
+                 result.truncated ? " (start overwritten)" : "", result.inputs,
+                 (result.end_us - result.start_us) / 1000000, result.decisions, result.matched,
+                 result.mismatched, result.missing, result.extra, result.lost, result.first_divergence_us);
+    } else {
+        ESP_LOGI(TAG, "session %u%s: %lu inputs over %lld s, decisions reproduced: %lu of %lu", result.session,
+                 result.truncated ? " (start overwritten)" : "", result.inputs,
+                 (result.end_us - result.start_us) / 1000000, result.matched, result.decisions);
     }
     
     vTaskDelete(NULL);
@@ -361,16 +1590,18 @@ void lcd_task(void *pvParameters) {
     float distance = 0.0f;
     float temp = 0.0f;
     float humidity = 0.0f;
+    bool armed = false;
     
     while (1) {
         // read shared sensor data
-        if (xSemaphoreTake(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
+        if (LOCKPROF_TAKE(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
             motion = sensor_data.motion_detected;
             remote_motion = sensor_data.remote_motion_detected;
             distance = sensor_data.distance_cm;
             temp = sensor_data.temperature;
             humidity = sensor_data.humidity;
-            xSemaphoreGive(sensor_data.mutex);
+            armed = sensor_data.armed;
+            LOCKPROF_GIVE(sensor_data.mutex);
         }
         
         // update lcd display
@@ -378,7 +1609,7 @@ void lcd_task(void *pvParameters) {
         
         // line 1: motion and distance
         lcd_set_cursor(&lcd, 0, 0);
-        lcd_printf(&lcd, "M:%c D:%.0fcm", motion ? 'Y' : 'N', distance);
+        lcd_printf(&lcd, "M:%c D:%.0fcm %s", motion ? 'Y' : 'N', distance, armed ? "ARM" : "");
         
         // line 2: temperature and humidity
         lcd_set_cursor(&lcd, 0, 1);
@@ -390,6 +1621,21 @@ void lcd_task(void *pvParameters) {
     vTaskDelete(NULL);
 }
 
+void persist_task(void *pvParameters) {
+    ESP_LOGI(TAG, "persist task started");
+    
+    TickType_t last_wake = xTaskGetTickCount();
+    
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(OCCUPANCY_PERSIST_PERIOD_MS));
+        
+        // only zones with new episodes (or aged hours) are written
+        occupancy_save(&occupancy);
+    }
+    
+    vTaskDelete(NULL);
+}
+
 // ============================================================================
 // ble functions
 // ============================================================================
@@ -401,6 +1647,27 @@ static void ble_host_task(void *param) {
 
 static void ble_on_sync(void) {
     ESP_LOGI(TAG, "ble stack synced");
+    
+    if (presence_ready) {
+        ble_presence_scan_start();
+    }
+}
+
+static void ble_presence_scan_start(void) {
+    // passive, and no duplicate filtering so every advert updates rssi
+    struct ble_gap_disc_params params = {
+        .itvl = PRESENCE_SCAN_ITVL,
+        .window = PRESENCE_SCAN_WINDOW,
+        .filter_policy = 0,
+        .limited = 0,
+        .passive = 1,
+        .filter_duplicates = 0,
+    };
+    
+    int rc = ble_gap_disc(BLE_OWN_ADDR_PUBLIC, BLE_HS_FOREVER, &params, ble_gap_event, NULL);
+    if (rc != 0) {
+        ESP_LOGE(TAG, "failed to start presence scan (%d)", rc);
+    }
 }
 
 static void ble_on_reset(int reason) {
@@ -410,10 +1677,18 @@ static void ble_on_reset(int reason) {
 static int ble_gap_event(struct ble_gap_event *event, void *arg) {
     switch (event->type) {
         case BLE_GAP_EVENT_DISC:
-            // device discovered during scan
-            if (event->disc.length_data > 0) {
-                // check if this is our remote node
-                ESP_LOGI(TAG, "device discovered");
+            // every advert goes to the presence engine, strangers are cached
+            if (presence_ready) {
+                bool random_addr = (event->disc.addr.type == BLE_ADDR_RANDOM ||
+                                    event->disc.addr.type == BLE_ADDR_RANDOM_ID);
+                presence_observe(&presence, random_addr, event->disc.addr.val, event->disc.rssi);
+            }
+            break;
+            
+        case BLE_GAP_EVENT_DISC_COMPLETE:
+            // scan ended (e.g. preempted), resume
+            if (presence_ready) {
+                ble_presence_scan_start();
             }
             break;
             
@@ -421,24 +1696,14 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg) {
             if (event->connect.status == 0) {
                 ESP_LOGI(TAG, "connected to remote node");
                 ble_conn_handle = event->connect.conn_handle;
-                
-                // update connection status
-                if (xSemaphoreTake(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
-                    sensor_data.remote_connected = true;
-                    xSemaphoreGive(sensor_data.mutex);
-                }
+                remote_link(esp_timer_get_time(), true);
             }
             break;
             
         case BLE_GAP_EVENT_DISCONNECT:
             ESP_LOGI(TAG, "disconnected from remote node");
             ble_conn_handle = BLE_HS_CONN_HANDLE_NONE;
-            
-            // update connection status
-            if (xSemaphoreTake(sensor_data.mutex, portMAX_DELAY) == pdTRUE) {
-                sensor_data.remote_connected = false;
-                xSemaphoreGive(sensor_data.mutex);
-            }
+            remote_link(esp_timer_get_time(), false);
             break;
     }
     
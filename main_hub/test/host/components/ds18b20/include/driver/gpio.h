@@ -0,0 +1,71 @@
+/**
+ * @file gpio.h
+ * @author Anthony Yalong
+ * @brief GPIO subset for the simulated 1-Wire line - every pin is the bus
+ */
+#ifndef SIM_ONEWIRE_DRIVER_GPIO_H
+#define SIM_ONEWIRE_DRIVER_GPIO_H
+
+// imports
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = 1,
+    GPIO_MODE_OUTPUT = 2,
+    GPIO_MODE_OUTPUT_OD = 6,
+    GPIO_MODE_INPUT_OUTPUT_OD = 7,
+    GPIO_MODE_INPUT_OUTPUT = 3,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE = 0,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+} gpio_int_type_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+/**
+ * @brief Configure the bus pin (open drain expected)
+ *
+ * @param config Pin configuration
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG if not open drain
+ */
+esp_err_t gpio_config(const gpio_config_t *config);
+
+/**
+ * @brief Drive the line low (0) or release it (1)
+ *
+ * @param gpio_num Pin
+ * @param level Output level
+ * @return esp_err_t ESP_OK
+ */
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+
+/**
+ * @brief Line level at the current virtual time (wired-and of master and devices)
+ *
+ * @param gpio_num Pin
+ * @return int Line level
+ */
+int gpio_get_level(gpio_num_t gpio_num);
+
+#endif  // SIM_ONEWIRE_DRIVER_GPIO_H
@@ -0,0 +1,20 @@
+/**
+ * @file esp_timer.h
+ * @author Anthony Yalong
+ * @brief esp_timer subset for the simulated 1-Wire line - the clock is the
+ *        line model's virtual time
+ */
+#ifndef SIM_ONEWIRE_ESP_TIMER_H
+#define SIM_ONEWIRE_ESP_TIMER_H
+
+// imports
+#include <stdint.h>
+
+/**
+ * @brief Microseconds since start (virtual)
+ *
+ * @return int64_t Time in microseconds
+ */
+int64_t esp_timer_get_time(void);
+
+#endif  // SIM_ONEWIRE_ESP_TIMER_H
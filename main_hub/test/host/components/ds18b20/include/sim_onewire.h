@@ -0,0 +1,124 @@
+/**
+ * @file sim_onewire.h
+ * @author Anthony Yalong
+ * @brief Simulated multi-drop 1-Wire line - DS18B20-style devices answering
+ *        reset, ROM search/match/skip, Convert T and scratchpad reads and
+ *        writes, decoded from the master's edges on virtual time. Devices
+ *        use worst-case datasheet timing (presence low only 60-75 us after
+ *        release, a 0 held only 15 us into a read slot) so a slot that is
+ *        off spec reads wrong instead of passing.
+ */
+#ifndef SIM_ONEWIRE_H
+#define SIM_ONEWIRE_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+// configuration
+#define SIM_ONEWIRE_MAX_DEVICES 16
+
+/**
+ * @brief Master timing seen on the line (microseconds) and out-of-spec events
+ */
+typedef struct {
+    uint32_t resets;
+    uint32_t slots;
+    uint32_t violations;            // any measurement below outside its window
+    int32_t reset_low_min_us;       // >= 480
+    int32_t reset_high_min_us;      // >= 480 release to the first slot
+    int32_t presence_sample_min_us; // 60-75 after release
+    int32_t presence_sample_max_us;
+    int32_t write0_low_min_us;      // 60-120
+    int32_t write0_low_max_us;
+    int32_t write1_low_max_us;      // 1-15, also the read-slot start
+    int32_t read_sample_max_us;     // <= 15 after the falling edge
+    int32_t slot_min_us;            // >= 60 falling edge to falling edge
+    int32_t recovery_min_us;        // >= 1 released before the next slot
+} sim_onewire_timing_t;
+
+/**
+ * @brief Empty the bus and reset virtual time and timing counters
+ */
+void sim_onewire_clear(void);
+
+/**
+ * @brief Build a rom with a valid crc
+ *
+ * @param family Family code (0x28 for DS18B20)
+ * @param serial 48-bit serial number
+ * @return uint64_t Rom, family in the low byte
+ */
+uint64_t sim_onewire_rom(uint8_t family, uint64_t serial);
+
+/**
+ * @brief Attach a device at power-on state (12-bit, 85 C in the scratchpad)
+ *
+ * @param rom Device rom
+ * @param temperature Temperature the next conversion measures, deg C
+ * @return int Device index, -1 if the bus is full
+ */
+int sim_onewire_add(uint64_t rom, float temperature);
+
+/**
+ * @brief Set the temperature the next conversion measures
+ *
+ * @param index Device index
+ * @param temperature Deg C
+ */
+void sim_onewire_set_temperature(int index, float temperature);
+
+/**
+ * @brief Flip a data bit in the next scratchpad reads (crc no longer matches)
+ *
+ * @param index Device index
+ * @param reads Number of reads to corrupt
+ */
+void sim_onewire_corrupt(int index, int reads);
+
+/**
+ * @brief Device resolution from its config register
+ *
+ * @param index Device index
+ * @return uint8_t Bits (9-12)
+ */
+uint8_t sim_onewire_resolution(int index);
+
+/**
+ * @brief Conversions the device has run since it was added
+ *
+ * @param index Device index
+ * @return uint32_t Conversion count
+ */
+uint32_t sim_onewire_conversions(int index);
+
+/**
+ * @brief Master timing since the last clear
+ *
+ * @param timing Filled with the measurements
+ */
+void sim_onewire_get_timing(sim_onewire_timing_t *timing);
+
+/**
+ * @brief Virtual time, stands in for esp_timer_get_time() in the real sources
+ *
+ * @return int64_t Microseconds
+ */
+int64_t sim_onewire_now_us(void);
+
+/**
+ * @brief Advance virtual time, stands in for esp_rom_delay_us()
+ *
+ * @param us Microseconds
+ */
+void sim_onewire_delay_us(uint32_t us);
+
+/**
+ * @brief Advance virtual time, stands in for vTaskDelay()
+ *
+ * @param ticks Ticks
+ */
+void sim_onewire_delay_ticks(const TickType_t ticks);
+
+#endif  // SIM_ONEWIRE_H
@@ -0,0 +1,433 @@
+/**
+ * @file sim_onewire.c
+ * @author Anthony Yalong
+ * @brief Simulated multi-drop 1-Wire line - the master's gpio edges are
+ *        timed on virtual time, classified against the datasheet windows
+ *        and fed to every attached device's protocol state machine; the
+ *        line reads as the wired-and of the master and all devices
+ */
+
+#include "sim_onewire.h"
+#include <math.h>
+#include <string.h>
+#include <sys/param.h>
+#include "driver/gpio.h"
+#include "onewire.h"
+
+// ============================================================================
+// Datasheet Windows (standard speed, microseconds)
+// ============================================================================
+#define RESET_LOW_MIN_US        480
+#define RESET_HIGH_MIN_US       480     // release to the first slot
+#define PRESENCE_FROM_US        60      // latest start of the presence pulse
+#define PRESENCE_TO_US          75      // earliest end of it
+#define SLOT_LOW_MAX_US         15      // write 1 / read start, and latest read sample
+#define WRITE0_LOW_MIN_US       60
+#define WRITE0_LOW_MAX_US       120
+#define SLOT_MIN_US             60
+#define RECOVERY_MIN_US         1
+#define READ_HOLD_US            15      // a device's 0 is only guaranteed this long
+#define CONVERT_12BIT_US        750000
+#define POWER_ON_RAW            0x0550  // 85 C
+
+// ds18b20 function commands
+#define CMD_CONVERT_T           0x44
+#define CMD_WRITE_SCRATCH       0x4E
+#define CMD_READ_SCRATCH        0xBE
+
+/**
+ * @brief Device protocol state
+ */
+typedef enum {
+    DEVICE_IDLE,                // deselected until the next reset
+    DEVICE_ROM_COMMAND,
+    DEVICE_SEARCH,              // bit, complement, direction per rom bit
+    DEVICE_MATCH,
+    DEVICE_FUNCTION_COMMAND,
+    DEVICE_CONVERTING,          // read slots return 0 until done
+    DEVICE_READ_SCRATCH,
+    DEVICE_WRITE_SCRATCH,
+} device_state_t;
+
+/**
+ * @brief One device on the line
+ */
+typedef struct {
+    uint64_t rom;
+    float temperature;          // what the next conversion measures
+    uint8_t th, tl, config;
+    int16_t raw;                // temperature register
+    int16_t pending_raw;        // conversion result, latched when done
+    int64_t convert_done_us;    // 0 when no conversion runs
+    uint32_t conversions;
+    int corrupt_reads;
+    device_state_t state;
+    int bit;                    // slot count within the state
+    uint64_t data;              // bits received, lsb first
+    uint8_t scratchpad[9];
+    bool tx;                    // the device drives the current slot
+} device_t;
+
+static struct {
+    device_t devices[SIM_ONEWIRE_MAX_DEVICES];
+    int count;
+    int64_t now_us;
+    bool master_low;
+    int64_t fall_us;            // master's last falling edge
+    int64_t rise_us;            // master's last release
+    bool after_reset;           // the last release ended a reset pulse
+    bool in_slot;               // the last release ended a time slot
+    bool presence;
+    int64_t hold_until_us;      // a device holds 0 in the current slot
+    sim_onewire_timing_t timing;
+} line;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Count a measurement outside its window
+ *
+ * @param ok Measurement inside the window
+ */
+static void check(bool ok);
+
+/**
+ * @brief Dallas/Maxim crc8, written out independently of onewire_crc8()
+ *
+ * @param data Bytes
+ * @param len Byte count
+ * @return uint8_t Crc
+ */
+static uint8_t crc8(const uint8_t *data, size_t len);
+
+/**
+ * @brief Master pulled the line low - devices that transmit this slot decide their bit
+ *
+ * @param device Device
+ */
+static void device_slot_begin(device_t *device);
+
+/**
+ * @brief Master released the line after a time slot - listening devices sample it
+ *
+ * @param device Device
+ * @param bit Bit the master wrote
+ */
+static void device_receive(device_t *device, bool bit);
+
+/**
+ * @brief Latch a finished conversion into the temperature register
+ *
+ * @param device Device
+ */
+static void device_update(device_t *device);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+void sim_onewire_clear(void) {
+    memset(&line, 0, sizeof(line));
+    line.timing.reset_low_min_us = INT32_MAX;
+    line.timing.reset_high_min_us = INT32_MAX;
+    line.timing.presence_sample_min_us = INT32_MAX;
+    line.timing.write0_low_min_us = INT32_MAX;
+    line.timing.slot_min_us = INT32_MAX;
+    line.timing.recovery_min_us = INT32_MAX;
+}
+
+uint64_t sim_onewire_rom(uint8_t family, uint64_t serial) {
+    uint8_t bytes[7];
+    uint64_t rom = family | ((serial & 0xFFFFFFFFFFFFULL) << 8);
+
+    for (int i = 0; i < 7; i++) {
+        bytes[i] = (uint8_t)(rom >> (8 * i));
+    }
+    return rom | ((uint64_t)crc8(bytes, sizeof(bytes)) << 56);
+}
+
+int sim_onewire_add(uint64_t rom, float temperature) {
+    if (line.count >= SIM_ONEWIRE_MAX_DEVICES) {
+        return -1;
+    }
+
+    device_t *device = &line.devices[line.count];
+    memset(device, 0, sizeof(*device));
+    device->rom = rom;
+    device->temperature = temperature;
+    device->th = 0x4B;
+    device->tl = 0x46;
+    device->config = 0x7F;
+    device->raw = POWER_ON_RAW;
+    device->state = DEVICE_IDLE;
+    return line.count++;
+}
+
+void sim_onewire_set_temperature(int index, float temperature) {
+    line.devices[index].temperature = temperature;
+}
+
+void sim_onewire_corrupt(int index, int reads) {
+    line.devices[index].corrupt_reads = reads;
+}
+
+uint8_t sim_onewire_resolution(int index) {
+    return 9 + ((line.devices[index].config >> 5) & 0x03);
+}
+
+uint32_t sim_onewire_conversions(int index) {
+    device_update(&line.devices[index]);
+    return line.devices[index].conversions;
+}
+
+void sim_onewire_get_timing(sim_onewire_timing_t *timing) {
+    *timing = line.timing;
+}
+
+int64_t sim_onewire_now_us(void) {
+    return line.now_us;
+}
+
+void sim_onewire_delay_us(uint32_t us) {
+    line.now_us += us;
+}
+
+void sim_onewire_delay_ticks(const TickType_t ticks) {
+    line.now_us += (int64_t)ticks * 1000000 / configTICK_RATE_HZ;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    // a push-pull master would fight the devices' zeros
+    return config->mode == GPIO_MODE_INPUT_OUTPUT_OD ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (level == 0 && !line.master_low) {
+        // falling edge: the previous slot or reset ends here
+        if (line.in_slot) {
+            int32_t slot_us = (int32_t)(line.now_us - line.fall_us);
+            int32_t recovery_us = (int32_t)(line.now_us - line.rise_us);
+            line.timing.slot_min_us = MIN(line.timing.slot_min_us, slot_us);
+            line.timing.recovery_min_us = MIN(line.timing.recovery_min_us, recovery_us);
+            check(slot_us >= SLOT_MIN_US && recovery_us >= RECOVERY_MIN_US);
+        } else if (line.after_reset) {
+            int32_t high_us = (int32_t)(line.now_us - line.rise_us);
+            line.timing.reset_high_min_us = MIN(line.timing.reset_high_min_us, high_us);
+            check(high_us >= RESET_HIGH_MIN_US);
+        }
+
+        line.master_low = true;
+        line.fall_us = line.now_us;
+        line.after_reset = false;
+        line.in_slot = false;
+        line.hold_until_us = 0;
+        for (int i = 0; i < line.count; i++) {
+            device_slot_begin(&line.devices[i]);
+        }
+    } else if (level != 0 && line.master_low) {
+        int32_t low_us = (int32_t)(line.now_us - line.fall_us);
+        line.master_low = false;
+        line.rise_us = line.now_us;
+
+        if (low_us >= RESET_LOW_MIN_US) {
+            // reset pulse: every device answers and waits for a rom command
+            line.timing.resets++;
+            line.timing.reset_low_min_us = MIN(line.timing.reset_low_min_us, low_us);
+            for (int i = 0; i < line.count; i++) {
+                line.devices[i].state = DEVICE_ROM_COMMAND;
+                line.devices[i].bit = 0;
+                line.devices[i].data = 0;
+            }
+            line.presence = (line.count > 0);
+            line.after_reset = true;
+        } else if (low_us > WRITE0_LOW_MAX_US) {
+            // too long for a slot, too short for a reset
+            check(false);
+        } else {
+            // time slot: devices sample 15-60 us after the edge
+            bool bit = (low_us <= SLOT_LOW_MAX_US);
+            line.timing.slots++;
+            if (bit) {
+                line.timing.write1_low_max_us = MAX(line.timing.write1_low_max_us, low_us);
+            } else {
+                line.timing.write0_low_min_us = MIN(line.timing.write0_low_min_us, low_us);
+                line.timing.write0_low_max_us = MAX(line.timing.write0_low_max_us, low_us);
+                check(low_us >= WRITE0_LOW_MIN_US);
+            }
+            for (int i = 0; i < line.count; i++) {
+                if (!line.devices[i].tx) {
+                    device_receive(&line.devices[i], bit);
+                }
+            }
+            line.in_slot = true;
+        }
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (line.master_low) {
+        return 0;
+    }
+
+    if (line.after_reset) {
+        int32_t sample_us = (int32_t)(line.now_us - line.rise_us);
+        line.timing.presence_sample_min_us = MIN(line.timing.presence_sample_min_us, sample_us);
+        line.timing.presence_sample_max_us = MAX(line.timing.presence_sample_max_us, sample_us);
+        bool low = line.presence && sample_us >= PRESENCE_FROM_US && sample_us <= PRESENCE_TO_US;
+        check(sample_us >= PRESENCE_FROM_US && sample_us <= PRESENCE_TO_US);
+        return low ? 0 : 1;
+    }
+
+    if (line.in_slot) {
+        int32_t sample_us = (int32_t)(line.now_us - line.fall_us);
+        line.timing.read_sample_max_us = MAX(line.timing.read_sample_max_us, sample_us);
+        check(sample_us <= SLOT_LOW_MAX_US);
+        return line.now_us <= line.hold_until_us ? 0 : 1;
+    }
+    return 1;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void check(bool ok) {
+    if (!ok) {
+        line.timing.violations++;
+    }
+}
+
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    // x^8 + x^5 + x^4 + 1, shifted in lsb first as the device computes it
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < len * 8; i++) {
+        bool in = (data[i / 8] >> (i % 8)) & 0x01;
+        bool feedback = in ^ (crc & 0x01);
+        crc >>= 1;
+        if (feedback) {
+            crc ^= 0x8C;
+        }
+    }
+    return crc;
+}
+
+static void device_slot_begin(device_t *device) {
+    int out = -1;
+
+    device_update(device);
+    switch (device->state) {
+    case DEVICE_SEARCH: {
+        bool rom_bit = (device->rom >> (device->bit / 3)) & 0x01;
+        if (device->bit % 3 == 0) {
+            out = rom_bit;
+        } else if (device->bit % 3 == 1) {
+            out = !rom_bit;
+        }
+        break;
+    }
+    case DEVICE_CONVERTING:
+        out = (device->convert_done_us == 0);
+        break;
+    case DEVICE_READ_SCRATCH:
+        out = device->bit < 72 ? (device->scratchpad[device->bit / 8] >> (device->bit % 8)) & 0x01 : 1;
+        break;
+    default:
+        break;
+    }
+
+    device->tx = (out >= 0);
+    if (!device->tx) {
+        return;
+    }
+    if (device->state != DEVICE_CONVERTING) {
+        device->bit++;
+    }
+    if (out == 0) {
+        line.hold_until_us = line.now_us + READ_HOLD_US;
+    }
+}
+
+static void device_receive(device_t *device, bool bit) {
+    switch (device->state) {
+    case DEVICE_ROM_COMMAND:
+    case DEVICE_FUNCTION_COMMAND:
+    case DEVICE_MATCH:
+    case DEVICE_WRITE_SCRATCH:
+        device->data |= (uint64_t)bit << device->bit;
+        device->bit++;
+        break;
+    case DEVICE_SEARCH:
+        // the master's direction: devices whose bit differs drop out
+        if (bit != ((device->rom >> (device->bit / 3)) & 0x01)) {
+            device->state = DEVICE_IDLE;
+            return;
+        }
+        if (++device->bit == 64 * 3) {
+            device->state = DEVICE_FUNCTION_COMMAND;
+            device->bit = 0;
+            device->data = 0;
+        }
+        return;
+    default:
+        return;
+    }
+
+    if (device->state == DEVICE_ROM_COMMAND && device->bit == 8) {
+        uint8_t command = (uint8_t)device->data;
+        device->bit = 0;
+        device->data = 0;
+        device->state = command == ONEWIRE_CMD_SEARCH_ROM ? DEVICE_SEARCH
+                      : command == ONEWIRE_CMD_MATCH_ROM  ? DEVICE_MATCH
+                      : command == ONEWIRE_CMD_SKIP_ROM   ? DEVICE_FUNCTION_COMMAND
+                                                          : DEVICE_IDLE;
+    } else if (device->state == DEVICE_MATCH && device->bit == 64) {
+        device->state = (device->data == device->rom) ? DEVICE_FUNCTION_COMMAND : DEVICE_IDLE;
+        device->bit = 0;
+        device->data = 0;
+    } else if (device->state == DEVICE_FUNCTION_COMMAND && device->bit == 8) {
+        uint8_t command = (uint8_t)device->data;
+        uint8_t resolution = sim_onewire_resolution((int)(device - line.devices));
+        device->bit = 0;
+        device->data = 0;
+        device->state = DEVICE_IDLE;
+        if (command == CMD_CONVERT_T) {
+            // lower resolutions drop low bits and finish sooner
+            int16_t raw = (int16_t)lrintf(device->temperature * 16.0f);
+            device->pending_raw = (int16_t)(raw & ~((1 << (12 - resolution)) - 1));
+            device->convert_done_us = line.now_us + (CONVERT_12BIT_US >> (12 - resolution));
+            device->state = DEVICE_CONVERTING;
+        } else if (command == CMD_READ_SCRATCH) {
+            uint8_t *scratchpad = device->scratchpad;
+            scratchpad[0] = (uint8_t)device->raw;
+            scratchpad[1] = (uint8_t)((uint16_t)device->raw >> 8);
+            scratchpad[2] = device->th;
+            scratchpad[3] = device->tl;
+            scratchpad[4] = device->config;
+            scratchpad[5] = 0xFF;
+            scratchpad[6] = 0x0C;
+            scratchpad[7] = 0x10;
+            scratchpad[8] = crc8(scratchpad, 8);
+            if (device->corrupt_reads > 0) {
+                scratchpad[0] ^= 0x01;
+                device->corrupt_reads--;
+            }
+            device->state = DEVICE_READ_SCRATCH;
+        } else if (command == CMD_WRITE_SCRATCH) {
+            device->state = DEVICE_WRITE_SCRATCH;
+        }
+    } else if (device->state == DEVICE_WRITE_SCRATCH && device->bit == 24) {
+        device->th = (uint8_t)device->data;
+        device->tl = (uint8_t)(device->data >> 8);
+        device->config = (uint8_t)(((device->data >> 16) & 0x60) | 0x1F);
+        device->state = DEVICE_IDLE;
+    }
+}
+
+static void device_update(device_t *device) {
+    if (device->convert_done_us != 0 && line.now_us >= device->convert_done_us) {
+        device->raw = device->pending_raw;
+        device->convert_done_us = 0;
+        device->conversions++;
+    }
+}
@@ -0,0 +1,292 @@
+/**
+ * @file eval_approach.c
+ * @author Anthony Yalong
+ * @brief Approach tracker on synthetic walking traces at the hub's 5 Hz
+ *        ultrasonic rate - people walking in and out at several speeds,
+ *        walking past the beam, loitering and an empty room - with sensor
+ *        noise, dropouts (no echo) and stray echoes. Reports velocity
+ *        error, detection rate and delay, false events and update cost.
+ */
+
+// imports
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "approach.h"
+#include "host_eval.h"
+
+// evaluation configuration (tracker settings as in include/main_hub_system_config.h)
+#define SAMPLE_US       200000
+#define ALPHA           0.8f        // critically damped: beta = alpha^2 / (2 - alpha)
+#define BETA            0.53f
+#define SPEED_CM_S      30.0f
+#define NEAR_CM         150.0f
+#define LOITER_MS       5000
+#define WALL_CM         250.0f
+#define NOISE_CM        0.5f
+#define DROPOUT_PCT     10          // readings with no echo
+#define STRAY_PCT       2           // readings from a stray echo
+#define RUNS            100         // seeds per scenario
+#define GRACE_US        1000000     // late events still credited to a motion that just ended
+#define SETTLE_US       600000      // velocity error counted from this far into a walk
+#define MIN_DETECTION   0.95        // required detection rate
+#define MAX_FALSE       0.02        // tolerated false events per run
+
+/**
+ * @brief Ground truth of one trace: distance (or none) and the expected state
+ */
+typedef struct {
+    bool present;                   // target in the beam (else the wall echoes)
+    float distance_cm;
+    float velocity_cm_s;
+    approach_event_type_t expected; // none: no event wanted
+} truth_t;
+
+/**
+ * @brief Scenario - ground truth at time t, duration
+ */
+typedef struct {
+    const char *name;
+    void (*truth)(float t, float speed, uint32_t *rng, truth_t *out);
+    float speed;
+    float duration_s;
+    approach_event_type_t wanted;   // event that must be reported, none for clutter scenes
+} scenario_t;
+
+// function prototypes
+static void truth_walk_in(float t, float speed, uint32_t *rng, truth_t *out);
+static void truth_walk_past(float t, float speed, uint32_t *rng, truth_t *out);
+static void truth_loiter(float t, float speed, uint32_t *rng, truth_t *out);
+static void truth_empty(float t, float speed, uint32_t *rng, truth_t *out);
+static int evaluate(const scenario_t *scenario);
+static int evaluate_cost(void);
+static int compare_float(const void *a, const void *b);
+
+static const scenario_t scenarios[] = {
+    { "walk in/out 0.5m/s", truth_walk_in, 50.0f, 16.0f, APPROACH_EVENT_APPROACHING },
+    { "walk in/out 1.0m/s", truth_walk_in, 100.0f, 12.0f, APPROACH_EVENT_APPROACHING },
+    { "walk in/out 1.5m/s", truth_walk_in, 150.0f, 10.0f, APPROACH_EVENT_APPROACHING },
+    { "walk past", truth_walk_past, 0.0f, 10.0f, APPROACH_EVENT_NONE },
+    { "loiter", truth_loiter, 0.0f, 20.0f, APPROACH_EVENT_LOITERING },
+    { "empty room", truth_empty, 0.0f, 600.0f, APPROACH_EVENT_NONE },
+};
+
+int eval_approach(void) {
+    int failures = 0;
+
+    printf("\n==== approach tracker (5 Hz, %d%% dropouts, %d%% stray echoes, %d runs per scene) ====\n",
+           DROPOUT_PCT, STRAY_PCT, RUNS);
+    printf("%-20s %9s %9s %9s %9s %9s %15s\n", "scene", "detected", "delay ms", "recede", "delay ms",
+           "false/run", "vel err p50/p90");
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        failures += evaluate(&scenarios[s]);
+    }
+    failures += evaluate_cost();
+    return failures;
+}
+
+static int evaluate(const scenario_t *scenario) {
+    uint32_t detected = 0;
+    uint32_t receded = 0;
+    double delay_ms = 0.0;
+    double recede_delay_ms = 0.0;
+    uint32_t false_events = 0;
+    static float velocity_errors[RUNS * 1024];
+    uint32_t velocity_samples = 0;
+    approach_tracker_t tracker;
+
+    for (uint32_t run = 0; run < RUNS; run++) {
+        uint32_t rng = 1000 + run * 7919;
+        bool seen = false;
+        bool seen_recede = false;
+        int64_t expected_since_us = -1;
+        approach_event_type_t expected = APPROACH_EVENT_NONE;
+        approach_event_type_t previous = APPROACH_EVENT_NONE;
+        int64_t previous_since_us = -1;
+        int64_t previous_until_us = -1;
+        approach_init(&tracker, ALPHA, BETA, SPEED_CM_S, NEAR_CM, LOITER_MS);
+
+        // the scene starts at a random phase of the sample clock
+        float phase = (host_eval_random(&rng) % 200) / 1000.0f;
+        for (int64_t time_us = 0; time_us < (int64_t)(scenario->duration_s * 1e6f); time_us += SAMPLE_US) {
+            truth_t truth;
+            scenario->truth(time_us / 1e6f + phase, scenario->speed, &rng, &truth);
+            if (truth.expected != expected) {
+                previous = expected;
+                previous_since_us = expected_since_us;
+                previous_until_us = time_us;
+                expected = truth.expected;
+                expected_since_us = time_us;
+            }
+
+            // hc-sr04: noise, missing echoes, the odd stray echo
+            uint32_t roll = host_eval_random(&rng) % 100;
+            approach_event_t event;
+            approach_event_type_t type = APPROACH_EVENT_NONE;
+            if (roll < DROPOUT_PCT) {
+                approach_miss(&tracker, time_us);
+                continue;
+            }
+            float measured = truth.present ? truth.distance_cm : WALL_CM;
+            if (roll < DROPOUT_PCT + STRAY_PCT) {
+                measured = 20.0f + (host_eval_random(&rng) % 350);
+            }
+            type = approach_update(&tracker, time_us, measured + host_eval_noise(&rng, NOISE_CM), &event);
+
+            // velocity error while someone is walking steadily, once settled
+            float velocity;
+            if (truth.present && truth.velocity_cm_s != 0.0f && approach_get_track(&tracker, NULL, &velocity) &&
+                time_us - expected_since_us >= SETTLE_US) {
+                if (velocity_samples < sizeof(velocity_errors) / sizeof(velocity_errors[0])) {
+                    velocity_errors[velocity_samples++] = fabsf(velocity - truth.velocity_cm_s);
+                }
+            }
+
+            if (type == APPROACH_EVENT_NONE) {
+                continue;
+            }
+
+            // a short walk can end before its event is due: late reports within the grace time count
+            int64_t since_us = expected_since_us;
+            bool matches = (type == expected);
+            if (!matches && type == previous && time_us - previous_until_us <= GRACE_US) {
+                matches = true;
+                since_us = previous_since_us;
+            }
+            if (!matches) {
+                false_events++;
+            } else if (type == scenario->wanted && !seen) {
+                seen = true;
+                detected++;
+                delay_ms += (time_us - since_us) / 1000.0;
+            } else if (type == APPROACH_EVENT_RECEDING && !seen_recede) {
+                seen_recede = true;
+                receded++;
+                recede_delay_ms += (time_us - since_us) / 1000.0;
+            }
+        }
+    }
+
+    bool wanted = scenario->wanted != APPROACH_EVENT_NONE;
+    bool walking = scenario->truth == truth_walk_in;
+    bool ok = (!wanted || detected >= MIN_DETECTION * RUNS) && (!walking || receded >= MIN_DETECTION * RUNS) &&
+              false_events <= MAX_FALSE * RUNS * (scenario->duration_s / 10.0f);
+    char detected_text[16] = "-";
+    char delay_text[16] = "-";
+    char recede_text[16] = "-";
+    char recede_delay_text[16] = "-";
+    char velocity_text[24] = "-";
+    if (wanted) {
+        snprintf(detected_text, sizeof(detected_text), "%.0f%%", 100.0 * detected / RUNS);
+        snprintf(delay_text, sizeof(delay_text), "%.0f", detected ? delay_ms / detected : 0.0);
+    }
+    if (walking) {
+        snprintf(recede_text, sizeof(recede_text), "%.0f%%", 100.0 * receded / RUNS);
+        snprintf(recede_delay_text, sizeof(recede_delay_text), "%.0f", receded ? recede_delay_ms / receded : 0.0);
+    }
+    if (velocity_samples > 0) {
+        qsort(velocity_errors, velocity_samples, sizeof(float), compare_float);
+        snprintf(velocity_text, sizeof(velocity_text), "%.1f/%.1f cm/s", velocity_errors[velocity_samples / 2],
+                 velocity_errors[velocity_samples * 9 / 10]);
+    }
+    printf("%-20s %9s %9s %9s %9s %9.2f %15s%s\n", scenario->name, detected_text, delay_text, recede_text,
+           recede_delay_text, (double)false_events / RUNS, velocity_text, ok ? "" : "  <-- FAIL");
+    return ok ? 0 : 1;
+}
+
+static int evaluate_cost(void) {
+    approach_tracker_t tracker;
+    approach_event_t event;
+    uint32_t rng = 99;
+    float trace[60];                // one 12 s walk in and out at 1 m/s
+    const int updates = 6000000;
+
+    for (int i = 0; i < 60; i++) {
+        truth_t truth;
+        truth_walk_in(i * 0.2f, 100.0f, &rng, &truth);
+        trace[i] = (truth.present ? truth.distance_cm : WALL_CM) + host_eval_noise(&rng, NOISE_CM);
+    }
+
+    approach_init(&tracker, ALPHA, BETA, SPEED_CM_S, NEAR_CM, LOITER_MS);
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < updates; i++) {
+        approach_update(&tracker, (int64_t)i * SAMPLE_US, trace[i % 60], &event);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / updates;
+    printf("cost: %.1f ns/update on this host, %zu B state per channel, no floating point after input conversion\n",
+           ns, sizeof(approach_tracker_t));
+    return 0;
+}
+
+static int compare_float(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// ============================================================================
+// traces
+// ============================================================================
+
+static void truth_walk_in(float t, float speed, uint32_t *rng, truth_t *out) {
+    // 1 s empty, walk from the wall to 50 cm, stand 3 s, walk back out
+    float walk_s = (WALL_CM - 20.0f - 50.0f) / speed;
+    out->present = true;
+    out->velocity_cm_s = 0.0f;
+    out->expected = APPROACH_EVENT_NONE;
+    if (t < 1.0f) {
+        out->present = false;
+    } else if (t < 1.0f + walk_s) {
+        out->distance_cm = WALL_CM - 20.0f - speed * (t - 1.0f);
+        out->velocity_cm_s = -speed;
+        out->expected = APPROACH_EVENT_APPROACHING;
+    } else if (t < 4.0f + walk_s) {
+        out->distance_cm = 50.0f;
+    } else if (t < 4.0f + 2.0f * walk_s) {
+        out->distance_cm = 50.0f + speed * (t - 4.0f - walk_s);
+        out->velocity_cm_s = speed;
+        out->expected = APPROACH_EVENT_RECEDING;
+    } else {
+        out->present = false;
+    }
+}
+
+static void truth_walk_past(float t, float speed, uint32_t *rng, truth_t *out) {
+    // crossing the beam at 80-200 cm for about a second, slight radial drift
+    static float range;
+    if (t < 0.2f) {
+        range = 80.0f + host_eval_random(rng) % 120;
+    }
+    out->present = (t >= 3.0f && t < 4.0f) || (t >= 6.0f && t < 6.8f);
+    out->distance_cm = range + 8.0f * (t - 3.0f);
+    out->velocity_cm_s = 0.0f;
+    out->expected = APPROACH_EVENT_NONE;
+}
+
+static void truth_loiter(float t, float speed, uint32_t *rng, truth_t *out) {
+    // walk in at 1 m/s to 100 cm, then stand and sway for the rest
+    out->present = t >= 1.0f;
+    out->expected = APPROACH_EVENT_NONE;
+    out->velocity_cm_s = 0.0f;
+    if (t < 1.0f) {
+        out->distance_cm = WALL_CM;
+    } else if (t < 2.3f) {
+        out->distance_cm = 230.0f - 100.0f * (t - 1.0f);
+        out->velocity_cm_s = -100.0f;
+        out->expected = APPROACH_EVENT_APPROACHING;
+    } else {
+        out->distance_cm = 100.0f + 3.0f * sinf(t * 1.3f);
+        out->expected = (t >= 2.3f + LOITER_MS / 1000.0f) ? APPROACH_EVENT_LOITERING : APPROACH_EVENT_NONE;
+    }
+}
+
+static void truth_empty(float t, float speed, uint32_t *rng, truth_t *out) {
+    out->present = false;
+    out->velocity_cm_s = 0.0f;
+    out->expected = APPROACH_EVENT_NONE;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file eval_compressor.c
+ * @author Anthony Yalong
+ * @brief Telemetry compression on a simulated day of each hub sensor -
+ *        samples and bytes kept, reconstruction error against the bound,
+ *        deadband vs swinging door. Traces model the sensors' sample
+ *        rates, quantisation and noise (dht11 whole units, ds18b20
+ *        1/16 C, hc-sr04 walk-bys, an analog smoke episode).
+ */
+
+// imports
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "compressor.h"
+#include "host_eval.h"
+
+// evaluation configuration
+#define DAY_S           86400
+#define RECORD_BYTES    8           // history_record_t
+#define PI_F            3.14159265f
+
+/**
+ * @brief Trace generator - value at sample index i
+ */
+typedef float (*trace_fn_t)(uint32_t i, uint32_t *rng);
+
+/**
+ * @brief Trace and the hub's compression setting for it
+ */
+typedef struct {
+    const char *name;
+    trace_fn_t generate;
+    uint32_t period_ms;
+    compressor_mode_t hub_mode;     // include/main_hub_system_config.h
+    float deviation;
+} trace_t;
+
+// function prototypes
+static float trace_temperature(uint32_t i, uint32_t *rng);
+static float trace_humidity(uint32_t i, uint32_t *rng);
+static float trace_distance(uint32_t i, uint32_t *rng);
+static float trace_zone(uint32_t i, uint32_t *rng);
+static float trace_gas(uint32_t i, uint32_t *rng);
+static int evaluate(const trace_t *trace, compressor_mode_t mode);
+
+static const trace_t traces[] = {
+    { "dht11 temperature", trace_temperature, 3000, COMPRESSOR_DEADBAND, 1.0f },
+    { "dht11 humidity", trace_humidity, 3000, COMPRESSOR_DEADBAND, 2.0f },
+    { "hc-sr04 distance", trace_distance, 200, COMPRESSOR_SWINGING_DOOR, 2.0f },
+    { "ds18b20 zone", trace_zone, 10000, COMPRESSOR_SWINGING_DOOR, 0.1f },
+    { "analog gas", trace_gas, 1000, COMPRESSOR_SWINGING_DOOR, 16.0f },
+};
+
+int eval_compressor(void) {
+    int failures = 0;
+
+    printf("==== telemetry compression (one simulated day per channel, 5 min max interval) ====\n");
+    printf("%-18s %-6s %7s %7s %7s %9s %9s %8s %8s %5s\n", "trace", "mode", "dev", "samples", "points", "bytes in",
+           "bytes out", "max err", "rms err", "kept");
+    for (size_t t = 0; t < sizeof(traces) / sizeof(traces[0]); t++) {
+        failures += evaluate(&traces[t], COMPRESSOR_DEADBAND);
+        failures += evaluate(&traces[t], COMPRESSOR_SWINGING_DOOR);
+    }
+    printf("(* = hub setting; deadband reconstructs by hold, swinging door by interpolation)\n");
+    return failures;
+}
+
+static int evaluate(const trace_t *trace, compressor_mode_t mode) {
+    uint32_t samples = DAY_S * 1000 / trace->period_ms;
+    float *values = malloc(samples * sizeof(float));
+    compressor_point_t *points = malloc((samples + 1) * sizeof(compressor_point_t));
+    compressor_t compressor;
+    uint32_t count = 0;
+    uint32_t rng = 12345;
+
+    compressor_init(&compressor, mode, trace->deviation, 300000);
+    for (uint32_t i = 0; i < samples; i++) {
+        values[i] = trace->generate(i, &rng);
+        if (compressor_add(&compressor, (int64_t)i * trace->period_ms * 1000, values[i], &points[count])) {
+            count++;
+        }
+    }
+    if (compressor_flush(&compressor, &points[count])) {
+        count++;
+    }
+
+    // reconstruct every original sample from the points
+    double max_error = 0.0;
+    double sum_squares = 0.0;
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        int64_t time_us = (int64_t)i * trace->period_ms * 1000;
+        while (j + 1 < count && points[j + 1].time_us <= time_us) {
+            j++;
+        }
+
+        float estimate = points[j].value;
+        if (mode == COMPRESSOR_SWINGING_DOOR && points[j].time_us < time_us && j + 1 < count) {
+            float fraction = (float)(time_us - points[j].time_us) / (points[j + 1].time_us - points[j].time_us);
+            estimate = points[j].value + fraction * (points[j + 1].value - points[j].value);
+        }
+
+        double error = fabs(estimate - values[i]);
+        max_error = fmax(max_error, error);
+        sum_squares += error * error;
+    }
+
+    // float rounding allowance on top of the bound
+    bool ok = max_error <= trace->deviation * 1.001 + 1e-4;
+    char label[8];
+    snprintf(label, sizeof(label), "%s%s", mode == COMPRESSOR_DEADBAND ? "dband" : "sdt",
+             mode == trace->hub_mode ? "*" : "");
+    printf("%-18s %-6s %7.2f %7lu %7lu %9lu %9lu %8.3f %8.3f %4.1f%%%s\n", trace->name, label, trace->deviation,
+           (unsigned long)samples, (unsigned long)count, (unsigned long)samples * RECORD_BYTES,
+           (unsigned long)count * RECORD_BYTES, max_error, sqrt(sum_squares / samples), 100.0 * count / samples,
+           ok ? "" : "  <-- bound exceeded");
+
+    free(values);
+    free(points);
+    return ok ? 0 : 1;
+}
+
+// ============================================================================
+// traces
+// ============================================================================
+
+static float trace_temperature(uint32_t i, uint32_t *rng) {
+    // daily swing, sensor noise, reported in whole degrees
+    float t = i * 3.0f;
+    float truth = 21.0f + 3.0f * sinf(2.0f * PI_F * t / DAY_S) + host_eval_noise(rng, 0.4f);
+    return roundf(truth);
+}
+
+static float trace_humidity(uint32_t i, uint32_t *rng) {
+    float t = i * 3.0f;
+    float truth = 45.0f - 8.0f * sinf(2.0f * PI_F * t / DAY_S) + host_eval_noise(rng, 1.2f);
+    return roundf(truth);
+}
+
+static float trace_distance(uint32_t i, uint32_t *rng) {
+    // wall at 250 cm; every 10 min someone walks in to 60 cm at 1 m/s, waits 5 s, walks out
+    float t = fmodf(i * 0.2f, 600.0f);
+    float truth = 250.0f;
+    if (t < 1.9f) {
+        truth = 250.0f - 100.0f * t;
+    } else if (t < 6.9f) {
+        truth = 60.0f;
+    } else if (t < 8.8f) {
+        truth = 60.0f + 100.0f * (t - 6.9f);
+    }
+    return truth + host_eval_noise(rng, 0.5f);
+}
+
+static float trace_zone(uint32_t i, uint32_t *rng) {
+    // slow drift plus a heater cycle every 2 h, 1/16 C resolution
+    float t = i * 10.0f;
+    float heater = (fmodf(t, 7200.0f) < 1800.0f) ? 1.5f * (1.0f - expf(-fmodf(t, 7200.0f) / 600.0f)) : 0.0f;
+    float truth = 19.0f + 2.0f * sinf(2.0f * PI_F * t / DAY_S) + heater + host_eval_noise(rng, 0.03f);
+    return roundf(truth * 16.0f) / 16.0f;
+}
+
+static float trace_gas(uint32_t i, uint32_t *rng) {
+    // baseline with drift, one smoke episode at 14:00 rising over 2 min and decaying
+    float t = i * 1.0f;
+    float level = 300.0f + 20.0f * sinf(2.0f * PI_F * t / DAY_S) + host_eval_noise(rng, 6.0f);
+    float since = t - 14.0f * 3600.0f;
+    if (since > 0.0f) {
+        level += (since < 120.0f) ? 2300.0f * since / 120.0f : 2300.0f * expf(-(since - 120.0f) / 900.0f);
+    }
+    return roundf(level);
+}
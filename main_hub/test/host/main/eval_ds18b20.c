@@ -0,0 +1,163 @@
+/**
+ * @file eval_ds18b20.c
+ * @author Anthony Yalong
+ * @brief DS18B20 zone bus on a simulated multi-drop 1-Wire line - the real
+ *        onewire.c, onewire_gpio.c and ds18b20.c driving devices decoded
+ *        from their edges. ROM search over several devices sharing long
+ *        prefixes plus one of another family, crc8 against the published
+ *        vector, scratchpad crc failures, one Convert T for every device,
+ *        and the master's slot timing against the datasheet windows.
+ */
+
+// imports
+#include <math.h>
+#include <stdio.h>
+#include "ds18b20.h"
+#include "host_eval.h"
+#include "sim_onewire.h"
+
+// evaluation configuration
+#define BUS_PIN         4
+#define RESOLUTION      10
+#define CONVERT_US      187500      // 10-bit conversion
+#define SENSORS         6
+
+// function prototypes
+static int evaluate_crc8(void);
+static int evaluate_empty(void);
+static int evaluate_bus(void);
+static int report(const char *name, bool ok, const char *detail);
+
+// serials branch at the first, middle and last rom bits
+static const uint64_t serials[SENSORS] = {
+    0x000000000001ULL, 0x000000000003ULL, 0x800000000001ULL,
+    0x7FFFFFFFFFFFULL, 0x000000000002ULL, 0x000000000000ULL,
+};
+static const float temperatures[SENSORS] = { 21.25f, -5.5f, 0.75f, 30.0f, 12.5f, -0.25f };
+
+int eval_ds18b20(void) {
+    int failures = 0;
+
+    printf("\n==== ds18b20 bus (simulated 1-wire line, %d sensors + 1 other family, %d-bit) ====\n", SENSORS,
+           RESOLUTION);
+    failures += evaluate_crc8();
+    failures += evaluate_empty();
+    failures += evaluate_bus();
+    return failures;
+}
+
+static int evaluate_crc8(void) {
+    // maxim application note 27 example rom, family 0x02
+    const uint8_t rom[8] = { 0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2 };
+    char detail[48];
+
+    snprintf(detail, sizeof(detail), "crc 0x%02X, residue 0x%02X", onewire_crc8(rom, 7), onewire_crc8(rom, 8));
+    return report("crc8 vector", onewire_crc8(rom, 7) == 0xA2 && onewire_crc8(rom, 8) == 0, detail);
+}
+
+static int evaluate_empty(void) {
+    ds18b20_bus_t sensors;
+    char detail[48];
+
+    sim_onewire_clear();
+    esp_err_t init = ds18b20_init(&sensors, BUS_PIN);
+    esp_err_t acquire = ds18b20_acquire(&sensors);
+    snprintf(detail, sizeof(detail), "%d sensors, acquire %s", sensors.count, esp_err_to_name(acquire));
+    return report("empty bus", init == ESP_OK && sensors.count == 0 && acquire == ESP_ERR_NOT_FOUND, detail);
+}
+
+static int evaluate_bus(void) {
+    int failures = 0;
+    ds18b20_bus_t sensors;
+    sim_onewire_timing_t timing;
+    char detail[96];
+
+    sim_onewire_clear();
+    for (int i = 0; i < SENSORS; i++) {
+        sim_onewire_add(sim_onewire_rom(DS18B20_FAMILY_CODE, serials[i]), temperatures[i]);
+    }
+    sim_onewire_add(sim_onewire_rom(0x10, 0x000000000001ULL), 0.0f);  // a DS18S20, skipped
+
+    // search: every DS18B20 rom exactly once, the other family left out
+    ds18b20_init(&sensors, BUS_PIN);
+    int found = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        uint64_t rom = sim_onewire_rom(DS18B20_FAMILY_CODE, serials[i]);
+        int matches = 0;
+        for (int j = 0; j < sensors.count; j++) {
+            matches += (sensors.roms[j] == rom);
+        }
+        found += (matches == 1);
+    }
+    snprintf(detail, sizeof(detail), "%d of %d roms, %d listed", found, SENSORS, sensors.count);
+    failures += report("rom search", found == SENSORS && sensors.count == SENSORS, detail);
+
+    // resolution written to every scratchpad through one skip rom
+    ds18b20_set_resolution(&sensors, RESOLUTION);
+    int configured = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        configured += (sim_onewire_resolution(i) == RESOLUTION);
+    }
+    snprintf(detail, sizeof(detail), "%d of %d at %d bits", configured, SENSORS, RESOLUTION);
+    failures += report("set resolution", configured == SENSORS, detail);
+
+    // one convert for all: the wait is one conversion time, not one per sensor
+    esp_err_t ret = ds18b20_acquire(&sensors);
+    int correct = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        int index = -1;
+        for (int j = 0; j < sensors.count; j++) {
+            index = (sensors.roms[j] == sim_onewire_rom(DS18B20_FAMILY_CODE, serials[i])) ? j : index;
+        }
+        correct += (index >= 0 && sensors.valid[index] && sensors.temperatures[index] == temperatures[i] &&
+                    sim_onewire_conversions(i) == 1);
+    }
+    snprintf(detail, sizeof(detail), "%d of %d correct, convert %.1f ms (one conversion %.1f ms), total %.1f ms",
+             correct, SENSORS, sensors.last_convert_us / 1000.0, CONVERT_US / 1000.0,
+             sensors.last_acquire_us / 1000.0);
+    failures += report("parallel convert",
+                       ret == ESP_OK && correct == SENSORS && sensors.last_convert_us >= CONVERT_US &&
+                       sensors.last_convert_us <= CONVERT_US + 2 * DS18B20_POLL_INTERVAL_MS * 1000,
+                       detail);
+
+    // a corrupted scratchpad fails crc, leaves the others valid and recovers on the next read
+    sim_onewire_corrupt(2, 1);
+    for (int i = 0; i < SENSORS; i++) {
+        sim_onewire_set_temperature(i, temperatures[i] + 1.0f);
+    }
+    ret = ds18b20_acquire(&sensors);
+    int valid = 0;
+    for (int j = 0; j < sensors.count; j++) {
+        valid += sensors.valid[j];
+    }
+    uint32_t crc_errors = sensors.crc_errors;
+    esp_err_t retry = ds18b20_acquire(&sensors);
+    int valid_after = 0;
+    for (int j = 0; j < sensors.count; j++) {
+        valid_after += sensors.valid[j];
+    }
+    snprintf(detail, sizeof(detail), "%s, %d of %d valid, %lu crc errors, retry %s with %d valid",
+             esp_err_to_name(ret), valid, SENSORS, (unsigned long)crc_errors, esp_err_to_name(retry), valid_after);
+    failures += report("crc failure",
+                       ret == ESP_ERR_INVALID_CRC && valid == SENSORS - 1 && crc_errors == 1 && retry == ESP_OK &&
+                       valid_after == SENSORS,
+                       detail);
+
+    // the master's slots against the datasheet windows, over everything above
+    sim_onewire_get_timing(&timing);
+    printf("timing: %lu resets, %lu slots; reset low %ld/high %ld, presence sample %ld-%ld, write 0 low %ld-%ld, "
+           "write 1 low %ld, read sample %ld, slot %ld, recovery %ld us\n",
+           (unsigned long)timing.resets, (unsigned long)timing.slots, (long)timing.reset_low_min_us,
+           (long)timing.reset_high_min_us, (long)timing.presence_sample_min_us, (long)timing.presence_sample_max_us,
+           (long)timing.write0_low_min_us, (long)timing.write0_low_max_us, (long)timing.write1_low_max_us,
+           (long)timing.read_sample_max_us, (long)timing.slot_min_us, (long)timing.recovery_min_us);
+    snprintf(detail, sizeof(detail), "%lu out of spec", (unsigned long)timing.violations);
+    failures += report("slot timing", timing.violations == 0, detail);
+
+    return failures;
+}
+
+static int report(const char *name, bool ok, const char *detail) {
+    printf("%-18s %s%s\n", name, detail, ok ? "" : "  <-- FAIL");
+    return ok ? 0 : 1;
+}
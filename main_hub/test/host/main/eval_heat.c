@@ -0,0 +1,256 @@
+/**
+ * @file eval_heat.c
+ * @author Anthony Yalong
+ * @brief Heat detector on synthetic heating curves at the hub's 3 s DHT11
+ *        rate - fires growing at several rates, a slow smoulder - and on
+ *        days of nuisance heat (diurnal swing, sun on the sensor, a space
+ *        heater, cooking). Readings are whole degrees clamped to the
+ *        DHT11's 0-50 C, with noise, failed reads and outages. Reports
+ *        detection rate and delay, false alarms per day and update cost.
+ */
+
+// imports
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "heat.h"
+#include "host_eval.h"
+
+// evaluation configuration (detector settings as in include/main_hub_system_config.h)
+#define SAMPLE_US       3000000
+#define FIXED_C         50.0f
+#define RATE_C_MIN      8.3f        // 15 F/min, the usual rate-of-rise setting
+#define WINDOW_MS       60000
+#define AMBIENT_C       22.0f
+#define NOISE_C         0.4f        // before rounding to whole degrees
+#define FAILURE_PCT     5           // timeouts and checksum errors
+#define OUTAGE_PER_MIL  2           // readings that start a 30 s outage
+#define OUTAGE_READINGS 10
+#define FIRE_START_S    300.0f
+#define RUNS            100         // seeds per fire scenario
+#define NUISANCE_DAYS   30          // simulated days per nuisance scenario
+#define MIN_DETECTION   0.98        // required detection rate
+#define MAX_FALSE_DAY   0.05        // tolerated false alarms per day
+
+/**
+ * @brief Scenario - true air temperature at time t
+ */
+typedef struct {
+    const char *name;
+    float (*temperature)(float t, float rate);
+    float rate;                     // C per minute for fires
+    float duration_s;
+    bool fire;                      // alarm wanted (else every alarm is false)
+    float max_delay_s;              // p90 from ignition (includes the first minute of growth), fires only
+} scenario_t;
+
+// function prototypes
+static float curve_fire(float t, float rate);
+static float curve_smoulder(float t, float rate);
+static float curve_diurnal(float t, float rate);
+static float curve_sun(float t, float rate);
+static float curve_heater(float t, float rate);
+static float curve_cooking(float t, float rate);
+static int evaluate(const scenario_t *scenario);
+static int evaluate_cost(void);
+
+static const scenario_t scenarios[] = {
+    { "fire 10 C/min", curve_fire, 10.0f, 1200.0f, true, 120.0f },
+    { "fire 15 C/min", curve_fire, 15.0f, 1200.0f, true, 90.0f },
+    { "fire 20 C/min", curve_fire, 20.0f, 1200.0f, true, 75.0f },
+    { "fire 30 C/min", curve_fire, 30.0f, 1200.0f, true, 70.0f },
+    { "fire 5 C/min", curve_fire, 5.0f, 1200.0f, true, 420.0f },
+    { "smoulder 2 C/min", curve_smoulder, 2.0f, 2400.0f, true, 900.0f },
+    { "diurnal 18-30 C", curve_diurnal, 0.0f, NUISANCE_DAYS * 86400.0f, false, 0.0f },
+    { "sun on sensor", curve_sun, 0.0f, NUISANCE_DAYS * 86400.0f, false, 0.0f },
+    { "space heater", curve_heater, 0.0f, NUISANCE_DAYS * 86400.0f, false, 0.0f },
+    { "cooking", curve_cooking, 0.0f, NUISANCE_DAYS * 86400.0f, false, 0.0f },
+};
+
+int eval_heat(void) {
+    int failures = 0;
+
+    printf("\n==== heat detector (dht11 every 3 s, whole degrees, %d%% failed reads + outages, %.1f C/min over %d s) "
+           "====\n", FAILURE_PCT, RATE_C_MIN, WINDOW_MS / 1000);
+    printf("%-18s %9s %9s %9s %9s %11s %9s\n", "scene", "detected", "delay s", "p90 s", "by rate", "false/day",
+           "max rate");
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        failures += evaluate(&scenarios[s]);
+    }
+    failures += evaluate_cost();
+    return failures;
+}
+
+static int evaluate(const scenario_t *scenario) {
+    uint32_t runs = scenario->fire ? RUNS : 1;
+    uint32_t detected = 0;
+    uint32_t by_rate = 0;
+    uint32_t false_alarms = 0;
+    float delays[RUNS];
+    float max_rate = 0.0f;
+    heat_detector_t detector;
+
+    for (uint32_t run = 0; run < runs; run++) {
+        uint32_t rng = 4000 + run * 7919;
+        int outage = 0;
+        bool seen = false;
+        heat_init(&detector, FIXED_C, RATE_C_MIN, WINDOW_MS);
+
+        // the scene starts at a random phase of the sample clock
+        float phase = (host_eval_random(&rng) % 3000) / 1000.0f;
+        for (int64_t time_us = 0; time_us < (int64_t)(scenario->duration_s * 1e6); time_us += SAMPLE_US) {
+            float t = time_us / 1e6f + phase;
+
+            // dht11: failed reads, the odd outage, noise, whole degrees, 0-50 C
+            uint32_t roll = host_eval_random(&rng) % 1000;
+            if (outage == 0 && roll < OUTAGE_PER_MIL) {
+                outage = OUTAGE_READINGS;
+            }
+            if (outage > 0 || roll % 100 < FAILURE_PCT) {
+                outage -= (outage > 0);
+                heat_miss(&detector);
+                continue;
+            }
+            float reading = roundf(scenario->temperature(t, scenario->rate) + host_eval_noise(&rng, NOISE_C));
+            reading = fminf(fmaxf(reading, 0.0f), 50.0f);
+
+            heat_event_t event;
+            if (heat_update(&detector, time_us, reading, &event) != HEAT_EVENT_ALARM) {
+                continue;
+            }
+            if (!scenario->fire || t < FIRE_START_S) {
+                false_alarms++;
+            } else if (!seen) {
+                seen = true;
+                delays[detected++] = t - FIRE_START_S;
+                by_rate += (event.cause & HEAT_CAUSE_RATE) != 0;
+            }
+        }
+
+        heat_stats_t stats;
+        heat_get_stats(&detector, &stats);
+        max_rate = fmaxf(max_rate, stats.max_rate_c_min);
+    }
+
+    // delays are found in run order, sort for the percentiles
+    for (uint32_t i = 1; i < detected; i++) {
+        for (uint32_t j = i; j > 0 && delays[j - 1] > delays[j]; j--) {
+            float swap = delays[j];
+            delays[j] = delays[j - 1];
+            delays[j - 1] = swap;
+        }
+    }
+
+    double days = runs * scenario->duration_s / 86400.0;
+    double mean_delay = 0.0;
+    for (uint32_t i = 0; i < detected; i++) {
+        mean_delay += delays[i] / detected;
+    }
+    bool ok = scenario->fire ? (detected >= MIN_DETECTION * runs && delays[detected * 9 / 10] <= scenario->max_delay_s &&
+                                false_alarms == 0)
+                             : false_alarms <= MAX_FALSE_DAY * days;
+
+    char detected_text[16] = "-";
+    char delay_text[16] = "-";
+    char p90_text[16] = "-";
+    char rate_text[16] = "-";
+    if (scenario->fire) {
+        snprintf(detected_text, sizeof(detected_text), "%.0f%%", 100.0 * detected / runs);
+        if (detected > 0) {
+            snprintf(delay_text, sizeof(delay_text), "%.0f", mean_delay);
+            snprintf(p90_text, sizeof(p90_text), "%.0f", delays[detected * 9 / 10]);
+            snprintf(rate_text, sizeof(rate_text), "%.0f%%", 100.0 * by_rate / detected);
+        }
+    }
+    printf("%-18s %9s %9s %9s %9s %11.3f %9.1f%s\n", scenario->name, detected_text, delay_text, p90_text, rate_text,
+           false_alarms / days, max_rate, ok ? "" : "  <-- FAIL");
+    return ok ? 0 : 1;
+}
+
+static int evaluate_cost(void) {
+    heat_detector_t detector;
+    heat_event_t event;
+    uint32_t rng = 99;
+    float trace[400];               // 20 min of a 15 C/min fire
+    const int updates = 4000000;
+
+    for (int i = 0; i < 400; i++) {
+        trace[i] = fminf(roundf(curve_fire(i * 3.0f, 15.0f) + host_eval_noise(&rng, NOISE_C)), 50.0f);
+    }
+
+    heat_init(&detector, FIXED_C, RATE_C_MIN, WINDOW_MS);
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < updates; i++) {
+        heat_update(&detector, (int64_t)i * SAMPLE_US, trace[i % 400], &event);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / updates;
+    printf("cost: %.1f ns/update on this host, %zu B state, independent of the window length\n", ns,
+           sizeof(heat_detector_t));
+    return 0;
+}
+
+// ============================================================================
+// curves
+// ============================================================================
+
+static float curve_fire(float t, float rate) {
+    // flaming fire under the sensor: ramp to the rate over the first minute
+    if (t < FIRE_START_S) {
+        return AMBIENT_C;
+    }
+    float m = (t - FIRE_START_S) / 60.0f;
+    return AMBIENT_C + rate * (m < 1.0f ? 0.5f * m * m : m - 0.5f);
+}
+
+static float curve_smoulder(float t, float rate) {
+    // too slow for the rate threshold, the fixed threshold has to catch it
+    return t < FIRE_START_S ? AMBIENT_C : AMBIENT_C + rate * (t - FIRE_START_S) / 60.0f;
+}
+
+static float curve_diurnal(float t, float rate) {
+    // unconditioned room in summer, 18 C at 6:00 to 30 C at 18:00
+    return 24.0f - 6.0f * cosf(2.0f * 3.14159265f * (t - 21600.0f) / 86400.0f);
+}
+
+static float curve_sun(float t, float rate) {
+    // sun reaches the sensor at 15:00 for an hour: +8 C with a 4 min time constant
+    float day = fmodf(t, 86400.0f);
+    float base = curve_diurnal(t, rate);
+    if (day < 54000.0f) {
+        return base;
+    }
+    if (day < 57600.0f) {
+        return base + 8.0f * (1.0f - expf(-(day - 54000.0f) / 240.0f));
+    }
+    return base + 8.0f * expf(-(day - 57600.0f) / 240.0f);
+}
+
+static float curve_heater(float t, float rate) {
+    // 2 kW heater switched on at 7:00 and 19:00 for an hour, 2 m away: +12 C, 3 min time constant
+    float on = fmodf(t, 43200.0f) - 25200.0f;
+    if (on < 0.0f) {
+        return 16.0f;
+    }
+    if (on < 3600.0f) {
+        return 16.0f + 12.0f * (1.0f - expf(-on / 180.0f));
+    }
+    return 16.0f + 12.0f * expf(-(on - 3600.0f) / 180.0f);
+}
+
+static float curve_cooking(float t, float rate) {
+    // oven door opened near the sensor at 18:30: +6 C in about a minute, for 5 min, twice a day
+    float day = fmodf(t, 43200.0f);
+    float base = AMBIENT_C;
+    float since = day - 23400.0f;
+    if (since < 0.0f) {
+        return base;
+    }
+    if (since < 300.0f) {
+        return base + 6.0f * (1.0f - expf(-since / 30.0f));
+    }
+    return base + 6.0f * expf(-(since - 300.0f) / 120.0f);
+}
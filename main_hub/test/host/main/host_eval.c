@@ -0,0 +1,23 @@
+/**
+ * @file host_eval.c
+ * @author Anthony Yalong
+ * @brief Host evaluation app entry - runs every evaluation, exit status is
+ *        the number of failed checks
+ */
+
+// imports
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_eval.h"
+
+void app_main(void) {
+    int failures = 0;
+
+    failures += eval_compressor();
+    failures += eval_approach();
+    failures += eval_heat();
+    failures += eval_ds18b20();
+
+    printf("\n%s (%d failed checks)\n", failures ? "FAIL" : "PASS", failures);
+    exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
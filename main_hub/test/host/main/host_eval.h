@@ -0,0 +1,62 @@
+/**
+ * @file host_eval.h
+ * @author Anthony Yalong
+ * @brief Host evaluations of hub algorithms on recorded and synthetic traces
+ */
+#ifndef HOST_EVAL_H
+#define HOST_EVAL_H
+
+// imports
+#include <stdint.h>
+
+/**
+ * @brief Deterministic pseudo-random generator (traces repeat run to run)
+ *
+ * @param state Generator state
+ * @return uint32_t Next value
+ */
+static inline uint32_t host_eval_random(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+/**
+ * @brief Uniform noise in [-amplitude, amplitude]
+ *
+ * @param state Generator state
+ * @param amplitude Noise amplitude
+ * @return float Noise sample
+ */
+static inline float host_eval_noise(uint32_t *state, float amplitude) {
+    return amplitude * (2.0f * (host_eval_random(state) & 0xFFFF) / 65535.0f - 1.0f);
+}
+
+/**
+ * @brief Telemetry compression: samples, bytes and reconstruction error
+ *
+ * @return int Number of failed checks
+ */
+int eval_compressor(void);
+
+/**
+ * @brief Approach tracker: detection, false events and velocity error on walking traces
+ *
+ * @return int Number of failed checks
+ */
+int eval_approach(void);
+
+/**
+ * @brief Heat detector: detection delay on heating curves, false alarms on nuisance heat
+ *
+ * @return int Number of failed checks
+ */
+int eval_heat(void);
+
+/**
+ * @brief DS18B20 bus: rom search, crc failures and parallel convert on a simulated 1-Wire line
+ *
+ * @return int Number of failed checks
+ */
+int eval_ds18b20(void);
+
+#endif  // HOST_EVAL_H
@@ -0,0 +1,140 @@
+/**
+ * @file test_adxl345.c
+ * @author Anthony Yalong
+ * @brief ADXL345 tamper sensor test application - checks tamper detection
+ *        and cpu cost per sample on simulated fifo batches, then runs the
+ *        device with watermark interrupts and reports i2c transactions per
+ *        second against samples per second. Replace main/main.c with this file.
+ */
+
+// imports
+#include <math.h>
+#include "adxl345.h"
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "main_hub_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define SIM_BATCHES 80              // 10 s of simulated data at 200 Hz
+#define SIM_SHAKE_FIRST 30          // batches with simulated tampering
+#define SIM_SHAKE_LAST 33
+#define SIM_RATE_HZ 200
+#define LIVE_REPORT_MS 1000         // live mode print interval
+#define TASK_STACK_DEPTH 4096
+#define TEST_PRIORITY 5
+
+// logging
+static const char *TAG = "test_adxl345";
+
+static adxl345_sensor_t sensor;
+static int starts;
+static int ends;
+
+// function prototypes
+esp_err_t i2c_master_init(void);
+void test_task(void *pvParameters);
+static void test_callback(const adxl345_event_t *event, void *arg);
+static void simulate_batch(uint32_t batch, int16_t (*xyz)[3]);
+
+void app_main(void) {
+    xTaskCreate(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL);
+}
+
+esp_err_t i2c_master_init(void) {
+    // i2c config
+    i2c_config_t config = {
+        .mode = I2C_MODE_MASTER,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ
+    };
+
+    esp_err_t ret = i2c_param_config(I2C_MASTER_NUM, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to configure i2c parameters");
+        return ret;
+    }
+
+    ret = i2c_driver_install(I2C_MASTER_NUM, config.mode, 0, 0, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to install i2c driver");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "i2c master initialized");
+    return ESP_OK;
+}
+
+void test_task(void *pvParameters) {
+    static int16_t xyz[ADXL345_WATERMARK][3];
+    adxl345_stats_t stats;
+
+    // simulated fifo: one shake episode should give exactly one start and one end
+    adxl345_init(&sensor, ADXL345_RMS_THRESHOLD_MG, ADXL345_PEAK_THRESHOLD_MG, test_callback, NULL);
+    for (uint32_t batch = 0; batch < SIM_BATCHES; batch++) {
+        simulate_batch(batch, xyz);
+        adxl345_process_batch(&sensor, (const int16_t (*)[3])xyz, ADXL345_WATERMARK);
+    }
+    adxl345_get_stats(&sensor, &stats);
+    ESP_LOGI(TAG, "simulated: %d starts, %d ends (%s) | %llu cycles/sample",
+             starts, ends, (starts == 1 && ends == 1) ? "ok" : "FAIL",
+             stats.process_cycles / stats.samples);
+
+    // live device
+    if (i2c_master_init() != ESP_OK) {
+        vTaskDelete(NULL);
+    }
+    adxl345_init(&sensor, ADXL345_RMS_THRESHOLD_MG, ADXL345_PEAK_THRESHOLD_MG, test_callback, NULL);
+    if (adxl345_start(&sensor, I2C_MASTER_NUM, ADXL345_ADDR, ADXL345_INT_PIN, ADXL345_WATERMARK) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start adxl345");
+        vTaskDelete(NULL);
+    }
+    ESP_LOGI(TAG, "live mode - tap or shake the sensor");
+
+    adxl345_stats_t previous = { 0 };
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(LIVE_REPORT_MS));
+        adxl345_get_stats(&sensor, &stats);
+
+        uint32_t samples = stats.samples - previous.samples;
+        uint64_t cycles = stats.process_cycles - previous.process_cycles;
+        ESP_LOGI(TAG, "%lu i2c transactions/s, %lu samples/s, %llu cycles/sample | "
+                 "rms %lu mg, peak %lu mg, %lu fifo overruns",
+                 stats.i2c_transactions - previous.i2c_transactions, samples,
+                 samples ? cycles / samples : 0, sensor.last_batch.rms_mg, sensor.last_batch.peak_mg,
+                 stats.fifo_overruns);
+        previous = stats;
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void test_callback(const adxl345_event_t *event, void *arg) {
+    if (event->type == ADXL345_EVENT_TAMPER_START) {
+        starts++;
+        ESP_LOGW(TAG, "tamper start: rms %lu mg, peak %lu mg", event->batch.rms_mg, event->batch.peak_mg);
+    } else {
+        ends++;
+        ESP_LOGI(TAG, "tamper end");
+    }
+}
+
+static void simulate_batch(uint32_t batch, int16_t (*xyz)[3]) {
+    // flat mount: 1 g on z (256 lsb), +/-2 lsb noise, 30/45 Hz shake during the episode
+    for (int i = 0; i < ADXL345_WATERMARK; i++) {
+        float t = (float)(batch * ADXL345_WATERMARK + i) / SIM_RATE_HZ;
+
+        xyz[i][0] = (int16_t)(esp_random() % 5) - 2;
+        xyz[i][1] = (int16_t)(esp_random() % 5) - 2;
+        xyz[i][2] = 256 + (int16_t)(esp_random() % 5) - 2;
+        if (batch >= SIM_SHAKE_FIRST && batch <= SIM_SHAKE_LAST) {
+            xyz[i][0] += (int16_t)(80.0f * sinf(2.0f * M_PI * 30.0f * t));
+            xyz[i][2] += (int16_t)(40.0f * sinf(2.0f * M_PI * 45.0f * t));
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file test_ds18b20.c
+ * @author Anthony Yalong
+ * @brief DS18B20 bus test application - checks CRC8 and temperature
+ *        decoding against datasheet vectors, enumerates the bus and times
+ *        parallel acquisitions against the sequential cost (N conversions).
+ *        Replace main/main.c with this file.
+ */
+
+// imports
+#include <math.h>
+#include "ds18b20.h"
+#include "esp_log.h"
+#include "main_hub_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define TASK_DELAY_MS 5000          // time between acquisitions
+#define CONVERSION_TIME_MS 750      // 12-bit conversion, datasheet max
+#define TASK_STACK_DEPTH 4096
+#define TASK_PRIORITY 5
+
+// logging
+static const char *TAG = "test_ds18b20";
+
+// datasheet temperature/data relationship table
+static const struct {
+    uint16_t raw;
+    float celsius;
+} decode_vectors[] = {
+    { 0x07D0, 125.0f }, { 0x0550, 85.0f }, { 0x0191, 25.0625f }, { 0x00A2, 10.125f },
+    { 0x0008, 0.5f }, { 0x0000, 0.0f }, { 0xFFF8, -0.5f }, { 0xFF5E, -10.125f },
+    { 0xFE6F, -25.0625f }, { 0xFC90, -55.0f },
+};
+
+static ds18b20_bus_t sensors;
+
+// function prototypes
+void test_ds18b20(void *pvParameters);
+static bool test_vectors(void);
+
+void app_main(void) {
+    xTaskCreate(test_ds18b20, "test_ds18b20", TASK_STACK_DEPTH, NULL, TASK_PRIORITY, NULL);
+}
+
+void test_ds18b20(void *pvParameters) {
+    ESP_LOGI(TAG, "vectors: %s", test_vectors() ? "ok" : "FAIL");
+
+    if (ds18b20_init(&sensors, DS18B20_GPIO_PIN) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize ds18b20 bus");
+        vTaskDelete(NULL);
+    }
+    if (sensors.count == 0) {
+        ESP_LOGE(TAG, "no ds18b20 sensors found - check wiring and the 4.7k pull-up");
+        vTaskDelete(NULL);
+    }
+    ds18b20_set_resolution(&sensors, DS18B20_RESOLUTION);
+
+    while (true) {
+        esp_err_t ret = ds18b20_acquire(&sensors);
+
+        ESP_LOGI(TAG, "acquire %s: convert %lu ms, total %lu ms (sequential would be ~%d ms), %lu crc errors",
+                 ret == ESP_OK ? "ok" : "failed", sensors.last_convert_us / 1000, sensors.last_acquire_us / 1000,
+                 sensors.count * CONVERSION_TIME_MS, sensors.crc_errors);
+        for (uint8_t i = 0; i < sensors.count; i++) {
+            ESP_LOGI(TAG, "  %016llx: %.4f C%s", sensors.roms[i], sensors.temperatures[i],
+                     sensors.valid[i] ? "" : " (invalid)");
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(TASK_DELAY_MS));
+    }
+
+    vTaskDelete(NULL);
+}
+
+static bool test_vectors(void) {
+    bool ok = true;
+
+    // rom from the maxim 1-wire crc application note, crc byte last
+    const uint8_t rom[8] = { 0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2 };
+    if (onewire_crc8(rom, 7) != 0xA2 || onewire_crc8(rom, 8) != 0) {
+        ESP_LOGE(TAG, "crc8 mismatch: 0x%02x", onewire_crc8(rom, 7));
+        ok = false;
+    }
+
+    for (size_t i = 0; i < sizeof(decode_vectors) / sizeof(decode_vectors[0]); i++) {
+        float value = ds18b20_decode(decode_vectors[i].raw & 0xFF, decode_vectors[i].raw >> 8);
+        if (fabsf(value - decode_vectors[i].celsius) > 0.001f) {
+            ESP_LOGE(TAG, "decode 0x%04x: got %.4f, expected %.4f",
+                     decode_vectors[i].raw, value, decode_vectors[i].celsius);
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file test_history.c
+ * @author Anthony Yalong
+ * @brief History store test application - fills the ring past capacity,
+ *        checks cursor filters and fixed point formatting, a window over
+ *        channels whose points arrive late and interleaved, then measures
+ *        export throughput (rows/s, cursor + formatter into one chunk
+ *        buffer, as the http exporter does) and the free-heap drop for
+ *        short and full ranges. For the network path run the hub and
+ *        `curl -o /dev/null "http://<hub ip>/api/history?format=json"` -
+ *        the exporter logs rows/s and peak heap. Replace main/main.c with
+ *        this file.
+ */
+
+// imports
+#include <stdio.h>
+#include <string.h>
+#include "history.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define FILL_RECORDS (HISTORY_CAPACITY + 1000)  // laps the ring
+#define RECORD_STEP_S 20
+#define CHUNK_LEN 1024
+#define BATCH 32
+#define INTERLEAVE_ROUNDS 1000          // one 2 s sample per round
+#define INTERLEAVE_LATE_S 45            // a closing point this far back every third round
+#define TASK_STACK_DEPTH 6144
+#define TEST_PRIORITY 5
+
+// logging
+static const char *TAG = "test_history";
+
+static history_t history;
+
+// function prototypes
+void test_task(void *pvParameters);
+static uint32_t export_range(uint32_t from_s, uint32_t to_s, uint32_t mask, history_format_t format);
+static bool test_interleaved(void);
+
+void app_main(void) {
+    xTaskCreate(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL);
+}
+
+void test_task(void *pvParameters) {
+    int temperature;
+    int humidity;
+    int gas;
+    char row[HISTORY_ROW_MAX];
+
+    history_init(&history);
+    history_add_channel(&history, "temperature", 1, &temperature);
+    history_add_channel(&history, "humidity", 0, &humidity);
+    history_add_channel(&history, "gas", 0, &gas);
+
+    // fixed point formatting and rounding
+    history_record_t record = { .time_s = 1, .channel = temperature, .value = -53 };
+    history_format_row(&history, HISTORY_FORMAT_CSV, &record, true, row, sizeof(row));
+    ESP_LOGI(TAG, "format -5.3: %s", strcmp(row, "1,temperature,-5.3\n") == 0 ? "ok" : "FAIL");
+    history_record(&history, temperature, 0, -0.04f);
+    ESP_LOGI(TAG, "round -0.04: %s", history.records[0].value == 0 ? "ok" : "FAIL");
+    ESP_LOGI(TAG, "interleaved late points: %s", test_interleaved() ? "ok" : "FAIL");
+
+    // three channels round robin, laps the ring by 1000 records
+    history_init(&history);
+    history_add_channel(&history, "temperature", 1, &temperature);
+    history_add_channel(&history, "humidity", 0, &humidity);
+    history_add_channel(&history, "gas", 0, &gas);
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < FILL_RECORDS; i++) {
+        history_record(&history, i % 3, i * RECORD_STEP_S, 20.0f + (i % 50) * 0.1f);
+    }
+    ESP_LOGI(TAG, "record: %lld ns each", (esp_timer_get_time() - start) * 1000 / FILL_RECORDS);
+
+    // filters: the oldest 1000 records are gone, one channel is a third
+    uint32_t oldest_s = (FILL_RECORDS - HISTORY_CAPACITY) * RECORD_STEP_S;
+    uint32_t rows = export_range(0, UINT32_MAX, 1UL << gas, HISTORY_FORMAT_CSV);
+    ESP_LOGI(TAG, "gas only: %lu rows (%s)", rows,
+             rows == (HISTORY_CAPACITY + 2) / 3 || rows == HISTORY_CAPACITY / 3 ? "ok" : "FAIL");
+    rows = export_range(oldest_s + 100 * RECORD_STEP_S, oldest_s + 199 * RECORD_STEP_S, UINT32_MAX,
+                        HISTORY_FORMAT_CSV);
+    ESP_LOGI(TAG, "100 record window: %lu rows (%s)", rows, rows == 100 ? "ok" : "FAIL");
+
+    // throughput and heap, short vs full range
+    ESP_LOGI(TAG, "---- export throughput ----");
+    export_range(oldest_s, oldest_s + 99 * RECORD_STEP_S, UINT32_MAX, HISTORY_FORMAT_CSV);
+    export_range(0, UINT32_MAX, UINT32_MAX, HISTORY_FORMAT_CSV);
+    export_range(0, UINT32_MAX, UINT32_MAX, HISTORY_FORMAT_JSON);
+
+    vTaskDelete(NULL);
+}
+
+static bool test_interleaved(void) {
+    static const uint32_t windows[][2] = { { 0, 99 }, { 601, 899 }, { 1000, 1010 }, { 1900, UINT32_MAX } };
+    int on_time;
+    int late;
+    bool ok = true;
+
+    // one channel stamped as it arrives, the other's points land up to INTERLEAVE_LATE_S behind it
+    history_init(&history);
+    history_add_channel(&history, "temperature", 1, &on_time);
+    history_add_channel(&history, "humidity", 0, &late);
+    for (uint32_t i = 0; i < INTERLEAVE_ROUNDS; i++) {
+        uint32_t now_s = i * 2;
+        history_record(&history, on_time, now_s, 20.0f);
+        if (i % 3 == 0 && now_s >= INTERLEAVE_LATE_S) {
+            history_record(&history, late, now_s - INTERLEAVE_LATE_S + (i % 7), 50.0f);
+        }
+    }
+
+    // every window against a count over the whole ring
+    for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+        uint32_t expected = 0;
+        for (uint32_t i = 0; i < history.head; i++) {
+            uint32_t time_s = history.records[i].time_s;
+            expected += (time_s >= windows[w][0] && time_s <= windows[w][1]);
+        }
+        uint32_t rows = export_range(windows[w][0], windows[w][1], UINT32_MAX, HISTORY_FORMAT_CSV);
+        ESP_LOGI(TAG, "window %lu-%lu: %lu of %lu rows", windows[w][0], windows[w][1], rows, expected);
+        ok = ok && rows == expected;
+    }
+    return ok;
+}
+
+static uint32_t export_range(uint32_t from_s, uint32_t to_s, uint32_t mask, history_format_t format) {
+    char chunk[CHUNK_LEN];
+    history_record_t batch[BATCH];
+    history_cursor_t cursor;
+    uint32_t rows = 0;
+    uint32_t chunks = 0;
+    size_t used = 0;
+
+    size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t heap_min = heap_before;
+    int64_t start = esp_timer_get_time();
+
+    history_cursor_init(&history, &cursor, from_s, to_s, mask);
+    while (!cursor.done) {
+        size_t count = history_read(&history, &cursor, batch, BATCH);
+        for (size_t i = 0; i < count; i++) {
+            // a full chunk stands in for httpd_resp_send_chunk
+            if (used + HISTORY_ROW_MAX > sizeof(chunk)) {
+                chunks++;
+                used = 0;
+                size_t heap_now = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+                if (heap_now < heap_min) {
+                    heap_min = heap_now;
+                }
+            }
+            used += history_format_row(&history, format, &batch[i], rows == 0, chunk + used, sizeof(chunk) - used);
+            rows++;
+        }
+    }
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    ESP_LOGI(TAG, "%4s %5lu rows, %3lu chunks: %lld us, %llu rows/s, peak heap delta %d B",
+             format == HISTORY_FORMAT_JSON ? "json" : "csv", rows, chunks + 1, elapsed,
+             elapsed ? (uint64_t)rows * 1000000ULL / elapsed : 0, (int)(heap_before - heap_min));
+    return rows;
+}
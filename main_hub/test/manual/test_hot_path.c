@@ -0,0 +1,155 @@
+/**
+ * @file test_hot_path.c
+ * @author Anthony Yalong
+ * @brief Hot-path placement test application - reads the DHT11 and the
+ *        HC-SR04 (pointed at a fixed target) first on a quiet system, then
+ *        while the other core keeps writing NVS (every flash write disables
+ *        the cache and flushes it). Reports cycles per poll, stalled polls
+ *        and pulse jitter for each phase. Build in measurement mode, once
+ *        as is and once with the timing loops left in flash, and compare:
+ *            idf.py -DHOT_PATH_STATS=1 build
+ *            idf.py -DHOT_PATH_STATS=1 -DHOT_PATH_FLASH=1 build
+ *        Replace main/main.c with this file.
+ */
+
+// imports
+#include <math.h>
+#include "dht11.h"
+#include "hcsr04.h"
+#include "main_hub_system_config.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define PHASE_MS 60000
+#define DHT11_PERIOD_MS 2000
+#define HCSR04_PERIOD_MS 100
+#define WRITE_BLOB_LEN 1024         // per nvs commit
+#define TASK_STACK_DEPTH 4096
+#define TEST_PRIORITY 5
+#define WRITER_PRIORITY 4
+
+// logging
+static const char *TAG = "test_hot_path";
+
+static dht11_sensor_t dht11;
+static hcsr04_sensor_t hcsr04;
+static volatile bool writing;
+static uint32_t commits;
+
+// function prototypes
+void test_task(void *pvParameters);
+void writer_task(void *pvParameters);
+static void run_phase(const char *name);
+
+void app_main(void) {
+    nvs_flash_init();
+    if (dht11_init(&dht11, DHT11_GPIO_PIN) != ESP_OK ||
+        hcsr04_init(&hcsr04, HCSR04_PIN_TRIG, HCSR04_PIN_ECHO, HCSR04_TIMEOUT_US) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize sensors");
+        return;
+    }
+
+    // cycle counts are per core: readers on core 0, flash writes on core 1
+    xTaskCreatePinnedToCore(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL, 0);
+    xTaskCreatePinnedToCore(writer_task, "writer_task", TASK_STACK_DEPTH, NULL, WRITER_PRIORITY, NULL, 1);
+}
+
+void test_task(void *pvParameters) {
+    if (!DHT11_TIMING_STATS || !HCSR04_TIMING_STATS) {
+        ESP_LOGW(TAG, "not built in measurement mode (idf.py -DHOT_PATH_STATS=1 build)");
+    }
+    ESP_LOGI(TAG, "timing loops in %s, stall = poll over %d us", DHT11_IRAM ? "iram" : "flash", DHT11_STALL_US);
+
+    run_phase("quiet");
+    writing = true;
+    run_phase("flash writes");
+    writing = false;
+    ESP_LOGI(TAG, "%lu nvs commits during the write phase", commits);
+
+    vTaskDelete(NULL);
+}
+
+void writer_task(void *pvParameters) {
+    static uint8_t blob[WRITE_BLOB_LEN];
+    nvs_handle_t handle;
+
+    if (nvs_open("hot_path", NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to open nvs");
+        vTaskDelete(NULL);
+    }
+    while (1) {
+        if (!writing) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        blob[0]++;
+        nvs_set_blob(handle, "blob", blob, sizeof(blob));
+        nvs_commit(handle);
+        commits++;
+        vTaskDelay(1);
+    }
+}
+
+static void run_phase(const char *name) {
+    uint32_t dht11_ok = 0;
+    uint32_t dht11_failed = 0;
+    uint32_t hcsr04_ok = 0;
+    uint32_t hcsr04_failed = 0;
+    double echo_sum = 0.0;
+    double echo_squares = 0.0;
+    int64_t echo_min = INT64_MAX;
+    int64_t echo_max = 0;
+    dht11_timing_t dt;
+    hcsr04_timing_t ht;
+
+    dht11_reset_timing(&dht11);
+    hcsr04_reset_timing(&hcsr04);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    for (int elapsed = 0; elapsed < PHASE_MS; elapsed += HCSR04_PERIOD_MS) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(HCSR04_PERIOD_MS));
+
+        if (hcsr04_read_distance(&hcsr04) == ESP_OK) {
+            int64_t pulse = hcsr04.last_pulse_us;
+            hcsr04_ok++;
+            echo_sum += pulse;
+            echo_squares += (double)pulse * pulse;
+            echo_min = (pulse < echo_min) ? pulse : echo_min;
+            echo_max = (pulse > echo_max) ? pulse : echo_max;
+        } else {
+            hcsr04_failed++;
+        }
+
+        if (elapsed % DHT11_PERIOD_MS == 0) {
+            if (dht11_read(&dht11) == ESP_OK) {
+                dht11_ok++;
+            } else {
+                dht11_failed++;
+            }
+        }
+    }
+
+    dht11_get_timing(&dht11, &dt);
+    hcsr04_get_timing(&hcsr04, &ht);
+    uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+    double echo_mean = hcsr04_ok ? echo_sum / hcsr04_ok : 0.0;
+    double echo_sd = hcsr04_ok ? sqrt(fmax(echo_squares / hcsr04_ok - echo_mean * echo_mean, 0.0)) : 0.0;
+
+    ESP_LOGI(TAG, "---- %s ----", name);
+    ESP_LOGI(TAG, "dht11 : %lu ok, %lu failed, %.1f cycles/poll, max poll %lu us, %lu stalls in %lu of %lu reads",
+             dht11_ok, dht11_failed, dt.polls ? (double)dt.poll_cycles / dt.polls : 0.0,
+             dt.max_poll_cycles / ticks_per_us, dt.stalls, dt.stalled_reads, dt.reads);
+    ESP_LOGI(TAG, "dht11 : high pulse spread %ld us (0 bits %ld-%ld), %ld us (1 bits %ld-%ld)",
+             dt.pulse_max_us[0] - dt.pulse_min_us[0], dt.pulse_min_us[0], dt.pulse_max_us[0],
+             dt.pulse_max_us[1] - dt.pulse_min_us[1], dt.pulse_min_us[1], dt.pulse_max_us[1]);
+    ESP_LOGI(TAG, "hcsr04: %lu ok, %lu failed, %.1f cycles/poll, max poll %lu us, %lu stalls in %lu of %lu reads",
+             hcsr04_ok, hcsr04_failed, ht.polls ? (double)ht.poll_cycles / ht.polls : 0.0,
+             ht.max_poll_cycles / ticks_per_us, ht.stalls, ht.stalled_reads, ht.reads);
+    ESP_LOGI(TAG, "hcsr04: echo %.1f us, jitter sd %.2f us, spread %lld us", echo_mean, echo_sd,
+             hcsr04_ok ? echo_max - echo_min : 0);
+}
@@ -0,0 +1,200 @@
+/**
+ * @file test_keypad.c
+ * @author Anthony Yalong
+ * @brief Keypad test application - checks PIN set/verify/lockout, then logs
+ *        every key event with its wake-up to handler latency and reports
+ *        scans per interval to show that an idle keypad costs nothing.
+ *        The stored PIN is saved first and put back when the checks are
+ *        done (or erased if there was none).
+ *        Replace main/main.c with this file.
+ */
+
+// imports
+#include "keypad.h"
+#include "keypad_pin.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "main_hub_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define TEST_PIN "2468"
+#define TEST_NEW_PIN "13579"
+#define REPORT_INTERVAL_MS 5000     // idle report interval
+#define LATENCY_LIMIT_US 20000      // key to handler budget
+#define TASK_STACK_DEPTH 4096
+#define TEST_PRIORITY 5
+
+// logging
+static const char *TAG = "test_keypad";
+
+static keypad_t keypad;
+static const gpio_num_t rows[] = KEYPAD_ROW_PINS;
+static const gpio_num_t cols[] = KEYPAD_COL_PINS;
+
+// function prototypes
+void test_task(void *pvParameters);
+static bool test_pin(void);
+static bool pin_backup(uint8_t *salt, uint8_t *hash);
+static void pin_restore(bool saved, const uint8_t *salt, const uint8_t *hash);
+
+void app_main(void) {
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+    xTaskCreate(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL);
+}
+
+void test_task(void *pvParameters) {
+    ESP_LOGI(TAG, "pin checks: %s", test_pin() ? "ok" : "FAIL");
+
+    if (keypad_init(&keypad, rows, sizeof(rows) / sizeof(rows[0]), cols, sizeof(cols) / sizeof(cols[0]),
+                    KEYPAD_KEYMAP) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize keypad");
+        vTaskDelete(NULL);
+    }
+    ESP_LOGI(TAG, "press keys - hold one to see typematic repeats");
+
+    static const char *type_names[] = { "press", "repeat", "release" };
+    keypad_event_t event;
+    uint32_t presses = 0;
+    int64_t worst_us = 0;
+    uint32_t last_wakeups = 0;
+    uint32_t last_scans = 0;
+
+    while (true) {
+        if (keypad_receive(&keypad, &event, pdMS_TO_TICKS(REPORT_INTERVAL_MS))) {
+            int64_t latency_us = esp_timer_get_time() - event.wake_time_us;
+
+            // only the press that woke the scanner measures interrupt-to-handler latency
+            if (event.type == KEYPAD_EVENT_PRESS) {
+                presses++;
+                if (latency_us > worst_us) {
+                    worst_us = latency_us;
+                }
+            }
+            ESP_LOGI(TAG, "%-7s %c  queued +%lld us, handled +%lld us from wake-up",
+                     type_names[event.type], event.key, event.event_time_us - event.wake_time_us, latency_us);
+            continue;
+        }
+
+        // no events for a full interval: scans should not have moved
+        ESP_LOGI(TAG, "idle: %lu wake-ups, %lu scans since last report | %lu presses, worst %lld us (%s)",
+                 keypad.wakeups - last_wakeups, keypad.scans - last_scans, presses, worst_us,
+                 worst_us <= LATENCY_LIMIT_US ? "ok" : "over budget");
+        last_wakeups = keypad.wakeups;
+        last_scans = keypad.scans;
+    }
+
+    vTaskDelete(NULL);
+}
+
+static bool test_pin(void) {
+    bool ok = true;
+    bool match;
+
+    // the checks overwrite the user's pin, keep it aside
+    uint8_t salt[KEYPAD_PIN_SALT_LEN];
+    uint8_t hash[KEYPAD_PIN_HASH_LEN];
+    bool saved = pin_backup(salt, hash);
+
+    if (keypad_pin_set("12a4") != ESP_ERR_INVALID_ARG || keypad_pin_set("123") != ESP_ERR_INVALID_ARG) {
+        ESP_LOGE(TAG, "invalid pins accepted");
+        ok = false;
+    }
+
+    keypad_pin_set(TEST_PIN);
+    if (keypad_pin_verify(TEST_PIN, &match) != ESP_OK || !match) {
+        ESP_LOGE(TAG, "correct pin rejected");
+        ok = false;
+    }
+
+    // time a match against mismatches, they should cost the same
+    const char *attempts[] = { TEST_PIN, "2469", "9999", "" };
+    for (size_t i = 0; i < sizeof(attempts) / sizeof(attempts[0]); i++) {
+        int64_t start = esp_timer_get_time();
+        keypad_pin_verify(attempts[i], &match);
+        ESP_LOGI(TAG, "verify \"%s\": %s in %lld us", attempts[i], match ? "match" : "no match",
+                 esp_timer_get_time() - start);
+        if (match != (i == 0)) {
+            ok = false;
+        }
+    }
+
+    // failures above count towards the lockout, these trip it
+    for (int i = 0; i < KEYPAD_PIN_MAX_FAILURES; i++) {
+        keypad_pin_verify("0000", &match);
+    }
+    if (keypad_pin_verify(TEST_PIN, &match) != ESP_ERR_INVALID_STATE || match) {
+        ESP_LOGE(TAG, "lockout not enforced");
+        ok = false;
+    }
+
+    // setting a pin clears the lockout
+    keypad_pin_set(TEST_PIN);
+    if (keypad_pin_verify(TEST_PIN, &match) != ESP_OK || !match) {
+        ESP_LOGE(TAG, "lockout not cleared by a new pin");
+        ok = false;
+    }
+
+    // a change needs the current pin
+    if (keypad_pin_change("0000", TEST_NEW_PIN, &match) != ESP_OK || match ||
+        keypad_pin_verify(TEST_PIN, &match) != ESP_OK || !match) {
+        ESP_LOGE(TAG, "pin changed without the current pin");
+        ok = false;
+    }
+    if (keypad_pin_change(TEST_PIN, TEST_NEW_PIN, &match) != ESP_OK || !match ||
+        keypad_pin_verify(TEST_NEW_PIN, &match) != ESP_OK || !match) {
+        ESP_LOGE(TAG, "pin change failed");
+        ok = false;
+    }
+
+    pin_restore(saved, salt, hash);
+    ESP_LOGI(TAG, "stored pin %s", saved ? "restored" : "erased (none was provisioned)");
+    return ok;
+}
+
+static bool pin_backup(uint8_t *salt, uint8_t *hash) {
+    nvs_handle_t handle;
+    size_t salt_len = KEYPAD_PIN_SALT_LEN;
+    size_t hash_len = KEYPAD_PIN_HASH_LEN;
+    bool saved = false;
+
+    if (nvs_open(KEYPAD_PIN_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        saved = nvs_get_blob(handle, KEYPAD_PIN_SALT_KEY, salt, &salt_len) == ESP_OK &&
+                nvs_get_blob(handle, KEYPAD_PIN_HASH_KEY, hash, &hash_len) == ESP_OK;
+        nvs_close(handle);
+    }
+    return saved;
+}
+
+static void pin_restore(bool saved, const uint8_t *salt, const uint8_t *hash) {
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(KEYPAD_PIN_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to restore the stored pin");
+        return;
+    }
+
+    if (saved) {
+        ret = nvs_set_blob(handle, KEYPAD_PIN_SALT_KEY, salt, KEYPAD_PIN_SALT_LEN);
+        if (ret == ESP_OK) {
+            ret = nvs_set_blob(handle, KEYPAD_PIN_HASH_KEY, hash, KEYPAD_PIN_HASH_LEN);
+        }
+    } else {
+        nvs_erase_key(handle, KEYPAD_PIN_SALT_KEY);
+        nvs_erase_key(handle, KEYPAD_PIN_HASH_KEY);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to restore the stored pin");
+    }
+}
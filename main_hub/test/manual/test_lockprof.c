@@ -0,0 +1,148 @@
+/**
+ * @file test_lockprof.c
+ * @author Anthony Yalong
+ * @brief Lock profiler test application - checks wait, hold and contention
+ *        accounting against a mutex held for a known time by another task
+ *        and a queue kept full, then measures the cost of a profiled
+ *        take/give pair against the plain FreeRTOS calls. Build with
+ *        idf.py -DLOCK_PROFILE=1 build. Replace main/main.c with this file.
+ */
+
+// imports
+#include "lockprof.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define HOLD_MS 20                  // two ticks at 100 Hz: a hold lasts 10-20 ms
+#define HOLDS 20
+#define QUEUE_LEN 4
+#define BENCH_PAIRS 10000
+#define TASK_STACK_DEPTH 4096
+#define TEST_PRIORITY 5
+
+// logging
+static const char *TAG = "test_lockprof";
+
+static SemaphoreHandle_t mutex;
+static QueueHandle_t queue;
+
+// function prototypes
+void test_task(void *pvParameters);
+void holder_task(void *pvParameters);
+static bool test_mutex(void);
+static bool test_queue(void);
+static void bench(void);
+
+void app_main(void) {
+    // one core, so the holder task preempts the test task
+    xTaskCreatePinnedToCore(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL, 0);
+}
+
+void test_task(void *pvParameters) {
+    if (!LOCKPROF_ENABLED) {
+        ESP_LOGE(TAG, "built without the profiler (idf.py -DLOCK_PROFILE=1 build)");
+        vTaskDelete(NULL);
+    }
+
+    mutex = xSemaphoreCreateMutex();
+    queue = xQueueCreate(QUEUE_LEN, sizeof(uint32_t));
+    lockprof_register(mutex, "test_mutex", LOCKPROF_MUTEX);
+    lockprof_register(queue, "test_queue", LOCKPROF_QUEUE);
+
+    ESP_LOGI(TAG, "mutex accounting: %s", test_mutex() ? "ok" : "FAIL");
+    ESP_LOGI(TAG, "queue accounting: %s", test_queue() ? "ok" : "FAIL");
+    lockprof_log_report();
+    bench();
+
+    vTaskDelete(NULL);
+}
+
+void holder_task(void *pvParameters) {
+    // takes the mutex and sits on it, the test task blocks meanwhile
+    for (int i = 0; i < HOLDS; i++) {
+        lockprof_take(mutex, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(HOLD_MS));
+        lockprof_give(mutex);
+        vTaskDelay(pdMS_TO_TICKS(HOLD_MS));
+    }
+    vTaskDelete(NULL);
+}
+
+static bool test_mutex(void) {
+    lockprof_lock_t lock;
+
+    // uncontended pairs
+    for (int i = 0; i < 10; i++) {
+        lockprof_take(mutex, portMAX_DELAY);
+        lockprof_give(mutex);
+    }
+    lockprof_get(0, &lock);
+    bool ok = lock.acquires == 10 && lock.contended == 0 && lock.owner_count == 1;
+
+    // a higher-priority holder: about every other take by this task has to wait for it
+    lockprof_reset();
+    xTaskCreatePinnedToCore(holder_task, "holder_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY + 1, NULL, 0);
+    for (int i = 0; i < HOLDS; i++) {
+        vTaskDelay(1);
+        lockprof_take(mutex, portMAX_DELAY);
+        lockprof_give(mutex);
+    }
+    vTaskDelay(pdMS_TO_TICKS(2 * HOLD_MS));
+
+    lockprof_get(0, &lock);
+    const lockprof_owner_t *holder = NULL;
+    const lockprof_owner_t *waiter = NULL;
+    for (int i = 0; i < lock.owner_count; i++) {
+        if (lock.owners[i].task == xTaskGetCurrentTaskHandle()) {
+            waiter = &lock.owners[i];
+        } else {
+            holder = &lock.owners[i];
+        }
+    }
+    ok = ok && holder != NULL && waiter != NULL && waiter->contended >= HOLDS / 4;
+    ok = ok && holder->max_hold_us >= HOLD_MS * 500 && lock.max_wait_us >= HOLD_MS * 250;
+    ESP_LOGI(TAG, "holder: hold max %lu us; waiter: %lu of %lu contended, wait %llu us", holder ? holder->max_hold_us : 0,
+             waiter ? waiter->contended : 0, waiter ? waiter->acquires : 0, waiter ? waiter->wait_us : 0);
+    return ok;
+}
+
+static bool test_queue(void) {
+    lockprof_lock_t lock;
+    uint32_t item = 0;
+
+    // fill, then one send that times out on the full queue
+    for (int i = 0; i < QUEUE_LEN; i++) {
+        lockprof_send(queue, &item, 0);
+    }
+    bool full = lockprof_send(queue, &item, pdMS_TO_TICKS(50)) != pdTRUE;
+    while (lockprof_receive(queue, &item, 0) == pdTRUE) {
+    }
+
+    lockprof_get(1, &lock);
+    return full && lock.acquires == QUEUE_LEN + 1 && lock.contended == 1 && lock.timeouts == 1 &&
+           lock.received == QUEUE_LEN && lock.max_depth == QUEUE_LEN && lock.max_wait_us >= 40000;
+}
+
+static void bench(void) {
+    SemaphoreHandle_t plain = xSemaphoreCreateMutex();
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCH_PAIRS; i++) {
+        xSemaphoreTake(plain, portMAX_DELAY);
+        xSemaphoreGive(plain);
+    }
+    uint32_t raw = (esp_cpu_get_cycle_count() - start) / BENCH_PAIRS;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCH_PAIRS; i++) {
+        lockprof_take(mutex, portMAX_DELAY);
+        lockprof_give(mutex);
+    }
+    uint32_t profiled = (esp_cpu_get_cycle_count() - start) / BENCH_PAIRS;
+
+    ESP_LOGI(TAG, "take/give pair: %lu cycles plain, %lu cycles profiled (+%lu)", raw, profiled, profiled - raw);
+    vSemaphoreDelete(plain);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test_occupancy.c
+ * @author Anthony Yalong
+ * @brief Occupancy rollup test application - checks hour splitting, ring
+ *        ageing (by episodes and by the clock) and unmapped sensors,
+ *        measures cycles per recorded episode (same hour and hour rollover
+ *        across all zones), reports the RAM budget for 64 zones and times a
+ *        save/load round trip. Erases the occupancy partition when done.
+ *        Replace main/main.c with this file.
+ */
+
+// imports
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "occupancy.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define BENCH_EPISODES 10000
+#define BENCH_STEP_S 30                 // average gap between episodes
+#define BUDGET_ZONES 64
+#define START_TIME 1700000000           // tuesday 2023-11-14 22:13:20 utc, slot 70
+#define TASK_STACK_DEPTH 4096
+#define TEST_PRIORITY 5
+
+// logging
+static const char *TAG = "test_occupancy";
+
+static occupancy_t occupancy;
+static occupancy_rollup_t rollup;
+
+// function prototypes
+void test_task(void *pvParameters);
+static bool test_rollup(void);
+static void bench(void);
+static void test_persistence(void);
+
+void app_main(void) {
+    xTaskCreate(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL);
+}
+
+void test_task(void *pvParameters) {
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    ESP_LOGI(TAG, "hour split and ageing: %s", test_rollup() ? "ok" : "FAIL");
+    bench();
+
+    // fixed ram: zone rollups plus the sensor map, nothing grows with episodes
+    size_t budget = sizeof(occupancy_t) - OCCUPANCY_MAX_ZONES * sizeof(occupancy_zone_t) +
+                    BUDGET_ZONES * sizeof(occupancy_zone_t);
+    ESP_LOGI(TAG, "memory: %u B per zone, %u B for %d zones (built for %d: %u B)",
+             sizeof(occupancy_zone_t), budget, BUDGET_ZONES, OCCUPANCY_MAX_ZONES, sizeof(occupancy_t));
+
+    test_persistence();
+    vTaskDelete(NULL);
+}
+
+static bool test_rollup(void) {
+    occupancy_init(&occupancy);
+    occupancy_add_zone(&occupancy, "hall", 0, 0, NULL);
+    occupancy_add_zone(&occupancy, "hall", 1, 3, NULL);
+
+    // 3000 s from 22:13:20: 2800 s in slot 70, 200 s in slot 71
+    bool ok = occupancy_record_episode(&occupancy, 1, 3, START_TIME, 3000) == ESP_OK;
+    occupancy_get_rollup(&occupancy, 0, &rollup);
+    ok = ok && rollup.episodes[70] == 1 && rollup.dwell_s[70] == 2800 && rollup.dwell_s[71] == 200;
+    ok = ok && occupancy_record_episode(&occupancy, 2, 0, START_TIME, 10) == ESP_ERR_NOT_FOUND;
+
+    // a week later slot 70 is reused, 71 still holds the hour 167 h back
+    ok = ok && occupancy_record_episode(&occupancy, 0, 0, START_TIME + 7 * 86400, 10) == ESP_OK;
+    occupancy_get_rollup(&occupancy, 0, &rollup);
+    ok = ok && rollup.episodes[70] == 1 && rollup.dwell_s[70] == 10 && rollup.dwell_s[71] == 200;
+    ok = ok && occupancy_record_episode(&occupancy, 0, 0, START_TIME, 10) == ESP_ERR_INVALID_STATE;
+
+    // two idle days later a read ages the ring to the clock: 71 (a week old) is cleared, 70 is kept
+    struct timeval saved_clock;
+    gettimeofday(&saved_clock, NULL);
+    struct timeval clock = { .tv_sec = START_TIME + 9 * 86400 };
+    settimeofday(&clock, NULL);
+    occupancy_get_rollup(&occupancy, 0, &rollup);
+    settimeofday(&saved_clock, NULL);
+    ok = ok && rollup.episodes[70] == 1 && rollup.dwell_s[71] == 0;
+    return ok;
+}
+
+static void bench(void) {
+    uint32_t same_hour = 0;
+    uint32_t same_hour_max = 0;
+    uint32_t rollover = 0;
+    uint32_t rollover_max = 0;
+    uint32_t same_count = 0;
+    uint32_t rollover_count = 0;
+
+    // full zone table, sensors spread over sources
+    occupancy_init(&occupancy);
+    for (int i = 0; i < OCCUPANCY_MAX_ZONES; i++) {
+        char name[OCCUPANCY_NAME_LEN];
+        snprintf(name, sizeof(name), "zone%d", i);
+        occupancy_add_zone(&occupancy, name, i % OCCUPANCY_MAX_SOURCES, i / OCCUPANCY_MAX_SOURCES, NULL);
+    }
+
+    time_t now = START_TIME;
+    for (int i = 0; i < BENCH_EPISODES; i++) {
+        int zone = esp_random() % OCCUPANCY_MAX_ZONES;
+        bool crosses = (now + 60) / 3600 != now / 3600;
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        occupancy_record_episode(&occupancy, zone % OCCUPANCY_MAX_SOURCES, zone / OCCUPANCY_MAX_SOURCES, now,
+                                 esp_random() % 60);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+        if (crosses) {
+            rollover += cycles;
+            rollover_count++;
+            rollover_max = (cycles > rollover_max) ? cycles : rollover_max;
+        } else {
+            same_hour += cycles;
+            same_count++;
+            same_hour_max = (cycles > same_hour_max) ? cycles : same_hour_max;
+        }
+        now += esp_random() % (2 * BENCH_STEP_S);
+    }
+
+    ESP_LOGI(TAG, "same hour: %lu cycles/episode avg (%lu us), %lu max", same_hour / same_count,
+             same_hour / same_count / esp_rom_get_cpu_ticks_per_us(), same_hour_max);
+    ESP_LOGI(TAG, "hour rollover (%lu): %lu cycles/episode avg, %lu max (%d zones cleared)", rollover_count,
+             rollover_count ? rollover / rollover_count : 0, rollover_max, OCCUPANCY_MAX_ZONES);
+}
+
+static void test_persistence(void) {
+    occupancy_rollup_t before;
+
+    // start from an empty partition so load keeps the benchmark rollups
+    nvs_flash_erase_partition(OCCUPANCY_NVS_PARTITION);
+    if (occupancy_load(&occupancy) != ESP_OK) {
+        ESP_LOGE(TAG, "no occupancy partition in the partition table");
+        return;
+    }
+    occupancy_get_rollup(&occupancy, 0, &before);
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = occupancy_save(&occupancy);
+    int64_t save_us = esp_timer_get_time() - start;
+
+    // fresh structure with the same zones, restored from nvs
+    occupancy_init(&occupancy);
+    for (int i = 0; i < OCCUPANCY_MAX_ZONES; i++) {
+        char name[OCCUPANCY_NAME_LEN];
+        snprintf(name, sizeof(name), "zone%d", i);
+        occupancy_add_zone(&occupancy, name, i % OCCUPANCY_MAX_SOURCES, i / OCCUPANCY_MAX_SOURCES, NULL);
+    }
+    start = esp_timer_get_time();
+    ret = (ret == ESP_OK) ? occupancy_load(&occupancy) : ret;
+    int64_t load_us = esp_timer_get_time() - start;
+    occupancy_get_rollup(&occupancy, 0, &rollup);
+
+    ESP_LOGI(TAG, "save/load %d zones: %s, save %lld ms, load %lld ms", OCCUPANCY_MAX_ZONES,
+             (ret == ESP_OK && memcmp(&before, &rollup, sizeof(rollup)) == 0) ? "ok" : "FAIL",
+             save_us / 1000, load_us / 1000);
+
+    nvs_flash_deinit_partition(OCCUPANCY_NVS_PARTITION);
+    nvs_flash_erase_partition(OCCUPANCY_NVS_PARTITION);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file test_pir_bank.c
+ * @author Anthony Yalong
+ * @brief PIR bank test application - benchmarks the bit-parallel debouncer
+ *        against N separate pir_read() calls and logs live edge events from
+ *        the interrupt-driven bank. Replace main/main.c with this file to
+ *        run PIR bank tests.
+ */
+
+// imports
+#include "pir.h"
+#include "pir_bank.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "driver/gpio.h"
+#include "main_hub_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define BENCH_PASSES 1000       // debounce passes per measurement
+#define TASK_STACK_DEPTH 4096   // safe stack depth for testing
+#define TASK_PRIORITY 5         // safe task priority for testing
+
+// logging
+static const char *TAG = "test_pir_bank";
+
+// sensors under test
+static pir_bank_t pir_bank;
+static pir_sensor_t pir_sensors[PIR_BANK_MAX_PINS];
+
+// function prototypes
+void benchmark_debounce(void);
+void test_pir_bank(void *pvParameters);
+
+void app_main(void) {
+    // error management
+    esp_err_t ret;
+
+    // cpu cost comparison first, before the bank task is running
+    benchmark_debounce();
+
+    // live bank on the hub pir pin
+    const gpio_num_t pins[] = { PIR_GPIO_PIN };
+    ret = pir_bank_init(&pir_bank, pins, sizeof(pins) / sizeof(pins[0]), PIR_DEBOUNCE_TIME_MS);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize pir bank");
+        return;
+    }
+
+    // create task
+    xTaskCreate(
+        test_pir_bank,
+        "test_pir_bank",
+        TASK_STACK_DEPTH,
+        NULL,
+        TASK_PRIORITY,
+        NULL
+    );
+}
+
+void benchmark_debounce(void) {
+    static const int pin_counts[] = { 1, 4, 8, 16, 32 };
+
+    // every per-pin instance reads the real pir pin so pir_read does its full work
+    for (int i = 0; i < PIR_BANK_MAX_PINS; i++) {
+        pir_init(&pir_sensors[i], PIR_GPIO_PIN, PIR_DEBOUNCE_TIME_MS);
+    }
+
+    for (size_t n = 0; n < sizeof(pin_counts) / sizeof(pin_counts[0]); n++) {
+        int pins = pin_counts[n];
+
+        // N separate pir_read calls per pass
+        esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+        for (int pass = 0; pass < BENCH_PASSES; pass++) {
+            for (int i = 0; i < pins; i++) {
+                pir_read(&pir_sensors[i]);
+            }
+        }
+        uint32_t per_pin_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_PASSES;
+
+        // one bit-parallel pass over the same number of pins (alternating noisy input)
+        pir_bank_t bank = {
+            .pin_mask = (pins == 32) ? UINT32_MAX : ((1UL << pins) - 1),
+            .cnt0 = UINT32_MAX,
+            .cnt1 = UINT32_MAX,
+        };
+        uint32_t toggles = 0;
+        start = esp_cpu_get_cycle_count();
+        for (int pass = 0; pass < BENCH_PASSES; pass++) {
+            toggles += __builtin_popcount(pir_bank_debounce(&bank, (pass & 4) ? UINT32_MAX : 0));
+        }
+        uint32_t bank_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_PASSES;
+
+        ESP_LOGI(TAG, "%2d pins: pir_read x%d = %lu cycles/pass, pir_bank_debounce = %lu cycles/pass (%lu toggles)",
+                 pins, pins, per_pin_cycles, bank_cycles, toggles);
+    }
+}
+
+void test_pir_bank(void *pvParameters) {
+    pir_bank_event_t event;
+
+    while (true) {
+        // block until the isr-driven debouncer accepts an edge
+        if (pir_bank_receive(&pir_bank, &event, portMAX_DELAY)) {
+            ESP_LOGI(TAG, "gpio %d %s at %lld us (motion count %lu)",
+                     event.pin, event.rising ? "HIGH" : "LOW", event.timestamp_us,
+                     pir_bank_get_motion_count(&pir_bank));
+        }
+    }
+
+    vTaskDelete(NULL);
+}
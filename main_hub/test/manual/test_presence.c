@@ -0,0 +1,166 @@
+/**
+ * @file test_presence.c
+ * @author Anthony Yalong
+ * @brief Presence engine test application - checks RPA resolution against
+ *        the Bluetooth Core sample data, then benchmarks resolution cost per
+ *        advert with 10 known IRKs: uncached strangers (worst case), first
+ *        advert of a known device, cached repeats and a mixed advert stream.
+ *        Does not touch the stored device table. Replace main/main.c with
+ *        this file.
+ */
+
+// imports
+#include <stdio.h>
+#include <string.h>
+#include "presence.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "mbedtls/aes.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define KNOWN_DEVICES 10
+#define STRANGERS 40                // other advertisers in range
+#define BENCH_ADVERTS 2000
+#define STREAM_ADVERTS 20000
+#define ROTATE_EVERY 2000           // stream adverts between address rotations
+#define TASK_STACK_DEPTH 4096
+#define TEST_PRIORITY 5
+
+// logging
+static const char *TAG = "test_presence";
+
+static presence_t presence;
+static presence_identity_t identities[KNOWN_DEVICES];
+
+// function prototypes
+void test_task(void *pvParameters);
+static bool test_vector(void);
+static void make_rpa(const uint8_t *irk, uint8_t *addr);
+static void report(const char *name, const presence_stats_t *before, uint32_t adverts);
+
+void app_main(void) {
+    xTaskCreate(test_task, "test_task", TASK_STACK_DEPTH, NULL, TEST_PRIORITY, NULL);
+}
+
+void test_task(void *pvParameters) {
+    static uint8_t stream_addrs[KNOWN_DEVICES + STRANGERS][6];
+    uint8_t stranger_irk[16];
+    uint8_t addr[6];
+    presence_stats_t before;
+
+    ESP_LOGI(TAG, "rpa sample data: %s", test_vector() ? "ok" : "FAIL");
+
+    // 10 known phones with random irks
+    presence_init(&presence, -75, -88, 120000, NULL, NULL);
+    for (int i = 0; i < KNOWN_DEVICES; i++) {
+        memset(&identities[i], 0, sizeof(identities[i]));
+        snprintf(identities[i].name, PRESENCE_NAME_LEN, "phone%d", i);
+        esp_fill_random(identities[i].irk, sizeof(identities[i].irk));
+        identities[i].has_irk = true;
+        presence_add_device(&presence, &identities[i]);
+    }
+    esp_fill_random(stranger_irk, sizeof(stranger_irk));
+
+    // worst case: every advert a new unknown rpa, every irk tried
+    presence_get_stats(&presence, &before);
+    for (int i = 0; i < BENCH_ADVERTS; i++) {
+        make_rpa(stranger_irk, addr);
+        presence_observe(&presence, true, addr, -70);
+    }
+    report("uncached stranger", &before, BENCH_ADVERTS);
+
+    // first advert of a known device after it rotated its address
+    presence_get_stats(&presence, &before);
+    for (int i = 0; i < BENCH_ADVERTS; i++) {
+        make_rpa(identities[i % KNOWN_DEVICES].irk, addr);
+        if (presence_observe(&presence, true, addr, -70) != i % KNOWN_DEVICES) {
+            ESP_LOGE(TAG, "phone%d not resolved", i % KNOWN_DEVICES);
+        }
+    }
+    report("uncached known", &before, BENCH_ADVERTS);
+
+    // repeats of the same address
+    presence_get_stats(&presence, &before);
+    for (int i = 0; i < BENCH_ADVERTS; i++) {
+        presence_observe(&presence, true, addr, -70);
+    }
+    report("cached", &before, BENCH_ADVERTS);
+
+    // mixed stream: known phones and strangers advertising, addresses rotating
+    for (int i = 0; i < KNOWN_DEVICES + STRANGERS; i++) {
+        make_rpa(i < KNOWN_DEVICES ? identities[i].irk : stranger_irk, stream_addrs[i]);
+    }
+    presence_get_stats(&presence, &before);
+    for (int i = 0; i < STREAM_ADVERTS; i++) {
+        int sender = esp_random() % (KNOWN_DEVICES + STRANGERS);
+        if (i % ROTATE_EVERY == 0) {
+            make_rpa(sender < KNOWN_DEVICES ? identities[sender].irk : stranger_irk, stream_addrs[sender]);
+        }
+        presence_observe(&presence, true, stream_addrs[sender], -70);
+    }
+    report("mixed stream", &before, STREAM_ADVERTS);
+
+    vTaskDelete(NULL);
+}
+
+static bool test_vector(void) {
+    // core spec vol 3 part h appendix d.7: irk ec0234a3 57c8ad05 341010a6 0a397d9b,
+    // prand 708194, hash 0dfbaa
+    static const uint8_t irk_be[16] = { 0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+                                        0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b };
+    uint8_t rpa[6] = { 0xaa, 0xfb, 0x0d, 0x94, 0x81, 0x70 };
+    presence_identity_t identity = { .name = "sample", .has_irk = true };
+
+    for (int i = 0; i < 16; i++) {
+        identity.irk[i] = irk_be[15 - i];
+    }
+    presence_init(&presence, -75, -88, 120000, NULL, NULL);
+    presence_add_device(&presence, &identity);
+
+    bool ok = presence_observe(&presence, true, rpa, -60) == 0;
+    rpa[0] ^= 0x01;
+    ok = ok && presence_observe(&presence, true, rpa, -60) == -1;
+    return ok;
+}
+
+static void make_rpa(const uint8_t *irk, uint8_t *addr) {
+    mbedtls_aes_context aes;
+    uint8_t key[16];
+    uint8_t block[16] = { 0 };
+    uint8_t out[16];
+
+    // random prand with the resolvable marker (top bits 01)
+    uint32_t prand = (esp_random() & 0x3FFFFF) | 0x400000;
+    addr[3] = prand & 0xFF;
+    addr[4] = (prand >> 8) & 0xFF;
+    addr[5] = (prand >> 16) & 0xFF;
+
+    for (int i = 0; i < 16; i++) {
+        key[i] = irk[15 - i];
+    }
+    block[13] = addr[5];
+    block[14] = addr[4];
+    block[15] = addr[3];
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, key, 128);
+    mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, block, out);
+    mbedtls_aes_free(&aes);
+
+    addr[0] = out[15];
+    addr[1] = out[14];
+    addr[2] = out[13];
+}
+
+static void report(const char *name, const presence_stats_t *before, uint32_t adverts) {
+    presence_stats_t after;
+    presence_get_stats(&presence, &after);
+
+    uint64_t cycles = (after.resolve_cycles - before->resolve_cycles) / adverts;
+    ESP_LOGI(TAG, "%-17s: %llu cycles/advert (%llu us), %.1f aes/advert, %.0f%% cache hits", name,
+             cycles, cycles / esp_rom_get_cpu_ticks_per_us(),
+             (float)(after.aes_ops - before->aes_ops) / adverts,
+             100.0f * (after.cache_hits - before->cache_hits) / adverts);
+}
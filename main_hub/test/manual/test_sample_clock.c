@@ -0,0 +1,134 @@
+/**
+ * @file test_sample_clock.c
+ * @author Anthony Yalong
+ * @brief Sampling clock test application - measures per-channel period
+ *        jitter of vTaskDelayUntil pacing and of the hardware-timer sample
+ *        clock under the same higher-priority interference, using
+ *        esp_timer trace timestamps. Replace main/main.c with this file.
+ */
+
+// imports
+#include "sample_clock.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "main_hub_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define TEST_DURATION_MS 30000      // run time per mode
+#define TEST_CHANNELS 3
+#define DISTURB_PERIOD_MS 70        // interfering task period
+#define DISTURB_MAX_BUSY_US 4000    // interfering task busy time (random up to)
+#define TASK_STACK_DEPTH 4096       // safe stack depth for testing
+#define SAMPLER_PRIORITY 4
+#define DISTURB_PRIORITY 6          // above every sampler
+#define CONTROL_PRIORITY 7
+
+// logging
+static const char *TAG = "test_sample_clock";
+
+// sampler channel description
+typedef struct {
+    const char *name;
+    uint32_t period_us;
+    uint32_t phase_us;
+    int channel;
+    sample_jitter_t jitter;         // used in tick-paced mode
+} sampler_t;
+
+static sampler_t samplers[TEST_CHANNELS] = {
+    { "pir", PIR_SAMPLE_PERIOD_US, PIR_SAMPLE_PHASE_US, 0, { 0 } },
+    { "ultrasonic", ULTRASONIC_SAMPLE_PERIOD_US, ULTRASONIC_SAMPLE_PHASE_US, 0, { 0 } },
+    { "dht11", DHT11_SAMPLE_PERIOD_US, DHT11_SAMPLE_PHASE_US, 0, { 0 } },
+};
+
+static sample_clock_t sample_clock;
+static volatile bool running;
+
+// function prototypes
+void control_task(void *pvParameters);
+void disturb_task(void *pvParameters);
+void tick_sampler_task(void *pvParameters);
+void clock_sampler_task(void *pvParameters);
+
+void app_main(void) {
+    xTaskCreate(control_task, "control_task", TASK_STACK_DEPTH, NULL, CONTROL_PRIORITY, NULL);
+}
+
+void control_task(void *pvParameters) {
+    TaskHandle_t handles[TEST_CHANNELS];
+
+    running = true;
+    xTaskCreate(disturb_task, "disturb_task", TASK_STACK_DEPTH, NULL, DISTURB_PRIORITY, NULL);
+
+    // mode 1: vTaskDelayUntil pacing
+    ESP_LOGI(TAG, "mode 1: vTaskDelayUntil for %d ms", TEST_DURATION_MS);
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        xTaskCreate(tick_sampler_task, samplers[i].name, TASK_STACK_DEPTH, &samplers[i],
+                    SAMPLER_PRIORITY, &handles[i]);
+    }
+    vTaskDelay(pdMS_TO_TICKS(TEST_DURATION_MS));
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        vTaskDelete(handles[i]);
+        sample_jitter_log(samplers[i].name, &samplers[i].jitter);
+    }
+
+    // mode 2: hardware-timer sample clock
+    ESP_LOGI(TAG, "mode 2: sample clock for %d ms", TEST_DURATION_MS);
+    if (sample_clock_init(&sample_clock) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize sample clock");
+        vTaskDelete(NULL);
+    }
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        xTaskCreate(clock_sampler_task, samplers[i].name, TASK_STACK_DEPTH, &samplers[i],
+                    SAMPLER_PRIORITY, &handles[i]);
+        sample_clock_add_channel(&sample_clock, handles[i], samplers[i].period_us,
+                                 samplers[i].phase_us, &samplers[i].channel);
+    }
+    sample_clock_start(&sample_clock);
+    vTaskDelay(pdMS_TO_TICKS(TEST_DURATION_MS));
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        vTaskDelete(handles[i]);
+        sample_jitter_log(samplers[i].name, sample_clock_get_jitter(&sample_clock, samplers[i].channel));
+    }
+
+    running = false;
+    ESP_LOGI(TAG, "test complete");
+    vTaskDelete(NULL);
+}
+
+void disturb_task(void *pvParameters) {
+    // higher-priority work that overruns at random points
+    while (running) {
+        esp_rom_delay_us(esp_random() % DISTURB_MAX_BUSY_US);
+        vTaskDelay(pdMS_TO_TICKS(DISTURB_PERIOD_MS));
+    }
+
+    vTaskDelete(NULL);
+}
+
+void tick_sampler_task(void *pvParameters) {
+    sampler_t *sampler = (sampler_t *)pvParameters;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(sampler->period_us / 1000));
+        sample_jitter_record(&sampler->jitter, esp_timer_get_time(), sampler->period_us);
+    }
+
+    vTaskDelete(NULL);
+}
+
+void clock_sampler_task(void *pvParameters) {
+    sampler_t *sampler = (sampler_t *)pvParameters;
+
+    // jitter is recorded inside sample_clock_wait
+    while (true) {
+        sample_clock_wait(&sample_clock, sampler->channel);
+    }
+
+    vTaskDelete(NULL);
+}
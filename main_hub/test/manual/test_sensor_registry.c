@@ -0,0 +1,199 @@
+/**
+ * @file test_sensor_registry.c
+ * @author Anthony Yalong
+ * @brief Sensor registry test application - cycles per sample through
+ *        sensor_registry_step() on drivers that do no i/o against the same
+ *        calls made directly, then the hub's pir, hc-sr04 and dht11 read
+ *        from one registry task on the sampling clock with per-channel
+ *        jitter, dispatch cost and stack use. Replace main/main.c with
+ *        this file.
+ */
+
+// imports
+#include "sensor.h"
+#include "sample_clock.h"
+#include "pir.h"
+#include "hcsr04.h"
+#include "dht11.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "main_hub_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define TEST_PASSES 10000           // dispatch passes (one pir period each)
+#define TEST_DURATION_MS 30000      // live run time
+#define TASK_STACK_DEPTH 4096       // safe stack depth for testing
+#define SENSOR_PRIORITY 5
+#define CONTROL_PRIORITY 7
+
+// logging
+static const char *TAG = "test_sensor_registry";
+
+// dispatch drivers - a counter as every value
+static esp_err_t null_start(void *sensor, uint32_t *wait_us);
+static esp_err_t null_poll(void *sensor, uint32_t *wait_us);
+static void null_get(const void *sensor, sensor_sample_t *sample);
+static const sensor_driver_t null_level_driver = {
+    .name = "null_level", .caps = SENSOR_CAP_LEVEL, .poll = null_poll, .get = null_get,
+};
+static const sensor_driver_t null_split_driver = {
+    .name = "null_split", .caps = SENSOR_CAP_TEMPERATURE | SENSOR_CAP_SPLIT,
+    .start = null_start, .poll = null_poll, .get = null_get,
+};
+
+static sample_clock_t sample_clock;
+static sensor_registry_t registry;
+static pir_sensor_t pir_sensor;
+static hcsr04_sensor_t ultrasonic_sensor;
+static dht11_sensor_t dht11_sensor;
+static uint32_t null_state[3];
+static volatile uint32_t sink;
+static uint32_t live_samples[3];
+static uint32_t live_errors[3];
+
+// function prototypes
+void control_task(void *pvParameters);
+static void dispatch_test(void);
+static void live_test(void);
+static void null_sink(const sensor_sample_t *sample, void *arg);
+static void live_sink(const sensor_sample_t *sample, void *arg);
+
+void app_main(void) {
+    xTaskCreate(control_task, "control_task", TASK_STACK_DEPTH, NULL, CONTROL_PRIORITY, NULL);
+}
+
+void control_task(void *pvParameters) {
+    dispatch_test();
+    live_test();
+
+    ESP_LOGI(TAG, "test complete");
+    vTaskDelete(NULL);
+}
+
+static void dispatch_test(void) {
+    const int every[3] = { 1, 2, 30 };     // pir, hc-sr04 and dht11 periods in pir periods
+    const sensor_driver_t *drivers[3] = { &null_level_driver, &null_level_driver, &null_split_driver };
+    uint32_t samples = 0;
+
+    // registry without a task, passes driven from here as the task would
+    sensor_registry_init(&registry, &sample_clock);
+    for (int i = 0; i < 3; i++) {
+        sensor_registry_add(&registry, drivers[i], &null_state[i], NULL, every[i] * PIR_SAMPLE_PERIOD_US, 0,
+                            null_sink, NULL);
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int pass = 0; pass < TEST_PASSES; pass++) {
+        int64_t now_us = (int64_t)pass * PIR_SAMPLE_PERIOD_US;
+        uint32_t due = 0;
+        for (int i = 0; i < 3; i++) {
+            due |= (pass % every[i] == 0) ? 1u << i : 0;
+        }
+        int64_t poll_us = sensor_registry_step(&registry, due, now_us);
+        if (poll_us != INT64_MAX) {
+            sensor_registry_step(&registry, 0, poll_us);
+        }
+    }
+    uint32_t registry_cycles = esp_cpu_get_cycle_count() - start;
+
+    // the same reads called directly, as the per-sensor tasks did
+    start = esp_cpu_get_cycle_count();
+    for (int pass = 0; pass < TEST_PASSES; pass++) {
+        for (int i = 0; i < 3; i++) {
+            if (pass % every[i] == 0) {
+                uint32_t wait_us = 0;
+                sensor_sample_t sample = { 0 };
+                if (drivers[i]->start != NULL) {
+                    drivers[i]->start(&null_state[i], &wait_us);
+                }
+                sample.status = drivers[i]->poll(&null_state[i], &wait_us);
+                drivers[i]->get(&null_state[i], &sample);
+                null_sink(&sample, NULL);
+                samples++;
+            }
+        }
+    }
+    uint32_t direct_cycles = esp_cpu_get_cycle_count() - start;
+
+    sensor_stats_t stats;
+    sensor_registry_get_stats(&registry, &stats);
+    ESP_LOGI(TAG, "dispatch: %lu samples (%lu direct), %lu wakes, %lu dispatches", stats.samples, samples,
+             stats.wakes, stats.dispatches);
+    ESP_LOGI(TAG, "cycles per sample: registry %lu, direct %lu, max registry share of a pass %lu",
+             registry_cycles / samples, direct_cycles / samples, stats.max_overhead_cycles);
+}
+
+static void live_test(void) {
+    static const int index[3] = { 0, 1, 2 };
+
+    // the hub's three sampled sensors on one task
+    if (sample_clock_init(&sample_clock) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize sample clock");
+        return;
+    }
+    sensor_registry_init(&registry, &sample_clock);
+    const pir_config_t pir_config = { PIR_GPIO_PIN, PIR_DEBOUNCE_TIME_MS, PIR_EPISODE_HOLD_TIME_MS };
+    const hcsr04_config_t hcsr04_config = { HCSR04_PIN_TRIG, HCSR04_PIN_ECHO, HCSR04_TIMEOUT_US };
+    const dht11_config_t dht11_config = { DHT11_GPIO_PIN };
+    if (sensor_registry_add(&registry, &pir_driver, &pir_sensor, &pir_config, PIR_SAMPLE_PERIOD_US,
+                            PIR_SAMPLE_PHASE_US, live_sink, (void *)&index[0]) != ESP_OK ||
+        sensor_registry_add(&registry, &hcsr04_driver, &ultrasonic_sensor, &hcsr04_config,
+                            ULTRASONIC_SAMPLE_PERIOD_US, ULTRASONIC_SAMPLE_PHASE_US, live_sink,
+                            (void *)&index[1]) != ESP_OK ||
+        sensor_registry_add(&registry, &dht11_driver, &dht11_sensor, &dht11_config, DHT11_SAMPLE_PERIOD_US,
+                            DHT11_SAMPLE_PHASE_US, live_sink, (void *)&index[2]) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize sensors");
+        return;
+    }
+    if (sensor_registry_start(&registry, SENSOR_PRIORITY) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start sensor task");
+        return;
+    }
+
+    ESP_LOGI(TAG, "live: %d ms", TEST_DURATION_MS);
+    sample_clock_start(&sample_clock);
+    vTaskDelay(pdMS_TO_TICKS(TEST_DURATION_MS));
+
+    for (int i = 0; i < registry.count; i++) {
+        const sensor_instance_t *instance = &registry.instances[i];
+        ESP_LOGI(TAG, "%s: %lu samples, %lu errors", instance->driver->name, live_samples[i], live_errors[i]);
+        sample_jitter_log(instance->driver->name, sample_clock_get_jitter(&sample_clock, instance->channel));
+    }
+    sensor_stats_t stats;
+    sensor_registry_get_stats(&registry, &stats);
+    ESP_LOGI(TAG, "%lu wakes, %lu busy skips, cycles: registry %llu per wake (max %lu), drivers %llu",
+             stats.wakes, stats.busy_skips,
+             stats.wakes ? (stats.pass_cycles - stats.driver_cycles - stats.callback_cycles) / stats.wakes : 0,
+             stats.max_overhead_cycles, stats.driver_cycles);
+    ESP_LOGI(TAG, "sensor task stack: %lu of %d bytes unused (three tasks used %d)",
+             (uint32_t)uxTaskGetStackHighWaterMark(registry.task), SENSOR_TASK_STACK, 3 * TASK_STACK_DEPTH);
+}
+
+static esp_err_t null_start(void *sensor, uint32_t *wait_us) {
+    *wait_us = DHT11_START_SIGNAL_LOW_MS * 1000;
+    return ESP_OK;
+}
+
+static esp_err_t null_poll(void *sensor, uint32_t *wait_us) {
+    (*(uint32_t *)sensor)++;
+    return ESP_OK;
+}
+
+static void null_get(const void *sensor, sensor_sample_t *sample) {
+    uint32_t count = *(const uint32_t *)sensor;
+    sample->level = count & 1;
+    sample->temperature = (float)(count % 40);
+}
+
+static void null_sink(const sensor_sample_t *sample, void *arg) {
+    sink += sample->level + (uint32_t)sample->temperature;
+}
+
+static void live_sink(const sensor_sample_t *sample, void *arg) {
+    int i = *(const int *)arg;
+    live_samples[i]++;
+    live_errors[i] += (sample->status != ESP_OK);
+}
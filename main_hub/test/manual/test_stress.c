@@ -0,0 +1,96 @@
+/**
+ * @file test_stress.c
+ * @author Anthony Yalong
+ * @brief Stress generator test application - drives a stand-in pipeline
+ *        (queue of 32, consumer spending a fixed 2 ms per event, so about
+ *        500 events/s) and checks the ramp finds its capacity: offered
+ *        rates are met, 400 events/s passes, 800 events/s overflows the
+ *        queue. The loaded pass adds cpu and flash-write load and must not
+ *        come out higher. Replace main/main.c with this file.
+ */
+
+// imports
+#include "stress.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+// test configuration
+#define CONSUMER_US 2000
+#define QUEUE_LEN 32
+#define EXPECTED_CAPACITY 400
+#define STEP_MS 10000               // 1 ms generator ticks
+#define TASK_STACK_DEPTH 4096
+#define CONSUMER_PRIORITY 4
+
+// logging
+static const char *TAG = "test_stress";
+
+static stress_t stress;
+static QueueHandle_t queue;
+
+// function prototypes
+void consumer_task(void *pvParameters);
+static void inject(stress_kind_t kind, uint32_t sequence, int64_t time_us, void *arg);
+
+void app_main(void) {
+    nvs_flash_init();
+    queue = xQueueCreate(QUEUE_LEN, sizeof(int64_t));
+    xTaskCreate(consumer_task, "consumer_task", TASK_STACK_DEPTH, NULL, CONSUMER_PRIORITY, NULL);
+
+    const stress_config_t config = {
+        .rates = { 50, 100, 200, 400, 800, 1600 },
+        .step_ms = STEP_MS,
+        .settle_ms = 1000,
+        .weights = { 1, 1, 1 },
+        .cpu_load_pct = 50,
+        .flash_writes_per_s = 2,
+        .slo_p99_us = 20000,
+        .slo_max_us = 100000,
+        .slo_max_drops = 0,
+        .slo_max_overruns = 0,
+        .inject = inject,
+    };
+    if (stress_start(&stress, &config) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to start stress run");
+        return;
+    }
+    while (!stress.done) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    // the generator kept its ticks (under 1% missed) up to the capacity
+    bool offered = true;
+    for (int i = 0; i < stress.step_count; i++) {
+        const stress_step_t *step = &stress.steps[i];
+        if (step->pass && step->generator_lag * 100 > STEP_MS) {
+            offered = false;
+        }
+    }
+    ESP_LOGI(TAG, "offered rates met: %s", offered ? "ok" : "FAIL");
+    ESP_LOGI(TAG, "quiet capacity %lu events/s (want %d): %s", stress.capacity[0], EXPECTED_CAPACITY,
+             (stress.capacity[0] == EXPECTED_CAPACITY) ? "ok" : "FAIL");
+    ESP_LOGI(TAG, "loaded capacity %lu events/s, not above quiet: %s", stress.capacity[1],
+             (stress.capacity[1] <= stress.capacity[0]) ? "ok" : "FAIL");
+}
+
+void consumer_task(void *pvParameters) {
+    int64_t time_us;
+
+    while (1) {
+        if (xQueueReceive(queue, &time_us, portMAX_DELAY) == pdTRUE) {
+            esp_rom_delay_us(CONSUMER_US);
+            stress_record_latency(&stress, esp_timer_get_time() - time_us);
+        }
+    }
+}
+
+static void inject(stress_kind_t kind, uint32_t sequence, int64_t time_us, void *arg) {
+    if (xQueueSend(queue, &time_us, 0) != pdTRUE) {
+        stress_record_drop(&stress);
+    }
+}
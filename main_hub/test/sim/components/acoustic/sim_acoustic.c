@@ -0,0 +1,15 @@
+/**
+ * @file sim_acoustic.c
+ * @author Anthony Yalong
+ * @brief Acoustic sensor stand-in - no microphone
+ */
+
+#include "acoustic.h"
+
+esp_err_t acoustic_sensor_init(acoustic_sensor_t *sensor, acoustic_event_cb_t callback, void *arg) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t acoustic_sensor_start(acoustic_sensor_t *sensor, gpio_num_t bclk, gpio_num_t ws, gpio_num_t din) {
+    return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,17 @@
+/**
+ * @file sim_adxl345.c
+ * @author Anthony Yalong
+ * @brief ADXL345 stand-in - no accelerometer
+ */
+
+#include "adxl345.h"
+
+esp_err_t adxl345_init(adxl345_sensor_t *sensor, uint32_t rms_threshold_mg, uint32_t peak_threshold_mg,
+                       adxl345_event_cb_t callback, void *arg) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t adxl345_start(adxl345_sensor_t *sensor, i2c_port_t i2c_port, uint8_t addr,
+                        gpio_num_t int_pin, uint8_t watermark) {
+    return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,17 @@
+/**
+ * @file sim_analog_sensor.c
+ * @author Anthony Yalong
+ * @brief Analog sensor stand-in - no adc front end
+ */
+
+#include "analog_sensor.h"
+
+esp_err_t analog_sensor_init(analog_sensor_t *engine, const analog_channel_config_t *channels,
+                             uint8_t count, uint32_t sample_freq_hz,
+                             analog_event_cb_t callback, void *arg) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t analog_sensor_start(analog_sensor_t *engine) {
+    return ESP_ERR_NOT_FOUND;
+}
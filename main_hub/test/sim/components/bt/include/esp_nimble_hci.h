@@ -0,0 +1,9 @@
+/**
+ * @file esp_nimble_hci.h
+ * @author Anthony Yalong
+ * @brief NimBLE hci stand-in - nothing below the host is simulated
+ */
+#ifndef ESP_NIMBLE_HCI_H
+#define ESP_NIMBLE_HCI_H
+
+#endif  // ESP_NIMBLE_HCI_H
@@ -0,0 +1,77 @@
+/**
+ * @file ble_gap.h
+ * @author Anthony Yalong
+ * @brief NimBLE gap stand-in - the types and calls the hub uses
+ */
+#ifndef BLE_GAP_H
+#define BLE_GAP_H
+
+// imports
+#include <stdint.h>
+
+#define BLE_ADDR_PUBLIC             0x00
+#define BLE_ADDR_RANDOM             0x01
+#define BLE_ADDR_PUBLIC_ID          0x02
+#define BLE_ADDR_RANDOM_ID          0x03
+#define BLE_OWN_ADDR_PUBLIC         0x00
+
+#define BLE_GAP_EVENT_CONNECT       0
+#define BLE_GAP_EVENT_DISCONNECT    1
+#define BLE_GAP_EVENT_DISC          7
+#define BLE_GAP_EVENT_DISC_COMPLETE 8
+
+typedef struct {
+    uint8_t type;
+    uint8_t val[6];
+} ble_addr_t;
+
+struct ble_gap_disc_params {
+    uint16_t itvl;
+    uint16_t window;
+    uint8_t filter_policy;
+    uint8_t limited : 1;
+    uint8_t passive : 1;
+    uint8_t filter_duplicates : 1;
+};
+
+struct ble_gap_disc_desc {
+    uint8_t event_type;
+    uint8_t length_data;
+    ble_addr_t addr;
+    int8_t rssi;
+    const uint8_t *data;
+};
+
+struct ble_gap_event {
+    uint8_t type;
+    union {
+        struct {
+            int status;
+            uint16_t conn_handle;
+        } connect;
+        struct {
+            int reason;
+        } disconnect;
+        struct ble_gap_disc_desc disc;
+        struct {
+            int reason;
+        } disc_complete;
+    };
+};
+
+typedef int ble_gap_event_fn(struct ble_gap_event *event, void *arg);
+
+/**
+ * @brief Start discovery - scenario phones are reported as adverts
+ *
+ * @param own_addr_type Own address type
+ * @param duration_ms Scan duration (BLE_HS_FOREVER)
+ * @param disc_params Scan parameters
+ * @param cb Gap event callback, also gets the remote node's connects
+ * @param cb_arg Callback argument
+ * @return int 0
+ */
+int ble_gap_disc(uint8_t own_addr_type, int32_t duration_ms, const struct ble_gap_disc_params *disc_params,
+                 ble_gap_event_fn *cb, void *cb_arg);
+
+#endif  // BLE_GAP_H
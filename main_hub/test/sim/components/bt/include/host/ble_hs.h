@@ -0,0 +1,26 @@
+/**
+ * @file ble_hs.h
+ * @author Anthony Yalong
+ * @brief NimBLE host stand-in
+ */
+#ifndef BLE_HS_H
+#define BLE_HS_H
+
+// imports
+#include <stdint.h>
+#include "host/ble_gap.h"
+
+#define BLE_HS_FOREVER              INT32_MAX
+#define BLE_HS_CONN_HANDLE_NONE     0xffff
+
+typedef void ble_hs_sync_fn(void);
+typedef void ble_hs_reset_fn(int reason);
+
+struct ble_hs_cfg {
+    ble_hs_sync_fn *sync_cb;
+    ble_hs_reset_fn *reset_cb;
+};
+
+extern struct ble_hs_cfg ble_hs_cfg;
+
+#endif  // BLE_HS_H
@@ -0,0 +1,31 @@
+/**
+ * @file nimble_port.h
+ * @author Anthony Yalong
+ * @brief NimBLE port stand-in
+ */
+#ifndef NIMBLE_PORT_H
+#define NIMBLE_PORT_H
+
+// imports
+#include "esp_err.h"
+
+/**
+ * @brief Initialize the host stand-in
+ *
+ * @return esp_err_t ESP_OK
+ */
+esp_err_t nimble_port_init(void);
+
+/**
+ * @brief Host event loop - reports sync, then blocks until deinit
+ */
+void nimble_port_run(void);
+
+/**
+ * @brief Stop the host event loop
+ *
+ * @return esp_err_t ESP_OK
+ */
+esp_err_t nimble_port_deinit(void);
+
+#endif  // NIMBLE_PORT_H
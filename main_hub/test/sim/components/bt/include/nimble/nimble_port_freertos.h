@@ -0,0 +1,25 @@
+/**
+ * @file nimble_port_freertos.h
+ * @author Anthony Yalong
+ * @brief NimBLE host task stand-in
+ */
+#ifndef NIMBLE_PORT_FREERTOS_H
+#define NIMBLE_PORT_FREERTOS_H
+
+// imports
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @brief Start the host task
+ *
+ * @param host_task_fn Host task, runs nimble_port_run()
+ */
+void nimble_port_freertos_init(TaskFunction_t host_task_fn);
+
+/**
+ * @brief End the host task (called from it)
+ */
+void nimble_port_freertos_deinit(void);
+
+#endif  // NIMBLE_PORT_FREERTOS_H
@@ -0,0 +1,14 @@
+/**
+ * @file ble_svc_gap.h
+ * @author Anthony Yalong
+ * @brief NimBLE gap service stand-in
+ */
+#ifndef BLE_SVC_GAP_H
+#define BLE_SVC_GAP_H
+
+/**
+ * @brief Register the gap service (no-op)
+ */
+void ble_svc_gap_init(void);
+
+#endif  // BLE_SVC_GAP_H
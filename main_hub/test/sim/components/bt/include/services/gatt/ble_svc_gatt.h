@@ -0,0 +1,14 @@
+/**
+ * @file ble_svc_gatt.h
+ * @author Anthony Yalong
+ * @brief NimBLE gatt service stand-in
+ */
+#ifndef BLE_SVC_GATT_H
+#define BLE_SVC_GATT_H
+
+/**
+ * @brief Register the gatt service (no-op)
+ */
+void ble_svc_gatt_init(void);
+
+#endif  // BLE_SVC_GATT_H
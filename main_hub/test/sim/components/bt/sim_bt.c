@@ -0,0 +1,145 @@
+/**
+ * @file sim_bt.c
+ * @author Anthony Yalong
+ * @brief NimBLE host stand-in - scenario phones arrive as discovery events,
+ *        the remote node's link as connect/disconnect events
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host/ble_hs.h"
+#include "nimble/nimble_port.h"
+#include "nimble/nimble_port_freertos.h"
+#include "services/gap/ble_svc_gap.h"
+#include "services/gatt/ble_svc_gatt.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_BT";
+
+#define SIM_BT_CONN_HANDLE      1
+
+struct ble_hs_cfg ble_hs_cfg;
+
+// host state
+static SemaphoreHandle_t stop_semaphore;
+static ble_gap_event_fn *gap_cb;
+static void *gap_cb_arg;
+static bool remote_motion;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Remote node stand-in - link changes reach the gap callback, motion
+ *        is logged (the hub has no gatt client to read it yet)
+ *
+ * @param action Remote action
+ * @param value Motion state
+ */
+static void sim_bt_remote(sim_remote_action_t action, bool value);
+
+/**
+ * @brief Phone advert - one discovery event while the scan runs
+ *
+ * @param addr Advertising address
+ * @param rssi Signal strength
+ */
+static void sim_bt_advert(const uint8_t *addr, int8_t rssi);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t nimble_port_init(void) {
+    stop_semaphore = xSemaphoreCreateBinary();
+    if (stop_semaphore == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim_set_ble(sim_bt_remote, sim_bt_advert);
+    return ESP_OK;
+}
+
+void nimble_port_run(void) {
+    // controller and host are up at once
+    if (ble_hs_cfg.sync_cb != NULL) {
+        ble_hs_cfg.sync_cb();
+    }
+    xSemaphoreTake(stop_semaphore, portMAX_DELAY);
+}
+
+esp_err_t nimble_port_deinit(void) {
+    sim_set_ble(NULL, NULL);
+    xSemaphoreGive(stop_semaphore);
+    return ESP_OK;
+}
+
+void nimble_port_freertos_init(TaskFunction_t host_task_fn) {
+    xTaskCreate(host_task_fn, "nimble_host", SIM_TASK_STACK, NULL, 4, NULL);
+}
+
+void nimble_port_freertos_deinit(void) {
+    vTaskDelete(NULL);
+}
+
+void ble_svc_gap_init(void) {
+}
+
+void ble_svc_gatt_init(void) {
+}
+
+int ble_gap_disc(uint8_t own_addr_type, int32_t duration_ms, const struct ble_gap_disc_params *disc_params,
+                 ble_gap_event_fn *cb, void *cb_arg) {
+    gap_cb_arg = cb_arg;
+    gap_cb = cb;
+    return 0;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void sim_bt_remote(sim_remote_action_t action, bool value) {
+    struct ble_gap_event event;
+
+    memset(&event, 0, sizeof(event));
+    switch (action) {
+        case SIM_REMOTE_CONNECT:
+            event.type = BLE_GAP_EVENT_CONNECT;
+            event.connect.status = 0;
+            event.connect.conn_handle = SIM_BT_CONN_HANDLE;
+            break;
+
+        case SIM_REMOTE_DISCONNECT:
+            event.type = BLE_GAP_EVENT_DISCONNECT;
+            event.disconnect.reason = 0x13;     // remote user terminated
+            break;
+
+        case SIM_REMOTE_MOTION:
+            remote_motion = value;
+            ESP_LOGI(TAG, "remote motion %d (not read by the hub yet)", remote_motion);
+            return;
+    }
+
+    // the hub takes link events on its scan callback
+    if (gap_cb == NULL) {
+        ESP_LOGW(TAG, "no gap callback registered, remote %s dropped",
+                 action == SIM_REMOTE_CONNECT ? "connect" : "disconnect");
+        return;
+    }
+    gap_cb(&event, gap_cb_arg);
+}
+
+static void sim_bt_advert(const uint8_t *addr, int8_t rssi) {
+    struct ble_gap_event event;
+
+    if (gap_cb == NULL) {
+        return;
+    }
+    memset(&event, 0, sizeof(event));
+    event.type = BLE_GAP_EVENT_DISC;
+    event.disc.addr.type = BLE_ADDR_PUBLIC;
+    memcpy(event.disc.addr.val, addr, sizeof(event.disc.addr.val));
+    event.disc.rssi = rssi;
+    gap_cb(&event, gap_cb_arg);
+}
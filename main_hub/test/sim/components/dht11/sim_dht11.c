@@ -0,0 +1,145 @@
+/**
+ * @file sim_dht11.c
+ * @author Anthony Yalong
+ * @brief DHT11 driver api over the simulated frame - same decoder, checks,
+ *        results and read time as the real driver
+ */
+
+#include "dht11.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sim.h"
+
+static const char *TAG = "DHT11";
+
+// 40 bits after the start signal, as long as the real read
+#define SIM_DHT11_FRAME_MS  5
+#define SIM_DHT11_ZERO_US   26          // high pulse of a 0 bit
+#define SIM_DHT11_ONE_US    70          // high pulse of a 1 bit
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t dht11_init(dht11_sensor_t *sensor, gpio_num_t pin) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "dht11 sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // initialize state
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->pin = pin;
+    sensor->failed_bit = -1;
+
+    ESP_LOGI(TAG, "successfully initialized dht11 sensor");
+    return ESP_OK;
+}
+
+esp_err_t dht11_read(dht11_sensor_t *sensor) {
+    // error management
+    esp_err_t ret;
+
+    ret = dht11_start(sensor);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return dht11_finish(sensor);
+}
+
+esp_err_t dht11_start(dht11_sensor_t *sensor) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "dht11 sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // check last read time - enforce minimum interval
+    int64_t cur_time = esp_timer_get_time();
+    if ((cur_time - sensor->last_read_time_us) < (DHT11_MIN_READ_INTERVAL_MS * 1000)) {
+        ESP_LOGW(TAG, "read too soon, minimum interval is %d ms", DHT11_MIN_READ_INTERVAL_MS);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sensor->start_time_us = cur_time;
+    return ESP_OK;
+}
+
+esp_err_t dht11_finish(dht11_sensor_t *sensor) {
+    // error management
+    esp_err_t ret;
+
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "dht11 sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sensor->start_time_us == 0) {
+        ESP_LOGE(TAG, "no read started");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // rest of the start signal, then the frame
+    int64_t remaining = sensor->start_time_us + DHT11_START_SIGNAL_LOW_MS * 1000 - esp_timer_get_time();
+    sensor->start_time_us = 0;
+    TickType_t ticks = pdMS_TO_TICKS(SIM_DHT11_FRAME_MS) + ((remaining > 0) ? pdMS_TO_TICKS(remaining / 1000) : 0);
+    vTaskDelay(ticks);
+
+    uint8_t data[5] = {0};
+    ret = sim_dht11_frame(data);
+    if (ret != ESP_OK) {
+        sensor->failed_bit = 0;
+        ESP_LOGW(TAG, "timeout reading data bit %d", sensor->failed_bit);
+        return ret;
+    }
+    sensor->failed_bit = -1;
+
+    // the frame as the sensor sends it, through the real decoder
+    uint8_t pulse_us[DHT11_FRAME_BITS];
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        pulse_us[i] = (data[i / 8] & (1 << (7 - (i % 8)))) ? SIM_DHT11_ONE_US : SIM_DHT11_ZERO_US;
+    }
+    ret = dht11_decode(pulse_us, data);
+    if (ret != ESP_OK) {
+        uint8_t checksum = data[0] + data[1] + data[2] + data[3];
+        ESP_LOGW(TAG, "checksum mismatch: calculated 0x%02X, received 0x%02X", checksum, data[4]);
+        return ret;
+    }
+
+    // extract values
+    sensor->last_humidity = data[0];
+    sensor->last_temperature = data[2];
+    sensor->last_read_time_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+float dht11_get_temperature(const dht11_sensor_t *sensor) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "dht11 sensor pointer is null");
+        return 0.0;
+    }
+    return sensor->last_temperature;
+}
+
+float dht11_get_humidity(const dht11_sensor_t *sensor) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "dht11 sensor pointer is null");
+        return 0.0;
+    }
+    return sensor->last_humidity;
+}
+
+void dht11_get_timing(const dht11_sensor_t *sensor, dht11_timing_t *timing) {
+    if (sensor == NULL || timing == NULL) {
+        return;
+    }
+    memset(timing, 0, sizeof(*timing));
+}
+
+void dht11_reset_timing(dht11_sensor_t *sensor) {
+}
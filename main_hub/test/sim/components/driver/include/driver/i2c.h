@@ -0,0 +1,83 @@
+/**
+ * @file i2c.h
+ * @author Anthony Yalong
+ * @brief Simulated legacy I2C master driver - command links are executed
+ *        against the simulated devices (the LCD backpack), other
+ *        addresses do not acknowledge
+ */
+#ifndef SIM_DRIVER_I2C_H
+#define SIM_DRIVER_I2C_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+#define I2C_MASTER_WRITE    0
+#define I2C_MASTER_READ     1
+#define I2C_CMD_MAX_BYTES   32
+
+typedef enum {
+    I2C_NUM_0 = 0,
+    I2C_NUM_1,
+    I2C_NUM_MAX,
+} i2c_port_t;
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER,
+} i2c_mode_t;
+
+typedef struct {
+    i2c_mode_t mode;
+    int sda_io_num;
+    int scl_io_num;
+    bool sda_pullup_en;
+    bool scl_pullup_en;
+    union {
+        struct {
+            uint32_t clk_speed;
+        } master;
+        struct {
+            uint8_t addr_10bit_en;
+            uint16_t slave_addr;
+        } slave;
+    };
+    uint32_t clk_flags;
+} i2c_config_t;
+
+/**
+ * @brief Command link - the bytes of one write transaction
+ */
+typedef struct {
+    uint8_t data[I2C_CMD_MAX_BYTES];
+    size_t length;
+} i2c_cmd_link_t;
+
+typedef i2c_cmd_link_t *i2c_cmd_handle_t;
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags);
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t length, bool ack_en);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+
+/**
+ * @brief Run a command link on the simulated bus
+ *
+ * @param port Port
+ * @param cmd Command link
+ * @param ticks_to_wait Bus timeout (unused, the bus is never busy)
+ * @return esp_err_t ESP_OK, ESP_FAIL if no device acknowledged,
+ *                   ESP_ERR_INVALID_STATE before i2c_driver_install
+ */
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks_to_wait);
+
+#endif  // SIM_DRIVER_I2C_H
@@ -0,0 +1,11 @@
+/**
+ * @file i2s_std.h
+ * @author Anthony Yalong
+ * @brief I2S types for the acoustic sensor header (no microphone is simulated)
+ */
+#ifndef SIM_DRIVER_I2S_STD_H
+#define SIM_DRIVER_I2S_STD_H
+
+typedef struct i2s_channel_obj_t *i2s_chan_handle_t;
+
+#endif  // SIM_DRIVER_I2S_STD_H
@@ -0,0 +1,20 @@
+/**
+ * @file adc_continuous.h
+ * @author Anthony Yalong
+ * @brief Continuous ADC types for the analog sensor header (no adc is
+ *        simulated)
+ */
+#ifndef SIM_ESP_ADC_CONTINUOUS_H
+#define SIM_ESP_ADC_CONTINUOUS_H
+
+// imports
+#include "hal/adc_types.h"
+
+// adc1 channel count the analog sensor header sizes its map with
+#ifndef SOC_ADC_CHANNEL_NUM
+#define SOC_ADC_CHANNEL_NUM(unit)   10
+#endif
+
+typedef struct adc_continuous_ctx_t *adc_continuous_handle_t;
+
+#endif  // SIM_ESP_ADC_CONTINUOUS_H
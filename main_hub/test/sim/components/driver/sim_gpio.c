@@ -0,0 +1,57 @@
+/**
+ * @file sim_gpio.c
+ * @author Anthony Yalong
+ * @brief Simulated GPIO driver implementation
+ */
+
+#include "driver/gpio.h"
+#include <stdbool.h>
+#include "esp_log.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_GPIO";
+
+// pin state: direction and driven output level
+static bool outputs[GPIO_NUM_MAX];
+static uint8_t levels[GPIO_NUM_MAX];
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t gpio_config(const gpio_config_t *config) {
+    // sanity check
+    if (config == NULL || config->pin_bit_mask == 0 || (config->pin_bit_mask >> GPIO_NUM_MAX) != 0) {
+        ESP_LOGE(TAG, "invalid pin mask");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (config->pin_bit_mask & (1ULL << pin)) {
+            outputs[pin] = (config->mode & GPIO_MODE_OUTPUT) != 0;
+        }
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return 0;
+    }
+    return outputs[gpio_num] ? levels[gpio_num] : sim_gpio_input(gpio_num);
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    levels[gpio_num] = (level != 0);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    outputs[gpio_num] = (mode & GPIO_MODE_OUTPUT) != 0;
+    return ESP_OK;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file sim_gptimer.c
+ * @author Anthony Yalong
+ * @brief Simulated general-purpose timer implementation
+ */
+
+#include "driver/gptimer.h"
+#include <stdlib.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_GPTIMER";
+
+/**
+ * @brief Timer state
+ */
+struct gptimer_t {
+    uint32_t resolution_hz;
+    gptimer_alarm_cb_t on_alarm;
+    void *user_ctx;
+    bool enabled;
+    bool running;
+    int64_t start_us;               // virtual time of count 0
+    uint64_t alarm_count;
+    bool alarm_armed;
+    TaskHandle_t task;
+};
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Current count
+ *
+ * @param timer Timer
+ * @return uint64_t Count at the timer resolution
+ */
+static uint64_t sim_gptimer_count(gptimer_handle_t timer);
+
+/**
+ * @brief Alarm task - raises the alarm callback when the count reaches the
+ *        alarm, in place of the timer isr
+ *
+ * @param pvParameters Timer
+ */
+static void sim_gptimer_task(void *pvParameters);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t gptimer_new_timer(const gptimer_config_t *config, gptimer_handle_t *ret_timer) {
+    // sanity check
+    if (config == NULL || ret_timer == NULL || config->resolution_hz == 0 || config->direction != GPTIMER_COUNT_UP) {
+        ESP_LOGE(TAG, "only up-counting timers are simulated");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gptimer_handle_t timer = calloc(1, sizeof(struct gptimer_t));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->resolution_hz = config->resolution_hz;
+    if (xTaskCreate(sim_gptimer_task, "sim_gptimer", SIM_TASK_STACK, timer, SIM_TASK_PRIORITY, &timer->task) !=
+        pdPASS) {
+        free(timer);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *ret_timer = timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t *cbs,
+                                           void *user_data) {
+    if (timer == NULL || cbs == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->on_alarm = cbs->on_alarm;
+    timer->user_ctx = user_data;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t *config) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    timer->alarm_armed = (config != NULL);
+    timer->alarm_count = (config != NULL) ? config->alarm_count : 0;
+    xTaskNotifyGive(timer->task);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->enabled || timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->start_us = sim_now_us();
+    timer->running = true;
+    xTaskNotifyGive(timer->task);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer) {
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->running = false;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_get_raw_count(gptimer_handle_t timer, uint64_t *value) {
+    if (timer == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *value = sim_gptimer_count(timer);
+    return ESP_OK;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static uint64_t sim_gptimer_count(gptimer_handle_t timer) {
+    return (uint64_t)(sim_now_us() - timer->start_us) * timer->resolution_hz / 1000000;
+}
+
+static void sim_gptimer_task(void *pvParameters) {
+    gptimer_handle_t timer = (gptimer_handle_t)pvParameters;
+
+    while (1) {
+        if (!timer->running || !timer->alarm_armed || timer->on_alarm == NULL) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        int64_t due_us = timer->start_us + (int64_t)(timer->alarm_count * 1000000 / timer->resolution_hz);
+        TickType_t ticks = sim_ticks_until(due_us);
+        if (ticks > 0) {
+            ulTaskNotifyTake(pdTRUE, ticks);
+            continue;
+        }
+
+        // one alarm per set_alarm_action, the callback usually arms the next
+        timer->alarm_armed = false;
+        gptimer_alarm_event_data_t edata = {
+            .count_value = sim_gptimer_count(timer),
+            .alarm_value = timer->alarm_count,
+        };
+        if (timer->on_alarm(timer, &edata, timer->user_ctx)) {
+            taskYIELD();
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file sim_i2c.c
+ * @author Anthony Yalong
+ * @brief Simulated I2C master implementation
+ */
+
+#include "driver/i2c.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_I2C";
+
+static bool installed[I2C_NUM_MAX];
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config) {
+    if (port < 0 || port >= I2C_NUM_MAX || config == NULL || config->mode != I2C_MODE_MASTER) {
+        ESP_LOGE(TAG, "only master ports are simulated");
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags) {
+    if (port < 0 || port >= I2C_NUM_MAX || mode != I2C_MODE_MASTER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (installed[port]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    installed[port] = true;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    i2c_cmd_handle_t cmd = calloc(1, sizeof(i2c_cmd_link_t));
+    if (cmd != NULL) {
+        sim_fault_i2c_link(1);
+    }
+    return cmd;
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd) {
+    if (cmd != NULL) {
+        sim_fault_i2c_link(-1);
+    }
+    free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+    if (cmd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cmd->length = 0;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en) {
+    return i2c_master_write(cmd, &data, 1, ack_en);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t length, bool ack_en) {
+    if (cmd == NULL || data == NULL || cmd->length + length > I2C_CMD_MAX_BYTES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(&cmd->data[cmd->length], data, length);
+    cmd->length += length;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+    return (cmd != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks_to_wait) {
+    if (port < 0 || port >= I2C_NUM_MAX || cmd == NULL || cmd->length == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!installed[port]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // the backpack is the only device on the bus, anything else is a nack
+    uint8_t address = cmd->data[0] >> 1;
+    if (address != SIM_LCD_ADDR || (cmd->data[0] & 1) == I2C_MASTER_READ) {
+        return ESP_FAIL;
+    }
+
+    // a hung bus holds the caller for the whole timeout
+    if (sim_fault_inject(SIM_FAULT_I2C_HANG)) {
+        vTaskDelay(ticks_to_wait);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (sim_fault_inject(SIM_FAULT_I2C_NACK)) {
+        return ESP_FAIL;
+    }
+    sim_fault_ok(SIM_FAULT_I2C_HANG);
+    sim_fault_ok(SIM_FAULT_I2C_NACK);
+
+    sim_lcd_write(&cmd->data[1], cmd->length - 1);
+    return ESP_OK;
+}
@@ -0,0 +1,23 @@
+/**
+ * @file sim_ds18b20.c
+ * @author Anthony Yalong
+ * @brief DS18B20 stand-in - an empty bus
+ */
+
+#include "ds18b20.h"
+
+esp_err_t ds18b20_init(ds18b20_bus_t *sensors, gpio_num_t pin) {
+    if (sensors == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sensors->count = 0;
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ds18b20_set_resolution(ds18b20_bus_t *sensors, uint8_t bits) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ds18b20_acquire(ds18b20_bus_t *sensors) {
+    return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file sim_httpd.c
+ * @author Anthony Yalong
+ * @brief HTTP server stand-in - no requests reach the handlers
+ */
+
+#include "esp_http_server.h"
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file esp_netif.h
+ * @author Anthony Yalong
+ * @brief Network interface stand-in - every call fails with
+ *        ESP_ERR_NOT_SUPPORTED
+ */
+#ifndef ESP_NETIF_H
+#define ESP_NETIF_H
+
+// imports
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef enum {
+    IP_EVENT_STA_GOT_IP = 0,
+} ip_event_t;
+
+typedef struct {
+    uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct {
+    esp_netif_ip_info_t ip_info;
+} ip_event_got_ip_t;
+
+typedef struct esp_netif_obj esp_netif_t;
+
+#define IPSTR           "%d.%d.%d.%d"
+#define esp_ip4_addr_get_byte(ipaddr, idx)  (((const uint8_t *)(&(ipaddr)->addr))[idx])
+#define IP2STR(ipaddr)  esp_ip4_addr_get_byte(ipaddr, 0), esp_ip4_addr_get_byte(ipaddr, 1), \
+                        esp_ip4_addr_get_byte(ipaddr, 2), esp_ip4_addr_get_byte(ipaddr, 3)
+
+esp_err_t esp_netif_init(void);
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+
+#endif  // ESP_NETIF_H
@@ -0,0 +1,20 @@
+/**
+ * @file esp_netif_sntp.h
+ * @author Anthony Yalong
+ * @brief SNTP stand-in - the simulated wall clock comes from the scenario
+ */
+#ifndef ESP_NETIF_SNTP_H
+#define ESP_NETIF_SNTP_H
+
+// imports
+#include "esp_err.h"
+
+typedef struct {
+    const char *servers[1];
+} esp_sntp_config_t;
+
+#define ESP_NETIF_SNTP_DEFAULT_CONFIG(server)   { .servers = { server } }
+
+esp_err_t esp_netif_sntp_init(const esp_sntp_config_t *config);
+
+#endif  // ESP_NETIF_SNTP_H
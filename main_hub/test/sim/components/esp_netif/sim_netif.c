@@ -0,0 +1,23 @@
+/**
+ * @file sim_netif.c
+ * @author Anthony Yalong
+ * @brief Network interface stand-in - no ip stack
+ */
+
+#include <stddef.h>
+#include "esp_netif.h"
+#include "esp_netif_sntp.h"
+
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+esp_err_t esp_netif_init(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void) {
+    return NULL;
+}
+
+esp_err_t esp_netif_sntp_init(const esp_sntp_config_t *config) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file esp_cpu.h
+ * @author Anthony Yalong
+ * @brief Cycle counter for the simulator - host nanoseconds stand in for
+ *        cpu cycles
+ */
+#ifndef ESP_CPU_H
+#define ESP_CPU_H
+
+// imports
+#include <stdint.h>
+#include <time.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+/**
+ * @brief Free running cycle counter (host nanoseconds, wraps like the ccount register)
+ *
+ * @return esp_cpu_cycle_count_t Count
+ */
+static inline esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (esp_cpu_cycle_count_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+#endif  // ESP_CPU_H
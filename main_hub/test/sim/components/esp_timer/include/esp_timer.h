@@ -0,0 +1,85 @@
+/**
+ * @file esp_timer.h
+ * @author Anthony Yalong
+ * @brief High resolution timer api on the simulator's virtual clock - the
+ *        subset the hub uses
+ */
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// configuration
+#define ESP_TIMER_SIM_MAX       16          // timers alive at once
+
+typedef struct esp_timer *esp_timer_handle_t;
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;   // callbacks always run in the dispatcher task
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+/**
+ * @brief Virtual time since boot
+ *
+ * @return int64_t Microseconds
+ */
+int64_t esp_timer_get_time(void);
+
+/**
+ * @brief Create a timer
+ *
+ * @param create_args Callback and name
+ * @param out_handle Output timer
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM when all timers are in use
+ */
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+
+/**
+ * @brief Start a periodic timer
+ *
+ * @param timer Timer
+ * @param period Period in microseconds
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+
+/**
+ * @brief Start a one-shot timer
+ *
+ * @param timer Timer
+ * @param timeout_us Timeout in microseconds
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+
+/**
+ * @brief Stop a timer
+ *
+ * @param timer Timer
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+/**
+ * @brief Delete a stopped timer
+ *
+ * @param timer Timer
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_STATE if still running
+ */
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+#endif  // ESP_TIMER_H
@@ -0,0 +1,203 @@
+/**
+ * @file sim_esp_timer.c
+ * @author Anthony Yalong
+ * @brief esp_timer on the virtual clock - one dispatcher task runs every
+ *        callback, like the esp_timer task
+ */
+
+#include "esp_timer.h"
+#include <stddef.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_ESP_TIMER";
+
+// dispatcher just below the simulator tasks, above every hub task
+#define SIM_ESP_TIMER_PRIORITY  (configMAX_PRIORITIES - 2)
+
+/**
+ * @brief Timer state
+ */
+struct esp_timer {
+    esp_timer_create_args_t args;
+    bool in_use;
+    bool running;
+    int64_t due_us;
+    uint64_t period_us;        // 0 for one-shot
+};
+
+static portMUX_TYPE timer_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct esp_timer timers[ESP_TIMER_SIM_MAX];
+static TaskHandle_t dispatcher;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Arm a timer and wake the dispatcher
+ *
+ * @param timer Timer
+ * @param timeout_us First expiry from now
+ * @param period_us Period, 0 for one-shot
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if running
+ */
+static esp_err_t sim_esp_timer_arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us);
+
+/**
+ * @brief Dispatcher task - runs expired callbacks in expiry order
+ *
+ * @param pvParameters Unused
+ */
+static void sim_esp_timer_task(void *pvParameters);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+int64_t esp_timer_get_time(void) {
+    // uptime, internally the timers run on virtual time
+    return SIM_UPTIME_START_US + sim_now_us();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    // sanity check
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // dispatcher starts with the first timer
+    if (dispatcher == NULL &&
+        xTaskCreate(sim_esp_timer_task, "esp_timer", SIM_TASK_STACK, NULL, SIM_ESP_TIMER_PRIORITY, &dispatcher) !=
+            pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_timer_handle_t timer = NULL;
+    portENTER_CRITICAL(&timer_lock);
+    for (int i = 0; i < ESP_TIMER_SIM_MAX && timer == NULL; i++) {
+        if (!timers[i].in_use) {
+            timer = &timers[i];
+            timer->args = *create_args;
+            timer->in_use = true;
+            timer->running = false;
+        }
+    }
+    portEXIT_CRITICAL(&timer_lock);
+
+    if (timer == NULL) {
+        ESP_LOGE(TAG, "more than %d timers", ESP_TIMER_SIM_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    return sim_esp_timer_arm(timer, period, period);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return sim_esp_timer_arm(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    // error management
+    esp_err_t ret = ESP_OK;
+
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&timer_lock);
+    if (timer->running) {
+        timer->running = false;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    // error management
+    esp_err_t ret = ESP_OK;
+
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&timer_lock);
+    if (timer->running) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        timer->in_use = false;
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    return ret;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t sim_esp_timer_arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+    // error management
+    esp_err_t ret = ESP_OK;
+
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t now = sim_now_us();
+
+    portENTER_CRITICAL(&timer_lock);
+    if (timer->running) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        timer->due_us = now + (int64_t)timeout_us;
+        timer->period_us = period_us;
+        timer->running = true;
+    }
+    portEXIT_CRITICAL(&timer_lock);
+
+    if (ret == ESP_OK) {
+        xTaskNotifyGive(dispatcher);
+    }
+    return ret;
+}
+
+static void sim_esp_timer_task(void *pvParameters) {
+    while (1) {
+        int64_t now = sim_now_us();
+        esp_timer_cb_t callback = NULL;
+        void *arg = NULL;
+        int64_t next_us = INT64_MAX;
+
+        // earliest running timer, rescheduled before its callback runs
+        portENTER_CRITICAL(&timer_lock);
+        struct esp_timer *earliest = NULL;
+        for (int i = 0; i < ESP_TIMER_SIM_MAX; i++) {
+            if (timers[i].in_use && timers[i].running && (earliest == NULL || timers[i].due_us < earliest->due_us)) {
+                earliest = &timers[i];
+            }
+        }
+        if (earliest != NULL && earliest->due_us <= now) {
+            callback = earliest->args.callback;
+            arg = earliest->args.arg;
+            if (earliest->period_us == 0) {
+                earliest->running = false;
+            } else {
+                earliest->due_us += earliest->period_us;
+                if (earliest->args.skip_unhandled_events && earliest->due_us <= now) {
+                    earliest->due_us = now + earliest->period_us;
+                }
+            }
+        } else if (earliest != NULL) {
+            next_us = earliest->due_us;
+        }
+        portEXIT_CRITICAL(&timer_lock);
+
+        if (callback != NULL) {
+            callback(arg);
+            continue;
+        }
+        ulTaskNotifyTake(pdTRUE, (next_us == INT64_MAX) ? portMAX_DELAY : sim_ticks_until(next_us));
+    }
+}
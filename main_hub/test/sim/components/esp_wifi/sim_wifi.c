@@ -0,0 +1,29 @@
+/**
+ * @file sim_wifi.c
+ * @author Anthony Yalong
+ * @brief Wifi stand-in - no radio
+ */
+
+#include "esp_wifi.h"
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_wifi_start(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_wifi_connect(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
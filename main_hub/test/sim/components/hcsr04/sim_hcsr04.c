@@ -0,0 +1,85 @@
+/**
+ * @file sim_hcsr04.c
+ * @author Anthony Yalong
+ * @brief HC-SR04 driver api over the simulated echo - same results, state
+ *        and pulse time as the real driver
+ */
+
+#include "hcsr04.h"
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sim.h"
+
+static const char *TAG = "HCSR04";
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t hcsr04_init(hcsr04_sensor_t *sensor, gpio_num_t trig_pin, gpio_num_t echo_pin, uint32_t timeout) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "hcsr04 sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // intialize state
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->trig_pin = trig_pin;
+    sensor->echo_pin = echo_pin;
+    sensor->timeout_us = timeout;
+
+    ESP_LOGI(TAG, "successfully initialized hcsr04 sensor");
+    return ESP_OK;
+}
+
+esp_err_t hcsr04_read_distance(hcsr04_sensor_t *sensor) {
+    // error management
+    esp_err_t ret;
+    int64_t pulse_width;
+
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGE(TAG, "hcsr04 sensor pointer is null");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ret = sim_hcsr04_echo(&pulse_width);
+    if (ret != ESP_OK || pulse_width > sensor->timeout_us) {
+        // the real driver gives up after timeout_us of echo high
+        vTaskDelay(pdMS_TO_TICKS(sensor->timeout_us / 1000));
+        ESP_LOGW(TAG, "timeout waiting for ECHO LOW");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // the caller is busy for the echo, like the polling loop
+    if (pdMS_TO_TICKS(pulse_width / 1000) > 0) {
+        vTaskDelay(pdMS_TO_TICKS(pulse_width / 1000));
+    }
+
+    sensor->last_pulse_us = pulse_width;
+    sensor->last_distance_cm = hcsr04_pulse_to_cm(pulse_width);
+
+    ESP_LOGI(TAG, "successfully read distance of hcsr04 sensor: %0.02f", sensor->last_distance_cm);
+    return ESP_OK;
+}
+
+float hcsr04_get_last_distance(const hcsr04_sensor_t *sensor) {
+    // sanity check
+    if (sensor == NULL) {
+        ESP_LOGW(TAG, "hcsr04 pointer is null");
+        return 0.0;
+    }
+    return sensor->last_distance_cm;
+}
+
+void hcsr04_get_timing(const hcsr04_sensor_t *sensor, hcsr04_timing_t *timing) {
+    if (sensor == NULL || timing == NULL) {
+        return;
+    }
+    memset(timing, 0, sizeof(*timing));
+}
+
+void hcsr04_reset_timing(hcsr04_sensor_t *sensor) {
+}
@@ -0,0 +1,37 @@
+/**
+ * @file sim_keypad.c
+ * @author Anthony Yalong
+ * @brief Keypad stand-in - no matrix attached
+ */
+
+#include "keypad.h"
+#include "keypad_pin.h"
+
+esp_err_t keypad_init(keypad_t *keypad, const gpio_num_t *rows, uint8_t row_count,
+                      const gpio_num_t *cols, uint8_t col_count, const char *keymap) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+bool keypad_receive(keypad_t *keypad, keypad_event_t *event, TickType_t timeout) {
+    vTaskDelay(timeout);
+    return false;
+}
+
+esp_err_t keypad_pin_set(const char *pin) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool keypad_pin_is_set(void) {
+    return false;
+}
+
+esp_err_t keypad_pin_verify(const char *pin, bool *match) {
+    if (match != NULL) {
+        *match = false;
+    }
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t keypad_pin_change(const char *current, const char *pin, bool *match) {
+    return keypad_pin_verify(current, match);
+}
@@ -0,0 +1,262 @@
+/**
+ * @file sim.h
+ * @author Anthony Yalong
+ * @brief Hub simulator core - virtual clock, scenario runner, simulated
+ *        devices and the terminal LCD
+ */
+#ifndef SIM_H
+#define SIM_H
+
+// imports
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// configuration
+#define SIM_EPOCH_DEFAULT       1736150400      // 2025-01-06 08:00 UTC, a monday morning
+#define SIM_MAX_ACTIONS         4096
+#define SIM_MAX_EXPECTS         64
+#define SIM_EXPECT_LABEL_LEN    24              // `as <label>`, the benchmark metric name
+#define SIM_MAX_PHONES          4
+#define SIM_PHONE_NAME_LEN      16
+#define SIM_LCD_ADDR            0x27            // pcf8574 backpack, LCD_ADDR in main_hub_system_config.h
+#define SIM_LCD_COLUMNS         16
+#define SIM_LCD_ROWS            2
+#define SIM_LCD_SETTLE_MS       50              // display unchanged this long = a finished frame
+#define SIM_ADVERT_PERIOD_MS    1000            // phone advert interval seen by the scan, link fault check
+#define SIM_TASK_PRIORITY       (configMAX_PRIORITIES - 1)  // scenario and timer tasks, above every hub task
+#define SIM_TASK_STACK          4096
+#define SIM_MAX_FAULTS          16
+#define SIM_FAULT_SETTLE_MS     10000           // after a fault window, before the leak check
+#define SIM_SOAK_MAX_SAMPLES    2048            // 30 days of hourly samples is 720
+#define SIM_SOAK_MAX_QUEUES     8
+#define SIM_SOAK_DRIFT_PCT      10              // last vs first quarter of a soak, relative change flagged
+#define SIM_UPTIME_START_US     ((int64_t)(TickType_t)configINITIAL_TICK_COUNT * portTICK_PERIOD_MS * 1000)  // esp_timer at boot
+
+/**
+ * @brief Remote node actions, delivered at the NimBLE gap boundary
+ */
+typedef enum {
+    SIM_REMOTE_CONNECT = 0,
+    SIM_REMOTE_DISCONNECT,
+    SIM_REMOTE_MOTION,
+} sim_remote_action_t;
+
+/**
+ * @brief Remote node stand-in - installed by the bt stand-in
+ *
+ * @param action What the remote node did
+ * @param value Motion state for SIM_REMOTE_MOTION
+ */
+typedef void (*sim_remote_cb_t)(sim_remote_action_t action, bool value);
+
+/**
+ * @brief Phone advert stand-in - installed by the bt stand-in
+ *
+ * @param addr Advertising address (NimBLE byte order)
+ * @param rssi Received signal strength (dBm)
+ */
+typedef void (*sim_advert_cb_t)(const uint8_t *addr, int8_t rssi);
+
+/**
+ * @brief Fault classes
+ */
+typedef enum {
+    SIM_FAULT_DHT11_CRC = 0,        // dht11 frame with a bad checksum
+    SIM_FAULT_HCSR04_TIMEOUT,       // hc-sr04 echo never ends
+    SIM_FAULT_I2C_NACK,             // lcd backpack does not acknowledge
+    SIM_FAULT_I2C_HANG,             // bus held low until the transaction times out
+    SIM_FAULT_BLE_DISCONNECT,       // remote node link drops, per second while connected
+    SIM_FAULT_BLE_DROP,             // phone advert or remote notification lost
+    SIM_FAULT_COUNT,
+} sim_fault_t;
+
+/**
+ * @brief Paths timed for the fault report
+ */
+typedef enum {
+    SIM_PATH_PIR = 0,               // pir edge to the hub's sample of it
+    SIM_PATH_DISTANCE,              // interval between hc-sr04 reads
+    SIM_PATH_CLIMATE,               // interval between dht11 reads
+    SIM_PATH_LCD,                   // interval between lcd frames
+    SIM_PATH_COUNT,
+} sim_path_t;
+
+/**
+ * @brief Run summary
+ */
+typedef struct {
+    int64_t virtual_us;         // simulated time at the end
+    double real_s;              // wall time spent
+    double cpu_s;               // user + system cpu time of the process
+    long max_rss_kb;
+    uint32_t frames;            // settled lcd frames
+    uint64_t lcd_bytes;         // i2c bytes sent to the lcd backpack
+    uint32_t expects;
+    uint32_t expects_met;
+    uint32_t tick_wraps;        // tick counter overflows (TICK_WRAP build)
+} sim_summary_t;
+
+/**
+ * @brief Start the simulation - load the scenario, start the clock, the
+ *        scenario runner and the lcd renderer
+ *
+ * Reads HUB_SIM_SCENARIO (script path), HUB_SIM_SPEED (0 = as fast as
+ * possible, N = at most N times real time), HUB_SIM_LCD (off = no lcd
+ * frames on stdout), HUB_SIM_SEED (fault injection seed), HUB_SIM_SOAK
+ * (soak sample period), HUB_SIM_EXACT (whole-tick clock, host tick timer
+ * stopped), HUB_SIM_JSON (summary file) and HUB_SIM_FLASH (emulated flash
+ * file, kept across runs). Must run before the hub starts.
+ *
+ * @param pir_pin GPIO the script's pir lines drive
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on a script error,
+ *                   ESP_ERR_NOT_FOUND if the script cannot be read
+ */
+esp_err_t sim_start(int pir_pin);
+
+/**
+ * @brief Block until the scenario reaches its end, then print the summary
+ *
+ * @return int Process exit status: 0 if every expectation was met and no
+ *             soak metric drifted, 1 otherwise
+ */
+int sim_wait_end(void);
+
+/**
+ * @brief Virtual time since boot
+ *
+ * Whole ticks plus the real time spent inside the current tick (capped
+ * below one tick), so it is monotonic and work inside a tick still costs
+ * time. Whole ticks only with HUB_SIM_EXACT, so runs repeat exactly.
+ *
+ * @return int64_t Microseconds
+ */
+int64_t sim_now_us(void);
+
+/**
+ * @brief Ticks to wait until a virtual time
+ *
+ * @param time_us Virtual time in microseconds
+ * @return TickType_t Ticks to block (0 if already due)
+ */
+TickType_t sim_ticks_until(int64_t time_us);
+
+/**
+ * @brief Wall clock seconds for time()
+ *
+ * @return int64_t Scenario start epoch plus virtual seconds
+ */
+int64_t sim_epoch_now(void);
+
+/**
+ * @brief Simulated input pin level (pir output)
+ *
+ * @param pin GPIO number
+ * @return int Level driven by the scenario, 0 for undriven pins
+ */
+int sim_gpio_input(int pin);
+
+/**
+ * @brief HC-SR04 model - echo pulse for the scripted distance
+ *
+ * @param pulse_us Output echo width in microseconds
+ * @return esp_err_t ESP_OK, ESP_ERR_TIMEOUT when nothing is in range
+ */
+esp_err_t sim_hcsr04_echo(int64_t *pulse_us);
+
+/**
+ * @brief DHT11 model - the 5-byte frame for the scripted climate
+ *
+ * @param data Output frame: humidity, 0, temperature, 0, checksum
+ * @return esp_err_t ESP_OK (the driver checks the checksum)
+ */
+esp_err_t sim_dht11_frame(uint8_t data[5]);
+
+/**
+ * @brief LCD backpack model - one i2c write transaction to the pcf8574
+ *
+ * Decodes the HD44780 4-bit protocol (data latched on the falling enable
+ * edge) into the display memory and checks pending lcd expectations.
+ *
+ * @param data Expander output bytes (after the address byte)
+ * @param length Byte count
+ */
+void sim_lcd_write(const uint8_t *data, size_t length);
+
+/**
+ * @brief Copy the visible display
+ *
+ * @param rows Output rows, NUL terminated
+ */
+void sim_lcd_read(char rows[SIM_LCD_ROWS][SIM_LCD_COLUMNS + 1]);
+
+/**
+ * @brief Install the remote node and phone advert stand-ins
+ *
+ * @param remote_cb Remote node actions
+ * @param advert_cb Phone adverts
+ */
+void sim_set_ble(sim_remote_cb_t remote_cb, sim_advert_cb_t advert_cb);
+
+/**
+ * @brief Phones declared by the script, to provision as presence devices
+ *
+ * @param index Phone index
+ * @param name Output name
+ * @param addr Output address (NimBLE byte order)
+ * @return bool false past the last phone
+ */
+bool sim_get_phone(int index, const char **name, const uint8_t **addr);
+
+/**
+ * @brief Fault point - called by a simulated device for each operation that
+ *        can fail
+ *
+ * Inside a scheduled window an operation starts a burst with the window's
+ * probability; the burst fails that many consecutive operations.
+ *
+ * @param fault Fault class
+ * @return bool true: fail this operation
+ */
+bool sim_fault_inject(sim_fault_t fault);
+
+/**
+ * @brief An operation of the fault class succeeded (ends a recovery)
+ *
+ * @param fault Fault class
+ */
+void sim_fault_ok(sim_fault_t fault);
+
+/**
+ * @brief Latency sample on a timed path
+ *
+ * @param path Path
+ * @param latency_us Latency or interval in microseconds
+ */
+void sim_fault_path(sim_path_t path, int64_t latency_us);
+
+/**
+ * @brief Count i2c command links created (+1) and deleted (-1), for the
+ *        leak check
+ *
+ * @param delta Change
+ */
+void sim_fault_i2c_link(int delta);
+
+/**
+ * @brief Ticks asked for through vTaskDelay since boot, by every task
+ *
+ * @return uint64_t Ticks
+ */
+uint64_t sim_delay_ticks(void);
+
+/**
+ * @brief Get the run summary so far
+ *
+ * @param summary Output summary
+ */
+void sim_get_summary(sim_summary_t *summary);
+
+#endif  // SIM_H
@@ -0,0 +1,53 @@
+/**
+ * @file sim_kernel.h
+ * @author Anthony Yalong
+ * @brief Kernel hooks for the hub simulator - force-included into every
+ *        file of the build (top CMakeLists.txt), so FreeRTOS picks them up
+ */
+#ifndef SIM_KERNEL_H
+#define SIM_KERNEL_H
+
+// imports
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A task blocked with a timeout - records its wake-up tick so the
+ *        pacer can jump straight to the next one
+ *
+ * Runs inside the kernel with the scheduler suspended.
+ *
+ * @param wake_tick Tick the task times out at
+ */
+void sim_kernel_delayed(uint32_t wake_tick);
+
+/**
+ * @brief A task called vTaskDelay - counts the ticks asked for, the delay
+ *        part of a driver's cost on the target (benchmarks)
+ *
+ * Runs inside the kernel with the scheduler suspended.
+ *
+ * @param ticks Ticks to delay
+ */
+void sim_kernel_delay(uint32_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+// tasks.c expands these where xTimeToWake is the blocking task's wake-up tick
+#define traceMOVED_TASK_TO_DELAYED_LIST()           sim_kernel_delayed(xTimeToWake)
+#define traceMOVED_TASK_TO_OVERFLOW_DELAYED_LIST()  sim_kernel_delayed(xTimeToWake)
+#define traceTASK_DELAY()                           sim_kernel_delay(xTicksToDelay)
+
+// idf.py -DTICK_WRAP=<s>: the tick counter starts <s> seconds before it wraps
+#ifdef SIM_TICK_WRAP_S
+#define configINITIAL_TICK_COUNT    ((TickType_t)(0U - (uint32_t)(SIM_TICK_WRAP_S) * configTICK_RATE_HZ))
+#else
+#define configINITIAL_TICK_COUNT    0
+#endif
+
+#endif  // SIM_KERNEL_H
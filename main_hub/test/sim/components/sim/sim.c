@@ -0,0 +1,437 @@
+/**
+ * @file sim.c
+ * @author Anthony Yalong
+ * @brief Hub simulator core - virtual clock, pacing, log prefix and the run
+ *        summary
+ */
+
+#include "sim.h"
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_private/partition_linux.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sim_kernel.h"
+#include "sim_priv.h"
+
+static const char *TAG = "SIM";
+
+#define SIM_TICK_US         ((int64_t)portTICK_PERIOD_MS * 1000)
+#define SIM_START_TICK      ((TickType_t)configINITIAL_TICK_COUNT)
+#define SIM_MAX_WAKES       32                      // tasks tracked by the pacer
+#define SIM_MAX_STEP        pdMS_TO_TICKS(1000)     // longest jump of the pacer
+
+/**
+ * @brief Latest timed block of a task
+ */
+typedef struct {
+    TaskHandle_t task;
+    TickType_t tick;
+} sim_wake_t;
+
+// clock state
+static portMUX_TYPE sim_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t tick_wraps;
+static TickType_t last_tick = SIM_START_TICK;
+static int64_t last_tick_real_us;
+static int64_t last_now_us;
+static int64_t real_start_us;
+static uint32_t speed;
+static bool exact;                      // HUB_SIM_EXACT: whole ticks, pacer is the only tick source
+static uint64_t delay_ticks;
+static const char *scenario_path;
+static const char *json_path;
+static const char *flash_path;          // HUB_SIM_FLASH: emulated flash kept in this file
+static bool flash_new;                  // created by this run, copied out at the end
+static SemaphoreHandle_t end_semaphore;
+
+// wake-up ticks, written by the kernel hook
+static sim_wake_t wakes[SIM_MAX_WAKES];
+static int wake_count;
+static bool wakes_lost;                 // more tasks than SIM_MAX_WAKES: step one tick
+
+// time() is linked to __wrap_time (-Wl,--wrap=time)
+time_t __wrap_time(time_t *t);
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Host monotonic clock
+ *
+ * @return int64_t Microseconds
+ */
+static int64_t sim_real_us(void);
+
+/**
+ * @brief Earliest recorded wake-up after now
+ *
+ * Stale entries (tasks woken early) only shorten the jump. One tick when
+ * pacing to HUB_SIM_SPEED or when wake-ups were not recorded.
+ *
+ * @return TickType_t Tick to advance to
+ */
+static TickType_t sim_next_wake(void);
+
+/**
+ * @brief Pacer task - advances the tick count to the next wake-up whenever
+ *        every hub task is blocked, capped at HUB_SIM_SPEED times real time
+ *
+ * @param pvParameters Unused
+ */
+static void sim_pacer_task(void *pvParameters);
+
+/**
+ * @brief Log output with a virtual time prefix (days hh:mm:ss.mmm)
+ *
+ * @param format Log format
+ * @param args Log arguments
+ * @return int Characters written
+ */
+static int sim_log_vprintf(const char *format, va_list args);
+
+/**
+ * @brief Scenario end callback - releases sim_wait_end()
+ */
+static void sim_on_end(void);
+
+/**
+ * @brief Write the run summary and each expectation's latency as json
+ *        (HUB_SIM_JSON)
+ *
+ * @param summary Run summary
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the file cannot
+ *                   be written
+ */
+static esp_err_t sim_write_json(const sim_summary_t *summary);
+
+/**
+ * @brief Keep the emulated flash of this run in HUB_SIM_FLASH - copies the
+ *        dump esp_partition created (partition table included) to the file
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if either file
+ *                   cannot be opened
+ */
+static esp_err_t sim_flash_keep(void);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t sim_start(int pir_pin) {
+    // error management
+    esp_err_t ret;
+
+    scenario_path = getenv("HUB_SIM_SCENARIO");
+    const char *speed_env = getenv("HUB_SIM_SPEED");
+    const char *lcd_env = getenv("HUB_SIM_LCD");
+    const char *seed_env = getenv("HUB_SIM_SEED");
+    const char *soak_env = getenv("HUB_SIM_SOAK");
+    const char *exact_env = getenv("HUB_SIM_EXACT");
+    int64_t soak_us = 0;
+    if (scenario_path == NULL) {
+        ESP_LOGE(TAG, "set HUB_SIM_SCENARIO to a scenario script");
+        return ESP_ERR_NOT_FOUND;
+    }
+    speed = (speed_env != NULL) ? strtoul(speed_env, NULL, 10) : 0;
+    exact = exact_env != NULL && strcmp(exact_env, "0") != 0;
+    json_path = getenv("HUB_SIM_JSON");
+    flash_path = getenv("HUB_SIM_FLASH");
+
+    // every task allocates from the main arena, so mallinfo2() sees the whole heap
+    mallopt(M_ARENA_MAX, 1);
+    sim_fault_seed((seed_env != NULL) ? strtoull(seed_env, NULL, 10) : 1);
+    if (soak_env != NULL && (!sim_parse_duration(soak_env, &soak_us) || soak_us < 1000000)) {
+        ESP_LOGE(TAG, "HUB_SIM_SOAK: sample period like 1h, at least 1s");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ret = sim_scenario_load(scenario_path, pir_pin);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // emulated flash from a file: an earlier run's (replay recording) or a
+    // device dump (esptool.py read_flash 0 0x400000); set before the first
+    // partition access. Without the file esp_partition builds a fresh image
+    // from the partition table and it is copied out at the end
+    if (flash_path != NULL) {
+        esp_partition_file_mmap_ctrl_t *flash = esp_partition_get_file_mmap_ctrl_input();
+        FILE *file = fopen(flash_path, "rb");
+        flash_new = (file == NULL);
+        if (file != NULL) {
+            fclose(file);
+            snprintf(flash->flash_file_name, sizeof(flash->flash_file_name), "%s", flash_path);
+        } else {
+            flash->remove_dump = false;
+        }
+    }
+
+    end_semaphore = xSemaphoreCreateBinary();
+    if (end_semaphore == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // the posix port ticks on SIGALRM from ITIMER_REAL: stopped, time only
+    // moves when every task is blocked, so computing costs none and a run
+    // repeats tick for tick
+    if (exact) {
+        struct itimerval stopped = { 0 };
+        setitimer(ITIMER_REAL, &stopped, NULL);
+        speed = 0;
+    }
+
+    real_start_us = sim_real_us();
+    esp_log_set_vprintf(sim_log_vprintf);
+    sim_lcd_start(lcd_env == NULL || strcmp(lcd_env, "off") != 0);
+
+    // pacer shares the idle priority, every hub task preempts it
+    if (xTaskCreate(sim_pacer_task, "sim_pacer", SIM_TASK_STACK, NULL, tskIDLE_PRIORITY, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (soak_us > 0) {
+        ret = sim_soak_start(soak_us, getenv("HUB_SIM_SOAK_CSV"));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    ret = sim_scenario_start(sim_on_end);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "scenario %s, speed %s%s", scenario_path, speed ? speed_env : "unlimited", exact ? ", exact" : "");
+    return ESP_OK;
+}
+
+int sim_wait_end(void) {
+    sim_summary_t summary;
+
+    xSemaphoreTake(end_semaphore, portMAX_DELAY);
+    printf("\n==== hub simulation: %s ====\n", scenario_path);
+    uint32_t missed = sim_lcd_finish();
+    sim_fault_report();
+    uint32_t drifting = sim_soak_report();
+    sim_get_summary(&summary);
+
+    int64_t seconds = summary.virtual_us / 1000000;
+    printf("virtual %" PRId64 "d %02" PRId64 ":%02" PRId64 ":%02" PRId64 ".%03" PRId64
+           " in %.2f s real (%.0fx), %.2f s cpu, max rss %.1f MB\n",
+           seconds / 86400, seconds / 3600 % 24, seconds / 60 % 60, seconds % 60, summary.virtual_us / 1000 % 1000,
+           summary.real_s, summary.virtual_us / 1e6 / summary.real_s, summary.cpu_s, summary.max_rss_kb / 1024.0);
+    printf("lcd: %" PRIu32 " frames, %" PRIu64 " i2c bytes (%.0f per frame)\n", summary.frames, summary.lcd_bytes,
+           summary.frames ? (double)summary.lcd_bytes / summary.frames : 0.0);
+    printf("expectations: %" PRIu32 " of %" PRIu32 " met\n", summary.expects_met, summary.expects);
+    if (summary.tick_wraps > 0) {
+        printf("tick count wrapped %" PRIu32 " times\n", summary.tick_wraps);
+    }
+    fflush(stdout);
+
+    if (json_path != NULL && sim_write_json(&summary) != ESP_OK) {
+        ESP_LOGE(TAG, "cannot write %s", json_path);
+        return 1;
+    }
+    if (flash_new && sim_flash_keep() != ESP_OK) {
+        ESP_LOGE(TAG, "cannot write %s", flash_path);
+        return 1;
+    }
+    return (missed || drifting) ? 1 : 0;
+}
+
+int64_t sim_now_us(void) {
+    int64_t real = sim_real_us();
+
+    portENTER_CRITICAL(&sim_lock);
+    TickType_t tick = xTaskGetTickCount();
+    if (tick != last_tick) {
+        tick_wraps += (tick < last_tick);
+        last_tick = tick;
+        last_tick_real_us = real;
+    }
+
+    // real time inside the tick, capped so the next tick is always later
+    int64_t offset = exact ? 0 : real - last_tick_real_us;
+    if (offset >= SIM_TICK_US) {
+        offset = SIM_TICK_US - 1;
+    }
+    int64_t now = ((((int64_t)tick_wraps) << 32) + tick - SIM_START_TICK) * SIM_TICK_US + offset;
+    if (now < last_now_us) {
+        now = last_now_us;
+    }
+    last_now_us = now;
+    portEXIT_CRITICAL(&sim_lock);
+    return now;
+}
+
+TickType_t sim_ticks_until(int64_t time_us) {
+    int64_t now = sim_now_us();
+    if (time_us <= now) {
+        return 0;
+    }
+    int64_t ticks = (time_us - now + SIM_TICK_US - 1) / SIM_TICK_US;
+    return (ticks < portMAX_DELAY) ? (TickType_t)ticks : portMAX_DELAY - 1;
+}
+
+int64_t sim_epoch_now(void) {
+    return sim_scenario_epoch() + sim_now_us() / 1000000;
+}
+
+void sim_get_summary(sim_summary_t *summary) {
+    struct rusage usage;
+
+    if (summary == NULL) {
+        return;
+    }
+    memset(summary, 0, sizeof(*summary));
+    summary->virtual_us = sim_now_us();
+    summary->real_s = (sim_real_us() - real_start_us) / 1e6;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        summary->cpu_s = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+                         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        summary->max_rss_kb = usage.ru_maxrss;
+    }
+    sim_lcd_stats(&summary->frames, &summary->lcd_bytes, &summary->expects, &summary->expects_met);
+    portENTER_CRITICAL(&sim_lock);
+    summary->tick_wraps = tick_wraps;
+    portEXIT_CRITICAL(&sim_lock);
+}
+
+void sim_kernel_delayed(uint32_t wake_tick) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    for (int i = 0; i < wake_count; i++) {
+        if (wakes[i].task == task) {
+            wakes[i].tick = wake_tick;
+            return;
+        }
+    }
+    if (wake_count < SIM_MAX_WAKES) {
+        wakes[wake_count++] = (sim_wake_t){ .task = task, .tick = wake_tick };
+    } else {
+        wakes_lost = true;
+    }
+}
+
+void sim_kernel_delay(uint32_t ticks) {
+    delay_ticks += ticks;
+}
+
+uint64_t sim_delay_ticks(void) {
+    portENTER_CRITICAL(&sim_lock);
+    uint64_t ticks = delay_ticks;
+    portEXIT_CRITICAL(&sim_lock);
+    return ticks;
+}
+
+time_t __wrap_time(time_t *t) {
+    time_t now = (time_t)sim_epoch_now();
+    if (t != NULL) {
+        *t = now;
+    }
+    return now;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static int64_t sim_real_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sim_pacer_task(void *pvParameters) {
+    while (1) {
+        // speed cap: let the real tick catch up instead
+        if (speed > 0 && sim_now_us() >= (sim_real_us() - real_start_us) * speed) {
+            vTaskDelay(1);
+            continue;
+        }
+
+        // nothing else runnable: the next wake-up is now
+        TickType_t ticks = sim_next_wake() - xTaskGetTickCount();
+        xTaskCatchUpTicks((ticks >= 1 && ticks <= SIM_MAX_STEP) ? ticks : 1);
+    }
+}
+
+static TickType_t sim_next_wake(void) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t step = (speed > 0 || wake_count == 0 || wakes_lost) ? 1 : SIM_MAX_STEP;
+
+    for (int i = 0; i < wake_count; i++) {
+        TickType_t ahead = wakes[i].tick - now;
+        if (ahead > 0 && ahead < step) {
+            step = ahead;
+        }
+    }
+    return now + step;
+}
+
+static int sim_log_vprintf(const char *format, va_list args) {
+    int64_t ms = sim_now_us() / 1000;
+    int64_t seconds = ms / 1000;
+
+    int n = printf("[%" PRId64 "d %02" PRId64 ":%02" PRId64 ":%02" PRId64 ".%03" PRId64 "] ", seconds / 86400,
+                   seconds / 3600 % 24, seconds / 60 % 60, seconds % 60, ms % 1000);
+    return n + vprintf(format, args);
+}
+
+static void sim_on_end(void) {
+    xSemaphoreGive(end_semaphore);
+}
+
+static esp_err_t sim_write_json(const sim_summary_t *summary) {
+    FILE *file = fopen(json_path, "w");
+    if (file == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // script texts are quoted in the script, so never contain a quote
+    fprintf(file, "{\n  \"scenario\": \"%s\",\n  \"exact\": %s,\n", scenario_path, exact ? "true" : "false");
+    fprintf(file, "  \"virtual_us\": %" PRId64 ",\n  \"real_s\": %.3f,\n  \"cpu_s\": %.3f,\n  \"max_rss_kb\": %ld,\n",
+            summary->virtual_us, summary->real_s, summary->cpu_s, summary->max_rss_kb);
+    fprintf(file, "  \"frames\": %" PRIu32 ",\n  \"lcd_bytes\": %" PRIu64 ",\n  \"tick_wraps\": %" PRIu32
+            ",\n  \"expects\": [",
+            summary->frames, summary->lcd_bytes, summary->tick_wraps);
+
+    int line;
+    const char *text;
+    const char *label;
+    int64_t latency_us;
+    for (uint32_t i = 0; sim_lcd_get_expect(i, &line, &text, &label, &latency_us); i++) {
+        fprintf(file, "%s\n    {\"line\": %d, \"label\": \"%s\", \"text\": \"%s\", \"latency_us\": %" PRId64 "}",
+                i ? "," : "", line, label, text, latency_us);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return (fclose(file) == 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t sim_flash_keep(void) {
+    const char *dump = esp_partition_get_file_mmap_ctrl_act()->flash_file_name;
+    uint8_t buffer[4096];
+    size_t length;
+
+    FILE *in = fopen(dump, "rb");
+    if (in == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    FILE *out = fopen(flash_path, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return ESP_ERR_NOT_FOUND;
+    }
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, length, out);
+    }
+    fclose(in);
+    bool ok = (fclose(out) == 0);
+    remove(dump);
+    return ok ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
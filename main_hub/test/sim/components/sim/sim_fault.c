@@ -0,0 +1,360 @@
+/**
+ * @file sim_fault.c
+ * @author Anthony Yalong
+ * @brief Fault injection - scheduled fault windows, burst state per fault
+ *        class, recovery times, latency on the other paths and leak checks
+ */
+
+#include "sim.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "sim_priv.h"
+
+static const char *TAG = "SIM_FAULT";
+
+/**
+ * @brief Resources checked for leaks around a fault window
+ */
+typedef struct {
+    size_t heap_bytes;              // malloc'd bytes in use
+    UBaseType_t tasks;
+    int i2c_links;                  // i2c command links not deleted
+} sim_resources_t;
+
+/**
+ * @brief Scheduled fault window
+ */
+typedef struct {
+    sim_fault_t fault;
+    int64_t start_us;
+    int64_t end_us;                 // INT64_MAX: until the script ends
+    float probability;              // per operation, starts a burst
+    uint32_t burst;                 // operations failed per burst
+    int line;
+    bool opened;
+    bool closed;
+    sim_resources_t before;
+    sim_resources_t after;
+} sim_window_t;
+
+/**
+ * @brief Latency samples on one path
+ */
+typedef struct {
+    uint32_t count;
+    int64_t sum_us;
+    int64_t max_us;
+} sim_latency_t;
+
+/**
+ * @brief Per fault class state and results
+ */
+typedef struct {
+    uint32_t operations;            // operations that could fail
+    uint32_t injected;              // operations failed
+    uint32_t bursts;
+    uint32_t burst_left;            // operations still to fail in this burst
+    bool recovering;                // a burst happened, no success since
+    int64_t burst_start_us;
+    uint32_t recoveries;
+    int64_t recovery_sum_us;
+    int64_t recovery_max_us;
+} sim_fault_state_t;
+
+static const char *const fault_names[SIM_FAULT_COUNT] = {
+    "dht11_crc", "hcsr04_timeout", "i2c_nack", "i2c_hang", "ble_disconnect", "ble_drop",
+};
+static const char *const path_names[SIM_PATH_COUNT] = {
+    "pir", "distance", "climate", "lcd",
+};
+
+// the path each fault class acts on, SIM_PATH_COUNT for none of them
+static const sim_path_t fault_paths[SIM_FAULT_COUNT] = {
+    SIM_PATH_CLIMATE, SIM_PATH_DISTANCE, SIM_PATH_LCD, SIM_PATH_LCD, SIM_PATH_COUNT, SIM_PATH_COUNT,
+};
+
+static portMUX_TYPE fault_lock = portMUX_INITIALIZER_UNLOCKED;
+static sim_window_t windows[SIM_MAX_FAULTS];
+static int window_count;
+static sim_fault_state_t states[SIM_FAULT_COUNT];
+static sim_latency_t latencies[SIM_FAULT_COUNT + 1][SIM_PATH_COUNT];    // last row: no fault active
+static uint64_t rng_state = 1;
+static int i2c_links;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Deterministic pseudo random number (xorshift64*)
+ *
+ * @return float Uniform in [0, 1)
+ */
+static float sim_fault_random(void);
+
+/**
+ * @brief Active window of a fault class with the highest probability
+ *
+ * @param fault Fault class
+ * @param now_us Virtual time
+ * @return const sim_window_t* Window, NULL if none is active
+ */
+static const sim_window_t *sim_fault_window(sim_fault_t fault, int64_t now_us);
+
+/**
+ * @brief Add a latency sample
+ *
+ * @param bucket Samples
+ * @param latency_us Latency
+ */
+static void sim_fault_sample(sim_latency_t *bucket, int64_t latency_us);
+
+/**
+ * @brief Snapshot of the leak-checked resources
+ *
+ * @param resources Output snapshot
+ */
+static void sim_fault_resources(sim_resources_t *resources);
+
+/**
+ * @brief Print mean and max of a latency bucket next to the clean bucket
+ *
+ * @param path Path
+ * @param bucket Samples under the fault
+ * @param clean Samples with no fault active
+ */
+static void sim_fault_print_latency(sim_path_t path, const sim_latency_t *bucket, const sim_latency_t *clean);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+bool sim_fault_inject(sim_fault_t fault) {
+    bool fail = false;
+    int64_t now = sim_now_us();
+
+    portENTER_CRITICAL(&fault_lock);
+    sim_fault_state_t *state = &states[fault];
+    state->operations++;
+    if (state->burst_left > 0) {
+        state->burst_left--;
+        fail = true;
+    } else {
+        const sim_window_t *window = sim_fault_window(fault, now);
+        if (window != NULL && sim_fault_random() < window->probability) {
+            state->bursts++;
+            state->burst_left = window->burst - 1;
+            if (!state->recovering) {
+                state->recovering = true;
+                state->burst_start_us = now;
+            }
+            fail = true;
+        }
+    }
+    state->injected += fail;
+    portEXIT_CRITICAL(&fault_lock);
+    return fail;
+}
+
+void sim_fault_ok(sim_fault_t fault) {
+    int64_t now = sim_now_us();
+
+    portENTER_CRITICAL(&fault_lock);
+    sim_fault_state_t *state = &states[fault];
+    if (state->recovering) {
+        int64_t recovery = now - state->burst_start_us;
+        state->recovering = false;
+        state->recoveries++;
+        state->recovery_sum_us += recovery;
+        if (recovery > state->recovery_max_us) {
+            state->recovery_max_us = recovery;
+        }
+    }
+    portEXIT_CRITICAL(&fault_lock);
+}
+
+void sim_fault_path(sim_path_t path, int64_t latency_us) {
+    int64_t now = sim_now_us();
+    bool faulted = false;
+
+    sim_soak_path(path, latency_us);
+
+    // counted under every active fault class, or as a clean sample
+    portENTER_CRITICAL(&fault_lock);
+    for (int fault = 0; fault < SIM_FAULT_COUNT; fault++) {
+        if (sim_fault_window(fault, now) != NULL) {
+            sim_fault_sample(&latencies[fault][path], latency_us);
+            faulted = true;
+        }
+    }
+    if (!faulted) {
+        sim_fault_sample(&latencies[SIM_FAULT_COUNT][path], latency_us);
+    }
+    portEXIT_CRITICAL(&fault_lock);
+}
+
+void sim_fault_i2c_link(int delta) {
+    portENTER_CRITICAL(&fault_lock);
+    i2c_links += delta;
+    portEXIT_CRITICAL(&fault_lock);
+}
+
+esp_err_t sim_fault_add(const char *name, int64_t start_us, int64_t end_us, float probability, uint32_t burst,
+                        int line) {
+    int fault = 0;
+    while (fault < SIM_FAULT_COUNT && strcmp(fault_names[fault], name) != 0) {
+        fault++;
+    }
+    if (fault == SIM_FAULT_COUNT || probability < 0.0f || probability > 1.0f || burst == 0 || end_us <= start_us) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (window_count == SIM_MAX_FAULTS) {
+        ESP_LOGE(TAG, "more than %d fault windows", SIM_MAX_FAULTS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    windows[window_count++] = (sim_window_t){
+        .fault = fault,
+        .start_us = start_us,
+        .end_us = end_us,
+        .probability = probability,
+        .burst = burst,
+        .line = line,
+    };
+    return ESP_OK;
+}
+
+void sim_fault_seed(uint64_t seed) {
+    rng_state = seed ? seed : 1;
+}
+
+int64_t sim_fault_poll(int64_t now_us) {
+    int64_t next = INT64_MAX;
+
+    // leak snapshots as windows open, and once the hub settled after they close
+    for (int i = 0; i < window_count; i++) {
+        sim_window_t *window = &windows[i];
+        if (!window->opened && now_us >= window->start_us) {
+            window->opened = true;
+            sim_fault_resources(&window->before);
+            ESP_LOGI(TAG, "line %d: %s window open", window->line, fault_names[window->fault]);
+        }
+        int64_t settled = (window->end_us == INT64_MAX) ? INT64_MAX : window->end_us + SIM_FAULT_SETTLE_MS * 1000;
+        if (window->opened && !window->closed && now_us >= settled) {
+            window->closed = true;
+            sim_fault_resources(&window->after);
+            ESP_LOGI(TAG, "line %d: %s window closed", window->line, fault_names[window->fault]);
+        }
+
+        if (!window->opened && window->start_us < next) {
+            next = window->start_us;
+        } else if (!window->closed && settled < next) {
+            next = settled;
+        }
+    }
+    return next;
+}
+
+void sim_fault_report(void) {
+    sim_resources_t now;
+
+    if (window_count == 0) {
+        return;
+    }
+    sim_fault_resources(&now);
+
+    printf("faults:\n");
+    for (int i = 0; i < window_count; i++) {
+        sim_window_t *window = &windows[i];
+        if (!window->opened) {
+            printf("line %-4d %s: never opened\n", window->line, fault_names[window->fault]);
+            continue;
+        }
+        if (!window->closed) {
+            window->after = now;
+        }
+        printf("line %-4d %s p %.3f burst %lu: heap %+ld B, tasks %+ld, i2c links %+d%s\n", window->line,
+               fault_names[window->fault], window->probability, (unsigned long)window->burst,
+               (long)window->after.heap_bytes - (long)window->before.heap_bytes,
+               (long)window->after.tasks - (long)window->before.tasks, window->after.i2c_links - window->before.i2c_links,
+               window->closed ? "" : " (at the end)");
+    }
+
+    portENTER_CRITICAL(&fault_lock);
+    for (int fault = 0; fault < SIM_FAULT_COUNT; fault++) {
+        const sim_fault_state_t *state = &states[fault];
+        if (state->bursts == 0) {
+            continue;
+        }
+        printf("%s: %lu of %lu operations failed in %lu bursts, recovery ", fault_names[fault],
+               (unsigned long)state->injected, (unsigned long)state->operations, (unsigned long)state->bursts);
+        if (state->recoveries > 0) {
+            printf("mean %.3f s max %.3f s (%lu)%s\n", state->recovery_sum_us / 1e6 / state->recoveries,
+                   state->recovery_max_us / 1e6, (unsigned long)state->recoveries,
+                   state->recovering ? ", last burst not recovered" : "");
+        } else {
+            printf("none\n");
+        }
+        for (int path = 0; path < SIM_PATH_COUNT; path++) {
+            if (path != (int)fault_paths[fault]) {
+                sim_fault_print_latency(path, &latencies[fault][path], &latencies[SIM_FAULT_COUNT][path]);
+            }
+        }
+    }
+    portEXIT_CRITICAL(&fault_lock);
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static float sim_fault_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (float)((rng_state * 0x2545F4914F6CDD1DULL) >> 40) / (float)(1 << 24);
+}
+
+static const sim_window_t *sim_fault_window(sim_fault_t fault, int64_t now_us) {
+    const sim_window_t *found = NULL;
+
+    for (int i = 0; i < window_count; i++) {
+        const sim_window_t *window = &windows[i];
+        if (window->fault == fault && now_us >= window->start_us && now_us < window->end_us &&
+            (found == NULL || window->probability > found->probability)) {
+            found = window;
+        }
+    }
+    return found;
+}
+
+static void sim_fault_sample(sim_latency_t *bucket, int64_t latency_us) {
+    bucket->count++;
+    bucket->sum_us += latency_us;
+    if (latency_us > bucket->max_us) {
+        bucket->max_us = latency_us;
+    }
+}
+
+static void sim_fault_resources(sim_resources_t *resources) {
+    struct mallinfo2 info = mallinfo2();
+
+    resources->heap_bytes = info.uordblks;
+    resources->tasks = uxTaskGetNumberOfTasks();
+    portENTER_CRITICAL(&fault_lock);
+    resources->i2c_links = i2c_links;
+    portEXIT_CRITICAL(&fault_lock);
+}
+
+static void sim_fault_print_latency(sim_path_t path, const sim_latency_t *bucket, const sim_latency_t *clean) {
+    if (bucket->count == 0) {
+        return;
+    }
+    double mean = bucket->sum_us / 1e3 / bucket->count;
+    printf("  %-8s mean %8.1f ms max %8.1f ms", path_names[path], mean, bucket->max_us / 1e3);
+    if (clean->count > 0) {
+        printf("  (%+.1f / %+.1f ms vs no fault)", mean - clean->sum_us / 1e3 / clean->count,
+               (bucket->max_us - clean->max_us) / 1e3);
+    }
+    printf("\n");
+}
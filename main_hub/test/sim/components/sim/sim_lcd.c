@@ -0,0 +1,307 @@
+/**
+ * @file sim_lcd.c
+ * @author Anthony Yalong
+ * @brief LCD1602 behind a PCF8574 backpack - HD44780 4-bit protocol model,
+ *        terminal renderer and lcd expectations
+ */
+
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "sim_priv.h"
+
+static const char *TAG = "SIM_LCD";
+
+#define SIM_LCD_DDRAM_LEN   0x68        // two 40 character lines at 0x00 and 0x40
+
+// backpack wiring: p0 rs, p1 rw, p2 enable, p3 backlight, p4-p7 data
+#define SIM_LCD_RS          0x01
+#define SIM_LCD_RW          0x02
+#define SIM_LCD_EN          0x04
+
+// hd44780 instructions, highest set bit selects
+#define SIM_LCD_SET_DDRAM   0x80
+#define SIM_LCD_SET_CGRAM   0x40
+#define SIM_LCD_FUNCTION    0x20
+#define SIM_LCD_SHIFT       0x10
+#define SIM_LCD_DISPLAY     0x08
+#define SIM_LCD_ENTRY       0x04
+#define SIM_LCD_HOME        0x02
+#define SIM_LCD_CLEAR       0x01
+#define SIM_LCD_EIGHT_BIT   0x10        // function set data length
+#define SIM_LCD_DISPLAY_ON  0x04
+
+/**
+ * @brief Armed expectation
+ */
+typedef struct {
+    char text[SIM_LCD_COLUMNS + 1];
+    char label[SIM_EXPECT_LABEL_LEN];
+    int64_t armed_us;
+    int64_t deadline_us;
+    int64_t latency_us;             // -1 until met
+    int line;
+} sim_expect_t;
+
+// controller state
+static portMUX_TYPE lcd_lock = portMUX_INITIALIZER_UNLOCKED;
+static char ddram[SIM_LCD_DDRAM_LEN];
+static uint8_t address;
+static bool four_bit;
+static bool high_nibble_pending;
+static uint8_t high_nibble;
+static uint8_t last_output;
+static bool display_on;
+static int64_t changed_us;
+static uint32_t frames;
+static uint64_t bytes;
+static TaskHandle_t renderer;
+
+// expectations
+static sim_expect_t expects[SIM_MAX_EXPECTS];
+static uint32_t expect_count;
+static bool render;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Execute one instruction or data byte
+ *
+ * @param value Byte
+ * @param data true for a data write (RS high)
+ */
+static void sim_lcd_execute(uint8_t value, bool data);
+
+/**
+ * @brief Check pending expectations against the display (lcd_lock held)
+ *
+ * @param now_us Virtual time
+ */
+static void sim_lcd_check(int64_t now_us);
+
+/**
+ * @brief Renderer task - woken by display changes, prints every settled
+ *        frame
+ *
+ * @param pvParameters Unused
+ */
+static void sim_lcd_task(void *pvParameters);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+void sim_lcd_write(const uint8_t *data, size_t length) {
+    portENTER_CRITICAL(&lcd_lock);
+    bytes += length + 1;
+    int64_t before_us = changed_us;
+
+    for (size_t i = 0; i < length; i++) {
+        // the controller latches on the falling edge of enable
+        uint8_t byte = data[i];
+        bool latch = (last_output & SIM_LCD_EN) && !(byte & SIM_LCD_EN);
+        last_output = byte;
+        if (!latch || (byte & SIM_LCD_RW)) {
+            continue;
+        }
+
+        uint8_t nibble = byte & 0xF0;
+        if (!four_bit) {
+            // 8-bit interface after power-up: each nibble is a whole instruction
+            sim_lcd_execute(nibble, false);
+        } else if (!high_nibble_pending) {
+            high_nibble = nibble;
+            high_nibble_pending = true;
+        } else {
+            high_nibble_pending = false;
+            sim_lcd_execute(high_nibble | (nibble >> 4), (byte & SIM_LCD_RS) != 0);
+        }
+    }
+    bool changed = changed_us != before_us;
+    portEXIT_CRITICAL(&lcd_lock);
+
+    if (changed && renderer != NULL) {
+        xTaskNotifyGive(renderer);
+    }
+}
+
+void sim_lcd_read(char rows[SIM_LCD_ROWS][SIM_LCD_COLUMNS + 1]) {
+    portENTER_CRITICAL(&lcd_lock);
+    for (int row = 0; row < SIM_LCD_ROWS; row++) {
+        memcpy(rows[row], &ddram[row * 0x40], SIM_LCD_COLUMNS);
+        rows[row][SIM_LCD_COLUMNS] = '\0';
+    }
+    portEXIT_CRITICAL(&lcd_lock);
+}
+
+void sim_lcd_start(bool render_frames) {
+    memset(ddram, ' ', sizeof(ddram));
+    render = render_frames;
+    xTaskCreate(sim_lcd_task, "sim_lcd", SIM_TASK_STACK, NULL, 1, &renderer);
+}
+
+void sim_lcd_expect(const char *text, const char *label, int64_t within_us, int line) {
+    int64_t now = sim_now_us();
+
+    portENTER_CRITICAL(&lcd_lock);
+    if (expect_count < SIM_MAX_EXPECTS) {
+        sim_expect_t *expect = &expects[expect_count++];
+        strncpy(expect->text, text, SIM_LCD_COLUMNS);
+        expect->text[SIM_LCD_COLUMNS] = '\0';
+        strncpy(expect->label, label, SIM_EXPECT_LABEL_LEN - 1);
+        expect->label[SIM_EXPECT_LABEL_LEN - 1] = '\0';
+        expect->armed_us = now;
+        expect->deadline_us = now + within_us;
+        expect->latency_us = -1;
+        expect->line = line;
+
+        // already on screen counts as met at once
+        sim_lcd_check(now);
+    }
+    portEXIT_CRITICAL(&lcd_lock);
+
+    if (expect_count == SIM_MAX_EXPECTS) {
+        ESP_LOGW(TAG, "more than %d expectations, line %d ignored", SIM_MAX_EXPECTS, line);
+    }
+}
+
+uint32_t sim_lcd_finish(void) {
+    uint32_t missed = 0;
+
+    for (uint32_t i = 0; i < expect_count; i++) {
+        const sim_expect_t *expect = &expects[i];
+        bool met = expect->latency_us >= 0;
+        missed += !met;
+
+        char latency[24] = "-";
+        if (met) {
+            snprintf(latency, sizeof(latency), "%.3f s", expect->latency_us / 1e6);
+        }
+        printf("line %-4d expect \"%s\" within %.1f s from %.3f s: %s%s\n", expect->line, expect->text,
+               (expect->deadline_us - expect->armed_us) / 1e6, expect->armed_us / 1e6, latency,
+               met ? "" : "  <-- MISSED");
+    }
+    return missed;
+}
+
+void sim_lcd_stats(uint32_t *frame_count, uint64_t *byte_count, uint32_t *expect_total, uint32_t *met) {
+    portENTER_CRITICAL(&lcd_lock);
+    *frame_count = frames;
+    *byte_count = bytes;
+    *expect_total = expect_count;
+    *met = 0;
+    for (uint32_t i = 0; i < expect_count; i++) {
+        *met += expects[i].latency_us >= 0;
+    }
+    portEXIT_CRITICAL(&lcd_lock);
+}
+
+bool sim_lcd_get_expect(uint32_t index, int *line, const char **text, const char **label, int64_t *latency_us) {
+    if (index >= expect_count) {
+        return false;
+    }
+    *line = expects[index].line;
+    *text = expects[index].text;
+    *label = expects[index].label;
+    *latency_us = expects[index].latency_us;
+    return true;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void sim_lcd_execute(uint8_t value, bool data) {
+    int64_t now = sim_now_us();
+
+    if (data) {
+        ddram[address] = (value >= 0x20 && value < 0x7F) ? (char)value : '?';
+        address = (address + 1) % SIM_LCD_DDRAM_LEN;
+    } else if (value & SIM_LCD_SET_DDRAM) {
+        address = (value & 0x7F) % SIM_LCD_DDRAM_LEN;
+        return;
+    } else if (value & SIM_LCD_SET_CGRAM) {
+        // custom characters are not modelled
+        return;
+    } else if (value & SIM_LCD_FUNCTION) {
+        four_bit = !(value & SIM_LCD_EIGHT_BIT);
+        high_nibble_pending = false;
+        return;
+    } else if (value & SIM_LCD_SHIFT) {
+        // cursor or display shift, unused by the driver
+        return;
+    } else if (value & SIM_LCD_DISPLAY) {
+        display_on = (value & SIM_LCD_DISPLAY_ON) != 0;
+    } else if (value & SIM_LCD_ENTRY) {
+        return;
+    } else if (value & SIM_LCD_HOME) {
+        address = 0;
+        return;
+    } else if (value & SIM_LCD_CLEAR) {
+        memset(ddram, ' ', sizeof(ddram));
+        address = 0;
+    }
+
+    changed_us = now;
+    sim_lcd_check(now);
+}
+
+static void sim_lcd_check(int64_t now_us) {
+    if (!display_on) {
+        return;
+    }
+    for (uint32_t i = 0; i < expect_count; i++) {
+        sim_expect_t *expect = &expects[i];
+        if (expect->latency_us >= 0 || now_us > expect->deadline_us) {
+            continue;
+        }
+        for (int row = 0; row < SIM_LCD_ROWS; row++) {
+            char text[SIM_LCD_COLUMNS + 1];
+            memcpy(text, &ddram[row * 0x40], SIM_LCD_COLUMNS);
+            text[SIM_LCD_COLUMNS] = '\0';
+            if (strstr(text, expect->text) != NULL) {
+                expect->latency_us = now_us - expect->armed_us;
+                break;
+            }
+        }
+    }
+}
+
+static void sim_lcd_task(void *pvParameters) {
+    char shown[SIM_LCD_ROWS][SIM_LCD_COLUMNS + 1] = { { 0 } };
+    char rows[SIM_LCD_ROWS][SIM_LCD_COLUMNS + 1];
+    int64_t counted_us = -1;
+    int64_t last_frame_us = -1;
+
+    while (1) {
+        // a frame is done once the display has been quiet for the settle time
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t now;
+        do {
+            vTaskDelay(pdMS_TO_TICKS(SIM_LCD_SETTLE_MS));
+            now = sim_now_us();
+        } while (now - changed_us < SIM_LCD_SETTLE_MS * 1000);
+        if (!display_on || changed_us == counted_us) {
+            continue;
+        }
+        counted_us = changed_us;
+        portENTER_CRITICAL(&lcd_lock);
+        frames++;
+        portEXIT_CRITICAL(&lcd_lock);
+        if (last_frame_us >= 0) {
+            sim_fault_path(SIM_PATH_LCD, counted_us - last_frame_us);
+        }
+        last_frame_us = counted_us;
+
+        // redraws of the same content are counted, printed only on change
+        sim_lcd_read(rows);
+        if (memcmp(rows, shown, sizeof(rows)) == 0) {
+            continue;
+        }
+        memcpy(shown, rows, sizeof(rows));
+        if (render) {
+            printf("+----------------+ %.3f s\n|%s|\n|%s|\n+----------------+\n", now / 1e6, rows[0], rows[1]);
+        }
+    }
+}
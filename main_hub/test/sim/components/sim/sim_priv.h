@@ -0,0 +1,159 @@
+/**
+ * @file sim_priv.h
+ * @author Anthony Yalong
+ * @brief Hub simulator internals shared between the core, the scenario
+ *        runner and the lcd model
+ */
+#ifndef SIM_PRIV_H
+#define SIM_PRIV_H
+
+// imports
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sim.h"
+
+/**
+ * @brief Parse a scenario script
+ *
+ * @param path Script path
+ * @param pir Pin driven by pir lines
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if unreadable,
+ *                   ESP_ERR_INVALID_ARG on a syntax error (line is logged)
+ */
+esp_err_t sim_scenario_load(const char *path, int pir);
+
+/**
+ * @brief Start the scenario runner task
+ *
+ * @param end_cb Called once from the runner when the script ends
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the task cannot be created
+ */
+esp_err_t sim_scenario_start(void (*end_cb)(void));
+
+/**
+ * @brief Wall clock at boot
+ *
+ * @return int64_t Seconds since the unix epoch
+ */
+int64_t sim_scenario_epoch(void);
+
+/**
+ * @brief Parse a duration - 250ms, 3s, 2m, 1h, 1d
+ *
+ * @param text Duration text
+ * @param us Output microseconds
+ * @return bool true on success
+ */
+bool sim_parse_duration(const char *text, int64_t *us);
+
+/**
+ * @brief Start the lcd renderer task
+ *
+ * @param render false: track frames and expectations without printing
+ */
+void sim_lcd_start(bool render);
+
+/**
+ * @brief Arm an lcd expectation from now
+ *
+ * @param text Text that has to appear on either row
+ * @param label Expectation label, empty if none
+ * @param within_us Deadline from now
+ * @param line Script line, for the report
+ */
+void sim_lcd_expect(const char *text, const char *label, int64_t within_us, int line);
+
+/**
+ * @brief Close pending expectations and print one line per expectation
+ *
+ * @return uint32_t Expectations missed
+ */
+uint32_t sim_lcd_finish(void);
+
+/**
+ * @brief LCD counters
+ *
+ * @param frames Output settled frames
+ * @param bytes Output i2c bytes to the backpack
+ * @param expects Output expectations armed
+ * @param met Output expectations met
+ */
+void sim_lcd_stats(uint32_t *frames, uint64_t *bytes, uint32_t *expects, uint32_t *met);
+
+/**
+ * @brief Get one expectation for the json summary
+ *
+ * @param index Expectation index, in script order
+ * @param line Output script line
+ * @param text Output expected text
+ * @param label Output label, empty if none
+ * @param latency_us Output latency, -1 if missed
+ * @return bool false past the last expectation
+ */
+bool sim_lcd_get_expect(uint32_t index, int *line, const char **text, const char **label, int64_t *latency_us);
+
+/**
+ * @brief Schedule a fault window
+ *
+ * @param name Fault class name (dht11_crc, hcsr04_timeout, i2c_nack,
+ *             i2c_hang, ble_disconnect, ble_drop)
+ * @param start_us Window start
+ * @param end_us Window end, INT64_MAX for the rest of the run
+ * @param probability Chance per operation of starting a burst
+ * @param burst Operations failed per burst
+ * @param line Script line, for the report
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on a bad class or
+ *                   value, ESP_ERR_NO_MEM past SIM_MAX_FAULTS windows
+ */
+esp_err_t sim_fault_add(const char *name, int64_t start_us, int64_t end_us, float probability, uint32_t burst,
+                        int line);
+
+/**
+ * @brief Seed the fault random generator (HUB_SIM_SEED)
+ *
+ * @param seed Seed, 0 is taken as 1
+ */
+void sim_fault_seed(uint64_t seed);
+
+/**
+ * @brief Open and close windows due by now (leak snapshots)
+ *
+ * @param now_us Virtual time
+ * @return int64_t Next time a window opens or settles, INT64_MAX if none
+ */
+int64_t sim_fault_poll(int64_t now_us);
+
+/**
+ * @brief Print the fault report: leaks per window, then per class failures,
+ *        recovery times and latency on the other paths
+ */
+void sim_fault_report(void);
+
+/**
+ * @brief Start the soak sampler (HUB_SIM_SOAK)
+ *
+ * @param period_us Sample period
+ * @param csv_path Also write the samples here (HUB_SIM_SOAK_CSV), NULL for none
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the task or the
+ *                   sample buffer cannot be created, ESP_ERR_NOT_FOUND if the
+ *                   csv file cannot be opened
+ */
+esp_err_t sim_soak_start(int64_t period_us, const char *csv_path);
+
+/**
+ * @brief Latency sample for the soak percentiles
+ *
+ * @param path Path
+ * @param latency_us Latency or interval in microseconds
+ */
+void sim_soak_path(sim_path_t path, int64_t latency_us);
+
+/**
+ * @brief Print the soak report: run totals, flash wear and drift per metric
+ *
+ * @return uint32_t Metrics that drifted (0 when not soaking)
+ */
+uint32_t sim_soak_report(void);
+
+#endif  // SIM_PRIV_H
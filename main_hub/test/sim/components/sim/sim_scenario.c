@@ -0,0 +1,707 @@
+/**
+ * @file sim_scenario.c
+ * @author Anthony Yalong
+ * @brief Scenario scripts - parser, runner task and the device models the
+ *        simulated drivers read
+ */
+
+#include "sim.h"
+#include <ctype.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "sim_priv.h"
+
+static const char *TAG = "SIM_SCENARIO";
+
+#define SIM_LINE_LEN        256
+#define SIM_MAX_TOKENS      8
+#define SIM_GPIO_COUNT      40
+#define SIM_HCSR04_MAX_CM   400.0f      // beyond this the sensor sees no echo
+
+/**
+ * @brief Script actions
+ */
+typedef enum {
+    SIM_ACTION_GPIO = 0,
+    SIM_ACTION_DISTANCE,
+    SIM_ACTION_DISTANCE_NONE,
+    SIM_ACTION_TEMPERATURE,
+    SIM_ACTION_HUMIDITY,
+    SIM_ACTION_REMOTE,
+    SIM_ACTION_PHONE,
+    SIM_ACTION_EXPECT,
+    SIM_ACTION_END,
+    SIM_ACTION_REPEAT,              // the script again from the top, index rounds in all
+} sim_action_type_t;
+
+/**
+ * @brief One timed script line
+ */
+typedef struct {
+    int64_t time_us;
+    sim_action_type_t type;
+    int index;                      // gpio pin, phone or repeat rounds
+    float value;                    // level, start value, rssi, remote motion
+    float to;                       // ramp end value
+    int64_t over_us;                // ramp duration, 0 = step
+    sim_remote_action_t remote;
+    char text[SIM_LCD_COLUMNS + 1];
+    char label[SIM_EXPECT_LABEL_LEN];   // expectation label, empty if none
+    int line;
+} sim_action_t;
+
+/**
+ * @brief Scripted quantity - a step or a linear ramp
+ */
+typedef struct {
+    float from;
+    float to;
+    int64_t start_us;
+    int64_t over_us;
+} sim_ramp_t;
+
+/**
+ * @brief Provisioned phone
+ */
+typedef struct {
+    char name[SIM_PHONE_NAME_LEN];
+    uint8_t addr[6];                // NimBLE byte order
+    bool advertising;
+    int8_t rssi;
+} sim_phone_t;
+
+static sim_action_t *actions;
+static int action_count;
+static int64_t epoch = SIM_EPOCH_DEFAULT;
+static sim_phone_t phones[SIM_MAX_PHONES];
+static int phone_count;
+static int pir_pin = -1;
+
+// device state, written by the runner, read by the drivers
+static portMUX_TYPE device_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t gpio_levels[SIM_GPIO_COUNT];
+static bool distance_present;
+static sim_ramp_t distance = { 0 };
+static sim_ramp_t temperature = { 22.0f, 22.0f, 0, 0 };
+static sim_ramp_t humidity = { 45.0f, 45.0f, 0, 0 };
+static sim_remote_cb_t remote_cb;
+static sim_advert_cb_t advert_cb;
+static bool remote_connected;           // scripted link state
+static bool link_dropped;               // link down by a ble_disconnect fault
+static int64_t pir_edge_us = -1;        // unsampled pir edge
+static int64_t last_echo_us = -1;
+static int64_t last_frame_us = -1;
+static void (*end_callback)(void);
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Parse one script line into an action (or a header directive)
+ *
+ * @param tokens Line tokens, quotes removed
+ * @param count Token count
+ * @param line Line number
+ * @param last_us Time of the previous action, for +relative times
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on a syntax error
+ */
+static esp_err_t sim_parse_line(char **tokens, int count, int line, int64_t *last_us);
+
+/**
+ * @brief Parse a fault window: fault <class> <probability> [burst <n>] [for <time>]
+ *
+ * @param tokens Line tokens
+ * @param count Token count
+ * @param line Line number
+ * @param time_us Window start
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG on a syntax error
+ */
+static esp_err_t sim_parse_fault(char **tokens, int count, int line, int64_t time_us);
+
+/**
+ * @brief Split a line into whitespace separated tokens, "quoted" tokens kept
+ *        whole, # starts a comment
+ *
+ * @param line Line, modified in place
+ * @param tokens Output token pointers
+ * @return int Token count
+ */
+static int sim_tokenize(char *line, char **tokens);
+
+/**
+ * @brief Parse a number
+ *
+ * @param text Number text
+ * @param value Output value
+ * @return bool true on success
+ */
+static bool sim_parse_float(const char *text, float *value);
+
+/**
+ * @brief Find a phone by name
+ *
+ * @param name Phone name
+ * @return int Phone index, -1 if unknown
+ */
+static int sim_find_phone(const char *name);
+
+/**
+ * @brief Value of a scripted quantity now
+ *
+ * @param ramp Quantity
+ * @param now_us Virtual time
+ * @return float Value
+ */
+static float sim_ramp_value(const sim_ramp_t *ramp, int64_t now_us);
+
+/**
+ * @brief Start a step or ramp from the current value
+ *
+ * @param ramp Quantity
+ * @param action Action with the target (value, or value to `to` over over_us)
+ * @param time_us Ramp start
+ */
+static void sim_ramp_set(sim_ramp_t *ramp, const sim_action_t *action, int64_t time_us);
+
+/**
+ * @brief Apply one action at its time
+ *
+ * @param action Action
+ * @param time_us Time the action is due (later rounds of a repeated script
+ *                are offset)
+ * @return bool true if the script ended
+ */
+static bool sim_apply(const sim_action_t *action, int64_t time_us);
+
+/**
+ * @brief Once a second: phone adverts (minus dropped ones) and remote link
+ *        faults
+ */
+static void sim_second(void);
+
+/**
+ * @brief Runner task - applies actions on time and sends phone adverts
+ *
+ * @param pvParameters Unused
+ */
+static void sim_runner_task(void *pvParameters);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t sim_scenario_load(const char *path, int pir) {
+    char buf[SIM_LINE_LEN];
+    char *tokens[SIM_MAX_TOKENS];
+    int64_t last_us = 0;
+    int line = 0;
+
+    pir_pin = (pir >= 0 && pir < SIM_GPIO_COUNT) ? pir : -1;
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        ESP_LOGE(TAG, "cannot open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    actions = calloc(SIM_MAX_ACTIONS, sizeof(sim_action_t));
+    if (actions == NULL) {
+        fclose(file);
+        return ESP_ERR_NO_MEM;
+    }
+
+    while (fgets(buf, sizeof(buf), file) != NULL) {
+        line++;
+        int count = sim_tokenize(buf, tokens);
+        if (count == 0) {
+            continue;
+        }
+        if (sim_parse_line(tokens, count, line, &last_us) != ESP_OK) {
+            ESP_LOGE(TAG, "%s:%d: cannot parse '%s'", path, line, tokens[0]);
+            fclose(file);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    fclose(file);
+
+    // a script without an end stops one second after its last action
+    if (action_count == 0 || (actions[action_count - 1].type != SIM_ACTION_END &&
+                              actions[action_count - 1].type != SIM_ACTION_REPEAT)) {
+        if (action_count >= SIM_MAX_ACTIONS) {
+            ESP_LOGE(TAG, "%s: more than %d actions", path, SIM_MAX_ACTIONS);
+            return ESP_ERR_INVALID_ARG;
+        }
+        actions[action_count++] = (sim_action_t){ .time_us = last_us + 1000000, .type = SIM_ACTION_END, .line = line };
+    }
+
+    const sim_action_t *last = &actions[action_count - 1];
+    int rounds = (last->type == SIM_ACTION_REPEAT) ? last->index : 1;
+    ESP_LOGI(TAG, "%d actions, %d phones, ends at %" PRId64 " s", action_count, phone_count,
+             last->time_us * rounds / 1000000);
+    return ESP_OK;
+}
+
+bool sim_get_phone(int index, const char **name, const uint8_t **addr) {
+    if (index < 0 || index >= phone_count) {
+        return false;
+    }
+    *name = phones[index].name;
+    *addr = phones[index].addr;
+    return true;
+}
+
+esp_err_t sim_scenario_start(void (*end_cb)(void)) {
+    end_callback = end_cb;
+    if (xTaskCreate(sim_runner_task, "sim_runner", SIM_TASK_STACK, NULL, SIM_TASK_PRIORITY, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+int64_t sim_scenario_epoch(void) {
+    return epoch;
+}
+
+int sim_gpio_input(int pin) {
+    if (pin < 0 || pin >= SIM_GPIO_COUNT) {
+        return 0;
+    }
+
+    // first read of the pir pin after an edge closes the edge's latency
+    if (pin == pir_pin && pir_edge_us >= 0) {
+        sim_fault_path(SIM_PATH_PIR, sim_now_us() - pir_edge_us);
+        pir_edge_us = -1;
+    }
+    return gpio_levels[pin];
+}
+
+esp_err_t sim_hcsr04_echo(int64_t *pulse_us) {
+    int64_t now = sim_now_us();
+
+    if (last_echo_us >= 0) {
+        sim_fault_path(SIM_PATH_DISTANCE, now - last_echo_us);
+    }
+    last_echo_us = now;
+
+    portENTER_CRITICAL(&device_lock);
+    bool present = distance_present;
+    float cm = sim_ramp_value(&distance, now);
+    portEXIT_CRITICAL(&device_lock);
+
+    if (sim_fault_inject(SIM_FAULT_HCSR04_TIMEOUT)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (!present || cm > SIM_HCSR04_MAX_CM) {
+        return ESP_ERR_TIMEOUT;
+    }
+    sim_fault_ok(SIM_FAULT_HCSR04_TIMEOUT);
+
+    // inverse of the driver's conversion, so it reads back the scripted distance
+    *pulse_us = llroundf(fmaxf(cm, 2.0f) * 2.0f / 0.034f);
+    return ESP_OK;
+}
+
+esp_err_t sim_dht11_frame(uint8_t data[5]) {
+    int64_t now = sim_now_us();
+
+    if (last_frame_us >= 0) {
+        sim_fault_path(SIM_PATH_CLIMATE, now - last_frame_us);
+    }
+    last_frame_us = now;
+
+    portENTER_CRITICAL(&device_lock);
+    float t = sim_ramp_value(&temperature, now);
+    float h = sim_ramp_value(&humidity, now);
+    portEXIT_CRITICAL(&device_lock);
+
+    // whole units within the sensor's range: 0-50 C, 20-90 %
+    data[0] = (uint8_t)fminf(fmaxf(roundf(h), 20.0f), 90.0f);
+    data[1] = 0;
+    data[2] = (uint8_t)fminf(fmaxf(roundf(t), 0.0f), 50.0f);
+    data[3] = 0;
+    data[4] = data[0] + data[1] + data[2] + data[3];
+
+    // a flipped bit on the wire, the driver's checksum catches it
+    if (sim_fault_inject(SIM_FAULT_DHT11_CRC)) {
+        data[2] ^= 0x01;
+    } else {
+        sim_fault_ok(SIM_FAULT_DHT11_CRC);
+    }
+    return ESP_OK;
+}
+
+void sim_set_ble(sim_remote_cb_t remote, sim_advert_cb_t advert) {
+    remote_cb = remote;
+    advert_cb = advert;
+}
+
+bool sim_parse_duration(const char *text, int64_t *us) {
+    char *end;
+    double value = strtod(text, &end);
+
+    if (end == text || value < 0.0) {
+        return false;
+    }
+    double scale = (strcmp(end, "ms") == 0) ? 1e3 : (strcmp(end, "s") == 0) ? 1e6 : (strcmp(end, "m") == 0) ? 60e6 :
+                   (strcmp(end, "h") == 0) ? 3600e6 : (strcmp(end, "d") == 0) ? 86400e6 : 0.0;
+    if (scale == 0.0) {
+        return false;
+    }
+    *us = (int64_t)llround(value * scale);
+    return true;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t sim_parse_line(char **tokens, int count, int line, int64_t *last_us) {
+    // header directives: no time
+    if (strcmp(tokens[0], "start") == 0 && count == 3) {
+        struct tm tm = { 0 };
+        if (sscanf(tokens[1], "%d-%d-%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday) != 3 ||
+            sscanf(tokens[2], "%d:%d", &tm.tm_hour, &tm.tm_min) != 2) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        epoch = timegm(&tm);
+        return ESP_OK;
+    }
+    if (strcmp(tokens[0], "phone") == 0 && count == 3) {
+        unsigned int b[6];
+        if (phone_count >= SIM_MAX_PHONES ||
+            sscanf(tokens[2], "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        sim_phone_t *phone = &phones[phone_count++];
+        strncpy(phone->name, tokens[1], sizeof(phone->name) - 1);
+        for (int i = 0; i < 6; i++) {
+            phone->addr[i] = (uint8_t)b[5 - i];
+        }
+        return ESP_OK;
+    }
+
+    // timed actions: absolute, or +relative to the previous line
+    if (count < 2 || action_count >= SIM_MAX_ACTIONS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (action_count > 0 && actions[action_count - 1].type == SIM_ACTION_REPEAT) {
+        ESP_LOGE(TAG, "line %d: repeat has to be the last line", line);
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t time_us;
+    bool relative = (tokens[0][0] == '+');
+    if (!sim_parse_duration(tokens[0] + relative, &time_us)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    time_us += relative ? *last_us : 0;
+    if (time_us < *last_us) {
+        ESP_LOGE(TAG, "line %d: actions must be in time order", line);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // fault windows are scheduled, not applied
+    if (strcmp(tokens[1], "fault") == 0) {
+        esp_err_t ret = sim_parse_fault(tokens, count, line, time_us);
+        if (ret == ESP_OK) {
+            *last_us = time_us;
+        }
+        return ret;
+    }
+
+    sim_action_t *action = &actions[action_count];
+    memset(action, 0, sizeof(*action));
+    action->time_us = time_us;
+    action->line = line;
+    const char *device = tokens[1];
+    bool ok = false;
+
+    if (strcmp(device, "pir") == 0 && count == 3) {
+        action->type = SIM_ACTION_GPIO;
+        action->index = pir_pin;
+        ok = pir_pin >= 0 && sim_parse_float(tokens[2], &action->value);
+    } else if (strcmp(device, "gpio") == 0 && count == 4) {
+        action->type = SIM_ACTION_GPIO;
+        action->index = atoi(tokens[2]);
+        ok = action->index >= 0 && action->index < SIM_GPIO_COUNT && sim_parse_float(tokens[3], &action->value);
+    } else if (strcmp(device, "distance") == 0 && count == 3 && strcmp(tokens[2], "none") == 0) {
+        action->type = SIM_ACTION_DISTANCE_NONE;
+        ok = true;
+    } else if ((strcmp(device, "distance") == 0 || strcmp(device, "temperature") == 0 ||
+                strcmp(device, "humidity") == 0) && (count == 3 || count == 5)) {
+        action->type = (device[0] == 'd') ? SIM_ACTION_DISTANCE :
+                       (device[0] == 't') ? SIM_ACTION_TEMPERATURE : SIM_ACTION_HUMIDITY;
+        ok = sim_parse_float(tokens[2], &action->value);
+        action->to = action->value;
+        if (ok && count == 5) {
+            ok = sim_parse_float(tokens[3], &action->to) && sim_parse_duration(tokens[4], &action->over_us);
+        }
+    } else if (strcmp(device, "remote") == 0 && count >= 3) {
+        action->type = SIM_ACTION_REMOTE;
+        if (strcmp(tokens[2], "connect") == 0 && count == 3) {
+            action->remote = SIM_REMOTE_CONNECT;
+            ok = true;
+        } else if (strcmp(tokens[2], "disconnect") == 0 && count == 3) {
+            action->remote = SIM_REMOTE_DISCONNECT;
+            ok = true;
+        } else if (strcmp(tokens[2], "motion") == 0 && count == 4) {
+            action->remote = SIM_REMOTE_MOTION;
+            ok = sim_parse_float(tokens[3], &action->value);
+        }
+    } else if (strcmp(device, "phone") == 0 && count == 4) {
+        action->type = SIM_ACTION_PHONE;
+        action->index = sim_find_phone(tokens[2]);
+        action->value = 0.0f;
+        ok = action->index >= 0 && (strcmp(tokens[3], "off") == 0 || sim_parse_float(tokens[3], &action->value));
+        action->to = (strcmp(tokens[3], "off") == 0) ? 0.0f : 1.0f;
+    } else if (strcmp(device, "expect") == 0 && (count == 6 || (count == 8 && strcmp(tokens[6], "as") == 0)) &&
+               strcmp(tokens[2], "lcd") == 0 && strcmp(tokens[4], "within") == 0) {
+        action->type = SIM_ACTION_EXPECT;
+        ok = strlen(tokens[3]) <= SIM_LCD_COLUMNS && sim_parse_duration(tokens[5], &action->over_us) &&
+             (count == 6 || strlen(tokens[7]) < SIM_EXPECT_LABEL_LEN);
+        strncpy(action->text, tokens[3], SIM_LCD_COLUMNS);
+        if (count == 8) {
+            strncpy(action->label, tokens[7], SIM_EXPECT_LABEL_LEN - 1);
+        }
+    } else if (strcmp(device, "end") == 0 && count == 2) {
+        action->type = SIM_ACTION_END;
+        ok = true;
+    } else if (strcmp(device, "repeat") == 0 && count == 3) {
+        action->type = SIM_ACTION_REPEAT;
+        action->index = atoi(tokens[2]);
+        ok = action->index >= 1 && time_us > 0;
+    }
+
+    if (!ok) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    action_count++;
+    *last_us = time_us;
+    return ESP_OK;
+}
+
+static esp_err_t sim_parse_fault(char **tokens, int count, int line, int64_t time_us) {
+    float probability;
+    int64_t duration_us = 0;
+    uint32_t burst = 1;
+
+    if (count < 4 || (count % 2) != 0 || !sim_parse_float(tokens[3], &probability)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 4; i < count; i += 2) {
+        float value;
+        if (strcmp(tokens[i], "burst") == 0 && sim_parse_float(tokens[i + 1], &value) && value >= 1.0f) {
+            burst = (uint32_t)value;
+        } else if (strcmp(tokens[i], "for") == 0 && sim_parse_duration(tokens[i + 1], &duration_us)) {
+            continue;
+        } else {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return sim_fault_add(tokens[2], time_us, duration_us ? time_us + duration_us : INT64_MAX, probability, burst,
+                         line);
+}
+
+static int sim_tokenize(char *line, char **tokens) {
+    int count = 0;
+    char *p = line;
+
+    while (count < SIM_MAX_TOKENS) {
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            break;
+        }
+        if (*p == '"') {
+            tokens[count++] = ++p;
+            p = strchr(p, '"');
+            if (p == NULL) {
+                break;
+            }
+        } else {
+            tokens[count++] = p;
+            while (*p != '\0' && !isspace((unsigned char)*p)) {
+                p++;
+            }
+            if (*p == '\0') {
+                break;
+            }
+        }
+        *p++ = '\0';
+    }
+    return count;
+}
+
+static bool sim_parse_float(const char *text, float *value) {
+    char *end;
+    *value = strtof(text, &end);
+    return end != text && *end == '\0';
+}
+
+static int sim_find_phone(const char *name) {
+    for (int i = 0; i < phone_count; i++) {
+        if (strcmp(phones[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static float sim_ramp_value(const sim_ramp_t *ramp, int64_t now_us) {
+    if (ramp->over_us <= 0 || now_us >= ramp->start_us + ramp->over_us) {
+        return ramp->to;
+    }
+    if (now_us <= ramp->start_us) {
+        return ramp->from;
+    }
+    return ramp->from + (ramp->to - ramp->from) * (float)(now_us - ramp->start_us) / (float)ramp->over_us;
+}
+
+static void sim_ramp_set(sim_ramp_t *ramp, const sim_action_t *action, int64_t time_us) {
+    ramp->from = action->value;
+    ramp->to = action->to;
+    ramp->start_us = time_us;
+    ramp->over_us = action->over_us;
+}
+
+static bool sim_apply(const sim_action_t *action, int64_t time_us) {
+    switch (action->type) {
+        case SIM_ACTION_GPIO:
+            if (action->index == pir_pin && gpio_levels[pir_pin] != (action->value != 0.0f)) {
+                pir_edge_us = time_us;
+            }
+            gpio_levels[action->index] = (action->value != 0.0f);
+            break;
+
+        case SIM_ACTION_DISTANCE:
+            portENTER_CRITICAL(&device_lock);
+            distance_present = true;
+            sim_ramp_set(&distance, action, time_us);
+            portEXIT_CRITICAL(&device_lock);
+            break;
+
+        case SIM_ACTION_DISTANCE_NONE:
+            distance_present = false;
+            break;
+
+        case SIM_ACTION_TEMPERATURE:
+            portENTER_CRITICAL(&device_lock);
+            sim_ramp_set(&temperature, action, time_us);
+            portEXIT_CRITICAL(&device_lock);
+            break;
+
+        case SIM_ACTION_HUMIDITY:
+            portENTER_CRITICAL(&device_lock);
+            sim_ramp_set(&humidity, action, time_us);
+            portEXIT_CRITICAL(&device_lock);
+            break;
+
+        case SIM_ACTION_REMOTE:
+            if (action->remote != SIM_REMOTE_MOTION) {
+                remote_connected = (action->remote == SIM_REMOTE_CONNECT);
+                link_dropped = false;
+            } else if (sim_fault_inject(SIM_FAULT_BLE_DROP)) {
+                ESP_LOGI(TAG, "line %d: remote notification dropped", action->line);
+                break;
+            } else {
+                sim_fault_ok(SIM_FAULT_BLE_DROP);
+            }
+            if (remote_cb != NULL) {
+                remote_cb(action->remote, action->value != 0.0f);
+            }
+            break;
+
+        case SIM_ACTION_PHONE:
+            phones[action->index].advertising = (action->to != 0.0f);
+            phones[action->index].rssi = (int8_t)action->value;
+            break;
+
+        case SIM_ACTION_EXPECT:
+            sim_lcd_expect(action->text, action->label, action->over_us, action->line);
+            break;
+
+        case SIM_ACTION_END:
+        case SIM_ACTION_REPEAT:
+            return true;
+    }
+    return false;
+}
+
+static void sim_second(void) {
+    for (int i = 0; i < phone_count; i++) {
+        if (!phones[i].advertising || advert_cb == NULL) {
+            continue;
+        }
+        if (sim_fault_inject(SIM_FAULT_BLE_DROP)) {
+            continue;
+        }
+        sim_fault_ok(SIM_FAULT_BLE_DROP);
+        advert_cb(phones[i].addr, phones[i].rssi);
+    }
+
+    // the link stays down for the burst, then the remote reconnects
+    if (!remote_connected || remote_cb == NULL) {
+        return;
+    }
+    if (sim_fault_inject(SIM_FAULT_BLE_DISCONNECT)) {
+        if (!link_dropped) {
+            link_dropped = true;
+            remote_cb(SIM_REMOTE_DISCONNECT, false);
+        }
+        return;
+    }
+    if (link_dropped) {
+        link_dropped = false;
+        remote_cb(SIM_REMOTE_CONNECT, false);
+    }
+    sim_fault_ok(SIM_FAULT_BLE_DISCONNECT);
+}
+
+static void sim_runner_task(void *pvParameters) {
+    int64_t next_second = SIM_ADVERT_PERIOD_MS * 1000;
+    int64_t next_fault = sim_fault_poll(0);
+    int64_t offset_us = 0;          // start of the current round of a repeated script
+    int round = 1;
+    int next = 0;
+
+    while (1) {
+        int64_t due = actions[next].time_us + offset_us;
+        if (next_second < due) {
+            due = next_second;
+        }
+        if (next_fault < due) {
+            due = next_fault;
+        }
+        TickType_t ticks = sim_ticks_until(due);
+        if (ticks > 0) {
+            vTaskDelay(ticks);
+            continue;
+        }
+
+        // actions first, an advert at the same time sees their effect
+        int64_t now = sim_now_us();
+        while (actions[next].time_us + offset_us <= now) {
+            const sim_action_t *action = &actions[next++];
+            if (action->type == SIM_ACTION_REPEAT && round < action->index) {
+                round++;
+                offset_us += action->time_us;
+                next = 0;
+            } else if (sim_apply(action, action->time_us + offset_us)) {
+                end_callback();
+                vTaskSuspend(NULL);
+            }
+        }
+        if (next_fault <= now) {
+            next_fault = sim_fault_poll(now);
+        }
+        if (next_second <= now) {
+            sim_second();
+            next_second += SIM_ADVERT_PERIOD_MS * 1000;
+        }
+    }
+}
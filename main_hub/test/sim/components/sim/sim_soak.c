@@ -0,0 +1,526 @@
+/**
+ * @file sim_soak.c
+ * @author Anthony Yalong
+ * @brief Soak sampler - heap, fragmentation, tasks, queue depths, flash
+ *        writes and latency percentiles over a long run, with drift
+ *        detection and flash wear at the end
+ */
+
+#include "sim.h"
+#include <inttypes.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "sim_priv.h"
+
+static const char *TAG = "SIM_SOAK";
+
+#define SIM_SOAK_BUCKETS        320         // 16 linear us, then 8 per power of two
+#define SIM_SOAK_QUEUE_NAME     24
+#define SIM_FLASH_SECTOR        4096
+#define SIM_FLASH_SECTORS       1024        // 4 MB emulated flash
+#define SIM_FLASH_ENDURANCE     100000      // erase cycles per sector
+
+/**
+ * @brief Sampled metrics, the ones drift is checked on
+ */
+typedef enum {
+    SIM_SOAK_HEAP = 0,              // bytes allocated
+    SIM_SOAK_HOLES,                 // free bytes between allocations, % of the heap
+    SIM_SOAK_CHUNKS,                // free chunks
+    SIM_SOAK_TASKS,
+    SIM_SOAK_QUEUE,                 // deepest queue during the period
+    SIM_SOAK_FLASH,                 // bytes written during the period
+    SIM_SOAK_P99,                   // p99 per timed path during the period (ms)
+    SIM_SOAK_METRIC_COUNT = SIM_SOAK_P99 + SIM_PATH_COUNT,
+} sim_soak_metric_t;
+
+/**
+ * @brief How a metric is printed and how much change is drift
+ */
+typedef struct {
+    const char *name;
+    const char *unit;
+    double floor;                   // smaller absolute changes are never drift
+} sim_soak_info_t;
+
+/**
+ * @brief One sample
+ */
+typedef struct {
+    int64_t time_us;
+    double values[SIM_SOAK_METRIC_COUNT];   // NAN when a path had no samples
+} sim_soak_sample_t;
+
+/**
+ * @brief Queue created by the hub or the simulator
+ */
+typedef struct {
+    QueueHandle_t queue;
+    char name[SIM_SOAK_QUEUE_NAME];         // creating task and geometry
+    UBaseType_t peak;                       // since the last sample
+    UBaseType_t run_peak;
+} sim_soak_queue_t;
+
+static const sim_soak_info_t infos[SIM_SOAK_METRIC_COUNT] = {
+    { "heap", "B", 4096.0 },
+    { "heap holes", "%", 5.0 },
+    { "free chunks", "", 16.0 },
+    { "tasks", "", 0.5 },
+    { "queue peak", "", 1.0 },
+    { "flash writes", "B", 512.0 },
+    { "pir p99", "ms", 1.0 },
+    { "distance p99", "ms", 1.0 },
+    { "climate p99", "ms", 1.0 },
+    { "lcd p99", "ms", 1.0 },
+};
+static const char *const path_names[SIM_PATH_COUNT] = {
+    "pir", "distance", "climate", "lcd",
+};
+
+static portMUX_TYPE soak_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t period_us;
+static FILE *csv;
+static sim_soak_sample_t *samples;
+static int sample_count;
+static bool samples_full;
+
+// fed by the simulated devices and the wrapped calls
+static uint32_t period_hist[SIM_PATH_COUNT][SIM_SOAK_BUCKETS];
+static uint32_t run_hist[SIM_PATH_COUNT][SIM_SOAK_BUCKETS];
+static int64_t run_max_us[SIM_PATH_COUNT];
+static sim_soak_queue_t queues[SIM_SOAK_MAX_QUEUES];
+static int queue_count;
+static uint64_t flash_bytes;
+static uint64_t flash_writes;
+static uint64_t flash_period_bytes;
+static uint32_t erases[SIM_FLASH_SECTORS];
+static uint64_t erase_total;
+static __thread bool in_flash_write;        // esp_partition_write may call the raw write
+
+// linked to __wrap_* (-Wl,--wrap=...)
+QueueHandle_t __real_xQueueGenericCreate(const UBaseType_t length, const UBaseType_t item_size, const uint8_t type);
+BaseType_t __real_xQueueGenericSend(QueueHandle_t queue, const void *const item, TickType_t wait,
+                                    const BaseType_t position);
+esp_err_t __real_esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t size);
+esp_err_t __real_esp_partition_write_raw(const esp_partition_t *partition, size_t offset, const void *src,
+                                         size_t size);
+esp_err_t __real_esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+QueueHandle_t __wrap_xQueueGenericCreate(const UBaseType_t length, const UBaseType_t item_size, const uint8_t type);
+BaseType_t __wrap_xQueueGenericSend(QueueHandle_t queue, const void *const item, TickType_t wait,
+                                    const BaseType_t position);
+esp_err_t __wrap_esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t size);
+esp_err_t __wrap_esp_partition_write_raw(const esp_partition_t *partition, size_t offset, const void *src,
+                                         size_t size);
+esp_err_t __wrap_esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief Sampler task - one sample per period
+ *
+ * @param pvParameters Unused
+ */
+static void sim_soak_task(void *pvParameters);
+
+/**
+ * @brief Take, log and store one sample, and start the next period
+ *
+ * @param time_us Sample time
+ */
+static void sim_soak_take(int64_t time_us);
+
+/**
+ * @brief Histogram bucket of a latency
+ *
+ * @param latency_us Latency
+ * @return int Bucket
+ */
+static int sim_soak_bucket(int64_t latency_us);
+
+/**
+ * @brief Percentile of a histogram (bucket upper edge)
+ *
+ * @param hist Histogram
+ * @param fraction Percentile as a fraction, 0.99 for p99
+ * @return int64_t Latency in microseconds, -1 for an empty histogram
+ */
+static int64_t sim_soak_percentile(const uint32_t *hist, double fraction);
+
+/**
+ * @brief Count a flash write
+ *
+ * @param ret Result of the write
+ * @param size Bytes
+ */
+static void sim_soak_flash_write(esp_err_t ret, size_t size);
+
+/**
+ * @brief Mean of a metric over a sample range, NAN samples skipped
+ *
+ * @param metric Metric
+ * @param from First sample
+ * @param to One past the last sample
+ * @return double Mean, NAN if no sample had a value
+ */
+static double sim_soak_mean(int metric, int from, int to);
+
+/**
+ * @brief Least squares slope of a metric over a sample range
+ *
+ * @param metric Metric
+ * @param from First sample
+ * @param to One past the last sample
+ * @return double Change per day, NAN with fewer than two values
+ */
+static double sim_soak_slope(int metric, int from, int to);
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+esp_err_t sim_soak_start(int64_t period, const char *csv_path) {
+    samples = calloc(SIM_SOAK_MAX_SAMPLES, sizeof(sim_soak_sample_t));
+    if (samples == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (csv_path != NULL) {
+        csv = fopen(csv_path, "w");
+        if (csv == NULL) {
+            ESP_LOGE(TAG, "cannot open %s", csv_path);
+            return ESP_ERR_NOT_FOUND;
+        }
+        fprintf(csv, "time_s");
+        for (int metric = 0; metric < SIM_SOAK_METRIC_COUNT; metric++) {
+            fputc(',', csv);
+            for (const char *c = infos[metric].name; *c != '\0'; c++) {
+                fputc((*c == ' ') ? '_' : *c, csv);
+            }
+            fprintf(csv, "%s%s", infos[metric].unit[0] ? "_" : "", infos[metric].unit);
+        }
+        fprintf(csv, "\n");
+    }
+
+    // above every hub task, a sample is taken at its time
+    period_us = period;
+    if (xTaskCreate(sim_soak_task, "sim_soak", SIM_TASK_STACK, NULL, SIM_TASK_PRIORITY, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void sim_soak_path(sim_path_t path, int64_t latency_us) {
+    if (period_us == 0) {
+        return;
+    }
+    int bucket = sim_soak_bucket(latency_us);
+
+    portENTER_CRITICAL(&soak_lock);
+    period_hist[path][bucket]++;
+    run_hist[path][bucket]++;
+    if (latency_us > run_max_us[path]) {
+        run_max_us[path] = latency_us;
+    }
+    portEXIT_CRITICAL(&soak_lock);
+}
+
+uint32_t sim_soak_report(void) {
+    uint32_t drifting = 0;
+
+    if (period_us == 0) {
+        return 0;
+    }
+    if (csv != NULL) {
+        fclose(csv);
+    }
+    int64_t end_us = sim_now_us();
+    double days = end_us / 86400e6;
+
+    printf("soak: %d samples every %.0f s\n", sample_count, period_us / 1e6);
+    portENTER_CRITICAL(&soak_lock);
+    static const double fractions[] = { 0.5, 0.9, 0.99, 0.999 };
+    for (int path = 0; path < SIM_PATH_COUNT; path++) {
+        if (sim_soak_percentile(run_hist[path], 0.5) < 0) {
+            continue;
+        }
+        printf("  %-8s", path_names[path]);
+        for (size_t i = 0; i < sizeof(fractions) / sizeof(fractions[0]); i++) {
+            // bucket edges can overshoot the largest sample
+            int64_t value = sim_soak_percentile(run_hist[path], fractions[i]);
+            printf(" p%g %8.1f", fractions[i] * 100, (value < run_max_us[path] ? value : run_max_us[path]) / 1e3);
+        }
+        printf("  max %8.1f ms\n", run_max_us[path] / 1e3);
+    }
+    for (int i = 0; i < queue_count; i++) {
+        printf("  queue %-20s peak %lu\n", queues[i].name, (unsigned long)queues[i].run_peak);
+    }
+
+    // wear: the most erased sector against the rated cycles
+    uint32_t worst = 0;
+    int worst_sector = 0;
+    for (int sector = 0; sector < SIM_FLASH_SECTORS; sector++) {
+        if (erases[sector] > worst) {
+            worst = erases[sector];
+            worst_sector = sector;
+        }
+    }
+    printf("  flash: %llu B in %llu writes (%.0f B/day), %llu sector erases, most %lu at 0x%06x",
+           (unsigned long long)flash_bytes, (unsigned long long)flash_writes, days > 0 ? flash_bytes / days : 0.0,
+           (unsigned long long)erase_total, (unsigned long)worst, worst_sector * SIM_FLASH_SECTOR);
+    if (worst > 0 && days > 0) {
+        printf(" (%.1f years to %d cycles)", (SIM_FLASH_ENDURANCE - worst) / (worst / days) / 365.0,
+               SIM_FLASH_ENDURANCE);
+    }
+    printf("\n");
+    portEXIT_CRITICAL(&soak_lock);
+
+    // drift: last quarter against the first, after a warm-up tenth
+    int warmup = (sample_count + 9) / 10;
+    int quarter = (sample_count - warmup) / 4;
+    if (quarter < 2) {
+        printf("  too few samples for drift (%d)\n", sample_count);
+        return 0;
+    }
+    printf("  %-14s %12s %12s %12s   (first/last quarter after %d samples)\n", "metric", "first", "last", "per day",
+           warmup);
+    for (int metric = 0; metric < SIM_SOAK_METRIC_COUNT; metric++) {
+        double first = sim_soak_mean(metric, warmup, warmup + quarter);
+        double last = sim_soak_mean(metric, sample_count - quarter, sample_count);
+        if (isnan(first) || isnan(last)) {
+            continue;
+        }
+        double change = last - first;
+        bool drift = fabs(change) > infos[metric].floor && fabs(change) > fabs(first) * SIM_SOAK_DRIFT_PCT / 100.0;
+        drifting += drift;
+        printf("  %-14s %12.1f %12.1f %+12.2f %s%s\n", infos[metric].name, first, last,
+               sim_soak_slope(metric, warmup, sample_count), infos[metric].unit, drift ? "  <-- DRIFT" : "");
+    }
+    return drifting;
+}
+
+QueueHandle_t __wrap_xQueueGenericCreate(const UBaseType_t length, const UBaseType_t item_size, const uint8_t type) {
+    QueueHandle_t queue = __real_xQueueGenericCreate(length, item_size, type);
+
+    // queues only, semaphores and mutexes are created here too
+    if (queue == NULL || type != queueQUEUE_TYPE_BASE || item_size == 0) {
+        return queue;
+    }
+    portENTER_CRITICAL(&soak_lock);
+    if (queue_count < SIM_SOAK_MAX_QUEUES) {
+        sim_soak_queue_t *entry = &queues[queue_count++];
+        entry->queue = queue;
+        snprintf(entry->name, sizeof(entry->name), "%.12s %lux%lu", pcTaskGetName(NULL), (unsigned long)length,
+                 (unsigned long)item_size);
+    }
+    portEXIT_CRITICAL(&soak_lock);
+    return queue;
+}
+
+BaseType_t __wrap_xQueueGenericSend(QueueHandle_t queue, const void *const item, TickType_t wait,
+                                    const BaseType_t position) {
+    BaseType_t sent = __real_xQueueGenericSend(queue, item, wait, position);
+
+    if (sent != pdTRUE) {
+        return sent;
+    }
+    UBaseType_t depth = uxQueueMessagesWaiting(queue);
+    portENTER_CRITICAL(&soak_lock);
+    for (int i = 0; i < queue_count; i++) {
+        if (queues[i].queue == queue) {
+            if (depth > queues[i].peak) {
+                queues[i].peak = depth;
+            }
+            if (depth > queues[i].run_peak) {
+                queues[i].run_peak = depth;
+            }
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&soak_lock);
+    return sent;
+}
+
+esp_err_t __wrap_esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t size) {
+    bool outer = !in_flash_write;
+    in_flash_write = true;
+    esp_err_t ret = __real_esp_partition_write(partition, offset, src, size);
+    in_flash_write = !outer;
+    if (outer) {
+        sim_soak_flash_write(ret, size);
+    }
+    return ret;
+}
+
+esp_err_t __wrap_esp_partition_write_raw(const esp_partition_t *partition, size_t offset, const void *src,
+                                         size_t size) {
+    esp_err_t ret = __real_esp_partition_write_raw(partition, offset, src, size);
+    if (!in_flash_write) {
+        sim_soak_flash_write(ret, size);
+    }
+    return ret;
+}
+
+esp_err_t __wrap_esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size) {
+    esp_err_t ret = __real_esp_partition_erase_range(partition, offset, size);
+
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    portENTER_CRITICAL(&soak_lock);
+    for (size_t address = partition->address + offset; address < partition->address + offset + size;
+         address += SIM_FLASH_SECTOR) {
+        if (address / SIM_FLASH_SECTOR < SIM_FLASH_SECTORS) {
+            erases[address / SIM_FLASH_SECTOR]++;
+            erase_total++;
+        }
+    }
+    portEXIT_CRITICAL(&soak_lock);
+    return ret;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static void sim_soak_task(void *pvParameters) {
+    int64_t next = period_us;
+
+    while (1) {
+        TickType_t ticks = sim_ticks_until(next);
+        if (ticks > 0) {
+            vTaskDelay(ticks);
+            continue;
+        }
+        sim_soak_take(next);
+        next += period_us;
+    }
+}
+
+static void sim_soak_take(int64_t time_us) {
+    struct mallinfo2 info = mallinfo2();
+    sim_soak_sample_t sample = { .time_us = time_us };
+
+    sample.values[SIM_SOAK_HEAP] = info.uordblks;
+    sample.values[SIM_SOAK_HOLES] = info.arena ? 100.0 * (info.fordblks - info.keepcost) / info.arena : 0.0;
+    sample.values[SIM_SOAK_CHUNKS] = info.ordblks;
+    sample.values[SIM_SOAK_TASKS] = uxTaskGetNumberOfTasks();
+
+    portENTER_CRITICAL(&soak_lock);
+    UBaseType_t peak = 0;
+    for (int i = 0; i < queue_count; i++) {
+        if (queues[i].peak > peak) {
+            peak = queues[i].peak;
+        }
+        queues[i].peak = 0;
+    }
+    sample.values[SIM_SOAK_QUEUE] = peak;
+    sample.values[SIM_SOAK_FLASH] = flash_period_bytes;
+    flash_period_bytes = 0;
+    for (int path = 0; path < SIM_PATH_COUNT; path++) {
+        int64_t p99 = sim_soak_percentile(period_hist[path], 0.99);
+        sample.values[SIM_SOAK_P99 + path] = (p99 < 0) ? NAN : p99 / 1e3;
+    }
+    memset(period_hist, 0, sizeof(period_hist));
+    portEXIT_CRITICAL(&soak_lock);
+
+    ESP_LOGI(TAG, "heap %.0f B, %.1f%% holes in %.0f chunks, %.0f tasks, queue peak %.0f, flash %.0f B, "
+             "p99 pir %.1f distance %.1f climate %.1f lcd %.1f ms",
+             sample.values[SIM_SOAK_HEAP], sample.values[SIM_SOAK_HOLES], sample.values[SIM_SOAK_CHUNKS],
+             sample.values[SIM_SOAK_TASKS], sample.values[SIM_SOAK_QUEUE], sample.values[SIM_SOAK_FLASH],
+             sample.values[SIM_SOAK_P99 + SIM_PATH_PIR], sample.values[SIM_SOAK_P99 + SIM_PATH_DISTANCE],
+             sample.values[SIM_SOAK_P99 + SIM_PATH_CLIMATE], sample.values[SIM_SOAK_P99 + SIM_PATH_LCD]);
+    if (csv != NULL) {
+        fprintf(csv, "%" PRId64, time_us / 1000000);
+        for (int metric = 0; metric < SIM_SOAK_METRIC_COUNT; metric++) {
+            fprintf(csv, isnan(sample.values[metric]) ? "," : ",%.3f", sample.values[metric]);
+        }
+        fprintf(csv, "\n");
+    }
+
+    if (sample_count < SIM_SOAK_MAX_SAMPLES) {
+        samples[sample_count++] = sample;
+    } else if (!samples_full) {
+        ESP_LOGW(TAG, "more than %d samples, later ones are not checked for drift", SIM_SOAK_MAX_SAMPLES);
+        samples_full = true;
+    }
+}
+
+static int sim_soak_bucket(int64_t latency_us) {
+    if (latency_us < 16) {
+        return (latency_us < 0) ? 0 : (int)latency_us;
+    }
+    int octave = 63 - __builtin_clzll((uint64_t)latency_us);
+    int bucket = 16 + (octave - 4) * 8 + (int)((latency_us >> (octave - 3)) & 7);
+    return (bucket < SIM_SOAK_BUCKETS) ? bucket : SIM_SOAK_BUCKETS - 1;
+}
+
+static int64_t sim_soak_percentile(const uint32_t *hist, double fraction) {
+    uint64_t total = 0;
+
+    for (int bucket = 0; bucket < SIM_SOAK_BUCKETS; bucket++) {
+        total += hist[bucket];
+    }
+    if (total == 0) {
+        return -1;
+    }
+    uint64_t rank = (uint64_t)ceil(total * fraction);
+    uint64_t seen = 0;
+    int bucket = 0;
+    while (bucket < SIM_SOAK_BUCKETS - 1 && (seen += hist[bucket]) < rank) {
+        bucket++;
+    }
+    if (bucket < 16) {
+        return bucket;
+    }
+    int octave = (bucket - 16) / 8 + 4;
+    return ((int64_t)(9 + (bucket - 16) % 8) << (octave - 3)) - 1;
+}
+
+static void sim_soak_flash_write(esp_err_t ret, size_t size) {
+    if (ret != ESP_OK) {
+        return;
+    }
+    portENTER_CRITICAL(&soak_lock);
+    flash_bytes += size;
+    flash_period_bytes += size;
+    flash_writes++;
+    portEXIT_CRITICAL(&soak_lock);
+}
+
+static double sim_soak_mean(int metric, int from, int to) {
+    double sum = 0.0;
+    int count = 0;
+
+    for (int i = from; i < to; i++) {
+        if (!isnan(samples[i].values[metric])) {
+            sum += samples[i].values[metric];
+            count++;
+        }
+    }
+    return count ? sum / count : NAN;
+}
+
+static double sim_soak_slope(int metric, int from, int to) {
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    int count = 0;
+
+    for (int i = from; i < to; i++) {
+        double y = samples[i].values[metric];
+        if (isnan(y)) {
+            continue;
+        }
+        double x = samples[i].time_us / 86400e6;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        count++;
+    }
+    double denominator = count * sxx - sx * sx;
+    return (count < 2 || denominator == 0.0) ? NAN : (count * sxy - sx * sy) / denominator;
+}
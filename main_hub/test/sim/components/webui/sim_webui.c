@@ -0,0 +1,22 @@
+/**
+ * @file sim_webui.c
+ * @author Anthony Yalong
+ * @brief Web ui stand-in - no network, no server
+ */
+
+#include "webui.h"
+#include <string.h>
+
+esp_err_t webui_start(webui_t *webui, webui_status_cb_t status_cb, void *arg) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t webui_register_uri(webui_t *webui, const httpd_uri_t *uri) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void webui_get_stats(const webui_t *webui, webui_stats_t *stats) {
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
@@ -0,0 +1,897 @@
+/**
+ * @file sim_bench.c
+ * @author Anthony Yalong
+ * @brief Hub micro-benchmarks on the simulator - dht11 decode, distance
+ *        conversion, the lcd frame, the sensor snapshot, history insert and
+ *        query, the telemetry codec, the replay log and sensor dispatch,
+ *        written as json for tools/bench_compare.py
+ */
+
+// imports
+#include "sim_bench.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "analog_sensor.h"
+#include "compressor.h"
+#include "dht11.h"
+#include "driver/i2c.h"
+#include "ds18b20.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "hcsr04.h"
+#include "history.h"
+#include "lcd_i2c.h"
+#include "lockprof.h"
+#include "replay.h"
+#include "sensor.h"
+#include "sim.h"
+#include "main_hub_system_config.h"
+
+static const char *TAG = "HUB_BENCH";
+
+// benchmark configuration
+#define BENCH_DHT11_FRAMES          2000
+#define BENCH_DHT11_CORRUPT         50                      // every n-th frame has one bit flipped
+#define BENCH_DISTANCE_MAX_US       30000                   // every echo width up to the hub's timeout
+#define BENCH_LCD_FRAMES            10
+#define BENCH_I2C_BITS_PER_BYTE     9                       // 8 data + ack
+#define BENCH_SNAPSHOT_OPS          100000
+#define BENCH_HISTORY_CHANNELS      4
+#define BENCH_HISTORY_RECORDS       (HISTORY_CAPACITY * 2)  // the ring wraps once
+#define BENCH_HISTORY_WINDOW_S      600                     // query: last ten minutes of one channel
+#define BENCH_HISTORY_CHUNK         32                      // records per read, as the exporter
+#define BENCH_CODEC_SAMPLES         86400                   // a day of 1 Hz zone temperature
+#define BENCH_PI_F                  3.14159265f
+#define BENCH_REPLAY_STEPS          36000                   // an hour of pir polls
+#define BENCH_REPLAY_RECORDS        (BENCH_REPLAY_STEPS * 2)
+#define BENCH_REPLAY_PAGES          64
+#define BENCH_REPLAY_EPISODE_STEPS  300                     // 30 s of polls per motion episode
+#define BENCH_REPLAY_EPISODE_EVERY  6000                    // one episode every ten minutes
+#define BENCH_REPLAY_WALL_US        11600                   // echo off a wall 2 m away
+#define BENCH_SENSOR_STEPS          36000                   // an hour of pir periods
+#define BENCH_SENSOR_SPLIT_US       18000                   // dht11 start signal
+
+/**
+ * @brief One result value
+ */
+typedef struct {
+    const char *name;
+    double value;
+} bench_metric_t;
+
+/**
+ * @brief Results of one benchmark
+ */
+typedef struct {
+    const char *name;
+    bench_metric_t metrics[SIM_BENCH_MAX_METRICS];
+    int count;
+} bench_result_t;
+
+/**
+ * @brief Benchmark - fills in its metrics
+ */
+typedef esp_err_t (*bench_fn_t)(bench_result_t *result);
+
+/**
+ * @brief The hub's shared sensor data (main.c), same layout and locking
+ */
+typedef struct {
+    bool motion_detected;
+    float distance_cm;
+    float temperature;
+    float humidity;
+    bool remote_motion_detected;
+    bool remote_connected;
+    int32_t analog_levels[ANALOG_MAX_CHANNELS];
+    float zone_temperatures[DS18B20_MAX_DEVICES];
+    uint8_t zone_count;
+    bool armed;
+    SemaphoreHandle_t mutex;
+} bench_snapshot_t;
+
+// inputs and working buffers, too large for the stack
+static uint8_t dht11_pulses[BENCH_DHT11_FRAMES][DHT11_FRAME_BITS];
+static history_t history;
+static float codec_samples[BENCH_CODEC_SAMPLES];
+static compressor_point_t codec_points[BENCH_CODEC_SAMPLES + 1];
+static bench_snapshot_t snapshot;
+static replay_record_t replay_records[BENCH_REPLAY_RECORDS];
+static uint8_t replay_pages[BENCH_REPLAY_PAGES][REPLAY_PAGE_SIZE];
+static sensor_registry_t sensor_registry;
+static uint32_t sensor_state[3];
+static uint64_t sensor_sum;
+
+// ============================================================================
+// Helper Function Prototypes
+// ============================================================================
+/**
+ * @brief DHT11 decode - frames from jittered pulse widths, some corrupted
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK
+ */
+static esp_err_t bench_dht11_decode(bench_result_t *result);
+
+/**
+ * @brief HC-SR04 conversion of every echo width up to the hub's timeout
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK
+ */
+static esp_err_t bench_distance(bench_result_t *result);
+
+/**
+ * @brief The lcd task's frame through the real driver and the lcd model -
+ *        i2c bytes, delay ticks and target time per frame
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK, error code from the driver otherwise, ESP_FAIL
+ *                   if the display does not show the frame
+ */
+static esp_err_t bench_lcd_frame(bench_result_t *result);
+
+/**
+ * @brief Sensor snapshot publish and read under the mutex
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK, ESP_ERR_NO_MEM if the mutex cannot be created
+ */
+static esp_err_t bench_snapshot(bench_result_t *result);
+
+/**
+ * @brief History inserts through a wrap of the ring, then a window query
+ *        formatted as csv
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK, error code from history otherwise
+ */
+static esp_err_t bench_history(bench_result_t *result);
+
+/**
+ * @brief Telemetry codec - the hub's zone compressor over a day, then the
+ *        reconstruction by interpolation
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK, error code from the compressor otherwise
+ */
+static esp_err_t bench_codec(bench_result_t *result);
+
+/**
+ * @brief Replay log - an idle hour of the hub's inputs and decisions packed
+ *        into pages as the recorder does, then decoded and compared
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK, ESP_ERR_NO_MEM if the hour overflows the pages
+ */
+static esp_err_t bench_replay(bench_result_t *result);
+
+/**
+ * @brief Whether a decoded replay record carries the same values as the
+ *        recorded one (fields, not bytes: the union's padding differs)
+ *
+ * @param a Record
+ * @param b Record
+ * @return bool True if equal
+ */
+static bool bench_replay_equal(const replay_record_t *a, const replay_record_t *b);
+
+/**
+ * @brief Sensor dispatch - the hub's pir, hc-sr04 and dht11 schedule for an
+ *        hour through sensor_registry_step() on drivers that do no i/o,
+ *        against the same calls made directly as the per-sensor tasks did
+ *
+ * @param result Output metrics
+ * @return esp_err_t ESP_OK, error code from the registry otherwise
+ */
+static esp_err_t bench_sensor_dispatch(bench_result_t *result);
+
+/**
+ * @brief Bench driver start - split read, poll after the start signal
+ *
+ * @param sensor Counter
+ * @param wait_us Output wait
+ * @return esp_err_t ESP_OK
+ */
+static esp_err_t bench_sensor_start(void *sensor, uint32_t *wait_us);
+
+/**
+ * @brief Bench driver poll - counts the read
+ *
+ * @param sensor Counter
+ * @param wait_us Unused
+ * @return esp_err_t ESP_OK
+ */
+static esp_err_t bench_sensor_poll(void *sensor, uint32_t *wait_us);
+
+/**
+ * @brief Bench driver get - the counter as every value
+ *
+ * @param sensor Counter
+ * @param sample Output sample
+ */
+static void bench_sensor_get(const void *sensor, sensor_sample_t *sample);
+
+/**
+ * @brief Bench sample callback - sums the values so no call is dropped
+ *
+ * @param sample Completed sample
+ * @param arg Unused
+ */
+static void bench_sensor_sink(const sensor_sample_t *sample, void *arg);
+
+/**
+ * @brief Add a metric
+ *
+ * @param result Results
+ * @param name Metric name
+ * @param value Value
+ */
+static void bench_add(bench_result_t *result, const char *name, double value);
+
+/**
+ * @brief Host monotonic clock
+ *
+ * @return int64_t Nanoseconds
+ */
+static int64_t bench_host_ns(void);
+
+/**
+ * @brief Deterministic generator for the inputs
+ *
+ * @param state Generator state, updated
+ * @return uint32_t Next value
+ */
+static uint32_t bench_random(uint32_t *state);
+
+// sensor dispatch drivers, no i/o so only the dispatch is timed
+static const sensor_driver_t bench_level_driver = {
+    .name = "bench_level", .caps = SENSOR_CAP_LEVEL,
+    .poll = bench_sensor_poll, .get = bench_sensor_get,
+};
+static const sensor_driver_t bench_split_driver = {
+    .name = "bench_split", .caps = SENSOR_CAP_TEMPERATURE | SENSOR_CAP_SPLIT,
+    .start = bench_sensor_start, .poll = bench_sensor_poll, .get = bench_sensor_get,
+};
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+int sim_bench_run(const char *json_path) {
+    // error management
+    esp_err_t ret;
+
+    static const struct {
+        const char *name;
+        bench_fn_t run;
+    } benches[] = {
+        { "dht11_decode", bench_dht11_decode },
+        { "distance", bench_distance },
+        { "lcd_frame", bench_lcd_frame },
+        { "snapshot", bench_snapshot },
+        { "history", bench_history },
+        { "codec", bench_codec },
+        { "replay", bench_replay },
+        { "sensor_dispatch", bench_sensor_dispatch },
+    };
+    static bench_result_t results[sizeof(benches) / sizeof(benches[0])];
+    int count = sizeof(benches) / sizeof(benches[0]);
+    int failed = 0;
+
+    for (int i = 0; i < count; i++) {
+        results[i].name = benches[i].name;
+        ret = benches[i].run(&results[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "%s failed: %s", benches[i].name, esp_err_to_name(ret));
+            failed++;
+        }
+    }
+
+    FILE *file = fopen(json_path, "w");
+    if (file == NULL) {
+        ESP_LOGE(TAG, "cannot write %s", json_path);
+        return 1;
+    }
+    fprintf(file, "{\n  \"benchmarks\": {");
+    for (int i = 0; i < count; i++) {
+        printf("%s\n", results[i].name);
+        fprintf(file, "%s\n    \"%s\": {", i ? "," : "", results[i].name);
+        for (int m = 0; m < results[i].count; m++) {
+            const bench_metric_t *metric = &results[i].metrics[m];
+            printf("  %-28s %14.10g\n", metric->name, metric->value);
+            fprintf(file, "%s\"%s\": %.10g", m ? ", " : "", metric->name, metric->value);
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  }\n}\n");
+    if (fclose(file) != 0) {
+        ESP_LOGE(TAG, "cannot write %s", json_path);
+        return 1;
+    }
+
+    fflush(stdout);
+    return failed ? 1 : 0;
+}
+
+// ============================================================================
+// Helper Function Implementation
+// ============================================================================
+static esp_err_t bench_dht11_decode(bench_result_t *result) {
+    uint32_t rng = 1;
+
+    // frames as the sensor sends them: ~26 us zeros, ~70 us ones, +/-4 us
+    for (int f = 0; f < BENCH_DHT11_FRAMES; f++) {
+        uint8_t humidity = 20 + bench_random(&rng) % 71;
+        uint8_t temperature = bench_random(&rng) % 51;
+        uint8_t data[DHT11_FRAME_BITS / 8] = { humidity, 0, temperature, 0, humidity + temperature };
+        for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+            bool bit = data[i / 8] & (1 << (7 - (i % 8)));
+            dht11_pulses[f][i] = (bit ? 66 : 22) + bench_random(&rng) % 9;
+        }
+        if (f % BENCH_DHT11_CORRUPT == BENCH_DHT11_CORRUPT - 1) {
+            uint8_t *pulse = &dht11_pulses[f][bench_random(&rng) % DHT11_FRAME_BITS];
+            *pulse = (*pulse > DHT11_BIT_THRESHOLD_US) ? 26 : 70;
+        }
+    }
+
+    int64_t best_ns = INT64_MAX;
+    uint32_t ok = 0;
+    uint32_t crc_errors = 0;
+    uint64_t value_sum = 0;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        ok = 0;
+        crc_errors = 0;
+        value_sum = 0;
+        int64_t start = bench_host_ns();
+        for (int f = 0; f < BENCH_DHT11_FRAMES; f++) {
+            uint8_t data[DHT11_FRAME_BITS / 8];
+            if (dht11_decode(dht11_pulses[f], data) == ESP_OK) {
+                ok++;
+                value_sum += data[0] + data[2];
+            } else {
+                crc_errors++;
+            }
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        best_ns = (elapsed < best_ns) ? elapsed : best_ns;
+    }
+
+    bench_add(result, "frames", BENCH_DHT11_FRAMES);
+    bench_add(result, "ok", ok);
+    bench_add(result, "crc_errors", crc_errors);
+    bench_add(result, "value_sum", value_sum);
+    bench_add(result, "host_ns_per_frame", (double)best_ns / BENCH_DHT11_FRAMES);
+    return ESP_OK;
+}
+
+static esp_err_t bench_distance(bench_result_t *result) {
+    int64_t best_ns = INT64_MAX;
+    int64_t sum_mm = 0;
+
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        sum_mm = 0;
+        int64_t start = bench_host_ns();
+        for (int64_t pulse_us = 0; pulse_us <= BENCH_DISTANCE_MAX_US; pulse_us++) {
+            sum_mm += (int64_t)(hcsr04_pulse_to_cm(pulse_us) * 10.0f + 0.5f);
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        best_ns = (elapsed < best_ns) ? elapsed : best_ns;
+    }
+
+    bench_add(result, "conversions", BENCH_DISTANCE_MAX_US + 1);
+    bench_add(result, "sum_mm", sum_mm);
+    bench_add(result, "max_cm", hcsr04_pulse_to_cm(BENCH_DISTANCE_MAX_US));
+    bench_add(result, "host_ns_per_op", (double)best_ns / (BENCH_DISTANCE_MAX_US + 1));
+    return ESP_OK;
+}
+
+static esp_err_t bench_lcd_frame(bench_result_t *result) {
+    // error management
+    esp_err_t ret;
+
+    static lcd_handle_t lcd;
+    sim_summary_t before;
+    sim_summary_t after;
+
+    // bus and display as the hub brings them up
+    i2c_config_t config = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+    };
+    ret = i2c_param_config(I2C_MASTER_NUM, &config);
+    if (ret == ESP_OK) {
+        ret = i2c_driver_install(I2C_MASTER_NUM, config.mode, 0, 0, 0);
+    }
+    if (ret == ESP_OK) {
+        ret = lcd_init(&lcd, I2C_MASTER_NUM, LCD_ADDR, LCD_COLUMNS, LCD_ROWS);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // the lcd task's frame, fixed readings
+    sim_get_summary(&before);
+    uint64_t ticks = sim_delay_ticks();
+    for (int frame = 0; frame < BENCH_LCD_FRAMES && ret == ESP_OK; frame++) {
+        lcd_clear(&lcd);
+        lcd_set_cursor(&lcd, 0, 0);
+        lcd_printf(&lcd, "M:%c D:%.0fcm %s", 'Y', 120.0f, "ARM");
+        lcd_set_cursor(&lcd, 0, 1);
+        ret = lcd_printf(&lcd, "T:%.0fC H:%.0f%%", 21.0f, 45.0f);
+    }
+    ticks = sim_delay_ticks() - ticks;
+    sim_get_summary(&after);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    char rows[SIM_LCD_ROWS][SIM_LCD_COLUMNS + 1];
+    sim_lcd_read(rows);
+    if (strncmp(rows[0], "M:Y D:120cm ARM", 15) != 0 || strncmp(rows[1], "T:21C H:45%", 11) != 0) {
+        ESP_LOGE(TAG, "lcd shows \"%s\" / \"%s\"", rows[0], rows[1]);
+        return ESP_FAIL;
+    }
+
+    // target time: delays plus the bytes on the bus
+    double bytes = (double)(after.lcd_bytes - before.lcd_bytes) / BENCH_LCD_FRAMES;
+    double delay_ticks = (double)ticks / BENCH_LCD_FRAMES;
+    double bus_us = bytes * BENCH_I2C_BITS_PER_BYTE * 1e6 / I2C_MASTER_FREQ_HZ;
+    bench_add(result, "i2c_bytes_per_frame", bytes);
+    bench_add(result, "delay_ticks_per_frame", delay_ticks);
+    bench_add(result, "frame_us", delay_ticks * portTICK_PERIOD_MS * 1000 + bus_us);
+    return ESP_OK;
+}
+
+static esp_err_t bench_snapshot(bench_result_t *result) {
+    snapshot.mutex = xSemaphoreCreateMutex();
+    if (snapshot.mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // publish one reading, as a sensor task
+    int64_t publish_ns = INT64_MAX;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        int64_t start = bench_host_ns();
+        for (int i = 0; i < BENCH_SNAPSHOT_OPS; i++) {
+            if (LOCKPROF_TAKE(snapshot.mutex, portMAX_DELAY) == pdTRUE) {
+                snapshot.distance_cm = (float)i;
+                LOCKPROF_GIVE(snapshot.mutex);
+            }
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        publish_ns = (elapsed < publish_ns) ? elapsed : publish_ns;
+    }
+
+    // read a consistent copy of the whole snapshot
+    int64_t read_ns = INT64_MAX;
+    bench_snapshot_t copy = { 0 };
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        int64_t start = bench_host_ns();
+        for (int i = 0; i < BENCH_SNAPSHOT_OPS; i++) {
+            if (LOCKPROF_TAKE(snapshot.mutex, portMAX_DELAY) == pdTRUE) {
+                memcpy(&copy, &snapshot, sizeof(copy));
+                LOCKPROF_GIVE(snapshot.mutex);
+            }
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        read_ns = (elapsed < read_ns) ? elapsed : read_ns;
+    }
+    vSemaphoreDelete(snapshot.mutex);
+
+    bench_add(result, "ops", BENCH_SNAPSHOT_OPS);
+    bench_add(result, "last_read_cm", copy.distance_cm);
+    bench_add(result, "host_ns_per_publish", (double)publish_ns / BENCH_SNAPSHOT_OPS);
+    bench_add(result, "host_ns_per_read", (double)read_ns / BENCH_SNAPSHOT_OPS);
+    return ESP_OK;
+}
+
+static esp_err_t bench_history(bench_result_t *result) {
+    // error management
+    esp_err_t ret;
+
+    static const struct {
+        const char *name;
+        uint8_t decimals;
+    } channels[BENCH_HISTORY_CHANNELS] = {
+        { "temperature", 0 }, { "humidity", 0 }, { "distance", 1 }, { "zone0", 2 },
+    };
+    int channel_ids[BENCH_HISTORY_CHANNELS];
+    uint32_t rng = 1;
+
+    ret = history_init(&history);
+    for (int i = 0; i < BENCH_HISTORY_CHANNELS && ret == ESP_OK; i++) {
+        ret = history_add_channel(&history, channels[i].name, channels[i].decimals, &channel_ids[i]);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // insert: channels in turn, a second per round; times keep rising across repeats
+    int64_t insert_ns = INT64_MAX;
+    uint32_t time_s = 0;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS && ret == ESP_OK; repeat++) {
+        int64_t start = bench_host_ns();
+        for (int i = 0; i < BENCH_HISTORY_RECORDS && ret == ESP_OK; i++) {
+            int channel = i % BENCH_HISTORY_CHANNELS;
+            time_s += (channel == 0);
+            ret = history_record(&history, channel_ids[channel], time_s, (float)(bench_random(&rng) % 1000) / 10.0f);
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        insert_ns = (elapsed < insert_ns) ? elapsed : insert_ns;
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // query: the last window of one channel, formatted as the csv export
+    int64_t query_ns = INT64_MAX;
+    history_cursor_t cursor;
+    uint32_t rows = 0;
+    uint32_t reads = 0;
+    uint32_t csv_bytes = 0;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        history_record_t records[BENCH_HISTORY_CHUNK];
+        char row[HISTORY_ROW_MAX];
+        rows = 0;
+        reads = 0;
+        csv_bytes = 0;
+
+        int64_t start = bench_host_ns();
+        history_cursor_init(&history, &cursor, time_s - BENCH_HISTORY_WINDOW_S + 1, time_s, 1U << channel_ids[0]);
+        while (!cursor.done) {
+            size_t count = history_read(&history, &cursor, records, BENCH_HISTORY_CHUNK);
+            reads++;
+            for (size_t i = 0; i < count; i++) {
+                csv_bytes += history_format_row(&history, HISTORY_FORMAT_CSV, &records[i], rows == 0, row, sizeof(row));
+                rows++;
+            }
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        query_ns = (elapsed < query_ns) ? elapsed : query_ns;
+    }
+
+    bench_add(result, "records", BENCH_HISTORY_RECORDS);
+    bench_add(result, "rows", rows);
+    bench_add(result, "scanned", cursor.scanned);
+    bench_add(result, "reads", reads);
+    bench_add(result, "csv_bytes", csv_bytes);
+    bench_add(result, "host_ns_per_insert", (double)insert_ns / BENCH_HISTORY_RECORDS);
+    bench_add(result, "host_ns_per_row", rows ? (double)query_ns / rows : 0.0);
+    return ESP_OK;
+}
+
+static esp_err_t bench_codec(bench_result_t *result) {
+    // error management
+    esp_err_t ret;
+
+    compressor_t compressor;
+    uint32_t rng = 1;
+
+    // a day of one zone: slow daily swing, ds18b20 1/16 C steps
+    for (int i = 0; i < BENCH_CODEC_SAMPLES; i++) {
+        float value = 20.0f + 2.5f * sinf(2.0f * BENCH_PI_F * i / BENCH_CODEC_SAMPLES) +
+                      (float)((int)(bench_random(&rng) % 5) - 2) * 0.02f;
+        codec_samples[i] = roundf(value * 16.0f) / 16.0f;
+    }
+
+    // encode: the hub's setting for zone temperatures
+    int64_t encode_ns = INT64_MAX;
+    uint32_t points = 0;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        ret = compressor_init(&compressor, HISTORY_ZONE_MODE, HISTORY_ZONE_DEVIATION, HISTORY_MAX_INTERVAL_MS);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        points = 0;
+        int64_t start = bench_host_ns();
+        for (int i = 0; i < BENCH_CODEC_SAMPLES; i++) {
+            points += compressor_add(&compressor, (int64_t)i * 1000000, codec_samples[i], &codec_points[points]);
+        }
+        points += compressor_flush(&compressor, &codec_points[points]);
+        int64_t elapsed = bench_host_ns() - start;
+        encode_ns = (elapsed < encode_ns) ? elapsed : encode_ns;
+    }
+
+    // decode: every sample back by interpolating between kept points
+    int64_t decode_ns = INT64_MAX;
+    float max_error = 0.0f;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        uint32_t next = 0;
+        max_error = 0.0f;
+        int64_t start = bench_host_ns();
+        for (int i = 0; i < BENCH_CODEC_SAMPLES; i++) {
+            int64_t time_us = (int64_t)i * 1000000;
+            while (next + 1 < points && codec_points[next + 1].time_us <= time_us) {
+                next++;
+            }
+            const compressor_point_t *a = &codec_points[next];
+            const compressor_point_t *b = &codec_points[(next + 1 < points) ? next + 1 : next];
+            float value = a->value;
+            if (b->time_us > a->time_us) {
+                value += (b->value - a->value) * (float)(time_us - a->time_us) / (float)(b->time_us - a->time_us);
+            }
+            float error = fabsf(value - codec_samples[i]);
+            max_error = (error > max_error) ? error : max_error;
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        decode_ns = (elapsed < decode_ns) ? elapsed : decode_ns;
+    }
+
+    bench_add(result, "samples", BENCH_CODEC_SAMPLES);
+    bench_add(result, "points", points);
+    bench_add(result, "bytes", points * sizeof(history_record_t));
+    bench_add(result, "max_error_mc", roundf(max_error * 1000.0f));
+    bench_add(result, "host_ns_per_encode", (double)encode_ns / BENCH_CODEC_SAMPLES);
+    bench_add(result, "host_ns_per_decode", (double)decode_ns / BENCH_CODEC_SAMPLES);
+    return ESP_OK;
+}
+
+static esp_err_t bench_replay(bench_result_t *result) {
+    const uint32_t periods[REPLAY_STREAM_COUNT] = {
+        PIR_SAMPLE_PERIOD_US, ULTRASONIC_SAMPLE_PERIOD_US, DHT11_SAMPLE_PERIOD_US, 0,
+    };
+    int steps_per_distance = ULTRASONIC_SAMPLE_PERIOD_US / PIR_SAMPLE_PERIOD_US;
+    int steps_per_climate = DHT11_SAMPLE_PERIOD_US / PIR_SAMPLE_PERIOD_US;
+    uint32_t rng = 1;
+    int count = 0;
+
+    // inputs in time order as the sample clock delivers them, with task
+    // latency as jitter: pir only around episodes (idle polls are not
+    // recorded), the distance to a wall with 1 cm noise and a missed echo
+    // now and then, dht11 bytes drifting slowly, a decision per episode edge
+    for (int step = 0; step < BENCH_REPLAY_STEPS; step++) {
+        int64_t time_us = (int64_t)step * PIR_SAMPLE_PERIOD_US + bench_random(&rng) % 200;
+        int in_episode = step % BENCH_REPLAY_EPISODE_EVERY;
+
+        if (in_episode < BENCH_REPLAY_EPISODE_STEPS) {
+            replay_records[count++] = (replay_record_t){
+                .kind = REPLAY_INPUT, .stream = REPLAY_PIR, .time_us = time_us,
+                .pir.level = in_episode < BENCH_REPLAY_EPISODE_STEPS * 2 / 3,
+            };
+            if (in_episode == 0 || in_episode == BENCH_REPLAY_EPISODE_STEPS - 1) {
+                replay_records[count++] = (replay_record_t){
+                    .kind = REPLAY_DECISION, .stream = REPLAY_PIR, .digest = bench_random(&rng),
+                };
+            }
+        }
+        if (step % steps_per_distance == 0) {
+            bool ok = bench_random(&rng) % 100 != 0;
+            replay_records[count++] = (replay_record_t){
+                .kind = REPLAY_INPUT, .stream = REPLAY_DISTANCE, .time_us = time_us,
+                .distance = { .ok = ok, .pulse_us = ok ? BENCH_REPLAY_WALL_US + ((int)(bench_random(&rng) % 3) - 1) * 58 : 0 },
+            };
+        }
+        if (step % steps_per_climate == 0) {
+            bool ok = bench_random(&rng) % 50 != 0;
+            replay_records[count++] = (replay_record_t){
+                .kind = REPLAY_INPUT, .stream = REPLAY_CLIMATE, .time_us = time_us,
+                .climate = { .ok = ok, .humidity = ok ? 45 + step / 12000 : 0, .temperature = ok ? 22 : 0 },
+            };
+        }
+    }
+
+    // encode into pages as replay_store(): a record that does not fit opens
+    // the next page, each page with its own header and codec state
+    int64_t encode_ns = INT64_MAX;
+    int pages = 0;
+    uint32_t bytes = 0;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        replay_codec_t codec = { 0 };
+        uint8_t encoded[REPLAY_RECORD_MAX];
+        size_t fill = REPLAY_PAGE_SIZE;
+        int64_t last_us = 0;
+        pages = 0;
+        bytes = 0;
+        memset(replay_pages, 0xff, sizeof(replay_pages));
+        int64_t start = bench_host_ns();
+        for (int i = 0; i < count; i++) {
+            last_us = (replay_records[i].kind == REPLAY_INPUT) ? replay_records[i].time_us : last_us;
+            replay_codec_t next = codec;
+            size_t length = (fill < REPLAY_PAGE_SIZE) ? replay_encode(&next, &replay_records[i], encoded) : 0;
+            if (fill == REPLAY_PAGE_SIZE || fill + length > REPLAY_PAGE_SIZE) {
+                if (pages == BENCH_REPLAY_PAGES) {
+                    return ESP_ERR_NO_MEM;
+                }
+                replay_page_header_t header = { .magic = REPLAY_PAGE_MAGIC, .sequence = pages, .base_us = last_us };
+                memcpy(header.period_us, periods, sizeof(header.period_us));
+                memcpy(replay_pages[pages++], &header, sizeof(header));
+                fill = sizeof(header);
+                bytes += sizeof(header);
+                replay_codec_reset(&codec, header.base_us, periods);
+                next = codec;
+                length = replay_encode(&next, &replay_records[i], encoded);
+            }
+            memcpy(replay_pages[pages - 1] + fill, encoded, length);
+            fill += length;
+            bytes += length;
+            codec = next;
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        encode_ns = (elapsed < encode_ns) ? elapsed : encode_ns;
+    }
+
+    // decode every page and compare with the records that went in
+    int64_t decode_ns = INT64_MAX;
+    uint32_t mismatches = 0;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        replay_codec_t codec;
+        replay_record_t record;
+        int next = 0;
+        mismatches = 0;
+        int64_t start = bench_host_ns();
+        for (int page = 0; page < pages; page++) {
+            replay_page_header_t header;
+            memcpy(&header, replay_pages[page], sizeof(header));
+            uint32_t header_periods[REPLAY_STREAM_COUNT];
+            memcpy(header_periods, header.period_us, sizeof(header_periods));
+            replay_codec_reset(&codec, header.base_us, header_periods);
+            size_t offset = sizeof(header);
+            size_t used;
+            while ((used = replay_decode(&codec, replay_pages[page] + offset, REPLAY_PAGE_SIZE - offset, &record)) > 0) {
+                offset += used;
+                mismatches += next >= count || !bench_replay_equal(&record, &replay_records[next]);
+                next++;
+            }
+        }
+        mismatches += (next < count) ? count - next : 0;
+        int64_t elapsed = bench_host_ns() - start;
+        decode_ns = (elapsed < decode_ns) ? elapsed : decode_ns;
+    }
+
+    bench_add(result, "records", count);
+    bench_add(result, "pages", pages);
+    bench_add(result, "bytes_per_hour", bytes);
+    bench_add(result, "bytes_per_record", round((double)bytes / count * 1000.0) / 1000.0);
+    bench_add(result, "mismatches", mismatches);
+    bench_add(result, "host_ns_per_encode", (double)encode_ns / count);
+    bench_add(result, "host_ns_per_decode", (double)decode_ns / count);
+    return ESP_OK;
+}
+
+static bool bench_replay_equal(const replay_record_t *a, const replay_record_t *b) {
+    if (a->kind != b->kind || a->stream != b->stream) {
+        return false;
+    }
+    if (a->kind == REPLAY_DECISION) {
+        return a->digest == b->digest;
+    }
+    if (a->kind == REPLAY_GAP) {
+        return a->lost == b->lost;
+    }
+    if (a->time_us != b->time_us) {
+        return false;
+    }
+    switch (a->stream) {
+        case REPLAY_PIR:
+            return a->pir.level == b->pir.level;
+        case REPLAY_DISTANCE:
+            return a->distance.ok == b->distance.ok && a->distance.pulse_us == b->distance.pulse_us;
+        case REPLAY_CLIMATE:
+            return a->climate.ok == b->climate.ok && a->climate.humidity == b->climate.humidity &&
+                   a->climate.temperature == b->climate.temperature;
+        default:
+            return a->remote.connected == b->remote.connected && a->remote.motion == b->remote.motion;
+    }
+}
+
+static esp_err_t bench_sensor_dispatch(bench_result_t *result) {
+    // error management
+    esp_err_t ret;
+
+    // pir every period, hc-sr04 every second, dht11 every thirtieth with its start signal
+    const int every[3] = {
+        1, ULTRASONIC_SAMPLE_PERIOD_US / PIR_SAMPLE_PERIOD_US, DHT11_SAMPLE_PERIOD_US / PIR_SAMPLE_PERIOD_US,
+    };
+    const sensor_driver_t *drivers[3] = { &bench_level_driver, &bench_level_driver, &bench_split_driver };
+    static sample_clock_t clock;
+    sensor_registry_init(&sensor_registry, &clock);
+    for (int i = 0; i < 3; i++) {
+        ret = sensor_registry_add(&sensor_registry, drivers[i], &sensor_state[i], NULL,
+                                  (uint32_t)every[i] * PIR_SAMPLE_PERIOD_US, 0, bench_sensor_sink, NULL);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    // through the registry: one pass per clock wake-up, one more per split poll
+    int64_t registry_ns = INT64_MAX;
+    uint64_t registry_sum = 0;
+    sensor_stats_t stats = { 0 };
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        memset(&sensor_registry.stats, 0, sizeof(sensor_registry.stats));
+        memset(sensor_state, 0, sizeof(sensor_state));
+        sensor_sum = 0;
+        int64_t start = bench_host_ns();
+        for (int step = 0; step < BENCH_SENSOR_STEPS; step++) {
+            int64_t now_us = (int64_t)step * PIR_SAMPLE_PERIOD_US;
+            uint32_t due = 0;
+            for (int i = 0; i < 3; i++) {
+                due |= (step % every[i] == 0) ? 1u << i : 0;
+            }
+            int64_t poll_us = sensor_registry_step(&sensor_registry, due, now_us);
+            if (poll_us != INT64_MAX) {
+                sensor_registry_step(&sensor_registry, 0, poll_us);
+            }
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        registry_ns = (elapsed < registry_ns) ? elapsed : registry_ns;
+        registry_sum = sensor_sum;
+        sensor_registry_get_stats(&sensor_registry, &stats);
+    }
+
+    // the same reads called directly
+    int64_t direct_ns = INT64_MAX;
+    for (int repeat = 0; repeat < SIM_BENCH_REPEATS; repeat++) {
+        memset(sensor_state, 0, sizeof(sensor_state));
+        sensor_sum = 0;
+        int64_t start = bench_host_ns();
+        for (int step = 0; step < BENCH_SENSOR_STEPS; step++) {
+            for (int i = 0; i < 3; i++) {
+                if (step % every[i] == 0) {
+                    uint32_t wait_us = 0;
+                    sensor_sample_t sample = { 0 };
+                    if (drivers[i]->start != NULL) {
+                        drivers[i]->start(&sensor_state[i], &wait_us);
+                    }
+                    sample.status = drivers[i]->poll(&sensor_state[i], &wait_us);
+                    drivers[i]->get(&sensor_state[i], &sample);
+                    bench_sensor_sink(&sample, NULL);
+                }
+            }
+        }
+        int64_t elapsed = bench_host_ns() - start;
+        direct_ns = (elapsed < direct_ns) ? elapsed : direct_ns;
+    }
+
+    bench_add(result, "wakes", stats.wakes);
+    bench_add(result, "dispatches", stats.dispatches);
+    bench_add(result, "samples", stats.samples);
+    bench_add(result, "busy_skips", stats.busy_skips);
+    bench_add(result, "mismatches", registry_sum != sensor_sum);
+    bench_add(result, "host_ns_per_sample", (double)registry_ns / stats.samples);
+    bench_add(result, "host_ns_per_direct_sample", (double)direct_ns / stats.samples);
+    bench_add(result, "host_ns_overhead_per_sample", (double)(registry_ns - direct_ns) / stats.samples);
+    return ESP_OK;
+}
+
+static esp_err_t bench_sensor_start(void *sensor, uint32_t *wait_us) {
+    *wait_us = BENCH_SENSOR_SPLIT_US;
+    return ESP_OK;
+}
+
+static esp_err_t bench_sensor_poll(void *sensor, uint32_t *wait_us) {
+    (*(uint32_t *)sensor)++;
+    return ESP_OK;
+}
+
+static void bench_sensor_get(const void *sensor, sensor_sample_t *sample) {
+    uint32_t count = *(const uint32_t *)sensor;
+    sample->level = count & 1;
+    sample->temperature = (float)(count % 40);
+}
+
+static void bench_sensor_sink(const sensor_sample_t *sample, void *arg) {
+    sensor_sum += sample->level + (uint64_t)sample->temperature + (sample->status == ESP_OK);
+}
+
+static void bench_add(bench_result_t *result, const char *name, double value) {
+    if (result->count < SIM_BENCH_MAX_METRICS) {
+        result->metrics[result->count++] = (bench_metric_t){ .name = name, .value = value };
+    }
+}
+
+static int64_t bench_host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t bench_random(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
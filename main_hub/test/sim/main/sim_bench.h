@@ -0,0 +1,26 @@
+/**
+ * @file sim_bench.h
+ * @author Anthony Yalong
+ * @brief Hub micro-benchmarks on the simulator (HUB_SIM_BENCH)
+ */
+#ifndef SIM_BENCH_H
+#define SIM_BENCH_H
+
+// configuration
+#define SIM_BENCH_REPEATS           5           // timed loops run this often, the fastest is kept
+#define SIM_BENCH_MAX_METRICS       8
+
+/**
+ * @brief Run every micro-benchmark and write the results as json
+ *
+ * Counts, sizes and errors are exact and repeat from run to run; delays
+ * are counted in ticks and the i2c bus is timed at I2C_MASTER_FREQ_HZ, so
+ * frame times are those of the target. Host nanoseconds are informational.
+ *
+ * @param json_path Output file
+ * @return int Process exit status: 0 on success, 1 if a benchmark failed or
+ *             the file cannot be written
+ */
+int sim_bench_run(const char *json_path);
+
+#endif  // SIM_BENCH_H
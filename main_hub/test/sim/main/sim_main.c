@@ -0,0 +1,91 @@
+/**
+ * @file sim_main.c
+ * @author Anthony Yalong
+ * @brief Hub simulator entry - provisions the scenario's phones, starts the
+ *        simulation and runs the hub's app_main on it; exit status is 0 when
+ *        every expectation was met. With HUB_SIM_BENCH runs the
+ *        micro-benchmarks instead
+ */
+
+// imports
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs_flash.h"
+#include "presence.h"
+#include "sim.h"
+#include "sim_bench.h"
+#include "main_hub_system_config.h"
+
+static const char *TAG = "HUB_SIM";
+
+// main/main.c is built with app_main renamed
+void hub_app_main(void);
+
+/**
+ * @brief Store the scenario's phones as presence devices, as a provisioning
+ *        step would on a real hub
+ *
+ * @return esp_err_t ESP_OK on success, error code from nvs otherwise
+ */
+static esp_err_t sim_provision_phones(void) {
+    // error management
+    esp_err_t ret;
+
+    static presence_t presence;
+    const char *name;
+    const uint8_t *addr;
+
+    ret = nvs_flash_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = presence_init(&presence, PRESENCE_ENTER_RSSI, PRESENCE_EXIT_RSSI, PRESENCE_AWAY_TIMEOUT_MS, NULL, NULL);
+    for (int i = 0; ret == ESP_OK && sim_get_phone(i, &name, &addr); i++) {
+        presence_identity_t identity = { 0 };
+        strncpy(identity.name, name, sizeof(identity.name) - 1);
+        memcpy(identity.addr, addr, sizeof(identity.addr));
+        ret = presence_add_device(&presence, &identity);
+    }
+    if (ret == ESP_OK && presence.count > 0) {
+        ret = presence_save(&presence);
+    }
+    return ret;
+}
+
+/**
+ * @brief Hub main task - app_main deletes itself once the hub is up and
+ *        only returns when initialization failed
+ *
+ * @param pvParameters Unused
+ */
+static void sim_hub_task(void *pvParameters) {
+    hub_app_main();
+    ESP_LOGE(TAG, "hub failed to start");
+    exit(EXIT_FAILURE);
+}
+
+void app_main(void) {
+    // error management
+    esp_err_t ret;
+
+    // benchmarks need no scenario and no hub
+    const char *bench_path = getenv("HUB_SIM_BENCH");
+    if (bench_path != NULL) {
+        exit(sim_bench_run(bench_path));
+    }
+
+    ret = sim_start(PIR_GPIO_PIN);
+    if (ret == ESP_OK) {
+        ret = sim_provision_phones();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "simulation not started: %s", esp_err_to_name(ret));
+        exit(EXIT_FAILURE);
+    }
+
+    xTaskCreate(sim_hub_task, "main", 8192, NULL, 1, NULL);
+    exit(sim_wait_end());
+}
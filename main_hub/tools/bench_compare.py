@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+@file bench_compare.py
+@author Anthony Yalong
+@brief Compares benchmark results with the checked-in baseline. Results
+       are the simulator's micro-benchmark json (HUB_SIM_BENCH) and run
+       summaries (HUB_SIM_JSON), the latter as the "pipeline" benchmark:
+       each expectation's latency under its label, frames and lcd bytes
+       per frame. Host time (host_*) is printed, every other metric is
+       checked; one without a baseline value (null, or not in the
+       baseline) fails like a regression until --update records it.
+       Exits 1 on a regression or a missing baseline.
+
+usage: bench_compare.py <baseline.json> <results.json>... [--update]
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_results(paths):
+    """merge result files into {benchmark: {metric: value}}"""
+    benchmarks = {}
+    for path in paths:
+        with open(path) as f:
+            data = json.load(f)
+        if "benchmarks" in data:
+            benchmarks.update(data["benchmarks"])
+        elif "expects" in data:
+            benchmarks["pipeline"] = pipeline_metrics(data)
+        else:
+            sys.exit(f"{path}: neither benchmark results nor a run summary")
+    return benchmarks
+
+
+def pipeline_metrics(summary):
+    """a simulator run summary as metrics: latency per expectation label (None if missed)"""
+    metrics = {}
+    for expect in summary["expects"]:
+        latency = expect["latency_us"]
+        name = expect.get("label") or f"expect_line{expect['line']}"
+        metrics[f"{name}_ms"] = latency / 1000 if latency >= 0 else None
+    metrics["frames"] = summary["frames"]
+    metrics["lcd_bytes_per_frame"] = round(summary["lcd_bytes"] / summary["frames"], 3) if summary["frames"] else 0
+    return metrics
+
+
+def check(entry, value):
+    """(verdict, allowed band text) of one metric against its baseline entry"""
+    base = entry["value"]
+    if value is None:
+        return "REGRESSED", "missed"
+    if base is None:
+        return "NO BASE", "run bench_update"
+    slack = abs(base) * entry.get("tolerance_pct", 0) / 100 + entry.get("tolerance_abs", 0)
+    better = entry.get("better", "equal")
+    if better in ("lower", "equal") and value > base + slack:
+        return "REGRESSED", f"<= {base + slack:g}"
+    if better in ("higher", "equal") and value < base - slack:
+        return "REGRESSED", f">= {base - slack:g}"
+    if value != base:
+        return ("improved" if better != "equal" else "ok"), f"{base:g} +/- {slack:g}"
+    return "ok", ""
+
+
+def new_entry(name):
+    """baseline entry for a metric --update records for the first time"""
+    if name.endswith("_ms"):
+        return {"value": None, "better": "lower", "tolerance_abs": 1}
+    return {"value": None, "better": "equal", "tolerance_pct": 0}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="benchmark results against the baseline")
+    parser.add_argument("baseline")
+    parser.add_argument("results", nargs="+")
+    parser.add_argument("--update", action="store_true", help="store these results as the baseline values")
+    args = parser.parse_args()
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    results = load_results(args.results)
+
+    regressions = 0
+    unbased = 0
+    for bench, metrics in sorted(results.items()):
+        print(bench)
+        gated = baseline["benchmarks"].setdefault(bench, {}) if args.update else baseline["benchmarks"].get(bench, {})
+        for name, value in metrics.items():
+            shown = "missed" if value is None else f"{value:.10g}"
+            if name.startswith("host_"):
+                print(f"  {name:28s} {shown:>14s}")
+                continue
+            if name not in gated:
+                if args.update:
+                    gated[name] = new_entry(name)
+                else:
+                    unbased += 1
+                    print(f"  {name:28s} {shown:>14s}  {'NO BASE':9s} not in the baseline, run bench_update")
+                    continue
+            verdict, band = check(gated[name], value)
+            regressions += verdict == "REGRESSED"
+            unbased += verdict == "NO BASE"
+            print(f"  {name:28s} {shown:>14s}  {verdict:9s} {band}".rstrip())
+            if args.update and value is not None:
+                gated[name]["value"] = value
+
+    # gated metrics the run did not produce at all
+    for bench, gated in sorted(baseline["benchmarks"].items()):
+        for name in gated:
+            if name not in results.get(bench, {}):
+                print(f"{bench}.{name}: not reported  REGRESSED")
+                regressions += 1
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2)
+            f.write("\n")
+        print(f"baseline {args.baseline} updated")
+        return 0
+
+    print(f"{regressions} regression(s)" if regressions else "no regressions")
+    if unbased:
+        print(f"{unbased} metric(s) without a baseline value")
+    return 1 if regressions or unbased else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+@file webui_bench.py
+@author Anthony Yalong
+@brief Web ui load test - N concurrent clients fetch every dashboard asset
+       (full responses, then ETag revalidations) and report time to first
+       byte percentiles, then read the hub's /api/webui heap statistics.
+
+usage: webui_bench.py <host[:port]> [--clients 4] [--rounds 50]
+"""
+
+import argparse
+import http.client
+import json
+import statistics
+import threading
+import time
+
+ASSETS = ["/", "/app.js", "/style.css"]
+
+
+def fetch(host, path, etag=None):
+    """one request on a fresh connection, returns (status, ttfb s, total s, etag, body bytes)"""
+    start = time.perf_counter()
+    conn = http.client.HTTPConnection(host, timeout=10)
+    headers = {"Accept-Encoding": "gzip"}
+    if etag:
+        headers["If-None-Match"] = etag
+    conn.request("GET", path, headers=headers)
+    response = conn.getresponse()       # returns once the status line arrives
+    ttfb = time.perf_counter() - start
+    body = response.read()
+    total = time.perf_counter() - start
+    conn.close()
+    return response.status, ttfb, total, response.getheader("ETag"), len(body)
+
+
+def client(host, rounds, results, lock):
+    etags = {}
+    local = {"full": [], "revalidate": [], "errors": 0}
+    for i in range(rounds):
+        for path in ASSETS:
+            # first round downloads, later rounds revalidate with the stored etag
+            try:
+                status, ttfb, _, etag, _ = fetch(host, path, etags.get(path) if i > 0 else None)
+            except OSError:
+                local["errors"] += 1
+                continue
+            if status == 200:
+                etags[path] = etag
+                local["full"].append(ttfb)
+            elif status == 304:
+                local["revalidate"].append(ttfb)
+            else:
+                local["errors"] += 1
+    with lock:
+        for key in ("full", "revalidate"):
+            results[key].extend(local[key])
+        results["errors"] += local["errors"]
+
+
+def percentiles(samples):
+    samples = sorted(samples)
+    pick = lambda q: samples[min(len(samples) - 1, int(q * len(samples)))] * 1000
+    return f"n={len(samples):5d} p50 {pick(0.5):6.2f} ms  p95 {pick(0.95):6.2f} ms  max {samples[-1] * 1000:6.2f} ms"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="web ui first-byte latency under concurrent clients")
+    parser.add_argument("host")
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--rounds", type=int, default=50)
+    args = parser.parse_args()
+
+    # full responses from a cold client, for the baseline
+    cold = [fetch(args.host, path)[1] for path in ASSETS for _ in range(10)]
+
+    results = {"full": [], "revalidate": [], "errors": 0}
+    lock = threading.Lock()
+    threads = [threading.Thread(target=client, args=(args.host, args.rounds, results, lock))
+               for _ in range(args.clients)]
+    start = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.perf_counter() - start
+
+    requests = len(results["full"]) + len(results["revalidate"])
+    print(f"single client     : {percentiles(cold)}")
+    print(f"{args.clients} clients, 200   : {percentiles(results['full'])}")
+    print(f"{args.clients} clients, 304   : {percentiles(results['revalidate'])}")
+    print(f"throughput        : {requests / elapsed:.0f} req/s, {results['errors']} errors")
+
+    try:
+        conn = http.client.HTTPConnection(args.host, timeout=10)
+        conn.request("GET", "/api/webui")
+        stats = json.loads(conn.getresponse().read())
+        print(f"server            : {stats['requests']} requests, avg handler {stats['avg_handler_us']} us, "
+              f"max heap delta {stats['max_heap_delta']} B, free {stats['free_heap']} B "
+              f"(low-water {stats['min_free_heap']} B)")
+    except (OSError, ValueError, KeyError):
+        print("server            : no /api/webui statistics")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+@file webui_pack.py
+@author Anthony Yalong
+@brief Packs the web ui assets into a read-only image for the webui
+       partition. Assets are gzip-precompressed (kept raw if that is not
+       smaller), given a strong ETag and indexed by path, sorted for binary
+       search. Layout must match components/webui/include/webui_assets.h.
+
+usage: webui_pack.py <asset dir> <output image> [--size <partition size>]
+"""
+
+import argparse
+import gzip
+import hashlib
+import mimetypes
+import os
+import struct
+import sys
+
+# image layout (little endian)
+MAGIC = b"WUI1"
+HEADER = struct.Struct("<4sIII")            # magic, count, image size, reserved
+ENTRY = struct.Struct("<56s32s24sIIII")     # path, type, etag, offset, length, flags, reserved
+FLAG_GZIP = 0x01
+ALIGN = 4
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+
+def load_assets(root):
+    assets = []
+    for directory, _, files in os.walk(root):
+        for name in files:
+            full = os.path.join(directory, name)
+            path = "/" + os.path.relpath(full, root).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                raw = f.read()
+
+            # mtime=0 keeps the image (and etags) reproducible
+            packed = gzip.compress(raw, compresslevel=9, mtime=0)
+            flags = FLAG_GZIP
+            if len(packed) >= len(raw):
+                packed, flags = raw, 0
+
+            ext = os.path.splitext(name)[1].lower()
+            content_type = CONTENT_TYPES.get(ext) or mimetypes.guess_type(name)[0] or "application/octet-stream"
+            etag = '"' + hashlib.sha256(packed).hexdigest()[:20] + '"'
+            assets.append((path, content_type, etag, packed, flags, len(raw)))
+
+    # sorted by path bytes, matching strcmp on the device
+    assets.sort(key=lambda a: a[0].encode())
+    return assets
+
+
+def pack(assets):
+    data_offset = HEADER.size + ENTRY.size * len(assets)
+    entries = b""
+    data = b""
+    for path, content_type, etag, packed, flags, _ in assets:
+        if len(path.encode()) >= 56 or len(content_type) >= 32:
+            sys.exit(f"webui_pack: path or content type too long: {path}")
+        offset = data_offset + len(data)
+        entries += ENTRY.pack(path.encode(), content_type.encode(), etag.encode(), offset, len(packed), flags, 0)
+        data += packed + b"\0" * (-len(packed) % ALIGN)
+
+    size = data_offset + len(data)
+    return HEADER.pack(MAGIC, len(assets), size, 0) + entries + data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="pack web ui assets for the webui partition")
+    parser.add_argument("assets")
+    parser.add_argument("output")
+    parser.add_argument("--size", type=lambda v: int(v, 0), help="partition size limit")
+    args = parser.parse_args()
+
+    assets = load_assets(args.assets)
+    image = pack(assets)
+    if args.size is not None and len(image) > args.size:
+        sys.exit(f"webui_pack: image is {len(image)} bytes, partition holds {args.size}")
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    raw_total = sum(a[5] for a in assets)
+    print(f"webui_pack: {len(assets)} assets, {raw_total} -> {len(image)} bytes")
+    for path, _, etag, packed, flags, raw_len in assets:
+        print(f"  {path:<24} {raw_len:>7} -> {len(packed):>7} {'gzip' if flags & FLAG_GZIP else 'raw '} {etag}")
+
+
+if __name__ == "__main__":
+    main()
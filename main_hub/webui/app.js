@@ -0,0 +1,51 @@
+// polls the hub status endpoint and renders the dashboard
+'use strict';
+
+const POLL_MS = 2000;
+const ANALOG_NAMES = ['Gas', 'Smoke', 'Light', 'Sound'];
+
+function text(id, value) {
+  document.getElementById(id).textContent = value;
+}
+
+function render(status) {
+  const armed = document.getElementById('armed');
+  armed.textContent = status.armed ? 'ARMED' : 'DISARMED';
+  armed.className = 'badge ' + (status.armed ? 'armed' : 'disarmed');
+
+  text('motion', status.motion ? 'detected' : 'clear');
+  text('remote', status.remote_connected ? (status.remote_motion ? 'detected' : 'clear') : 'offline');
+  text('distance', status.distance_cm.toFixed(0) + ' cm');
+  text('temperature', status.temperature.toFixed(1) + ' °C');
+  text('humidity', status.humidity.toFixed(0) + ' %');
+
+  const zones = document.getElementById('zones');
+  zones.replaceChildren(...status.zones.map((t, i) => {
+    const item = document.createElement('li');
+    item.textContent = 'Zone ' + (i + 1) + ': ' + t.toFixed(2) + ' °C';
+    return item;
+  }));
+
+  const analog = document.getElementById('analog');
+  analog.replaceChildren(...status.analog.flatMap((level, i) => {
+    const name = document.createElement('dt');
+    const value = document.createElement('dd');
+    name.textContent = ANALOG_NAMES[i] || 'Channel ' + i;
+    value.textContent = level;
+    return [name, value];
+  }));
+
+  text('updated', 'updated ' + new Date().toLocaleTimeString());
+}
+
+async function poll() {
+  try {
+    const response = await fetch('/api/status', { cache: 'no-store' });
+    render(await response.json());
+  } catch (err) {
+    text('updated', 'hub unreachable');
+  }
+  setTimeout(poll, POLL_MS);
+}
+
+poll();
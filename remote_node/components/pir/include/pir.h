@@ -13,6 +13,24 @@
 #include "driver/gpio.h"
 #include "esp_err.h"
 
+// configuration
+#define PIR_DEFAULT_HOLD_TIME_MS 10000  // quiet time before an episode ends
+
+// pir episode event type
+typedef enum {
+    PIR_EPISODE_NONE = 0,      // no episode transition
+    PIR_EPISODE_START,         // first motion after a quiet period
+    PIR_EPISODE_END,           // no motion for the hold time
+} pir_episode_type_t;
+
+// pir occupancy episode event
+typedef struct {
+    pir_episode_type_t type;   // start or end
+    int64_t start_time_us;     // episode start time (microseconds)
+    int64_t duration_us;       // end only: first to last motion (microseconds)
+    uint32_t retrigger_count;  // end only: motion events after the first
+} pir_episode_t;
+
 // pir sensor structure
 typedef struct {
     gpio_num_t pin_num;        // gpio pin number
@@ -20,6 +38,11 @@ typedef struct {
     uint32_t motion_count;     // total motion events detected
     uint32_t debounce_ms;      // debounce time in milliseconds
     int64_t last_trigger_time; // last motion detection time (microseconds)
+    uint32_t hold_ms;          // episode hold time in milliseconds
+    bool in_episode;           // episode currently open
+    int64_t episode_start_time;// open episode start time (microseconds)
+    int64_t last_motion_time;  // last time output was HIGH (microseconds)
+    uint32_t retrigger_count;  // motion events since episode start
 } pir_sensor_t;
 
 /**
@@ -51,6 +74,32 @@ bool pir_read(pir_sensor_t *pir);
  */
 uint32_t pir_get_motion_count(const pir_sensor_t *pir);
 
+/**
+ * @brief Set episode hold time
+ * 
+ * An open episode ends once the sensor output has stayed LOW for this long.
+ * Should be longer than the HC-SR501 retrigger gap so that one presence
+ * produces one episode.
+ * 
+ * @param pir Pointer to PIR sensor structure
+ * @param hold_time Hold time in milliseconds
+ */
+void pir_set_hold_time(pir_sensor_t *pir, uint32_t hold_time);
+
+/**
+ * @brief Read PIR sensor and report occupancy episode transitions
+ * 
+ * Calls pir_read() and folds debounced motion events into episodes:
+ * PIR_EPISODE_START on the first motion after a quiet period, and
+ * PIR_EPISODE_END with duration and retrigger count once the output has
+ * been LOW for the hold time. Poll at the same rate as pir_read().
+ * 
+ * @param pir Pointer to PIR sensor structure
+ * @param episode Filled in when a transition is reported
+ * @return pir_episode_type_t Transition type, PIR_EPISODE_NONE if nothing changed
+ */
+pir_episode_type_t pir_poll_episode(pir_sensor_t *pir, pir_episode_t *episode);
+
 /**
  * @brief Reset motion event counter to zero
  * 
@@ -22,6 +22,16 @@
 #define PIR_GPIO_PIN            GPIO_NUM_13
 #define PIR_DEBOUNCE_TIME_MS    50
 
+// i2c configuration
+#define I2C_MASTER_SCL_IO       GPIO_NUM_22
+#define I2C_MASTER_SDA_IO       GPIO_NUM_21
+#define I2C_MASTER_NUM          I2C_NUM_0
+#define I2C_MASTER_FREQ_HZ      400000
+
+// oled configuration
+#define OLED_ADDR               0x3C
+#define OLED_SLEEP_TIMEOUT_MS   30000
+
 // task configuration
 #define SENSOR_TASK_STACK_SIZE  4096
 #define SENSOR_TASK_PRIORITY    5
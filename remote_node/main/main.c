@@ -9,6 +9,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "driver/i2c.h"
 #include "nvs_flash.h"
 #include "esp_nimble_hci.h"
 #include "nimble/nimble_port.h"
@@ -17,6 +18,7 @@
 #include "services/gap/ble_svc_gap.h"
 #include "services/gatt/ble_svc_gatt.h"
 #include "pir.h"
+#include "ssd1306.h"
 #include "remote_node_system_config.h"
 
 static const char *TAG = "REMOTE_NODE";
@@ -25,10 +27,29 @@ static const char *TAG = "REMOTE_NODE";
 static uint8_t motion_detected = 0;
 static uint16_t motion_char_handle;
 
+// local status display
+static ssd1306_handle_t oled;
+static bool oled_ready = false;
+
 // ============================================================================
 // function prototypes
 // ============================================================================
 
+/**
+ * @brief initialize i2c master bus
+ * 
+ * @return esp_err_t ESP_OK on success
+ */
+static esp_err_t i2c_master_init(void);
+
+/**
+ * @brief redraw local oled status and apply motion-based display sleep
+ * 
+ * @param motion current motion state
+ * @param motion_count total motion events
+ */
+static void oled_update(bool motion, uint32_t motion_count);
+
 /**
  * @brief advertise ble service for remote node discovery
  */
@@ -123,6 +144,18 @@ void app_main(void) {
         return;
     }
     
+    // initialize oled (optional - node keeps running without a display)
+    ret = i2c_master_init();
+    if (ret == ESP_OK) {
+        ret = ssd1306_init(&oled, I2C_MASTER_NUM, OLED_ADDR);
+    }
+    if (ret == ESP_OK) {
+        ssd1306_set_sleep_timeout(&oled, OLED_SLEEP_TIMEOUT_MS);
+        oled_ready = true;
+    } else {
+        ESP_LOGW(TAG, "oled not available, continuing without local display");
+    }
+    
     // initialize nimble
     ret = nimble_port_init();
     if (ret != ESP_OK) {
@@ -159,6 +192,56 @@ void app_main(void) {
     ESP_LOGI(TAG, "initialization complete");
 }
 
+// ============================================================================
+// helper functions
+// ============================================================================
+
+static esp_err_t i2c_master_init(void) {
+    // i2c config
+    i2c_config_t config = {
+        .mode = I2C_MODE_MASTER,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ
+    };
+    
+    esp_err_t ret = i2c_param_config(I2C_MASTER_NUM, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to configure i2c parameters");
+        return ret;
+    }
+    
+    ret = i2c_driver_install(I2C_MASTER_NUM, config.mode, 0, 0, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to install i2c driver");
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "i2c master initialized");
+    return ESP_OK;
+}
+
+static void oled_update(bool motion, uint32_t motion_count) {
+    if (!oled_ready) {
+        return;
+    }
+    
+    // motion wakes the panel, idle time puts it to sleep
+    if (motion) {
+        ssd1306_notify_motion(&oled);
+    } else {
+        ssd1306_sleep_check(&oled);
+    }
+    
+    // only changed glyph columns are flushed
+    ssd1306_printf_line(&oled, 0, "%s", BLE_DEVICE_NAME);
+    ssd1306_printf_line(&oled, 2, "Motion: %s", motion ? "YES" : "NO");
+    ssd1306_printf_line(&oled, 3, "Events: %lu", motion_count);
+    ssd1306_flush(&oled);
+}
+
 // ============================================================================
 // ble functions
 // ============================================================================
@@ -238,13 +321,20 @@ static void sensor_task(void *pvParameters) {
     pir_init(&pir, PIR_GPIO_PIN, PIR_DEBOUNCE_TIME_MS);
     
     TickType_t last_wake = xTaskGetTickCount();
+    uint32_t motion_count = 0;
     
     while (1) {
         // read pir sensor (simulated for now)
         motion_detected = (motion_detected == 0) ? 1 : 0;
+        if (motion_detected) {
+            motion_count++;
+        }
         
         ESP_LOGI(TAG, "motion status: %d", motion_detected);
         
+        // update local display
+        oled_update(motion_detected, motion_count);
+        
         vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SENSOR_READ_INTERVAL_MS));
     }
     
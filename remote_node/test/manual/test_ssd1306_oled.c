@@ -0,0 +1,150 @@
+/**
+ * @file test_ssd1306_oled.c
+ * @author Anthony Yalong
+ * @brief SSD1306 OLED test application - validates initialization, text
+ *        rendering, dirty-range flushing and motion-based display sleep.
+ *        Reports bytes and time per flush for a full frame and for a
+ *        typical status update at the configured i2c clock (400 kHz).
+ *        Replace main/main.c with this file to run OLED tests.
+ */
+
+// imports
+#include "ssd1306.h"
+#include "esp_log.h"
+#include "driver/i2c.h"
+#include "remote_node_system_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// test configuration
+#define TASK_DELAY_MS 1000          // 1s between status updates
+#define TASK_STACK_DEPTH 4096       // safe stack depth for testing
+#define TASK_PRIORITY 5             // safe task priority for testing
+#define TEST_SLEEP_TIMEOUT_MS 5000  // short timeout to observe sleep
+#define TEST_MOTION_PERIOD 12       // simulated motion every 12 updates
+
+// logging
+static const char *TAG = "test_ssd1306_oled";
+
+// oled handle
+static ssd1306_handle_t oled;
+static uint32_t counter = 0;
+
+// function prototypes
+esp_err_t i2c_master_init(void);
+void test_ssd1306_oled(void *pvParameters);
+void log_flush(const char *label);
+
+void app_main(void) {
+    esp_err_t ret;
+
+    ESP_LOGI(TAG, "Starting SSD1306 OLED test...");
+
+    // initialize i2c
+    ret = i2c_master_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize i2c master");
+        return;
+    }
+
+    // initialize oled
+    ret = ssd1306_init(&oled, I2C_MASTER_NUM, OLED_ADDR);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize oled");
+        return;
+    }
+    ssd1306_set_sleep_timeout(&oled, TEST_SLEEP_TIMEOUT_MS);
+
+    // full frame: every column lit then flushed
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+            ssd1306_draw_pixel(&oled, x, page * 8, true);
+        }
+    }
+    ssd1306_flush(&oled);
+    log_flush("full frame");
+
+    // startup screen
+    ssd1306_clear(&oled);
+    ssd1306_printf_line(&oled, 0, "oled test");
+    ssd1306_printf_line(&oled, 2, "Motion: NO");
+    ssd1306_printf_line(&oled, 3, "Count: 0");
+    ssd1306_flush(&oled);
+    log_flush("startup screen");
+
+    // create oled task
+    xTaskCreate(
+        test_ssd1306_oled,
+        "test_ssd1306_oled",
+        TASK_STACK_DEPTH,
+        NULL,
+        TASK_PRIORITY,
+        NULL
+    );
+}
+
+esp_err_t i2c_master_init(void) {
+    // i2c config
+    i2c_config_t config = {
+        .mode = I2C_MODE_MASTER,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ
+    };
+
+    esp_err_t ret = i2c_param_config(I2C_MASTER_NUM, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to configure i2c parameters");
+        return ret;
+    }
+
+    ret = i2c_driver_install(I2C_MASTER_NUM, config.mode, 0, 0, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to install i2c driver");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "i2c master initialized at %d Hz", I2C_MASTER_FREQ_HZ);
+    return ESP_OK;
+}
+
+void log_flush(const char *label) {
+    const ssd1306_stats_t *stats = ssd1306_get_stats(&oled);
+
+    // 9 clocks per byte (8 data + ack) - lower bound for the bus time
+    uint32_t wire_us = (uint32_t)(((uint64_t)stats->last_flush_bytes * 9 * 1000000) / I2C_MASTER_FREQ_HZ);
+
+    ESP_LOGI(TAG, "%s: %lu bytes, %lu transactions total, flush %lld us (wire min %lu us)",
+             label, stats->last_flush_bytes, stats->transactions, stats->last_flush_us, wire_us);
+    ssd1306_reset_stats(&oled);
+}
+
+void test_ssd1306_oled(void *pvParameters) {
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true) {
+        counter++;
+
+        // simulated motion pulse wakes the display, otherwise it sleeps after the timeout
+        bool motion = (counter % TEST_MOTION_PERIOD) == 0;
+        if (motion) {
+            ssd1306_notify_motion(&oled);
+        } else {
+            ssd1306_sleep_check(&oled);
+        }
+
+        // typical status update: motion flag and counter change
+        ssd1306_printf_line(&oled, 2, "Motion: %s", motion ? "YES" : "NO");
+        ssd1306_printf_line(&oled, 3, "Count: %lu", counter);
+        ssd1306_flush(&oled);
+        log_flush("status update");
+
+        ESP_LOGI(TAG, "display %s - counter: %lu", oled.display_on ? "ON" : "SLEEP", counter);
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TASK_DELAY_MS));
+    }
+
+    vTaskDelete(NULL);
+}